@@ -5,18 +5,44 @@
  * 
  */
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <filesystem>
 #include <fstream>
+#include <future>
 #include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <ostream>
+#include <random>
+#include <span>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 #include "clipp.h"
 #include "log_message/message.h"
+#include "log_message/symbol.h"
+#include "log_message_organizer/external_organizer.h"
 #include "log_message_organizer/organize_by_id.h"
+#include "log_message_organizer/organize_pipelines.h"
 #include "log_message_organizer/split_by_pipeline.h"
 #include "log_message_parser/ascii_body_parser.h"
 #include "log_message_parser/hex16_body_parser.h"
+#include "log_message_parser/input_source.h"
+#include "log_message_parser/pipeline_partitions.h"
 #include "log_message_parser/semantics.h"
+#include "log_message_parser/static_parser.h"
 #include "log_message_parser/structure.h"
+#include "log_message_parser/structure_incremental.h"
+#include "log_message_parser/structure_view.h"
 
 /******************************************************************************
  * TYPEDEFS AND ALIASES
@@ -26,6 +52,10 @@ namespace pipelines::app {
 /// Type alias for the structure parser results
 using StructureParseResult = log_message_parser::structure::ParseResult;
 
+/// Type alias for the zero-copy structure parser results
+using StructureViewParseResult =
+    log_message_parser::structure::ViewParseResult;
+
 /// Type alias for the semantics parser results
 using SemanticsParseResult = log_message_parser::semantics::ParseResult;
 
@@ -35,6 +65,54 @@ using SemanticsLogMessages = log_message_parser::semantics::LogMessages;
 /// Type alias for the log message errors separated by pipeline
 using MessagesByPipeline = log_message_organizer::PipelineLogMessagesByPipeline;
 
+/// Type alias for the organizers of the followed pipelines, by pipeline
+using OrganizersByPipeline =
+    std::map<std::string, log_message_organizer::IncrementalOrganizeById>;
+
+/// Type alias for the partition files of the partitioned mode
+using PipelinePartitions = log_message_parser::PipelinePartitions;
+
+/// Type alias for the ways the input file can be read
+using InputMode = log_message_parser::InputMode;
+
+/// Type alias for the limits on the size of the message bodies
+using BodyLimits = log_message_parser::structure::BodyLimits;
+
+/// Type alias for when the message bodies are decoded
+using BodyDecoding = log_message_parser::semantics::BodyDecoding;
+
+/// Type alias for whether the semantic errors carry their messages
+using ErrorMessages = log_message_parser::semantics::ErrorMessages;
+
+/// Type alias for the semantics parser, with the ascii body parser for the
+/// encoding "0" and the hexadecimal one for "1", fixed at compile time
+using SemanticsParser = log_message_parser::semantics::StaticParser<
+    log_message_parser::semantics::Encoding<
+        "0", log_message_parser::semantics::AsciiBodyParser>,
+    log_message_parser::semantics::Encoding<
+        "1", log_message_parser::semantics::Hex16BodyParser>>;
+
+}  // namespace pipelines::app
+
+/******************************************************************************
+ * CONSTANTS
+ *****************************************************************************/
+namespace pipelines::app {
+
+/// The names of the ways the input can be read, given with --io
+constexpr auto kInputModeNames = std::array<std::string_view, 6>{
+    "stream", "read", "mmap", "mmap-whole", "direct", "stdin"};
+
+/// Time between two checks for new data in follow mode
+constexpr auto kFollowPollInterval = std::chrono::milliseconds{500};
+
+/// Size of the blocks read from the followed file
+constexpr size_t kFollowBlockSize = 64 * 1024;
+
+/// Size of the blocks read by the single pass ingest, the messages of a block
+/// are routed to their pipelines before the next one is read
+constexpr size_t kIngestBlockSize = 1024 * 1024;
+
 }  // namespace pipelines::app
 
 /******************************************************************************
@@ -49,7 +127,7 @@ namespace pipelines::app {
  * This class has all the parsed command line arguments
  */
 struct CommandLineArguments {
-  /// The name of the input file where the data is
+  /// The name of the input file where the data is, "-" for stdin
   std::string input_file{};
   /// If output_to_file is true, this will contain the name of the file where we will write the output
   std::string output_file{};
@@ -61,6 +139,31 @@ struct CommandLineArguments {
   bool help = false;
   /// When set will make any error cause a failure
   bool strict = false;
+  /// When set the whole input file is memory mapped and parsed without
+  /// copying, set by --io mmap-whole or its shorthand -m
+  bool mmap = false;
+  /// Number of threads used to parse the input file and to organize the
+  /// pipelines
+  size_t threads = 1;
+  /// How the input file is read: stream, read, mmap, mmap-whole, direct or
+  /// stdin, empty for the default
+  std::string io{};
+  /// When set the input file is followed as it grows, like tail -f
+  bool follow = false;
+  /// Maximum number of bytes of a message body, 0 for no limit
+  size_t max_body_bytes = 0;
+  /// Maximum number of lines of a message body, 0 for no limit
+  size_t max_body_lines = 0;
+  /// When set the bodies are only validated, and decoded when printed
+  bool lazy_decoding = false;
+  /// Megabytes of messages kept in memory while organizing, the rest is
+  /// spilled to disk, 0 to keep everything in memory
+  size_t memory_budget = 0;
+  /// Directory of the spill files, the temporary directory when empty
+  std::string spill_directory{};
+  /// Number of partition files the messages are split into before being
+  /// organized a partition at a time, 0 to organize them all at once
+  size_t partitions = 0;
 };
 
 /**
@@ -93,30 +196,172 @@ namespace pipelines::app {
  */
 static std::pair<bool, CommandLineArguments> ParseCommandLineArguments(
     int argc, char* argv[]);
+/**
+ * @brief Checks the input options and fills in their defaults: -m is the
+ * same as --io mmap-whole, and with --io stdin the input file is optional,
+ * and can only be "-".
+ * @param cli_args The parsed command line arguments, completed in place.
+ * @return The error of conflicting or missing input options, if any.
+ */
+static std::optional<std::string> CompleteInputOptions(
+    CommandLineArguments& cli_args);
+/**
+ * @brief Checks that the options of the modes of the application can be
+ * combined: --follow can't be combined with --memory-budget or --partitions.
+ * @param cli_args The parsed command line arguments.
+ * @return The error of conflicting options, if any.
+ */
+static std::optional<std::string> CheckModeOptions(
+    const CommandLineArguments& cli_args);
 
-static void RunApplication(const CommandLineArguments& cli_args);
-
+/**
+ * @brief Converts the name of an input mode given in the command line.
+ * @param name The name of the input mode.
+ * @return The input mode.
+ */
+static InputMode ParseInputMode(const std::string& name);
 /**
  * @brief Parses the structure of the log messages from the input file.
- * @param input_file The input file containing log messages.
+ * @param input_file The input file containing log messages, "-" for stdin.
+ * @param input_mode How the input file is read.
+ * @param threads The number of threads used to parse.
+ * @param body_limits The limits on the size of the message bodies.
  * @return The parsed structure of the log messages.
  */
-static StructureParseResult ParseStructure(const std::string& input_file);
+static StructureParseResult ParseStructure(const std::string& input_file,
+                                           InputMode input_mode,
+                                           size_t threads,
+                                           BodyLimits body_limits);
+/**
+ * @brief Parses the structure of the log messages from a memory mapped input file.
+ * @param input_file The input file containing log messages.
+ * @param threads The number of threads used to parse.
+ * @param body_limits The limits on the size of the message bodies.
+ * @return The parsed structure of the log messages, pointing into the mapping.
+ */
+static StructureViewParseResult ParseStructureMapped(
+    const std::string& input_file, size_t threads, BodyLimits body_limits);
 /**
  * @brief Parses the semantics of the log messages from the structure parse result.
  * @param structure_parse_result The structure parse result.
+ * @param body_decoding When the bodies are decoded, the lazily decoded ones
+ * keep the structure messages they point into alive.
+ * @param threads The number of threads used to parse.
+ * @param error_messages Whether the errors carry their messages.
+ * @param symbol_table Where the IDs of the log messages are interned.
  * @return The parsed semantics of the log messages.
  */
+template <typename StructureResult>
 static SemanticsParseResult ParseSemantics(
-    const StructureParseResult& structure_parse_result);
+    const StructureResult& structure_parse_result, BodyDecoding body_decoding,
+    size_t threads, ErrorMessages error_messages,
+    log_message::SymbolTable& symbol_table);
+/**
+ * @brief Finds whether the semantic errors need their messages, they are
+ * only shown in verbose mode, otherwise only their number matters.
+ * @param cli_args The command line arguments.
+ * @return Whether the errors carry their messages.
+ */
+static ErrorMessages SemanticErrorMessages(
+    const CommandLineArguments& cli_args);
+/**
+ * @brief Reports the parsing errors, and fails in strict mode if there are any.
+ * @param input_file The input file containing log messages.
+ * @param structure_errors The errors of the structure parser.
+ * @param semantic_errors The errors of the semantics parser.
+ * @param cli_args The command line arguments.
+ */
+static void ReportParseErrors(
+    const std::string& input_file,
+    const log_message_parser::structure::ParseErrors& structure_errors,
+    const log_message_parser::semantics::ParseErrors& semantic_errors,
+    const CommandLineArguments& cli_args);
+/**
+ * @brief Reports the parsing errors and extracts the parsed log messages.
+ * @param input_file The input file containing log messages.
+ * @param structure_results The structure parse result.
+ * @param semantic_parse_result The semantics parse result, its messages are
+ * moved out of it.
+ * @param cli_args The command line arguments.
+ * @return The parsed log messages.
+ */
+template <typename StructureResult>
+static SemanticsLogMessages CheckParseResults(
+    const std::string& input_file, const StructureResult& structure_results,
+    SemanticsParseResult semantic_parse_result,
+    const CommandLineArguments& cli_args);
 /**
  * @brief Parses the input file and returns the log messages.
  * @param input_file The input file containing log messages.
  * @param cli_args The command line arguments.
+ * @param symbol_table Where the IDs of the log messages are interned.
  * @return The parsed log messages.
  */
 static SemanticsLogMessages ParseInputFile(
-    const std::string& input_file, const CommandLineArguments& cli_args);
+    const std::string& input_file, const CommandLineArguments& cli_args,
+    log_message::SymbolTable& symbol_table);
+/**
+ * @brief Parses the structure of the input file in blocks, giving the result
+ * of each block to a consumer as soon as it's parsed.
+ * @param input_file The input file containing log messages, "-" for stdin.
+ * @param cli_args The command line arguments.
+ * @param consume The consumer, called with the structure parse result of
+ * every block.
+ */
+template <typename Consume>
+static void ParseStructureInBlocks(const std::string& input_file,
+                                   const CommandLineArguments& cli_args,
+                                   Consume consume);
+/**
+ * @brief Parses the input file in blocks, giving the log messages of each
+ * block to a consumer as soon as they are parsed, and reports the errors at
+ * the end, like ParseInputFile.
+ * @param input_file The input file containing log messages, "-" for stdin.
+ * @param cli_args The command line arguments.
+ * @param body_decoding When the bodies are decoded.
+ * @param symbol_table Where the IDs of the log messages are interned, or
+ * nullptr to intern the IDs of every block in a table of its own, which only
+ * lives until the block is consumed.
+ * @param consume The consumer, called with the log messages of every block.
+ */
+template <typename Consume>
+static void ParseInBlocks(const std::string& input_file,
+                          const CommandLineArguments& cli_args,
+                          BodyDecoding body_decoding,
+                          log_message::SymbolTable* symbol_table,
+                          Consume consume);
+/**
+ * @brief Parses the input file in a single pass, routing the messages of each
+ * block to their pipelines as soon as they are parsed.
+ *
+ * Only the messages split by pipeline are kept, instead of the structure
+ * messages, the parsed ones and the split ones of the whole file. The results
+ * and the reported errors are the same as the ones of ParseInputFile.
+ *
+ * @param input_file The input file containing log messages, "-" for stdin.
+ * @param cli_args The command line arguments.
+ * @param symbol_table Where the IDs of the log messages are interned.
+ * @return The parsed log messages, by pipeline.
+ */
+static MessagesByPipeline IngestInputFile(
+    const std::string& input_file, const CommandLineArguments& cli_args,
+    log_message::SymbolTable& symbol_table);
+/**
+ * @brief Parses the input file and splits its log messages by pipeline,
+ * in a single pass when the file is parsed sequentially and not mapped.
+ * @param input_file The input file containing log messages.
+ * @param cli_args The command line arguments.
+ * @param symbol_table Where the IDs of the log messages are interned.
+ * @return The parsed log messages, by pipeline.
+ */
+static MessagesByPipeline ReadMessagesByPipeline(
+    const std::string& input_file, const CommandLineArguments& cli_args,
+    log_message::SymbolTable& symbol_table);
+/**
+ * @brief Fails because the input file has no messages.
+ * @throw ApplicationRuntimeError Always.
+ */
+[[noreturn]] static void FailWithoutMessages();
 /**
  * @brief Prints the log messages for a specific pipeline.
  * @param oss The output stream to print to.
@@ -140,6 +385,94 @@ static void PrintPipeline(std::ostream& oss,
  */
 static void OutputMessages(const MessagesByPipeline& messages,
                            const CommandLineArguments& cli_args);
+/**
+ * @brief Adds new messages to the pipelines and prints the pipelines that
+ * received any of them.
+ * @param oss The output stream to print to.
+ * @param structure_results The structure parse result of the new data.
+ * @param organizers The organizers of the messages received so far, by
+ * pipeline, the new ones are inserted into them.
+ * @param symbol_table Where the IDs of the new messages are interned, the
+ * same table as the ones of the organizers.
+ * @param cli_args The command line arguments.
+ */
+static void UpdatePipelines(std::ostream& oss,
+                            const StructureParseResult& structure_results,
+                            OrganizersByPipeline& organizers,
+                            log_message::SymbolTable& symbol_table,
+                            const CommandLineArguments& cli_args);
+/**
+ * @brief Follows the input file as it grows, printing the pipelines that
+ * receive new messages. It never returns, unless there is an error.
+ * @param oss The output stream to print to.
+ * @param cli_args The command line arguments.
+ */
+static void FollowInputFile(std::ostream& oss,
+                            const CommandLineArguments& cli_args);
+/**
+ * @brief Runs the follow mode, with the output decided by the cli.
+ * @param cli_args The command line arguments.
+ */
+static void RunFollowMode(const CommandLineArguments& cli_args);
+/**
+ * @brief Organizes the input file with a bounded amount of memory, spilling
+ * the messages to disk, and prints the pipelines.
+ * @param oss The output stream to print to.
+ * @param cli_args The command line arguments.
+ */
+static void OrganizeOutOfCore(std::ostream& oss,
+                              const CommandLineArguments& cli_args);
+/**
+ * @brief Runs the out-of-core mode, with the output decided by the cli.
+ * @param cli_args The command line arguments.
+ */
+static void RunOutOfCoreMode(const CommandLineArguments& cli_args);
+/**
+ * @brief Gets the directory of the spill files given in the command line.
+ * @param cli_args The command line arguments.
+ * @return The directory, the temporary directory by default.
+ */
+static std::filesystem::path SpillDirectory(
+    const CommandLineArguments& cli_args);
+/**
+ * @brief Splits the input file into partitions by pipeline, the first pass of
+ * the partitioned mode, and reports the errors like ParseInputFile.
+ *
+ * The messages are only checked, so their IDs aren't interned and their
+ * bodies aren't decoded, and the valid ones are written to their partition.
+ *
+ * @param input_file The input file containing log messages, "-" for stdin.
+ * @param cli_args The command line arguments.
+ * @param partitions The partitions, the messages are added to them.
+ */
+static void PartitionInputFile(const std::string& input_file,
+                               const CommandLineArguments& cli_args,
+                               PipelinePartitions& partitions);
+/**
+ * @brief Parses and organizes the partitions one at a time, the second pass
+ * of the partitioned mode, and prints the pipelines.
+ *
+ * Every partition has its own symbol table, so only the IDs of the
+ * partitions being organized are in memory. Without a memory budget the
+ * partitions are organized one at a time, with all the threads; with one,
+ * several are organized at once, a thread each, as long as the sizes of their
+ * files fit in the budget together.
+ *
+ * The organized pipelines are written to a spill file, and then copied to the
+ * output in the order of their IDs, the same order as the other modes.
+ *
+ * @param oss The output stream to print to.
+ * @param partitions The partitions, they are emptied.
+ * @param cli_args The command line arguments.
+ */
+static void OrganizePartitions(std::ostream& oss,
+                               PipelinePartitions& partitions,
+                               const CommandLineArguments& cli_args);
+/**
+ * @brief Runs the partitioned mode, with the output decided by the cli.
+ * @param cli_args The command line arguments.
+ */
+static void RunPartitionedMode(const CommandLineArguments& cli_args);
 /**
  * @brief Runs the application with the specified command line arguments.
  * @param cli_args The command line arguments.
@@ -162,77 +495,365 @@ static std::pair<bool, CommandLineArguments> ParseCommandLineArguments(
 
   auto cli =
       (option("-h", "--help").set(cli_args.help) % "show this help message",
-       value("infile", cli_args.input_file) % "input filename",
+       opt_value("infile", cli_args.input_file) %
+           "input filename, optional with -i stdin",
        option("-v", "--verbose").set(cli_args.verbose) %
            "verbose output, will show all warnings",
        option("-s", "--strict").set(cli_args.strict) %
            "strict mode, will throw an error if any warnings are found",
+       option("-m", "--mmap").set(cli_args.mmap) %
+           "memory map the whole input file and parse it without copying, "
+           "the same as --io mmap-whole",
+       option("-j", "--threads") %
+               "number of threads used to parse and to organize, including "
+               "the list ranking of big pipelines and the partitions" &
+           value("threads", cli_args.threads),
+       option("-i", "--io") %
+               "how the input is read: stream, read, mmap, mmap-whole, direct "
+               "or stdin" &
+           value("mode", cli_args.io),
+       option("-f", "--follow").set(cli_args.follow) %
+           "keep parsing the data appended to the input file, printing the "
+           "pipelines that change",
+       option("--max-body-bytes") %
+               "maximum size of a message body, a longer one is reported and "
+               "skipped until the next message (0 for no limit)" &
+           value("bytes", cli_args.max_body_bytes),
+       option("--max-body-lines") %
+               "maximum number of lines of a message body, a longer one is "
+               "reported and skipped until the next message (0 for no limit)" &
+           value("lines", cli_args.max_body_lines),
+       option("-l", "--lazy-decoding").set(cli_args.lazy_decoding) %
+           "only validate the message bodies while parsing, and decode them "
+           "when they are printed (with -m, -j, --memory-budget or "
+           "--partitions)",
+       option("--memory-budget") %
+               "organize with at most this many MiB of messages in memory, "
+               "spilling the bodies and the rest of the messages to disk (0 "
+               "for no limit)" &
+           value("MiB", cli_args.memory_budget),
+       option("--partitions") %
+               "split the messages by pipeline into this many files on disk, "
+               "and then parse and organize one file at a time, or several "
+               "within --memory-budget (0 for none)" &
+           value("N", cli_args.partitions),
+       option("--spill-dir") %
+               "directory of the spill files of --memory-budget and "
+               "--partitions, the temporary directory by default" &
+           value("dir", cli_args.spill_directory),
        option("-o", "--output").set(cli_args.output_to_file) %
                "output to file" &
            value("outfile", cli_args.output_file));
 
-  auto success = parse(argc, argv, cli);
+  auto success = static_cast<bool>(parse(argc, argv, cli));
+  if (success && !cli_args.help) {
+    auto error = CompleteInputOptions(cli_args);
+    if (!error) {
+      error = CheckModeOptions(cli_args);
+    }
+    if (error) {
+      std::cerr << *error << std::endl;
+      success = false;
+    }
+  }
   if (!success || cli_args.help) {
     std::cout << make_man_page(cli, argv[0]) << '\n';
   }
 
-  return {static_cast<bool>(success), cli_args};
+  return {success, cli_args};
+}
+
+static std::optional<std::string> CompleteInputOptions(
+    CommandLineArguments& cli_args) {
+  if (!cli_args.io.empty() &&
+      std::ranges::find(kInputModeNames, std::string_view{cli_args.io}) ==
+          kInputModeNames.end()) {
+    return "Unknown input mode: " + cli_args.io;
+  }
+  if (cli_args.mmap && !cli_args.io.empty() && cli_args.io != "mmap-whole") {
+    return "The -m/--mmap option maps the whole input file, it can't be "
+           "combined with --io " +
+           cli_args.io;
+  }
+  if (cli_args.io == "mmap-whole") {
+    cli_args.mmap = true;
+  }
+  // The modes that read the file in blocks map it a window at a time
+  if (cli_args.mmap) {
+    cli_args.io = "mmap";
+  }
+  if (cli_args.io.empty()) {
+    cli_args.io = "stream";
+  }
+
+  if (cli_args.input_file.empty()) {
+    if (cli_args.io != "stdin") {
+      return "An input file is required, unless the input is read with "
+             "--io stdin";
+    }
+    cli_args.input_file = "-";
+  }
+  if (cli_args.io == "stdin" && cli_args.input_file != "-") {
+    return "The input is read from the standard input with --io stdin, it "
+           "can't be combined with the input file " +
+           cli_args.input_file;
+  }
+  return std::nullopt;
+}
+
+static std::optional<std::string> CheckModeOptions(
+    const CommandLineArguments& cli_args) {
+  if (cli_args.follow && cli_args.memory_budget > 0) {
+    return "The --follow mode keeps every pipeline in memory, it can't be "
+           "combined with --memory-budget";
+  }
+  if (cli_args.follow && cli_args.partitions > 0) {
+    return "The --follow mode parses the input as it grows, it can't be "
+           "combined with --partitions";
+  }
+  return std::nullopt;
+}
+
+static InputMode ParseInputMode(const std::string& name) {
+  if (name == "stream") {
+    return InputMode::kStream;
+  }
+  if (name == "read") {
+    return InputMode::kRead;
+  }
+  if (name == "mmap") {
+    return InputMode::kMemoryMap;
+  }
+  if (name == "direct") {
+    return InputMode::kDirect;
+  }
+  if (name == "stdin") {
+    return InputMode::kStdin;
+  }
+  throw ApplicationRuntimeError("Unknown input mode: " + name);
 }
 
-static StructureParseResult ParseStructure(const std::string& input_file) {
+static StructureParseResult ParseStructure(const std::string& input_file,
+                                           InputMode input_mode,
+                                           size_t threads,
+                                           BodyLimits body_limits) {
   using StructureParser = log_message_parser::structure::Parser;
+  using InputSourceError = log_message_parser::InputSourceError;
 
-  std::ifstream file(input_file);
-  if (!file.is_open()) {
-    throw ApplicationRuntimeError("Error opening file: " + input_file);
+  if (input_file == "-") {
+    input_mode = InputMode::kStdin;
   }
 
-  auto structure_parser = StructureParser{file};
-  return structure_parser.Parse();
+  try {
+    auto input_source =
+        log_message_parser::OpenInputSource(input_file, input_mode);
+    auto structure_parser =
+        StructureParser{std::move(input_source), threads, body_limits};
+    return structure_parser.Parse();
+  } catch (const InputSourceError& e) {
+    throw ApplicationRuntimeError(e.what());
+  }
 }
 
-static SemanticsParseResult ParseSemantics(
-    const StructureParseResult& structure_parse_result) {
-  using SemanticParser = log_message_parser::semantics::Parser;
-  using HexBodyParser = log_message_parser::semantics::Hex16BodyParser;
-  using AsciiBodyParser = log_message_parser::semantics::AsciiBodyParser;
+static StructureViewParseResult ParseStructureMapped(
+    const std::string& input_file, size_t threads, BodyLimits body_limits) {
+  using MappedFile = log_message_parser::MappedFile;
+  using MappedFileError = log_message_parser::MappedFileError;
+  using StructureViewParser = log_message_parser::structure::ViewParser;
 
-  auto semantics_parser = SemanticParser{};
-  semantics_parser.RegisterBodyParser("0", std::make_unique<AsciiBodyParser>());
-  semantics_parser.RegisterBodyParser("1", std::make_unique<HexBodyParser>());
+  try {
+    auto mapped_file = std::make_shared<const MappedFile>(input_file);
+    return StructureViewParser{mapped_file, threads, body_limits}.Parse();
+  } catch (const MappedFileError& e) {
+    throw ApplicationRuntimeError(e.what());
+  }
+}
 
-  auto semantic_parse_result =
-      semantics_parser.Parse(structure_parse_result.messages());
+template <typename StructureResult>
+static SemanticsParseResult ParseSemantics(
+    const StructureResult& structure_parse_result, BodyDecoding body_decoding,
+    size_t threads, ErrorMessages error_messages,
+    log_message::SymbolTable& symbol_table) {
+  auto semantics_parser =
+      SemanticsParser{body_decoding, threads, error_messages, symbol_table};
 
-  return semantic_parse_result;
+  // The views don't own the input, the bodies have to keep the mapping alive
+  if constexpr (std::is_same_v<StructureResult, StructureViewParseResult>) {
+    return semantics_parser.Parse(structure_parse_result.messages(),
+                                  structure_parse_result.mapped_file());
+  } else {
+    return semantics_parser.Parse(structure_parse_result.messages());
+  }
 }
 
-static SemanticsLogMessages ParseInputFile(
-    const std::string& input_file, const CommandLineArguments& cli_args) {
+static ErrorMessages SemanticErrorMessages(
+    const CommandLineArguments& cli_args) {
+  return cli_args.verbose ? ErrorMessages::kFull : ErrorMessages::kNone;
+}
+
+static void ReportParseErrors(
+    const std::string& input_file,
+    const log_message_parser::structure::ParseErrors& structure_errors,
+    const log_message_parser::semantics::ParseErrors& semantic_errors,
+    const CommandLineArguments& cli_args) {
   auto show_warnings = cli_args.verbose;
   auto strict = cli_args.strict;
 
-  auto structure_results = ParseStructure(input_file);
-  auto semantic_parse_result = ParseSemantics(structure_results);
-
-  auto has_errors =
-      structure_results.HasErrors() || semantic_parse_result.HasErrors();
+  auto has_errors = !structure_errors.empty() || !semantic_errors.empty();
 
   if (show_warnings && has_errors) {
     std::cerr << "Some problems were found while parsing: " << input_file
               << " the output may be incomplete or incorrect." << std::endl;
-    for (const auto& error : structure_results.errors()) {
+    for (const auto& error : structure_errors) {
       std::cerr << "Structure error: " << error.message() << std::endl;
     }
-    for (const auto& error : semantic_parse_result.errors()) {
+    for (const auto& error : semantic_errors) {
       std::cerr << "Semantic error: " << error.message() << std::endl;
     }
   }
   if (has_errors && strict) {
     throw ApplicationRuntimeError("Strict mode enabled, errors found.");
   }
+}
+
+template <typename StructureResult>
+static SemanticsLogMessages CheckParseResults(
+    const std::string& input_file, const StructureResult& structure_results,
+    SemanticsParseResult semantic_parse_result,
+    const CommandLineArguments& cli_args) {
+  ReportParseErrors(input_file, structure_results.errors(),
+                    semantic_parse_result.errors(), cli_args);
+  return std::move(semantic_parse_result).messages();
+}
+
+static SemanticsLogMessages ParseInputFile(
+    const std::string& input_file, const CommandLineArguments& cli_args,
+    log_message::SymbolTable& symbol_table) {
+  auto body_limits =
+      BodyLimits{cli_args.max_body_bytes, cli_args.max_body_lines};
+  auto body_decoding =
+      cli_args.lazy_decoding ? BodyDecoding::kLazy : BodyDecoding::kEager;
+
+  if (cli_args.mmap) {
+    auto structure_results =
+        ParseStructureMapped(input_file, cli_args.threads, body_limits);
+    auto semantic_parse_result =
+        ParseSemantics(structure_results, body_decoding, cli_args.threads,
+                       SemanticErrorMessages(cli_args), symbol_table);
+    return CheckParseResults(input_file, structure_results,
+                             std::move(semantic_parse_result), cli_args);
+  }
+
+  auto structure_results =
+      ParseStructure(input_file, ParseInputMode(cli_args.io),
+                     cli_args.threads, body_limits);
+  auto semantic_parse_result =
+      ParseSemantics(structure_results, body_decoding, cli_args.threads,
+                     SemanticErrorMessages(cli_args), symbol_table);
+  return CheckParseResults(input_file, structure_results,
+                           std::move(semantic_parse_result), cli_args);
+}
+
+template <typename Consume>
+static void ParseStructureInBlocks(const std::string& input_file,
+                                   const CommandLineArguments& cli_args,
+                                   Consume consume) {
+  using InputSourceError = log_message_parser::InputSourceError;
+  using StructureParser = log_message_parser::structure::IncrementalParser;
+
+  auto input_mode = input_file == "-" ? InputMode::kStdin
+                                      : ParseInputMode(cli_args.io);
+  auto structure_parser = StructureParser{
+      BodyLimits{cli_args.max_body_bytes, cli_args.max_body_lines}};
+
+  try {
+    auto input_source =
+        log_message_parser::OpenInputSource(input_file, input_mode);
+    auto block = std::vector<char>(kIngestBlockSize);
+    while (auto read = input_source->Read(block)) {
+      consume(structure_parser.Feed(std::span{block.data(), read}));
+    }
+    consume(structure_parser.Finish());
+  } catch (const InputSourceError& e) {
+    throw ApplicationRuntimeError(e.what());
+  }
+}
+
+template <typename Consume>
+static void ParseInBlocks(const std::string& input_file,
+                          const CommandLineArguments& cli_args,
+                          BodyDecoding body_decoding,
+                          log_message::SymbolTable* symbol_table,
+                          Consume consume) {
+  using StructureParseErrors = log_message_parser::structure::ParseErrors;
+  using SemanticParseErrors = log_message_parser::semantics::ParseErrors;
+
+  const auto error_messages = SemanticErrorMessages(cli_args);
+  // The errors are reported at the end, the structure ones first, like the
+  // ones of ParseInputFile
+  auto structure_errors = StructureParseErrors{};
+  auto semantic_errors = SemanticParseErrors{};
+
+  ParseStructureInBlocks(
+      input_file, cli_args,
+      [&](const StructureParseResult& structure_results) {
+        auto block_symbol_table = std::optional<log_message::SymbolTable>{};
+        auto& parse_symbol_table = symbol_table != nullptr
+                                       ? *symbol_table
+                                       : block_symbol_table.emplace();
+        auto semantic_parse_result =
+            SemanticsParser{body_decoding, 1, error_messages,
+                            parse_symbol_table}
+                .Parse(structure_results.messages());
+        structure_errors.insert(structure_errors.end(),
+                                structure_results.errors().begin(),
+                                structure_results.errors().end());
+        semantic_errors.insert(semantic_errors.end(),
+                               semantic_parse_result.errors().begin(),
+                               semantic_parse_result.errors().end());
+        consume(std::move(semantic_parse_result).messages());
+      });
+
+  ReportParseErrors(input_file, structure_errors, semantic_errors, cli_args);
+}
+
+static MessagesByPipeline IngestInputFile(
+    const std::string& input_file, const CommandLineArguments& cli_args,
+    log_message::SymbolTable& symbol_table) {
+  using IncrementalSplitByPipeline =
+      log_message_organizer::IncrementalSplitByPipeline;
+
+  // The messages outlive their blocks, and a lazy body would keep its whole
+  // block alive, so the bodies are decoded up front and -l has no effect
+  auto splitter = IncrementalSplitByPipeline{};
+  ParseInBlocks(input_file, cli_args, BodyDecoding::kEager, &symbol_table,
+                [&splitter](SemanticsLogMessages&& log_messages) {
+                  splitter.Add(std::move(log_messages));
+                });
+  return splitter.Finish();
+}
+
+static MessagesByPipeline ReadMessagesByPipeline(
+    const std::string& input_file, const CommandLineArguments& cli_args,
+    log_message::SymbolTable& symbol_table) {
+  using SplitByPipeline = pipelines::log_message_organizer::SplitByPipeline;
+
+  // The mapped file is parsed without copying it, and the parallel parsers
+  // need the whole input, so only the sequential parsing is done in one pass
+  if (!cli_args.mmap && cli_args.threads <= 1) {
+    return IngestInputFile(input_file, cli_args, symbol_table);
+  }
+  return SplitByPipeline(ParseInputFile(input_file, cli_args, symbol_table),
+                         cli_args.threads)
+      .Split();
+}
 
-  return semantic_parse_result.messages();
+[[noreturn]] static void FailWithoutMessages() {
+  std::cerr << "No messages found in the input file." << std::endl;
+  std::cerr << "Please check if the file is empty or try running the program "
+               "with the -v option."
+            << std::endl;
+  throw ApplicationRuntimeError("No messages found in the input file.");
 }
 
 static void PrintPipelineLogMessages(
@@ -266,28 +887,373 @@ static void OutputMessages(const MessagesByPipeline& messages,
   }
 }
 
-static void RunApplication(const CommandLineArguments& cli_args) {
-  const std::string input_file = cli_args.input_file;
-
+static void UpdatePipelines(std::ostream& oss,
+                            const StructureParseResult& structure_results,
+                            OrganizersByPipeline& organizers,
+                            log_message::SymbolTable& symbol_table,
+                            const CommandLineArguments& cli_args) {
   using SplitByPipeline = pipelines::log_message_organizer::SplitByPipeline;
-  using OrganizeById = pipelines::log_message_organizer::OrganizeById;
 
-  auto structure_messages = ParseInputFile(input_file, cli_args);
+  // The organizers keep the messages until the program ends, and a lazy body
+  // would keep its whole block alive, so the bodies are decoded up front
+  auto semantic_parse_result =
+      ParseSemantics(structure_results, BodyDecoding::kEager, 1,
+                     SemanticErrorMessages(cli_args), symbol_table);
+  auto new_messages =
+      CheckParseResults(cli_args.input_file, structure_results,
+                        std::move(semantic_parse_result), cli_args);
+
+  // Only the pipelines that received messages are organized and printed again
+  auto new_messages_by_pipeline =
+      SplitByPipeline(std::move(new_messages)).Split();
+  // and the organizers only link the new ones to the ones received before
+  for (auto& [pipeline_id, messages] : new_messages_by_pipeline) {
+    auto& organizer = organizers[pipeline_id];
+    for (auto& message : messages) {
+      organizer.Insert(std::move(message));
+    }
+    PrintPipelineLogMessages(oss, pipeline_id, organizer.Snapshot());
+  }
+  oss.flush();
+}
+
+static void FollowInputFile(std::ostream& oss,
+                            const CommandLineArguments& cli_args) {
+  using FollowedFile = log_message_parser::FollowedFile;
+  using InputSourceError = log_message_parser::InputSourceError;
+  using StructureParser = log_message_parser::structure::IncrementalParser;
+  using StructureLogMessages = log_message_parser::structure::LogMessages;
+  using StructureParseErrors = log_message_parser::structure::ParseErrors;
+
+  if (cli_args.input_file == "-") {
+    throw ApplicationRuntimeError("The standard input can't be followed.");
+  }
+
+  try {
+    auto followed_file = FollowedFile{cli_args.input_file};
+    auto structure_parser = StructureParser{
+        BodyLimits{cli_args.max_body_bytes, cli_args.max_body_lines}};
+    // The IDs are only kept by the organizers, and released with them
+    auto symbol_table = log_message::SymbolTable{};
+    auto organizers = OrganizersByPipeline{};
+    auto block = std::vector<char>(kFollowBlockSize);
+
+    while (true) {
+      auto new_messages = StructureLogMessages{};
+      auto new_errors = StructureParseErrors{};
+      auto add_results = [&new_messages,
+                          &new_errors](const StructureParseResult& results) {
+        new_messages.insert(new_messages.end(), results.messages().begin(),
+                            results.messages().end());
+        new_errors.insert(new_errors.end(), results.errors().begin(),
+                          results.errors().end());
+      };
+
+      while (auto read = followed_file.Read(block)) {
+        add_results(structure_parser.Feed(std::span{block.data(), read}));
+      }
+
+      // After a rotation or truncation the end of the old data is final, and
+      // the new file is read right away
+      auto was_replaced = followed_file.ReopenIfReplaced();
+      if (was_replaced) {
+        add_results(structure_parser.Finish());
+      }
+
+      if (!new_messages.empty() || !new_errors.empty()) {
+        UpdatePipelines(oss, StructureParseResult{new_messages, new_errors},
+                        organizers, symbol_table, cli_args);
+      }
+      if (!was_replaced) {
+        std::this_thread::sleep_for(kFollowPollInterval);
+      }
+    }
+  } catch (const InputSourceError& e) {
+    throw ApplicationRuntimeError(e.what());
+  }
+}
+
+static void RunFollowMode(const CommandLineArguments& cli_args) {
+  if (cli_args.output_to_file) {
+    std::ofstream output_file(cli_args.output_file);
+    if (!output_file.is_open()) {
+      throw ApplicationRuntimeError("Error opening output file: " +
+                                    cli_args.output_file);
+    }
+    FollowInputFile(output_file, cli_args);
+  } else {
+    FollowInputFile(std::cout, cli_args);
+  }
+}
+
+static void OrganizeOutOfCore(std::ostream& oss,
+                              const CommandLineArguments& cli_args) {
+  using ExternalOrganizer = log_message_organizer::ExternalOrganizer;
+  using ExternalOrganizerError = log_message_organizer::ExternalOrganizerError;
+  using ExternalSortError = log_message_organizer::ExternalSortError;
+
+  try {
+    auto organizer = ExternalOrganizer{SpillDirectory(cli_args),
+                                       cli_args.memory_budget * 1024 * 1024,
+                                       cli_args.threads};
+    // The organizer copies the IDs and the decoded bodies, so the IDs of
+    // every block are only interned, and its lazy bodies only kept, while
+    // it's parsed
+    ParseInBlocks(cli_args.input_file, cli_args,
+                  cli_args.lazy_decoding ? BodyDecoding::kLazy
+                                         : BodyDecoding::kEager,
+                  nullptr,
+                  [&organizer](SemanticsLogMessages&& log_messages) {
+                    organizer.Add(log_messages);
+                  });
+    if (organizer.size() == 0) {
+      FailWithoutMessages();
+    }
+
+    // The same output as PrintPipeline, a message at a time
+    auto pipeline = std::optional<std::string>{};
+    organizer.Organize([&](std::string_view pipeline_id, std::string_view id,
+                           std::string_view body) {
+      if (pipeline != pipeline_id) {
+        pipeline = pipeline_id;
+        oss << "Pipeline " << pipeline_id << std::endl;
+      }
+      oss << "    " << id << "| " << body << std::endl;
+    });
+    for (const auto& pipeline_id : organizer.over_budget_pipelines()) {
+      std::cerr << "The tangled messages of pipeline " << pipeline_id
+                << " took more than the memory budget." << std::endl;
+    }
+  } catch (const ExternalOrganizerError& e) {
+    throw ApplicationRuntimeError(e.what());
+  } catch (const ExternalSortError& e) {
+    throw ApplicationRuntimeError(e.what());
+  }
+}
+
+static void RunOutOfCoreMode(const CommandLineArguments& cli_args) {
+  if (cli_args.output_to_file) {
+    std::ofstream output_file(cli_args.output_file);
+    if (!output_file.is_open()) {
+      throw ApplicationRuntimeError("Error opening output file: " +
+                                    cli_args.output_file);
+    }
+    OrganizeOutOfCore(output_file, cli_args);
+  } else {
+    OrganizeOutOfCore(std::cout, cli_args);
+  }
+}
+
+static std::filesystem::path SpillDirectory(
+    const CommandLineArguments& cli_args) {
+  if (cli_args.spill_directory.empty()) {
+    return std::filesystem::temp_directory_path();
+  }
+  return cli_args.spill_directory;
+}
+
+static void PartitionInputFile(const std::string& input_file,
+                               const CommandLineArguments& cli_args,
+                               PipelinePartitions& partitions) {
+  using StructureParseErrors = log_message_parser::structure::ParseErrors;
+  using SemanticParseErrors = log_message_parser::semantics::ParseErrors;
+
+  // The messages are only validated, so no ID is interned in the table
+  auto symbol_table = log_message::SymbolTable{};
+  const auto semantics_parser = SemanticsParser{
+      BodyDecoding::kEager, 1, SemanticErrorMessages(cli_args), symbol_table};
+  auto structure_errors = StructureParseErrors{};
+  auto semantic_errors = SemanticParseErrors{};
+
+  ParseStructureInBlocks(
+      input_file, cli_args,
+      [&](const StructureParseResult& structure_results) {
+        const auto& messages = structure_results.messages();
+        auto message_errors = semantics_parser.Validate(messages);
+        structure_errors.insert(structure_errors.end(),
+                                structure_results.errors().begin(),
+                                structure_results.errors().end());
+        for (size_t message = 0; message < messages.size(); ++message) {
+          if (auto& error = message_errors[message]) {
+            semantic_errors.push_back(std::move(*error));
+          } else {
+            partitions.Add(messages[message]);
+          }
+        }
+      });
+
+  ReportParseErrors(input_file, structure_errors, semantic_errors, cli_args);
+}
+
+static void OrganizePartitions(std::ostream& oss,
+                               PipelinePartitions& partitions,
+                               const CommandLineArguments& cli_args) {
+  using OrganizePipelines = log_message_organizer::OrganizePipelines;
+  using SplitByPipeline = log_message_organizer::SplitByPipeline;
 
-  if (structure_messages.empty()) {
-    std::cerr << "No messages found in the input file." << std::endl;
-    std::cerr << "Please check if the file is empty or try running the program "
-                 "with the -v option."
-              << std::endl;
-    throw ApplicationRuntimeError("No messages found in the input file.");
+  /// Where a pipeline was printed in the spill file
+  struct PrintedPipeline {
+    std::string pipeline_id;
+    std::streamoff offset;
+    std::streamoff size;
+  };
+
+  // The file is removed right away, it's only used through the stream, so it
+  // disappears with the stream even if the application fails
+  auto random = std::random_device{};
+  const auto organized_path =
+      SpillDirectory(cli_args) / ("pipelines_" + std::to_string(random()) +
+                                  "_" + std::to_string(random()) +
+                                  "_organized");
+  auto organized = std::fstream{organized_path, std::ios::in | std::ios::out |
+                                                    std::ios::binary |
+                                                    std::ios::trunc};
+  std::filesystem::remove(organized_path);
+  if (!organized.is_open()) {
+    throw ApplicationRuntimeError("Error creating a spill file in: " +
+                                  organized_path.parent_path().string());
+  }
+
+  auto printed_pipelines = std::vector<PrintedPipeline>{};
+  auto organized_mutex = std::mutex{};
+  auto organize_partition = [&](size_t partition, size_t threads) {
+    // The IDs of a partition are only needed while it's organized, so they
+    // are interned in its own table, destroyed with its messages. The
+    // messages were checked when they were partitioned, so parsing them
+    // again gives no errors
+    auto symbol_table = log_message::SymbolTable{};
+    auto semantics_parser = SemanticsParser{
+        cli_args.lazy_decoding ? BodyDecoding::kLazy : BodyDecoding::kEager,
+        threads, ErrorMessages::kFull, symbol_table};
+    auto parse_result = semantics_parser.Parse(partitions.Read(partition));
+    auto messages_by_pipeline =
+        SplitByPipeline(std::move(parse_result).messages(), threads).Split();
+    messages_by_pipeline =
+        OrganizePipelines(std::move(messages_by_pipeline), threads).Organize();
+    auto lock = std::scoped_lock{organized_mutex};
+    for (const auto& [pipeline_id, messages] : messages_by_pipeline) {
+      const auto offset = static_cast<std::streamoff>(organized.tellp());
+      PrintPipelineLogMessages(organized, pipeline_id, messages);
+      printed_pipelines.push_back(
+          {pipeline_id, offset,
+           static_cast<std::streamoff>(organized.tellp()) - offset});
+    }
+  };
+
+  if (cli_args.memory_budget == 0) {
+    for (size_t partition = 0; partition < partitions.partition_count();
+         ++partition) {
+      organize_partition(partition, cli_args.threads);
+    }
+  } else {
+    // A partition starts once the ones running and it fit in the budget, or
+    // right away when none is running, even if it's bigger than the budget
+    const auto budget = cli_args.memory_budget * 1024 * 1024;
+    const auto max_running = std::max<size_t>(cli_args.threads, 1);
+    auto running = std::deque<std::pair<std::future<void>, size_t>>{};
+    auto running_bytes = size_t{0};
+    for (size_t partition = 0; partition < partitions.partition_count();
+         ++partition) {
+      const auto bytes = partitions.partition_bytes(partition);
+      while (!running.empty() && (running.size() == max_running ||
+                                  running_bytes + bytes > budget)) {
+        running.front().first.get();
+        running_bytes -= running.front().second;
+        running.pop_front();
+      }
+      running.emplace_back(
+          std::async(std::launch::async, organize_partition, partition, 1),
+          bytes);
+      running_bytes += bytes;
+    }
+    for (auto& [organizing, bytes] : running) {
+      organizing.get();
+    }
+  }
+  if (!organized) {
+    throw ApplicationRuntimeError("Error writing the spill file of the "
+                                  "organized pipelines");
+  }
+
+  std::sort(printed_pipelines.begin(), printed_pipelines.end(),
+            [](const auto& lhs, const auto& rhs) {
+              return lhs.pipeline_id < rhs.pipeline_id;
+            });
+  auto block = std::vector<char>(kIngestBlockSize);
+  for (const auto& printed_pipeline : printed_pipelines) {
+    organized.seekg(printed_pipeline.offset);
+    for (auto left = printed_pipeline.size; left > 0;) {
+      const auto size =
+          std::min(left, static_cast<std::streamoff>(block.size()));
+      if (!organized.read(block.data(), size)) {
+        throw ApplicationRuntimeError("Error reading the spill file of the "
+                                      "organized pipelines");
+      }
+      oss.write(block.data(), size);
+      left -= size;
+    }
+  }
+  oss.flush();
+}
+
+static void RunPartitionedMode(const CommandLineArguments& cli_args) {
+  using PipelinePartitionsError = log_message_parser::PipelinePartitionsError;
+
+  try {
+    auto partitions =
+        PipelinePartitions{SpillDirectory(cli_args), cli_args.partitions};
+    PartitionInputFile(cli_args.input_file, cli_args, partitions);
+    if (partitions.size() == 0) {
+      FailWithoutMessages();
+    }
+
+    if (cli_args.output_to_file) {
+      std::ofstream output_file(cli_args.output_file);
+      if (!output_file.is_open()) {
+        throw ApplicationRuntimeError("Error opening output file: " +
+                                      cli_args.output_file);
+      }
+      OrganizePartitions(output_file, partitions, cli_args);
+    } else {
+      OrganizePartitions(std::cout, partitions, cli_args);
+    }
+  } catch (const PipelinePartitionsError& e) {
+    throw ApplicationRuntimeError(e.what());
   }
+}
 
-  auto messages_by_pipeline = SplitByPipeline(structure_messages).Split();
+static void RunApplication(const CommandLineArguments& cli_args) {
+  const std::string input_file = cli_args.input_file;
 
-  for (const auto& [pipeline_id, messages] : messages_by_pipeline) {
-    auto organized_messages = OrganizeById(messages).Organize();
-    messages_by_pipeline[pipeline_id] = organized_messages;
+  if (cli_args.follow) {
+    RunFollowMode(cli_args);
+    return;
   }
+  if (cli_args.partitions > 0) {
+    RunPartitionedMode(cli_args);
+    return;
+  }
+  if (cli_args.memory_budget > 0) {
+    RunOutOfCoreMode(cli_args);
+    return;
+  }
+
+  using OrganizePipelines =
+      pipelines::log_message_organizer::OrganizePipelines;
+
+  // The IDs of the messages live as long as them, in this run's own table
+  auto symbol_table = log_message::SymbolTable{};
+  auto messages_by_pipeline =
+      ReadMessagesByPipeline(input_file, cli_args, symbol_table);
+
+  if (messages_by_pipeline.empty()) {
+    FailWithoutMessages();
+  }
+
+  // The messages are moved through the organizer back into their pipeline
+  messages_by_pipeline =
+      OrganizePipelines(std::move(messages_by_pipeline), cli_args.threads)
+          .Organize();
 
   OutputMessages(messages_by_pipeline, cli_args);
 }
@@ -0,0 +1,171 @@
+/**
+ * @file body.h
+ * Description: This file defines the Body class, the body of a log message,
+ * which is either already decoded or still encoded and decoded when it's used.
+ *
+ * Decoding the bodies up front keeps a decoded copy of every body in memory
+ * from the parsing to the output, next to the input it was decoded from. A
+ * body that is still encoded only points into the parsed input, and is
+ * decoded when it's printed, into a buffer reused for every body that is then
+ * written to the output.
+ *
+ * @brief Body of a log message, decoded up front or on demand
+ */
+
+#ifndef COMPONENT_LOG_MESSAGE_PUBLIC_LOG_MESSAGE_BODY_H_
+#define COMPONENT_LOG_MESSAGE_PUBLIC_LOG_MESSAGE_BODY_H_
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include <compare>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+/******************************************************************************
+ * CLASSES
+ *****************************************************************************/
+
+namespace pipelines::log_message {
+
+/**
+ * @brief The body of a log message.
+ *
+ * It behaves like the decoded string in all cases: bodies are compared and
+ * printed by their decoded content. An encoded body shares the ownership of
+ * the memory it points into, so it stays valid after the parser is gone.
+ */
+class Body {
+ public:
+  /**
+   * @brief Function that decodes a valid encoded body, appending the result.
+   */
+  using Decoder = void (*)(std::string_view encoded, std::string& decoded);
+
+  /**
+   * @brief Constructor of an empty body.
+   */
+  Body() = default;
+
+  /**
+   * @brief Constructor of a body that is already decoded.
+   *
+   * @param decoded The decoded body.
+   */
+  Body(std::string decoded) : decoded_(std::move(decoded)) {}
+
+  /**
+   * @brief Constructor of a body that is decoded when it's used.
+   *
+   * @param encoded The encoded body, it must be valid for the decoder.
+   * @param decoder The function that decodes the body.
+   * @param owner Keeps the memory of the encoded body alive, can be null if
+   * the caller does it.
+   */
+  Body(std::string_view encoded, Decoder decoder,
+       std::shared_ptr<const void> owner)
+      : encoded_(encoded), decoder_(decoder), owner_(std::move(owner)) {}
+
+  /**
+   * @brief Check if the body is already decoded.
+   *
+   * @return True if the body was decoded up front.
+   */
+  bool is_decoded() const { return decoder_ == nullptr; }
+
+  /**
+   * @brief Decode the body, appending it to a string.
+   *
+   * @param output The string the decoded body is appended to.
+   */
+  void DecodeTo(std::string& output) const {
+    if (is_decoded()) {
+      output.append(decoded_);
+    } else {
+      decoder_(encoded_, output);
+    }
+  }
+
+  /**
+   * @brief Decode the body into a new string.
+   *
+   * @return The decoded body.
+   */
+  std::string Decode() const {
+    if (is_decoded()) {
+      return decoded_;
+    }
+    auto decoded = std::string{};
+    DecodeTo(decoded);
+    return decoded;
+  }
+
+  /**
+   * @brief Comparison operator, compares the decoded bodies.
+   *
+   * @param other The other Body to compare with.
+   * @return True if both bodies decode to the same string.
+   */
+  bool operator==(const Body& other) const {
+    if (is_decoded() && other.is_decoded()) {
+      return decoded_ == other.decoded_;
+    }
+    if (decoder_ == other.decoder_ && encoded_ == other.encoded_) {
+      return true;
+    }
+    return Decode() == other.Decode();
+  }
+
+  /**
+   * @brief Ordering operator, orders the bodies by their decoded strings.
+   *
+   * @param other The other Body to compare with.
+   * @return The ordering of the decoded bodies.
+   */
+  std::strong_ordering operator<=>(const Body& other) const {
+    if (is_decoded() && other.is_decoded()) {
+      return decoded_.compare(other.decoded_) <=> 0;
+    }
+    return Decode().compare(other.Decode()) <=> 0;
+  }
+
+  /**
+   * @brief Output operator, writes the decoded body.
+   *
+   * An encoded body is decoded into a buffer reused by every body printed by
+   * the thread, so printing doesn't allocate once the buffer is big enough.
+   * The decoders only append whole bodies to a string, so the decoded body is
+   * then copied from the buffer to the stream, one extra copy per body.
+   *
+   * @param os The output stream.
+   * @param body The Body to write.
+   * @return The output stream.
+   */
+  friend std::ostream& operator<<(std::ostream& os, const Body& body) {
+    if (body.is_decoded()) {
+      return os << body.decoded_;
+    }
+    thread_local auto buffer = std::string{};
+    buffer.clear();
+    body.DecodeTo(buffer);
+    return os << buffer;
+  }
+
+ private:
+  /// The decoded body, empty if the body is still encoded
+  std::string decoded_;
+  /// The encoded body, only used if there is a decoder
+  std::string_view encoded_;
+  /// Decodes the encoded body, nullptr if the body is already decoded
+  Decoder decoder_ = nullptr;
+  /// Keeps the memory of the encoded body alive
+  std::shared_ptr<const void> owner_;
+};
+
+}  // namespace pipelines::log_message
+
+#endif  // COMPONENT_LOG_MESSAGE_PUBLIC_LOG_MESSAGE_BODY_H_
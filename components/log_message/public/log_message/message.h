@@ -16,6 +16,9 @@
 
 #include <ostream>
 #include <string>
+#include <utility>
+#include "log_message/body.h"
+#include "log_message/symbol.h"
 
 /******************************************************************************
  * CLASSES 
@@ -30,7 +33,9 @@ namespace pipelines::log_message {
  * message ID, body, and next ID. 
  * 
  * The encoding is not included in this class, as it is this version of the message
- * should already contain the decoded body.
+ * should already contain the decoded body, or a body that decodes itself when used.
+ *
+ * The identifiers are stored as interned Symbols, so a message only owns its body.
  * 
  * It provides some utility methods e.g. comparison and output formatting.
  */
@@ -41,42 +46,87 @@ class Message {
    */
   Message() = delete;
 
+#if defined(PIPELINES_TESTING)
   /**
-   * @brief Constructor to initialize a Message object with the given parameters.
+   * @brief Constructor to initialize a Message object with the given
+   * parameters, only for the tests: the IDs are interned in the global table,
+   * which is never released.
    * 
    * @param pipeline_id The ID of the pipeline.
    * @param id The ID of the message.
-   * @param body The body of the message.
+   * @param body The body of the message, moved into the message.
    * @param next_id The ID of the next message.
    */
   Message(const std::string& pipeline_id, const std::string& id,
-          const std::string& body, const std::string& next_id)
-      : pipeline_id_(pipeline_id), id_(id), body_(body), next_id_(next_id) {}
+          std::string body, const std::string& next_id)
+      : pipeline_id_(pipeline_id),
+        id_(id),
+        body_(std::move(body)),
+        next_id_(next_id) {}
+#endif
+
+  /**
+   * @brief Constructor to initialize a Message object with interned identifiers.
+   * 
+   * @param pipeline_id The ID of the pipeline.
+   * @param id The ID of the message.
+   * @param body The body of the message.
+   * @param next_id The ID of the next message.
+   */
+  Message(Symbol pipeline_id, Symbol id, Body body, Symbol next_id)
+      : pipeline_id_(pipeline_id),
+        id_(id),
+        body_(std::move(body)),
+        next_id_(next_id) {}
 
   /**
    * @brief Get the pipeline ID of the message.
    * 
    * @return The pipeline ID.
    */
-  const std::string& pipeline_id() const { return pipeline_id_; }
+  const std::string& pipeline_id() const { return pipeline_id_.name(); }
   /**
    * @brief Get the ID of the message.
    * 
    * @return The message ID.
    */
-  const std::string& id() const { return id_; }
+  const std::string& id() const { return id_.name(); }
   /**
    * @brief Get the body of the message.
    * 
-   * @return The message body.
+   * @return The message body, it may only be decoded when used.
    */
-  const std::string& body() const { return body_; }
+  const Body& body() const& { return body_; }
+  /**
+   * @brief Move the body out of an expiring message.
+   * 
+   * @return The message body, it may only be decoded when used.
+   */
+  Body body() && { return std::move(body_); }
   /**
    * @brief Get the ID of the next message.
    * 
    * @return The next message ID.
    */
-  const std::string& next_id() const { return next_id_; }
+  const std::string& next_id() const { return next_id_.name(); }
+  /**
+   * @brief Get the interned pipeline ID of the message.
+   * 
+   * @return The pipeline ID symbol.
+   */
+  Symbol pipeline_id_symbol() const { return pipeline_id_; }
+  /**
+   * @brief Get the interned ID of the message.
+   * 
+   * @return The message ID symbol.
+   */
+  Symbol id_symbol() const { return id_; }
+  /**
+   * @brief Get the interned ID of the next message.
+   * 
+   * @return The next message ID symbol.
+   */
+  Symbol next_id_symbol() const { return next_id_; }
 
   /**
    * @brief Comparison operator to check if two Message objects are equal.
@@ -108,19 +158,19 @@ class Message {
   /**
    * @brief The ID of the pipeline.
    */
-  std::string pipeline_id_;
+  Symbol pipeline_id_;
   /**
    * @brief The ID of the message.
    */
-  std::string id_;
+  Symbol id_;
   /**
    * @brief The body of the message.
    */
-  std::string body_;
+  Body body_;
   /**
    * @brief The ID of the next message.
    */
-  std::string next_id_;
+  Symbol next_id_;
 };
 
 }  // namespace pipelines::log_message
@@ -0,0 +1,327 @@
+/**
+ * @file symbol.h
+ * Description: This file defines the Symbol class, an interned string used for
+ * the identifiers of the log messages (pipeline IDs, IDs and next IDs), and
+ * the SymbolTable that owns the interned strings.
+ *
+ * The same identifiers appear many times in a log, as the ID of a message and
+ * as the next ID of another one, and the organizer compares and hashes them
+ * over and over. With interning every distinct identifier is stored once, and
+ * comparing or hashing a Symbol doesn't look at the characters.
+ *
+ * A SymbolTable can be created for a piece of work, e.g. a partition of the
+ * input, and destroyed with it, so the memory of its strings is released.
+ * The Global() table is used when no table is given, it's never released, so
+ * the code that runs for a while takes its tables explicitly, and the string
+ * constructors and parser constructors that intern into it are only built
+ * for the tests (PIPELINES_TESTING). Symbols of different tables can still be
+ * compared, they are equal when their strings are.
+ *
+ * @brief Interned identifiers of the log messages
+ */
+
+#ifndef COMPONENT_LOG_MESSAGE_PUBLIC_LOG_MESSAGE_SYMBOL_H_
+#define COMPONENT_LOG_MESSAGE_PUBLIC_LOG_MESSAGE_SYMBOL_H_
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include <array>
+#include <atomic>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/******************************************************************************
+ * CLASSES
+ *****************************************************************************/
+
+namespace pipelines::log_message {
+
+/**
+ * @class SymbolTableError
+ * @brief Represents an error while interning a string, when the table is
+ * full.
+ */
+class SymbolTableError : public std::runtime_error {
+ public:
+  /**
+   * @brief Constructs a SymbolTableError with the given message.
+   * @param message The error message.
+   */
+  explicit SymbolTableError(const std::string& message)
+      : std::runtime_error(message) {}
+};
+
+/**
+ * @brief Table with the interned strings of a piece of work.
+ *
+ * The strings are only removed with the table, so a reference to an entry
+ * stays valid as long as the table. Interning is thread safe, reading an
+ * entry doesn't need the table at all. The table is split in shards by the
+ * hash of the strings, each with its own lock, so threads interning different
+ * strings rarely wait for each other.
+ *
+ * Every table numbers its entries from the beginning, so the same index
+ * means different strings in different tables, see Symbol::index().
+ *
+ * The class is not copyable, the symbols point into it.
+ */
+class SymbolTable {
+ public:
+  /// The maximum number of indexes, so an index plus one still fits in 32 bits
+  static constexpr size_t kMaxSize = std::numeric_limits<uint32_t>::max();
+
+  /**
+   * @brief An interned string and its dense index.
+   */
+  struct Entry {
+    std::string name;   /**< The interned string. */
+    uint32_t index{0};  /**< The position of the entry in the table. */
+    size_t hash{0};     /**< The hash of the string. */
+    const SymbolTable* table{nullptr}; /**< The table of the entry. */
+  };
+
+  /**
+   * @brief Constructor of an empty table.
+   */
+  SymbolTable() = default;
+
+  SymbolTable(const SymbolTable&) = delete; /**< Not copyable. */
+  SymbolTable& operator=(const SymbolTable&) = delete; /**< Not copyable. */
+
+  /**
+   * @brief Get the table used by the symbols created without a table.
+   *
+   * @return The table of the program, it lives until the end of the program.
+   */
+  static SymbolTable& Global() {
+    static auto table = SymbolTable{};
+    return table;
+  }
+
+  /**
+   * @brief Get the entry of a string, adding it to the table if needed.
+   *
+   * @param name The string to intern.
+   * @return The entry of the string, or nullptr for the empty string.
+   * @throws SymbolTableError if the table already has kMaxSize indexes.
+   */
+  const Entry* Intern(std::string_view name) {
+    if (name.empty()) {
+      return nullptr;
+    }
+    const auto hash = std::hash<std::string_view>{}(name);
+    auto& shard = shards_[hash % kShardCount];
+    auto lock = std::scoped_lock{shard.mutex};
+    if (auto it = shard.entries_by_name.find(name);
+        it != shard.entries_by_name.end()) {
+      return it->second;
+    }
+    // The indexes are shared by all the shards, so they stay dense, and they
+    // never wrap around
+    auto index = next_index_.load(std::memory_order_relaxed);
+    do {
+      if (index == kMaxSize) {
+        throw SymbolTableError("Too many distinct identifiers, the symbol "
+                               "table is full");
+      }
+    } while (!next_index_.compare_exchange_weak(index, index + 1,
+                                                std::memory_order_relaxed));
+    const auto& entry = shard.entries.emplace_back(
+        Entry{std::string(name), index, hash, this});
+    shard.entries_by_name.emplace(entry.name, &entry);
+    return &entry;
+  }
+
+  /**
+   * @brief Get the number of indexes used, all the indexes are smaller.
+   *
+   * @return The number of interned strings, plus the empty string.
+   */
+  size_t size() const { return next_index_.load(); }
+
+ private:
+  /// Number of shards, enough for the threads of a parser to rarely collide
+  static constexpr size_t kShardCount = 64;
+
+  /**
+   * @brief The strings with the same hash modulo the number of shards.
+   */
+  struct Shard {
+    /// Protects the containers while a string is interned
+    std::mutex mutex;
+    /// The entries, a deque never moves them when it grows
+    std::deque<Entry> entries;
+    /// The entries by their string, the keys point into the entries
+    std::unordered_map<std::string_view, const Entry*> entries_by_name;
+  };
+
+  /// The shards of the table
+  std::array<Shard, kShardCount> shards_;
+  /// The index of the next interned string, the index 0 is the empty string's
+  std::atomic<uint32_t> next_index_{1};
+};
+
+/**
+ * @brief An identifier of a log message, interned in a SymbolTable.
+ *
+ * It behaves like the string it represents: symbols are compared, ordered,
+ * hashed and printed as their strings, whatever their tables. Within a table
+ * every string has one entry, so only the entries are compared, and the dense
+ * index() can be used to index arrays.
+ *
+ * A symbol only holds a raw pointer to the entry of its string in its table,
+ * it doesn't keep the table alive: it must not outlive its table, and neither
+ * must the strings returned by name().
+ */
+class Symbol {
+ public:
+  /**
+   * @brief Constructor of the symbol of the empty string.
+   */
+  constexpr Symbol() = default;
+
+#if defined(PIPELINES_TESTING)
+  /**
+   * @brief Constructor that interns a string in the global table, only for
+   * the tests.
+   *
+   * @param name The string represented by the symbol.
+   * @throws SymbolTableError if the table is full.
+   */
+  explicit Symbol(std::string_view name)
+      : entry_(SymbolTable::Global().Intern(name)) {}
+#endif
+
+  /**
+   * @brief Constructor that interns a string in the given table.
+   *
+   * @param name The string represented by the symbol.
+   * @param table The table of the symbol, it must outlive the symbol.
+   * @throws SymbolTableError if the table is full.
+   */
+  Symbol(std::string_view name, SymbolTable& table)
+      : entry_(table.Intern(name)) {}
+
+  /**
+   * @brief Get the string represented by the symbol.
+   *
+   * @return The string, valid as long as the table of the symbol.
+   */
+  const std::string& name() const {
+    static const auto kEmpty = std::string{};
+    return entry_ == nullptr ? kEmpty : entry_->name;
+  }
+
+  /**
+   * @brief Get the dense index of the symbol, 0 for the empty string.
+   *
+   * The indexes of different tables overlap, they only identify the symbols
+   * that are in the same table, see SameTable().
+   *
+   * @return The index, smaller than the size() of the table of the symbol.
+   */
+  uint32_t index() const { return entry_ == nullptr ? 0 : entry_->index; }
+
+  /**
+   * @brief Get the table of the symbol.
+   *
+   * @return The table, or nullptr for the empty string, which is in every
+   * table.
+   */
+  const SymbolTable* table() const {
+    return entry_ == nullptr ? nullptr : entry_->table;
+  }
+
+  /**
+   * @brief Checks if the index of the symbol can be compared with another's.
+   *
+   * @param other The other Symbol.
+   * @return True if both symbols are in the same table, or one is empty.
+   */
+  bool SameTable(const Symbol& other) const {
+    return table() == nullptr || other.table() == nullptr ||
+           table() == other.table();
+  }
+
+  /**
+   * @brief Comparison operator, the symbols are equal when their strings are.
+   *
+   * In the same table the same string always has the same entry, so only
+   * the symbols of different tables compare their strings.
+   *
+   * @param other The other Symbol to compare with.
+   * @return True if both symbols represent the same string.
+   */
+  bool operator==(const Symbol& other) const {
+    if (entry_ == other.entry_) {
+      return true;
+    }
+    if (entry_ == nullptr || other.entry_ == nullptr ||
+        entry_->table == other.entry_->table) {
+      return false;
+    }
+    return entry_->hash == other.entry_->hash && entry_->name == other.name();
+  }
+
+  /**
+   * @brief Ordering operator, the symbols are ordered as their strings.
+   *
+   * @param other The other Symbol to compare with.
+   * @return The ordering of the strings of the symbols.
+   */
+  std::strong_ordering operator<=>(const Symbol& other) const {
+    if (entry_ == other.entry_) {
+      return std::strong_ordering::equal;
+    }
+    return name().compare(other.name()) <=> 0;
+  }
+
+  /**
+   * @brief Get the hash of the string of the symbol, computed when it was
+   * interned.
+   *
+   * @return The hash, the same for equal symbols of any table.
+   */
+  size_t hash() const { return entry_ == nullptr ? 0 : entry_->hash; }
+
+  /**
+   * @brief Output operator, writes the string of the symbol.
+   *
+   * @param os The output stream.
+   * @param symbol The Symbol to write.
+   * @return The output stream.
+   */
+  friend std::ostream& operator<<(std::ostream& os, const Symbol& symbol) {
+    return os << symbol.name();
+  }
+
+ private:
+  /// The entry in the table, which owns it, nullptr for the empty string
+  const SymbolTable::Entry* entry_ = nullptr;
+};
+
+}  // namespace pipelines::log_message
+
+/**
+ * @brief Hash of a Symbol, the hash of its string stored in its entry.
+ */
+template <>
+struct std::hash<pipelines::log_message::Symbol> {
+  size_t operator()(const pipelines::log_message::Symbol& symbol) const {
+    return symbol.hash();
+  }
+};
+
+#endif  // COMPONENT_LOG_MESSAGE_PUBLIC_LOG_MESSAGE_SYMBOL_H_
@@ -0,0 +1,79 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <cctype>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include "log_message/body.h"
+
+using ::testing::Eq;
+using ::testing::Gt;
+using ::testing::Lt;
+using ::testing::Ne;
+
+/**
+ * Decoder used by the tests, it converts the body to upper case.
+ */
+static void DecodeToUpper(std::string_view encoded, std::string& decoded) {
+  for (auto c : encoded) {
+    decoded.push_back(static_cast<char>(std::toupper(c)));
+  }
+}
+
+TEST(BodyTest, DecodedBody) {
+  using pipelines::log_message::Body;
+
+  auto body = Body{std::string{"some body"}};
+  auto output = std::ostringstream{};
+  output << body;
+
+  ASSERT_THAT(body.is_decoded(), Eq(true));
+  ASSERT_THAT(body.Decode(), Eq("some body"));
+  ASSERT_THAT(output.str(), Eq("some body"));
+}
+
+TEST(BodyTest, EncodedBodyIsDecodedWhenUsed) {
+  using pipelines::log_message::Body;
+
+  auto body = Body{"some body", DecodeToUpper, nullptr};
+  auto decoded = std::string{"> "};
+  body.DecodeTo(decoded);
+  auto output = std::ostringstream{};
+  output << body << '|' << body;
+
+  ASSERT_THAT(body.is_decoded(), Eq(false));
+  ASSERT_THAT(body.Decode(), Eq("SOME BODY"));
+  ASSERT_THAT(decoded, Eq("> SOME BODY"));
+  ASSERT_THAT(output.str(), Eq("SOME BODY|SOME BODY"));
+}
+
+TEST(BodyTest, EncodedBodyKeepsItsOwnerAlive) {
+  using pipelines::log_message::Body;
+
+  auto input = std::make_shared<std::string>("some body");
+  auto body = Body{*input, DecodeToUpper, input};
+  auto weak_input = std::weak_ptr<std::string>{input};
+  input.reset();
+
+  ASSERT_THAT(weak_input.expired(), Eq(false));
+  ASSERT_THAT(body.Decode(), Eq("SOME BODY"));
+
+  body = Body{};
+  ASSERT_THAT(weak_input.expired(), Eq(true));
+}
+
+TEST(BodyTest, BodiesAreComparedDecoded) {
+  using pipelines::log_message::Body;
+
+  auto decoded = Body{std::string{"ABC"}};
+  auto encoded = Body{"abc", DecodeToUpper, nullptr};
+  auto other_encoded = Body{"abd", DecodeToUpper, nullptr};
+
+  ASSERT_THAT(encoded, Eq(decoded));
+  ASSERT_THAT(decoded, Eq(encoded));
+  ASSERT_THAT(encoded, Ne(other_encoded));
+  ASSERT_THAT(encoded, Lt(other_encoded));
+  ASSERT_THAT(other_encoded, Gt(decoded));
+  ASSERT_THAT(Body{std::string{"ABB"}}, Lt(encoded));
+}
@@ -0,0 +1,181 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <compare>
+#include <cstdint>
+#include <functional>
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "log_message/symbol.h"
+
+using ::testing::Eq;
+using ::testing::Lt;
+using ::testing::Ne;
+
+TEST(SymbolTest, SameStringSameSymbol) {
+  using pipelines::log_message::Symbol;
+
+  auto text = std::string{"37620c47-da9b-4218-9c35-fdb5961d4239"};
+  auto first = Symbol{text};
+  auto second = Symbol{std::string_view{text}};
+
+  ASSERT_THAT(first, Eq(second));
+  ASSERT_THAT(first.index(), Eq(second.index()));
+  ASSERT_THAT(&first.name(), Eq(&second.name()));
+  ASSERT_THAT(first.name(), Eq(text));
+  ASSERT_THAT(Symbol{"other"}, Ne(first));
+}
+
+TEST(SymbolTest, EmptyString) {
+  using pipelines::log_message::Symbol;
+
+  ASSERT_THAT(Symbol{""}, Eq(Symbol{}));
+  ASSERT_THAT(Symbol{}.index(), Eq(0));
+  ASSERT_THAT(Symbol{}.name(), Eq(""));
+  ASSERT_THAT(Symbol{"x"}.index(), Ne(0));
+}
+
+TEST(SymbolTest, IndexesAreDense) {
+  using pipelines::log_message::Symbol;
+  using pipelines::log_message::SymbolTable;
+
+  auto symbol = Symbol{"a symbol only used in this test"};
+  ASSERT_THAT(symbol.index(), Lt(SymbolTable::Global().size()));
+  ASSERT_THAT(Symbol{"another symbol only used in this test"}.index(),
+              Eq(symbol.index() + 1));
+}
+
+TEST(SymbolTest, OrderedAndPrintedAsTheirStrings) {
+  using pipelines::log_message::Symbol;
+
+  // Interned in the opposite order of the strings
+  auto b = Symbol{"order-b"};
+  auto a = Symbol{"order-a"};
+  ASSERT_THAT(a < b, Eq(true));
+  ASSERT_THAT(b < a, Eq(false));
+  ASSERT_THAT(Symbol{"-1"} < Symbol{"0"}, Eq(true));
+
+  auto oss = std::ostringstream{};
+  oss << a;
+  ASSERT_THAT(oss.str(), Eq("order-a"));
+}
+
+TEST(SymbolTest, HashIsTheStringHash) {
+  using pipelines::log_message::Symbol;
+
+  auto symbol = Symbol{"hashed"};
+  ASSERT_THAT(std::hash<Symbol>{}(symbol),
+              Eq(std::hash<std::string_view>{}("hashed")));
+  ASSERT_THAT(std::hash<Symbol>{}(Symbol{}), Eq(0));
+}
+
+TEST(SymbolTest, ConcurrentInterning) {
+  using pipelines::log_message::Symbol;
+
+  constexpr auto kThreads = 4;
+  constexpr auto kSymbols = 1000;
+
+  auto symbols = std::vector<std::vector<Symbol>>(kThreads);
+  auto threads = std::vector<std::thread>{};
+  for (int thread = 0; thread < kThreads; ++thread) {
+    threads.emplace_back([&symbols, thread] {
+      for (int i = 0; i < kSymbols; ++i) {
+        symbols[thread].emplace_back("concurrent-" + std::to_string(i));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int thread = 1; thread < kThreads; ++thread) {
+    ASSERT_THAT(symbols[thread], Eq(symbols[0]));
+  }
+  ASSERT_THAT(symbols[0][42].name(), Eq("concurrent-42"));
+}
+
+TEST(SymbolTest, ConcurrentIndexesAreUnique) {
+  using pipelines::log_message::Symbol;
+  using pipelines::log_message::SymbolTable;
+
+  constexpr auto kThreads = 4;
+  constexpr auto kSymbols = 1000;
+
+  // Every thread interns different strings, in every shard of the table
+  auto symbols = std::vector<std::vector<Symbol>>(kThreads);
+  auto threads = std::vector<std::thread>{};
+  for (int thread = 0; thread < kThreads; ++thread) {
+    threads.emplace_back([&symbols, thread] {
+      for (int i = 0; i < kSymbols; ++i) {
+        symbols[thread].emplace_back("unique-" + std::to_string(thread) + "-" +
+                                     std::to_string(i));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto indexes = std::set<uint32_t>{};
+  for (const auto& thread_symbols : symbols) {
+    for (const auto& symbol : thread_symbols) {
+      ASSERT_THAT(symbol.index(), Lt(SymbolTable::Global().size()));
+      indexes.insert(symbol.index());
+    }
+  }
+  ASSERT_THAT(indexes.size(), Eq(kThreads * kSymbols));
+}
+
+TEST(SymbolTest, OwnedTablesAreSeparate) {
+  using pipelines::log_message::Symbol;
+  using pipelines::log_message::SymbolTable;
+
+  auto table = SymbolTable{};
+  auto other_table = SymbolTable{};
+  auto symbol = Symbol{"owned", table};
+  auto same = Symbol{"owned", table};
+  auto other = Symbol{"owned", other_table};
+
+  ASSERT_THAT(symbol, Eq(same));
+  ASSERT_THAT(&symbol.name(), Eq(&same.name()));
+  ASSERT_THAT(&symbol.name(), Ne(&other.name()));
+  ASSERT_THAT(symbol.table(), Eq(&table));
+  ASSERT_THAT(other.table(), Eq(&other_table));
+  ASSERT_THAT(symbol.SameTable(other), Eq(false));
+  ASSERT_THAT(symbol.SameTable(Symbol{}), Eq(true));
+  // Every table starts its indexes from the beginning
+  ASSERT_THAT(symbol.index(), Eq(1));
+  ASSERT_THAT(other.index(), Eq(1));
+  ASSERT_THAT(Symbol("", table), Eq(Symbol{}));
+  ASSERT_THAT(Symbol("second", table).index(), Eq(2));
+  ASSERT_THAT(table.size(), Eq(3));
+  ASSERT_THAT(other_table.size(), Eq(2));
+}
+
+TEST(SymbolTest, SymbolsOfDifferentTablesAreComparedByTheirStrings) {
+  using pipelines::log_message::Symbol;
+  using pipelines::log_message::SymbolTable;
+
+  auto table = SymbolTable{};
+  auto other_table = SymbolTable{};
+  auto x = Symbol{"mixed-x", table};
+  auto y = Symbol{"mixed-y", table};
+  auto other_y = Symbol{"mixed-y", other_table};
+  auto other_x = Symbol{"mixed-x", other_table};
+
+  // Interned in the opposite order, the indexes don't match the strings
+  ASSERT_THAT(x.index(), Eq(other_y.index()));
+  ASSERT_THAT(x, Ne(other_y));
+  ASSERT_THAT(x <=> other_y, Eq(std::strong_ordering::less));
+  ASSERT_THAT(y, Eq(other_y));
+  ASSERT_THAT(y <=> other_y, Eq(std::strong_ordering::equal));
+  ASSERT_THAT(x, Eq(other_x));
+  ASSERT_THAT(x, Eq(Symbol{"mixed-x"}));
+  ASSERT_THAT(x <=> Symbol{"mixed-x"}, Eq(std::strong_ordering::equal));
+  ASSERT_THAT(std::hash<Symbol>{}(x), Eq(std::hash<Symbol>{}(other_x)));
+  ASSERT_THAT(Symbol("", table), Eq(Symbol("", other_table)));
+  ASSERT_THAT(Symbol{}, Ne(x));
+}
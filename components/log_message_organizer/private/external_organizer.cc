@@ -0,0 +1,1059 @@
+/**
+ * @file external_organizer.cc
+ * @brief Implementation of the ExternalOrganizer class.
+ *
+ * This file contains the implementation of the ExternalOrganizer class, which
+ * sorts the messages by pipeline on disk, and orders every pipeline in memory
+ * or, if it doesn't fit, with more sorts on disk and walks over the ends of
+ * its tangled chains.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include "log_message_organizer/external_organizer.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <limits>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "log_message/symbol.h"
+
+/******************************************************************************
+ * CONSTANTS AND TYPEDEFS
+ *****************************************************************************/
+
+namespace pipelines::log_message_organizer::external_organizer {
+
+/// Constant for the terminator ID
+constexpr auto kTerminator = std::string_view{"-1"};
+
+/// Memory taken by every message of a pipeline ordered in memory besides its
+/// record: its position, its IDs in OrderById and in the symbol table
+constexpr size_t kOrderedMessageSize = 128;
+
+/// Memory taken by every tangled chain of a spilled pipeline besides its IDs:
+/// the chain, its group by ID, its walk starts and its steps in a walk
+constexpr size_t kTangledChainSize = 256;
+
+/// Number of sorts of a spilled pipeline that collect records at the same
+/// time, they share the memory budget
+constexpr size_t kSpilledPipelineSorts = 4;
+
+/// Position of a message that doesn't exist, the one before the first
+/// message of a chain
+constexpr auto kNoMessage = std::numeric_limits<uint64_t>::max();
+
+/**
+ * @enum Link
+ * @brief What a message of a spilled pipeline is linked to, the first byte of
+ * its links.
+ */
+enum class Link : char {
+  kChain = 'C',       /**< Its next ID is the ID of the message after it. */
+  kBranch = 'B',      /**< Its next ID is the ID of messages it isn't linked
+                           to, because one of them is tangled. */
+  kSelf = 'S',        /**< Its next ID is its own ID. */
+  kTermination = 'T', /**< Its next ID is the terminator. */
+  kInvalid = 'I',     /**< No message has its next ID. */
+  kTangled = 'X',     /**< It's tangled, besides its kind. */
+  kPrevious = 'P',    /**< The message before it, which follows this byte. */
+};
+
+/**
+ * @enum Section
+ * @brief The parts of the organized list of a pipeline, the first byte of the
+ * keys of its organized messages, see ListRankingOrganizer.
+ */
+enum class Section : char {
+  kTermination, /**< The ends of the chains that point to the terminator. */
+  kInvalid,     /**< The ends of the chains that point to a missing ID. */
+  kChain,       /**< The other messages, chain by chain. */
+};
+
+/**
+ * @struct Rank
+ * @brief The part of the chain of a message of a spilled pipeline that ends
+ * with it, while the messages are ranked.
+ */
+struct Rank {
+  uint64_t previous;   /**< The message before the part, or kNoMessage. */
+  uint64_t size;       /**< The number of messages of the part. */
+  uint64_t first;      /**< The first message of the part in the collection. */
+  uint64_t rest_first; /**< The same without the message that starts the
+                            part, or kNoMessage. */
+  uint64_t link;       /**< The Link of the message. */
+  uint64_t head;       /**< The message that starts the part. */
+  uint64_t linked;     /**< The message before it, or kNoMessage. */
+  uint64_t tangled;    /**< Whether the message is tangled. */
+};
+
+/**
+ * @enum ChainEnd
+ * @brief The messages of a chain of a spilled pipeline that are read to
+ * walk it if it's tangled, the last byte of their keys in the sort of the
+ * ends, after the head of the chain.
+ */
+enum class ChainEnd : char {
+  kHead,   /**< Its first message, followed by its ID. */
+  kSecond, /**< Its second message, followed by its ID. */
+  kTail,   /**< Its last message, followed by its next ID. */
+};
+
+/**
+ * @struct ChainEndRecord
+ * @brief The start of the value of a message in the sort of the ends of the
+ * chains, an ID follows it.
+ */
+struct ChainEndRecord {
+  uint64_t message;    /**< The position of the message. */
+  uint64_t rest_first; /**< Its Rank::rest_first. */
+  uint64_t link;       /**< The Link of the message. */
+  uint64_t tangled;    /**< Whether the message is tangled. */
+};
+
+/**
+ * @struct MessageRecord
+ * @brief The fields of a message record: the sizes of the IDs, the IDs and
+ * the body.
+ */
+struct MessageRecord {
+  std::string_view id;      /**< The ID of the message. */
+  std::string_view next_id; /**< The next ID of the message. */
+  std::string_view body;    /**< The decoded body of the message. */
+};
+
+}  // namespace pipelines::log_message_organizer::external_organizer
+
+/******************************************************************************
+ * PRIVATE HELPER DECLARATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_organizer {
+
+/**
+ * @brief Writes the record of a message.
+ * @param record Replaced by the record.
+ * @param id The ID of the message.
+ * @param next_id The next ID of the message.
+ * @param body The decoded body of the message.
+ */
+static void WriteMessageRecord(std::string& record, std::string_view id,
+                               std::string_view next_id, std::string_view body);
+
+/**
+ * @brief Reads the fields of the record of a message.
+ * @param record The record.
+ * @return The fields, views into the record.
+ */
+static external_organizer::MessageRecord ReadMessageRecord(
+    std::string_view record);
+
+/**
+ * @brief Creates the key of a message of a spilled pipeline.
+ * @param message The position of the message in the collection.
+ * @return The key, sorted by the position.
+ */
+static std::string MessageKey(uint64_t message);
+
+/**
+ * @brief Reads the key of a message of a spilled pipeline.
+ * @param key The key.
+ * @return The position of the message in the collection.
+ */
+static uint64_t MessageOf(std::string_view key);
+
+/**
+ * @brief Creates the links of a message that aren't another message.
+ * @param link The link.
+ * @return The value of the links.
+ */
+static std::string LinkValue(external_organizer::Link link);
+
+/**
+ * @brief Writes the rank of a message to a ranks file.
+ * @param ranks The ranks file.
+ * @param rank The rank.
+ */
+static void WriteRank(std::ostream& ranks,
+                      const external_organizer::Rank& rank);
+
+/**
+ * @brief Reads the rank of the next message from a ranks file.
+ * @param ranks The ranks file.
+ * @param rank Replaced by the rank.
+ * @return False if the file is over.
+ */
+static bool ReadRank(std::istream& ranks, external_organizer::Rank& rank);
+
+}  // namespace pipelines::log_message_organizer
+
+/******************************************************************************
+ * PRIVATE HELPER IMPLEMENTATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_organizer {
+
+static void WriteMessageRecord(std::string& record, std::string_view id,
+                               std::string_view next_id,
+                               std::string_view body) {
+  // The records are only read back by this organizer, so the sizes are
+  // written as they are
+  const uint32_t sizes[] = {static_cast<uint32_t>(id.size()),
+                            static_cast<uint32_t>(next_id.size())};
+  record.assign(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+  record.append(id);
+  record.append(next_id);
+  record.append(body);
+}
+
+static external_organizer::MessageRecord ReadMessageRecord(
+    std::string_view record) {
+  uint32_t sizes[2];
+  std::memcpy(sizes, record.data(), sizeof(sizes));
+  record.remove_prefix(sizeof(sizes));
+  return {record.substr(0, sizes[0]), record.substr(sizes[0], sizes[1]),
+          record.substr(sizes[0] + sizes[1])};
+}
+
+static std::string MessageKey(uint64_t message) {
+  auto key = std::string{};
+  ExternalSort::AppendKey(key, message);
+  return key;
+}
+
+static uint64_t MessageOf(std::string_view key) {
+  return ExternalSort::ReadKey(key);
+}
+
+static std::string LinkValue(external_organizer::Link link) {
+  return std::string(1, static_cast<char>(link));
+}
+
+static void WriteRank(std::ostream& ranks,
+                      const external_organizer::Rank& rank) {
+  static_assert(std::is_trivially_copyable_v<external_organizer::Rank>);
+  ranks.write(reinterpret_cast<const char*>(&rank), sizeof(rank));
+}
+
+static bool ReadRank(std::istream& ranks, external_organizer::Rank& rank) {
+  return static_cast<bool>(
+      ranks.read(reinterpret_cast<char*>(&rank), sizeof(rank)));
+}
+
+}  // namespace pipelines::log_message_organizer
+
+/******************************************************************************
+ * PRIVATE CLASS METHODS IMPLEMENTATION
+ *****************************************************************************/
+
+namespace pipelines::log_message_organizer {
+
+void ExternalOrganizer::StartOrganizing() {
+  messages_.Sort();
+  auto pipeline_id = std::string_view{};
+  auto record = std::string_view{};
+  has_next_message_ = messages_.Next(pipeline_id, record);
+  if (has_next_message_) {
+    next_pipeline_id_.assign(pipeline_id);
+    next_message_.assign(record);
+  }
+}
+
+bool ExternalOrganizer::OrganizeNextPipeline() {
+  pipeline_size_ = 0;
+  pipeline_records_.clear();
+  record_ends_.clear();
+  pipeline_order_.clear();
+  next_position_ = 0;
+  organized_.reset();
+  pipeline_file_.close();
+  has_tangled_messages_ = false;
+  if (!has_next_message_) {
+    return false;
+  }
+
+  std::swap(pipeline_id_, next_pipeline_id_);
+  AddToPipeline(next_message_);
+  auto pipeline_id = std::string_view{};
+  auto record = std::string_view{};
+  while ((has_next_message_ = messages_.Next(pipeline_id, record)) &&
+         pipeline_id == pipeline_id_) {
+    AddToPipeline(record);
+  }
+  if (has_next_message_) {
+    next_pipeline_id_.assign(pipeline_id);
+    next_message_.assign(record);
+  }
+
+  if (pipeline_file_.is_open()) {
+    OrderSpilled();
+  } else {
+    OrderInMemory();
+  }
+  return true;
+}
+
+bool ExternalOrganizer::NextOrganizedMessage(std::string_view& id,
+                                             std::string_view& body) {
+  auto record = std::string_view{};
+  if (organized_) {
+    auto key = std::string_view{};
+    if (!organized_->Next(key, record)) {
+      return false;
+    }
+  } else {
+    if (next_position_ == pipeline_order_.size()) {
+      return false;
+    }
+    const auto message = pipeline_order_[next_position_++];
+    const auto begin = message == 0 ? size_t{0} : record_ends_[message - 1];
+    record = std::string_view{pipeline_records_}.substr(
+        begin, record_ends_[message] - begin);
+  }
+  const auto message = ReadMessageRecord(record);
+  id = message.id;
+  body = message.body;
+  return true;
+}
+
+void ExternalOrganizer::AddToPipeline(std::string_view record) {
+  using namespace pipelines::log_message_organizer::external_organizer;
+
+  ++pipeline_size_;
+  auto spill = [this](std::string_view record) {
+    const auto size = uint64_t{record.size()};
+    pipeline_file_.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    pipeline_file_.write(record.data(),
+                         static_cast<std::streamsize>(record.size()));
+  };
+  if (pipeline_file_.is_open()) {
+    spill(record);
+    return;
+  }
+  const auto pipeline_size = pipeline_records_.size() + record.size() +
+                             pipeline_size_ * kOrderedMessageSize;
+  if (pipeline_size <= memory_budget_) {
+    // The buffer doubles as the pipeline grows, but never past the budget
+    const auto records_size = pipeline_records_.size() + record.size();
+    if (pipeline_records_.capacity() < records_size) {
+      pipeline_records_.reserve(std::min(
+          std::max(2 * pipeline_records_.capacity(), records_size),
+          memory_budget_));
+    }
+    pipeline_records_.append(record);
+    record_ends_.push_back(pipeline_records_.size());
+    return;
+  }
+
+  // The pipeline doesn't fit, the records so far start its spill file
+  pipeline_file_.open(pipeline_path_, std::ios::in | std::ios::out |
+                                          std::ios::binary | std::ios::trunc);
+  if (!pipeline_file_.is_open()) {
+    throw ExternalOrganizerError("Error creating the spill file: " +
+                                 pipeline_path_.string());
+  }
+  auto begin = size_t{0};
+  for (auto end : record_ends_) {
+    spill(std::string_view{pipeline_records_}.substr(begin, end - begin));
+    begin = end;
+  }
+  spill(record);
+  pipeline_records_.clear();
+  pipeline_records_.shrink_to_fit();
+  record_ends_ = std::vector<size_t>{};
+}
+
+std::string_view ExternalOrganizer::ReadSpilledRecord() {
+  auto size = uint64_t{0};
+  if (pipeline_file_.read(reinterpret_cast<char*>(&size), sizeof(size))) {
+    record_.resize(size);
+    if (pipeline_file_.read(record_.data(),
+                            static_cast<std::streamsize>(size))) {
+      return record_;
+    }
+  }
+  throw ExternalOrganizerError("Error reading the spill file: " +
+                               pipeline_path_.string());
+}
+
+void ExternalOrganizer::OrderInMemory() {
+  // The IDs are only needed while the pipeline is ordered
+  auto symbol_table = log_message::SymbolTable{};
+  auto message_ids = std::vector<MessageIds>{};
+  message_ids.reserve(record_ends_.size());
+  auto begin = size_t{0};
+  for (auto end : record_ends_) {
+    const auto message = ReadMessageRecord(
+        std::string_view{pipeline_records_}.substr(begin, end - begin));
+    message_ids.emplace_back(Symbol{message.id, symbol_table},
+                             Symbol{message.next_id, symbol_table});
+    begin = end;
+  }
+  pipeline_order_ = OrderById(std::move(message_ids), thread_count_).Order();
+}
+
+void ExternalOrganizer::OrderSpilled() {
+  using namespace pipelines::log_message_organizer::external_organizer;
+
+  pipeline_file_.flush();
+  if (!pipeline_file_) {
+    throw ExternalOrganizerError("Error writing the spill file: " +
+                                 pipeline_path_.string());
+  }
+
+  {
+    auto links = ExternalSort{spill_directory_,
+                              memory_budget_ / kSpilledPipelineSorts};
+    LinkSpilled(links);
+    RankSpilled(links);
+  }
+  SortSpilled();
+  pipeline_file_.close();
+  auto error = std::error_code{};
+  std::filesystem::remove(pipeline_path_, error);
+  std::filesystem::remove(ranks_path_, error);
+  std::filesystem::remove(next_ranks_path_, error);
+}
+
+void ExternalOrganizer::LinkSpilled(ExternalSort& links) {
+  using namespace pipelines::log_message_organizer::external_organizer;
+
+  const auto sort_budget = memory_budget_ / kSpilledPipelineSorts;
+  auto ids = ExternalSort{spill_directory_, sort_budget};
+  auto next_ids = ExternalSort{spill_directory_, sort_budget};
+  pipeline_file_.seekg(0);
+  for (uint64_t message = 0; message < pipeline_size_; ++message) {
+    const auto record = ReadMessageRecord(ReadSpilledRecord());
+    const auto key = MessageKey(message);
+    ids.Add(record.id, key);
+    if (record.next_id == kTerminator) {
+      links.Add(key, LinkValue(Link::kTermination));
+    } else if (record.next_id == record.id) {
+      links.Add(key, LinkValue(Link::kSelf));
+      AddTangled(links, key);
+    } else {
+      next_ids.Add(record.next_id, key);
+    }
+  }
+  ids.Sort();
+  next_ids.Sort();
+
+  // Sort-merge join of the IDs and the next IDs, an ID at a time. Only an ID
+  // with a single message and a single message pointing to it is linked,
+  // the messages of the others are tangled
+  auto id = std::string_view{};
+  auto message_key = std::string_view{};
+  auto next_id = std::string_view{};
+  auto pointing_key = std::string_view{};
+  auto has_id = ids.Next(id, message_key);
+  auto has_next_id = next_ids.Next(next_id, pointing_key);
+  auto current_id = std::string{};
+  auto current_key = std::string{};
+  auto first_pointing_key = std::string{};
+  auto previous = std::string{};
+  while (has_id || has_next_id) {
+    current_id.assign(has_id && (!has_next_id || id <= next_id) ? id
+                                                                : next_id);
+    current_key.clear();
+    auto id_messages = uint64_t{0};
+    for (; has_id && id == current_id; has_id = ids.Next(id, message_key)) {
+      if (++id_messages == 1) {
+        current_key.assign(message_key);
+        continue;
+      }
+      if (id_messages == 2) {
+        AddTangled(links, current_key);
+      }
+      AddTangled(links, message_key);
+    }
+    auto pointing_messages = uint64_t{0};
+    for (; has_next_id && next_id == current_id;
+         has_next_id = next_ids.Next(next_id, pointing_key)) {
+      if (id_messages == 0) {
+        links.Add(pointing_key, LinkValue(Link::kInvalid));
+        continue;
+      }
+      if (id_messages > 1) {
+        links.Add(pointing_key, LinkValue(Link::kBranch));
+        AddTangled(links, pointing_key);
+        continue;
+      }
+      if (++pointing_messages == 1) {
+        first_pointing_key.assign(pointing_key);
+        continue;
+      }
+      if (pointing_messages == 2) {
+        AddTangled(links, current_key);
+        links.Add(first_pointing_key, LinkValue(Link::kBranch));
+        AddTangled(links, first_pointing_key);
+      }
+      links.Add(pointing_key, LinkValue(Link::kBranch));
+      AddTangled(links, pointing_key);
+    }
+    if (id_messages == 1 && pointing_messages == 1) {
+      links.Add(first_pointing_key, LinkValue(Link::kChain));
+      previous = LinkValue(Link::kPrevious);
+      previous.append(first_pointing_key);
+      links.Add(current_key, previous);
+    }
+  }
+}
+
+void ExternalOrganizer::AddTangled(ExternalSort& links, std::string_view key) {
+  using namespace pipelines::log_message_organizer::external_organizer;
+
+  links.Add(key, LinkValue(Link::kTangled));
+  has_tangled_messages_ = true;
+}
+
+void ExternalOrganizer::RankSpilled(ExternalSort& links) {
+  using namespace pipelines::log_message_organizer::external_organizer;
+
+  auto open_ranks = [](const std::filesystem::path& path) {
+    auto ranks = std::ifstream{path, std::ios::binary};
+    if (!ranks) {
+      throw ExternalOrganizerError("Error reading the spill file: " +
+                                   path.string());
+    }
+    return ranks;
+  };
+  auto create_ranks = [](const std::filesystem::path& path) {
+    auto ranks = std::ofstream{path, std::ios::binary | std::ios::trunc};
+    if (!ranks) {
+      throw ExternalOrganizerError("Error creating the spill file: " +
+                                   path.string());
+    }
+    return ranks;
+  };
+  auto flush_ranks = [](std::ofstream& ranks,
+                        const std::filesystem::path& path) {
+    if (!ranks.flush()) {
+      throw ExternalOrganizerError("Error writing the spill file: " +
+                                   path.string());
+    }
+  };
+
+  // At first the part of every message is only itself
+  links.Sort();
+  auto pending = uint64_t{0};
+  {
+    auto ranks = create_ranks(ranks_path_);
+    auto key = std::string_view{};
+    auto value = std::string_view{};
+    auto has_link = links.Next(key, value);
+    for (uint64_t message = 0; message < pipeline_size_; ++message) {
+      auto rank = Rank{kNoMessage, 1, message, kNoMessage,
+                       0,          message, kNoMessage, 0};
+      for (; has_link && MessageOf(key) == message;
+           has_link = links.Next(key, value)) {
+        if (value.front() == static_cast<char>(Link::kPrevious)) {
+          value.remove_prefix(1);
+          rank.previous = ExternalSort::ReadKey(value);
+          rank.linked = rank.previous;
+          ++pending;
+        } else if (value.front() == static_cast<char>(Link::kTangled)) {
+          rank.tangled = 1;
+        } else {
+          rank.link = static_cast<uint64_t>(value.front());
+        }
+      }
+      WriteRank(ranks, rank);
+    }
+    flush_ranks(ranks, ranks_path_);
+  }
+
+  // Every pass joins the part of every message with the part before it, so
+  // the parts double and the chains are ranked after about log2(n) passes
+  const auto sort_budget = memory_budget_ / kSpilledPipelineSorts;
+  const auto max_passes = std::bit_width(uint64_t{pipeline_size_}) + 1;
+  auto rank_parts = [&]() {
+    for (size_t pass = 0; pending > 0 && pass < max_passes; ++pass) {
+      auto requests = ExternalSort{spill_directory_, sort_budget};
+      {
+        auto ranks = open_ranks(ranks_path_);
+        auto rank = Rank{};
+        for (uint64_t message = 0; ReadRank(ranks, rank); ++message) {
+          if (rank.previous != kNoMessage) {
+            requests.Add(MessageKey(rank.previous), MessageKey(message));
+          }
+        }
+      }
+      requests.Sort();
+
+      auto answers = ExternalSort{spill_directory_, sort_budget};
+      {
+        auto ranks = open_ranks(ranks_path_);
+        auto rank = Rank{};
+        auto read = uint64_t{0};
+        auto key = std::string_view{};
+        auto value = std::string_view{};
+        while (requests.Next(key, value)) {
+          const auto previous = MessageOf(key);
+          for (; read <= previous; ++read) {
+            if (!ReadRank(ranks, rank)) {
+              throw ExternalOrganizerError("Truncated spill file: " +
+                                           ranks_path_.string());
+            }
+          }
+          answers.Add(value, std::string_view{
+                                 reinterpret_cast<const char*>(&rank),
+                                 sizeof(rank)});
+        }
+      }
+      answers.Sort();
+
+      pending = 0;
+      {
+        auto ranks = open_ranks(ranks_path_);
+        auto next_ranks = create_ranks(next_ranks_path_);
+        auto key = std::string_view{};
+        auto value = std::string_view{};
+        auto has_answer = answers.Next(key, value);
+        auto rank = Rank{};
+        for (uint64_t message = 0; ReadRank(ranks, rank); ++message) {
+          if (has_answer && MessageOf(key) == message) {
+            auto before = Rank{};
+            std::memcpy(&before, value.data(), sizeof(before));
+            rank.previous = before.previous;
+            rank.size += before.size;
+            rank.rest_first = std::min(before.rest_first, rank.first);
+            rank.first = std::min(rank.first, before.first);
+            rank.head = before.head;
+            pending += rank.previous != kNoMessage;
+            has_answer = answers.Next(key, value);
+          }
+          WriteRank(next_ranks, rank);
+        }
+        flush_ranks(next_ranks, next_ranks_path_);
+      }
+      std::swap(ranks_path_, next_ranks_path_);
+    }
+  };
+  rank_parts();
+  if (pending == 0) {
+    return;
+  }
+
+  // The parts that never reached the start of their chain went around a
+  // cycle, so their first message is the first one of the cycle, where the
+  // walk over it starts. The cycles are broken before it and ranked again.
+  {
+    auto ranks = open_ranks(ranks_path_);
+    auto next_ranks = create_ranks(next_ranks_path_);
+    auto rank = Rank{};
+    pending = 0;
+    for (uint64_t message = 0; ReadRank(ranks, rank); ++message) {
+      if (rank.previous != kNoMessage) {
+        const auto previous = rank.first == message ? kNoMessage : rank.linked;
+        rank = Rank{previous,  1,       message,     kNoMessage,
+                    rank.link, message, rank.linked, rank.tangled};
+        pending += previous != kNoMessage;
+      }
+      WriteRank(next_ranks, rank);
+    }
+    flush_ranks(next_ranks, next_ranks_path_);
+  }
+  std::swap(ranks_path_, next_ranks_path_);
+  rank_parts();
+}
+
+void ExternalOrganizer::SortSpilled() {
+  using namespace pipelines::log_message_organizer::external_organizer;
+
+  auto chains = std::vector<TangledChain>{};
+  if (has_tangled_messages_) {
+    chains = ReadTangledChains();
+    WalkTangledChains(chains);
+  }
+
+  // The keys give the order of the ListRankingOrganizer: the ends of the
+  // terminated chains and then of the invalid ones, from the last walk to
+  // start in the collection, and then the chains, from the first walk to
+  // start, every chain from its end. The walk of a simple chain is started
+  // by its first message in the collection, the ones of the tangled chains
+  // are found by WalkTangledChains(), with the step of the walk that placed
+  // every part of them.
+  organized_.emplace(spill_directory_, memory_budget_);
+  auto ranks = std::ifstream{ranks_path_, std::ios::binary};
+  if (!ranks) {
+    throw ExternalOrganizerError("Error reading the spill file: " +
+                                 ranks_path_.string());
+  }
+  pipeline_file_.clear();
+  pipeline_file_.seekg(0);
+  auto key = std::string{};
+  auto rank = Rank{};
+  for (uint64_t message = 0; message < pipeline_size_; ++message) {
+    if (!ReadRank(ranks, rank)) {
+      throw ExternalOrganizerError("Truncated spill file: " +
+                                   ranks_path_.string());
+    }
+    auto walk = rank.first;
+    auto step = uint64_t{0};
+    auto position = ~rank.size;
+    auto collected = uint64_t{0};
+    const auto chain =
+        std::ranges::lower_bound(chains, rank.head, {}, &TangledChain::head);
+    if (chain != chains.end() && chain->head == rank.head) {
+      collected = chain->collected;
+      if (message == chain->head) {
+        // Its group is placed in the reverse order of the collection
+        walk = chain->head_walk;
+        step = chain->head_step;
+        position = ~message;
+      } else if (chain->body_walk != kNoMessage &&
+                 rank.rest_first > chain->body_walk) {
+        walk = chain->body_walk;
+        step = chain->body_step;
+      } else if (chain->tail_step != kNoMessage &&
+                 rank.rest_first == chain->tail_first) {
+        walk = chain->tail_first;
+        step = chain->tail_step;
+      } else {
+        walk = rank.rest_first;
+      }
+    }
+
+    key.clear();
+    switch (static_cast<Link>(rank.link)) {
+      case Link::kTermination:
+        key.push_back(static_cast<char>(Section::kTermination));
+        ExternalSort::AppendKey(key, ~walk);
+        ExternalSort::AppendKey(key, ~collected);
+        break;
+      case Link::kInvalid:
+        key.push_back(static_cast<char>(Section::kInvalid));
+        ExternalSort::AppendKey(key, ~walk);
+        ExternalSort::AppendKey(key, ~collected);
+        break;
+      default:
+        key.push_back(static_cast<char>(Section::kChain));
+        ExternalSort::AppendKey(key, walk);
+        ExternalSort::AppendKey(key, step);
+        ExternalSort::AppendKey(key, position);
+        break;
+    }
+    organized_->Add(key, ReadSpilledRecord());
+  }
+  organized_->Sort();
+}
+
+std::vector<ExternalOrganizer::TangledChain>
+ExternalOrganizer::ReadTangledChains() {
+  using namespace pipelines::log_message_organizer::external_organizer;
+
+  // The tangled messages are only at the ends of the chains, so the ends of
+  // every chain are sorted together by its head
+  auto ends = ExternalSort{spill_directory_,
+                           memory_budget_ / kSpilledPipelineSorts};
+  {
+    auto ranks = std::ifstream{ranks_path_, std::ios::binary};
+    if (!ranks) {
+      throw ExternalOrganizerError("Error reading the spill file: " +
+                                   ranks_path_.string());
+    }
+    pipeline_file_.clear();
+    pipeline_file_.seekg(0);
+    auto key = std::string{};
+    auto value = std::string{};
+    auto rank = Rank{};
+    for (uint64_t message = 0; message < pipeline_size_; ++message) {
+      if (!ReadRank(ranks, rank)) {
+        throw ExternalOrganizerError("Truncated spill file: " +
+                                     ranks_path_.string());
+      }
+      const auto record = ReadMessageRecord(ReadSpilledRecord());
+      auto add_end = [&](ChainEnd end, std::string_view id) {
+        const auto end_record =
+            ChainEndRecord{message, rank.rest_first, rank.link, rank.tangled};
+        key = MessageKey(rank.head);
+        key.push_back(static_cast<char>(end));
+        value.assign(reinterpret_cast<const char*>(&end_record),
+                     sizeof(end_record));
+        value.append(id);
+        ends.Add(key, value);
+      };
+      if (rank.head == message) {
+        add_end(ChainEnd::kHead, record.id);
+      }
+      if (rank.size == 2) {
+        add_end(ChainEnd::kSecond, record.id);
+      }
+      if (static_cast<Link>(rank.link) != Link::kChain) {
+        add_end(ChainEnd::kTail, record.next_id);
+      }
+    }
+  }
+  ends.Sort();
+
+  // Only the chains with a tangled end are kept, the cycles broken by
+  // RankSpilled() have no tail
+  auto chains = std::vector<TangledChain>{};
+  auto chain = TangledChain{};
+  auto tangled = false;
+  auto chains_size = size_t{0};
+  auto key = std::string_view{};
+  auto value = std::string_view{};
+  while (ends.Next(key, value)) {
+    auto end_record = ChainEndRecord{};
+    std::memcpy(&end_record, value.data(), sizeof(end_record));
+    const auto id = value.substr(sizeof(end_record));
+    switch (static_cast<ChainEnd>(key.back())) {
+      case ChainEnd::kHead:
+        chain = TangledChain{end_record.message, kNoMessage, kNoMessage, 0,
+                             std::string{id}, {}, {}, kNoMessage, kNoMessage,
+                             kNoMessage, kNoMessage, kNoMessage, 0};
+        tangled = end_record.tangled != 0;
+        break;
+      case ChainEnd::kSecond:
+        chain.second = end_record.message;
+        chain.second_id.assign(id);
+        break;
+      case ChainEnd::kTail:
+        if (!tangled && end_record.tangled == 0) {
+          break;
+        }
+        chain.tail_first = end_record.rest_first;
+        chain.tail_link = end_record.link;
+        chain.next_id.assign(id);
+        chains_size += kTangledChainSize + chain.id.size() +
+                       chain.second_id.size() + chain.next_id.size();
+        chains.push_back(std::move(chain));
+        break;
+    }
+  }
+  if (chains_size > memory_budget_) {
+    over_budget_pipelines_.push_back(pipeline_id_);
+  }
+  return chains;
+}
+
+void ExternalOrganizer::WalkTangledChains(std::vector<TangledChain>& chains) {
+  using namespace pipelines::log_message_organizer::external_organizer;
+
+  // The groups of the first messages by ID, every other message of a chain
+  // has a group of its own. The nodes of the walks are the groups, then the
+  // bodies reached from the first messages, and then the bodies reached by
+  // the walks of tail_first.
+  auto group_by_id = std::unordered_map<std::string_view, size_t>{};
+  auto group_chains = std::vector<std::vector<size_t>>{};
+  for (size_t chain = 0; chain < chains.size(); ++chain) {
+    const auto [group, added] =
+        group_by_id.try_emplace(chains[chain].id, group_chains.size());
+    if (added) {
+      group_chains.emplace_back();
+    }
+    group_chains[group->second].push_back(chain);
+  }
+  const auto group_count = group_chains.size();
+  const auto body = [group_count](size_t chain) { return group_count + chain; };
+  const auto tail = [group_count, &chains](size_t chain) {
+    return group_count + chains.size() + chain;
+  };
+  auto group_walks = std::vector<uint64_t>(group_count, kNoMessage);
+  auto group_steps = std::vector<uint64_t>(group_count, kNoMessage);
+
+  auto next_step = uint64_t{0};
+  auto next_collected = uint64_t{0};
+  auto collect = [&next_collected](TangledChain& chain) {
+    const auto link = static_cast<Link>(chain.tail_link);
+    if (link == Link::kTermination || link == Link::kInvalid) {
+      chain.collected = next_collected++;
+    }
+  };
+  auto tail_group = [&group_by_id](const TangledChain& chain) {
+    auto group = std::optional<size_t>{};
+    if (static_cast<Link>(chain.tail_link) == Link::kBranch) {
+      if (auto found = group_by_id.find(chain.next_id);
+          found != group_by_id.end()) {
+        group = found->second;
+      }
+    }
+    return group;
+  };
+
+  // Reaches a node, like Reach() of the organizer, finding the nodes that
+  // follow it. The body of a chain is reached up to the messages visited by
+  // earlier walks, and it's only followed by the group of the next ID of
+  // its last message if it reaches it.
+  auto reach = [&](size_t node, uint64_t walk,
+                   std::vector<size_t>& next_nodes) {
+    next_nodes.clear();
+    if (node < group_count) {
+      if (group_walks[node] != kNoMessage) {
+        return false;
+      }
+      group_walks[node] = walk;
+      auto named_nodes = std::vector<std::pair<std::string_view, size_t>>{};
+      for (auto chain : group_chains[node]) {
+        chains[chain].head_walk = walk;
+        if (chains[chain].second != kNoMessage) {
+          named_nodes.emplace_back(chains[chain].second_id, body(chain));
+          continue;
+        }
+        collect(chains[chain]);
+        if (auto group = tail_group(chains[chain])) {
+          named_nodes.emplace_back(chains[chain].next_id, *group);
+        }
+      }
+      // The following groups in the order of their IDs, like LinkGroups()
+      std::ranges::sort(named_nodes);
+      named_nodes.erase(
+          std::unique(named_nodes.begin(), named_nodes.end(),
+                      [](const auto& lhs, const auto& rhs) {
+                        return lhs.first == rhs.first;
+                      }),
+          named_nodes.end());
+      for (const auto& named_node : named_nodes) {
+        next_nodes.push_back(named_node.second);
+      }
+      return true;
+    }
+    if (node < tail(0)) {
+      auto& chain = chains[node - group_count];
+      if (chain.second <= walk) {
+        return false;
+      }
+      chain.body_walk = walk;
+      if (chain.tail_first > walk) {
+        collect(chain);
+        if (auto group = tail_group(chain)) {
+          next_nodes.push_back(*group);
+        }
+      }
+      return true;
+    }
+    auto& chain = chains[node - tail(0)];
+    collect(chain);
+    if (auto group = tail_group(chain)) {
+      next_nodes.push_back(*group);
+    }
+    return true;
+  };
+  auto place = [&](size_t node) {
+    if (node < group_count) {
+      group_steps[node] = next_step++;
+    } else if (node < tail(0)) {
+      chains[node - group_count].body_step = next_step++;
+    } else {
+      chains[node - tail(0)].tail_step = next_step++;
+    }
+  };
+
+  /**
+   * @struct Step
+   * @brief A node of a walk whose following nodes are being walked.
+   */
+  struct Step {
+    size_t node;                    /**< The node. */
+    std::vector<size_t> next_nodes; /**< The nodes that follow it. */
+    size_t next{0};                 /**< The next of them to walk. */
+  };
+  auto steps = std::vector<Step>{};
+  auto walk_from = [&](size_t first_node, uint64_t walk) {
+    auto next_nodes = std::vector<size_t>{};
+    if (!reach(first_node, walk, next_nodes)) {
+      return;
+    }
+    steps.push_back({first_node, std::move(next_nodes)});
+    while (!steps.empty()) {
+      auto& step = steps.back();
+      if (step.next == step.next_nodes.size()) {
+        place(step.node);
+        steps.pop_back();
+        continue;
+      }
+      const auto next_node = step.next_nodes[step.next++];
+      if (reach(next_node, walk, next_nodes)) {
+        steps.push_back({next_node, std::move(next_nodes)});
+      }
+    }
+  };
+
+  // The walks start in the order of the collection: at the first message of
+  // every chain, and at the first message of its body, which only starts
+  // one over the chains if its last message wasn't reached yet
+  auto walk_starts = std::vector<std::pair<uint64_t, size_t>>{};
+  walk_starts.reserve(chains.size() * 2);
+  for (size_t chain = 0; chain < chains.size(); ++chain) {
+    walk_starts.emplace_back(chains[chain].head,
+                             group_by_id.at(chains[chain].id));
+    if (chains[chain].second != kNoMessage) {
+      walk_starts.emplace_back(chains[chain].tail_first, tail(chain));
+    }
+  }
+  std::ranges::sort(walk_starts);
+  for (const auto& [walk, node] : walk_starts) {
+    if (node >= tail(0) && chains[node - tail(0)].body_walk != kNoMessage) {
+      continue;
+    }
+    walk_from(node, walk);
+  }
+
+  for (size_t group = 0; group < group_count; ++group) {
+    for (auto chain : group_chains[group]) {
+      chains[chain].head_step = group_steps[group];
+    }
+  }
+}
+}  // namespace pipelines::log_message_organizer
+
+/******************************************************************************
+ * PUBLIC CLASS METHODS IMPLEMENTATION
+ *****************************************************************************/
+
+namespace pipelines::log_message_organizer {
+
+ExternalOrganizer::ExternalOrganizer(
+    const std::filesystem::path& spill_directory, size_t memory_budget,
+    size_t thread_count)
+    : spill_directory_(spill_directory),
+      memory_budget_(memory_budget),
+      thread_count_(thread_count),
+      messages_(spill_directory, memory_budget) {
+  // Several organizers can share the directory
+  auto random = std::random_device{};
+  const auto spill_name = "pipelines_" + std::to_string(random()) + "_" +
+                          std::to_string(random());
+  pipeline_path_ = spill_directory_ / (spill_name + "_pipeline");
+  ranks_path_ = spill_directory_ / (spill_name + "_ranks");
+  next_ranks_path_ = spill_directory_ / (spill_name + "_next_ranks");
+}
+
+ExternalOrganizer::~ExternalOrganizer() {
+  organized_.reset();
+  pipeline_file_.close();
+  auto error = std::error_code{};
+  std::filesystem::remove(pipeline_path_, error);
+  std::filesystem::remove(ranks_path_, error);
+  std::filesystem::remove(next_ranks_path_, error);
+}
+
+void ExternalOrganizer::Add(const LogMessages& log_messages) {
+  auto body = std::string{};
+  for (const auto& message : log_messages) {
+    body.clear();
+    message.body().DecodeTo(body);
+    WriteMessageRecord(record_, message.id(), message.next_id(), body);
+    messages_.Add(message.pipeline_id(), record_);
+  }
+  size_ += log_messages.size();
+}
+
+}  // namespace pipelines::log_message_organizer
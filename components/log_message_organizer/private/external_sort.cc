@@ -0,0 +1,262 @@
+/**
+ * @file external_sort.cc
+ * @brief Implementation of the ExternalSort class.
+ *
+ * This file contains the implementation of the ExternalSort class, which
+ * spills sorted runs of records to disk and merges them back.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include "log_message_organizer/external_sort.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/******************************************************************************
+ * CONSTANTS
+ *****************************************************************************/
+
+namespace pipelines::log_message_organizer::external_sort {
+
+/// Maximum number of runs merged at once, more are merged in several passes
+/// so the open files stay few
+constexpr size_t kMaxMergedRuns = 64;
+
+}  // namespace pipelines::log_message_organizer::external_sort
+
+/******************************************************************************
+ * PRIVATE CLASS METHODS IMPLEMENTATION
+ *****************************************************************************/
+
+namespace pipelines::log_message_organizer {
+
+void ExternalSort::SpillRun() {
+  static_assert(std::is_trivially_copyable_v<RecordHeader>);
+
+  std::stable_sort(entries_.begin(), entries_.end(),
+                   [this](const auto& lhs, const auto& rhs) {
+                     return KeyOf(lhs) < KeyOf(rhs);
+                   });
+  const auto& path = run_paths_.emplace_back(
+      spill_directory_ /
+      (spill_name_ + "_run_" + std::to_string(created_runs_++)));
+  auto run_file = std::ofstream{path, std::ios::binary | std::ios::trunc};
+  for (const auto& entry : entries_) {
+    const auto header = RecordHeader{entry.key_size, entry.value_size};
+    run_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    run_file.write(records_.data() + entry.offset,
+                   static_cast<std::streamsize>(entry.key_size +
+                                                entry.value_size));
+  }
+  if (!run_file) {
+    throw ExternalSortError("Error writing the spill file: " + path.string());
+  }
+  records_.clear();
+  entries_.clear();
+}
+
+void ExternalSort::OpenRuns(size_t first, size_t last) {
+  open_runs_.clear();
+  run_heads_.clear();
+  merge_heap_.clear();
+  for (auto run = first; run < last; ++run) {
+    const auto& run_file =
+        open_runs_.emplace_back(run_paths_[run], std::ios::binary);
+    if (!run_file) {
+      throw ExternalSortError("Error reading the spill file: " +
+                              run_paths_[run].string());
+    }
+    run_heads_.emplace_back();
+    if (ReadHead(static_cast<uint32_t>(run - first))) {
+      merge_heap_.push_back(static_cast<uint32_t>(run - first));
+    }
+  }
+  std::make_heap(merge_heap_.begin(), merge_heap_.end(),
+                 [this](auto lhs, auto rhs) { return MergesAfter(lhs, rhs); });
+}
+
+bool ExternalSort::ReadHead(uint32_t run) {
+  auto& run_file = open_runs_[run];
+  auto& head = run_heads_[run];
+  auto header = RecordHeader{};
+  if (!run_file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+    return false;
+  }
+  head.key_size = header.key_size;
+  head.record.resize(header.key_size + header.value_size);
+  if (!run_file.read(head.record.data(),
+                     static_cast<std::streamsize>(head.record.size()))) {
+    throw ExternalSortError("Truncated spill file of a sorted run");
+  }
+  return true;
+}
+
+bool ExternalSort::MergesAfter(uint32_t lhs, uint32_t rhs) const {
+  // By the next key, and then in the order of the runs, so the merge is
+  // stable
+  return std::pair{KeyOf(run_heads_[rhs]), rhs} <
+         std::pair{KeyOf(run_heads_[lhs]), lhs};
+}
+
+bool ExternalSort::NextMergedRecord() {
+  if (merge_heap_.empty()) {
+    return false;
+  }
+  auto later = [this](auto lhs, auto rhs) { return MergesAfter(lhs, rhs); };
+  std::pop_heap(merge_heap_.begin(), merge_heap_.end(), later);
+  const auto run = merge_heap_.back();
+  // The buffers are swapped, so reading the next head reuses the memory of
+  // the last record
+  std::swap(current_, run_heads_[run]);
+  if (ReadHead(run)) {
+    std::push_heap(merge_heap_.begin(), merge_heap_.end(), later);
+  } else {
+    merge_heap_.pop_back();
+  }
+  return true;
+}
+
+}  // namespace pipelines::log_message_organizer
+
+/******************************************************************************
+ * PUBLIC CLASS METHODS IMPLEMENTATION
+ *****************************************************************************/
+
+namespace pipelines::log_message_organizer {
+
+ExternalSort::ExternalSort(const std::filesystem::path& spill_directory,
+                           size_t memory_budget)
+    : spill_directory_(spill_directory), memory_budget_(memory_budget) {
+  // Several sorts can share the directory
+  auto random = std::random_device{};
+  spill_name_ = "pipelines_" + std::to_string(random()) + "_" +
+                std::to_string(random()) + "_sort";
+}
+
+ExternalSort::~ExternalSort() {
+  open_runs_.clear();
+  auto error = std::error_code{};
+  for (const auto& path : run_paths_) {
+    std::filesystem::remove(path, error);
+  }
+}
+
+void ExternalSort::Add(std::string_view key, std::string_view value) {
+  // The run is spilled before it outgrows the budget, so its memory is
+  // allocated once, and only the pages used are taken
+  const auto run_size = records_.size() + key.size() + value.size() +
+                        (entries_.size() + 1) * sizeof(Entry);
+  if (!entries_.empty() && run_size > memory_budget_) {
+    SpillRun();
+  }
+  if (entries_.empty()) {
+    records_.reserve(memory_budget_);
+    entries_.reserve(memory_budget_ / sizeof(Entry));
+  }
+  entries_.push_back({records_.size(), key.size(), value.size()});
+  records_.append(key);
+  records_.append(value);
+  ++size_;
+}
+
+void ExternalSort::Sort() {
+  using namespace pipelines::log_message_organizer::external_sort;
+
+  if (run_paths_.empty()) {
+    std::stable_sort(entries_.begin(), entries_.end(),
+                     [this](const auto& lhs, const auto& rhs) {
+                       return KeyOf(lhs) < KeyOf(rhs);
+                     });
+    return;
+  }
+  if (!entries_.empty()) {
+    SpillRun();
+  }
+  records_.clear();
+  records_.shrink_to_fit();
+  entries_ = std::vector<Entry>{};
+
+  // Consecutive runs are merged, so the records with the same key keep the
+  // order they were added
+  while (run_paths_.size() > kMaxMergedRuns) {
+    auto merged_paths = std::vector<std::filesystem::path>{};
+    for (size_t first = 0; first < run_paths_.size();
+         first += kMaxMergedRuns) {
+      const auto last = std::min(first + kMaxMergedRuns, run_paths_.size());
+      OpenRuns(first, last);
+      const auto& path = merged_paths.emplace_back(
+          spill_directory_ /
+          (spill_name_ + "_run_" + std::to_string(created_runs_++)));
+      auto merged_file =
+          std::ofstream{path, std::ios::binary | std::ios::trunc};
+      while (NextMergedRecord()) {
+        const auto header = RecordHeader{
+            current_.key_size, current_.record.size() - current_.key_size};
+        merged_file.write(reinterpret_cast<const char*>(&header),
+                          sizeof(header));
+        merged_file.write(current_.record.data(),
+                          static_cast<std::streamsize>(current_.record.size()));
+      }
+      if (!merged_file) {
+        throw ExternalSortError("Error writing the spill file: " +
+                                path.string());
+      }
+      open_runs_.clear();
+      for (auto run = first; run < last; ++run) {
+        std::filesystem::remove(run_paths_[run]);
+      }
+    }
+    run_paths_ = std::move(merged_paths);
+  }
+  OpenRuns(0, run_paths_.size());
+}
+
+bool ExternalSort::Next(std::string_view& key, std::string_view& value) {
+  if (run_paths_.empty()) {
+    if (next_entry_ == entries_.size()) {
+      return false;
+    }
+    const auto& entry = entries_[next_entry_++];
+    key = KeyOf(entry);
+    value = std::string_view{records_}.substr(entry.offset + entry.key_size,
+                                              entry.value_size);
+    return true;
+  }
+  if (!NextMergedRecord()) {
+    return false;
+  }
+  key = KeyOf(current_);
+  value = std::string_view{current_.record}.substr(current_.key_size);
+  return true;
+}
+
+void ExternalSort::AppendKey(std::string& key, uint64_t number) {
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    key.push_back(static_cast<char>((number >> shift) & 0xFF));
+  }
+}
+
+uint64_t ExternalSort::ReadKey(std::string_view& key) {
+  auto number = uint64_t{0};
+  for (size_t byte = 0; byte < sizeof(number); ++byte) {
+    number = (number << 8) | static_cast<unsigned char>(key[byte]);
+  }
+  key.remove_prefix(sizeof(number));
+  return number;
+}
+
+}  // namespace pipelines::log_message_organizer
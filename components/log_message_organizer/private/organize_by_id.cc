@@ -1,9 +1,19 @@
 /**
  * @file organize_by_id.cc
  * @brief Implementation of the OrganizeById class.
- * 
+ *
  * This file contains the implementation of the OrganizeById class, which is responsible
  * for organizing log messages based on their identifiers.
+ *
+ * The messages are organized on their positions in the collection: they are
+ * grouped by ID with a flat hash table, the IDs that follow every ID are kept
+ * in a single array (compressed sparse rows), and the graph of the IDs is
+ * walked with an explicit stack, so long chains don't overflow the call stack.
+ * Only the result is built from the messages, moving each one once.
+ *
+ * A big pipeline can also be organized with several threads when its IDs form
+ * simple chains, by ranking the chains (ListRankingOrganizer); otherwise the
+ * Organizer is used.
  */
 
 /******************************************************************************
@@ -11,12 +21,19 @@
   *****************************************************************************/
 #include "log_message_organizer/organize_by_id.h"
 
-#include <list>
-#include <map>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <optional>
 #include <ranges>
-#include <set>
 #include <string>
 #include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 /******************************************************************************
  * CONSTANTS AND TYPEDEFS
@@ -26,36 +43,69 @@ namespace pipelines::log_message_organizer::organize_by_id {
 /// Constant for the terminator ID
 constexpr auto kTerminator = std::string_view{"-1"};
 
-/// Type alias for pipeline log messages grouped by ID
-using MessagesById = std::multimap<std::string, PipelineLogMessage>;
+/**
+ * @brief Checks if an ID is the terminator.
+ *
+ * The name is compared, so the messages can be interned in any SymbolTable.
+ * @param id The ID.
+ * @return True if the ID is the terminator.
+ */
+static bool IsTerminator(Symbol id) { return id.name() == kTerminator; }
 
-/// Type alias for an id map which tells if a message was already processed
-using MessagesVisited = std::map<std::string, bool>;
+/**
+ * @brief Checks if the IDs and next IDs of the messages are all interned in
+ * the same SymbolTable, so their indexes identify them.
+ * @tparam Messages The collection of the messages.
+ * @param log_messages The messages.
+ * @return True if the indexes of the symbols can be used as keys.
+ */
+template <typename Messages>
+static bool InOneSymbolTable(const Messages& log_messages) {
+  const log_message::SymbolTable* table = nullptr;
+  for (const auto& log_message : log_messages) {
+    for (auto symbol :
+         {log_message.id_symbol(), log_message.next_id_symbol()}) {
+      if (table == nullptr) {
+        table = symbol.table();
+      } else if (symbol.table() != nullptr && symbol.table() != table) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
 
-/// Type alias with a set of all the ids that should have been added to the current chain, but are already visited
-using MessagesVisitedSet = std::set<PipelineLogMessage>;
+/// Group of the IDs that no message has
+constexpr auto kNoGroup = std::numeric_limits<uint32_t>::max();
 
-/// Type alias for a pair of pipeline log messages that share the same ID and all the valid next IDs
-using ElementsUnderSameId = std::pair<class PipelineLogMessagesChain,
-                                      std::map<std::string, struct NextIdInfo>>;
+/// Position of a message that doesn't exist, e.g. the next one of the last
+/// message of a chain
+constexpr auto kNoMessage = std::numeric_limits<uint32_t>::max();
 
-}  // namespace pipelines::log_message_organizer::organize_by_id
+/// Position of the messages waiting for an ID when there are several, see
+/// IncrementalOrganizeById
+constexpr auto kSeveralMessages = kNoMessage - 1;
 
-/******************************************************************************
- * PRIVATE HELPER DECLARATIONS
- *****************************************************************************/
+static_assert(kMaxMessagesById <= kSeveralMessages,
+              "The positions of the messages must be below the markers");
 
-namespace pipelines::log_message_organizer::organize_by_id {
+/// Minimum number of messages ranked by each thread, fewer aren't worth a
+/// thread
+constexpr size_t kMinMessagesPerThread = 32 * 1024;
+
+/// Distance between the messages that start the sublists of the chains, only
+/// by their positions, the first message of every chain starts one too
+constexpr uint32_t kRulerSpacing = 64;
 
 /**
- * @brief Moves the elements of list2 to the end of list1.
- * @param list1 The first list to which elements will be added.
- * @param list2 The second list whose elements will be moved to the first list.
+ * @enum MessageKind
+ * @brief Where a message goes in the organized list, depending on its next ID.
  */
-template <typename T>
-static inline void AddListAtEnd(T& list1, T&& list2) {
-  list1.splice(std::end(list1), std::move(list2));
-}
+enum class MessageKind : uint8_t {
+  kChain,       /**< The next ID is its own ID or the ID of other messages. */
+  kTermination, /**< The next ID is the terminator. */
+  kInvalid,     /**< No message has the next ID. */
+};
 
 }  // namespace pipelines::log_message_organizer::organize_by_id
 
@@ -66,126 +116,127 @@ static inline void AddListAtEnd(T& list1, T&& list2) {
 namespace pipelines::log_message_organizer::organize_by_id {
 
 /**
- * @class PipelineLogMessagesChain
- * @brief Class to manage a chain of pipeline log messages.
+ * @class IdTable
+ * @brief Flat hash table from the IDs of the messages to their groups.
  *
- * By keeping a split between normal messages, invalid messages, and termination messages,
- * this class allows for better organization and management of log messages. 
- * It provides methods to add messages to the chain, merge chains, and retrieve the complete chain.
+ * It uses open addressing with linear probing on the dense indexes of the
+ * symbols, in two arrays allocated once for the number of messages. The
+ * indexes of different symbol tables overlap, so with symbols of several
+ * tables the keys are numbered by the names of the IDs instead.
  */
-class PipelineLogMessagesChain {
-
+class IdTable {
  public:
-  /// Type alias for a list of pipeline log messages
-  using Chain = std::list<PipelineLogMessage>;
-  /// Type alias for an iterator over the list of pipeline log messages
-  using ChainIterator = Chain::iterator;
-
-  /// Default constructor
-  PipelineLogMessagesChain() = default;
   /**
-   * @brief Adds a message to the chain of regular messages.
-   * @param message The pipeline log message to add.
-   * This method adds the message to the normal chain of messages.
+   * @brief Constructs an empty table for up to a number of IDs.
+   * @param max_ids The maximum number of IDs in the table.
+   * @param by_name If the IDs are keyed by their names, needed when they are
+   * interned in several tables, see InOneSymbolTable().
    */
-  void AddToChain(const PipelineLogMessage& message) {
-    chain_.push_back(message);
+  IdTable(size_t max_ids, bool by_name) : by_name_{by_name} {
+    auto capacity = size_t{16};
+    while (capacity < 2 * max_ids) {
+      capacity *= 2;
+    }
+    keys_.resize(capacity, kEmpty);
+    groups_.resize(capacity, kNoGroup);
+    mask_ = capacity - 1;
   }
+
   /**
-   * @brief Adds a message to the chain of termination messages.
-   * @param message The pipeline log message to add.
-   * This method adds the message to the termination chain of messages.
+   * @brief Finds the group of an ID.
+   * @param id The ID.
+   * @return The group, or kNoGroup if no message has the ID.
    */
-  void AddToTerminationChain(const PipelineLogMessage& message) {
-    termination_chain_.push_back(message);
+  uint32_t Find(Symbol id) const {
+    const auto key = Key(id);
+    return key == kEmpty ? kNoGroup : groups_[Slot(key)];
   }
+
   /**
-   * @brief Adds a message to the chain of invalid messages.
-   * @param message The pipeline log message to add.
-   * This method adds the message to the invalid chain of messages.
+   * @brief Finds the group of an ID, adding it with the next group if it's new.
+   * @param id The ID.
+   * @param next_group The group of the ID if it's new.
+   * @return The group of the ID.
    */
-  void AddToInvalidChain(const PipelineLogMessage& message) {
-    invalid_chain_.push_back(message);
+  uint32_t FindOrAdd(Symbol id, uint32_t next_group) {
+    auto key = Key(id);
+    if (key == kEmpty) {
+      key = static_cast<uint32_t>(key_by_name_.size()) + 1;
+      key_by_name_.emplace(id.name(), key);
+    }
+    const auto slot = Slot(key);
+    if (keys_[slot] == kEmpty) {
+      keys_[slot] = key;
+      groups_[slot] = next_group;
+    }
+    return groups_[slot];
   }
-  /**
-   * @brief Merges another PipelineLogMessagesChain into this one. 
-   * @param other The other PipelineLogMessagesChain to merge.
-   * This method combines the messages from the other chain into this one. 
-   * It adds all messages tot the end of their respective chains.
-   */
-  void Merge(PipelineLogMessagesChain& other);
-  /**
-   * @brief Same as Merge, but the regular messages are added after the given iterator.
-   * @param other The other PipelineLogMessagesChain to merge.
-   * @param it The iterator to the position in the chain where the merge should occur.
-   * This method combines the messages from the other chain into this one.
-   * It adds the regular messages after the given iterator.
-   * The termination and invalid messages are added to the end of their respective chains.
-   * @note The iterator must be valid and point to a position in the chain.
-   */
-  void MergeAfter(PipelineLogMessagesChain& other, ChainIterator it);
-  /**
-   * @brief Same as Merge, but the regular messages are added at the beginning of the chain.
-   * @param other The other PipelineLogMessagesChain to merge.
-   * This method combines the messages from the other chain into this one.
-   * It adds the regular messages at the beginning of the chain.
-   * The termination and invalid messages are added to the end of their respective chains.
-   */
-  void MergeAtBeginning(PipelineLogMessagesChain& other);
-  /**
-   * @brief Returns an iterator to last element of the chain.
-   * @return An iterator to the last element of the chain.
-   */
-  ChainIterator BeforeChainEnd() { return std::prev(std::end(chain_)); }
-  /** 
-   * @brief Returns the complete chain of messages, including regular, invalid, and termination messages.
-   * @return The complete chain of messages.
-   * This method combines all the messages from the three chains into one.
-   * The order of the messages is as follows:
-   * - Regular messages
-   * - Invalid messages
-   * - Termination messages
-   */
-  Chain CompleteChain();
 
  private:
-  /// The chain of regular messages
-  Chain chain_;
-  /// The chain of termination messages (Messages with next_id == "-1")
-  Chain termination_chain_;
-  /// The chain of invalid messages (Messages with next_id that do not exist)
-  Chain invalid_chain_;
-};
+  /// Key of the empty slots, the keys are the symbol indexes, or the positions
+  /// of the names, plus one
+  static constexpr uint32_t kEmpty = 0;
+  static_assert(log_message::SymbolTable::kMaxSize <=
+                    std::numeric_limits<uint32_t>::max(),
+                "The indexes plus one must fit in the keys");
 
-/**
- * @struct NextIdInfo
- * @brief Structure to hold information about the next ID in the log message chain.
- *
- * This structure contains flags to indicate whether the next ID is invalid,
- * a terminator, or the same as the current ID.
- */
-struct NextIdInfo {
-  /// Indicates if there is an element with this ID in the log messages
-  bool invalid{false};
-  /// Indicates if this ID is a terminator (e.g., "-1")
-  bool terminator{false};
-  /// Indicates if this ID is the same as the current ID
-  bool same_id{false};
+  /**
+   * @brief Gets the key of an ID.
+   * @param id The ID.
+   * @return The key, kEmpty if the IDs are keyed by name and the name wasn't
+   * added.
+   */
+  uint32_t Key(Symbol id) const {
+    if (!by_name_) {
+      return id.index() + 1;
+    }
+    auto key = key_by_name_.find(id.name());
+    return key == key_by_name_.end() ? kEmpty : key->second;
+  }
 
   /**
-   * @brief Checks if the ID is valid, i.e., an ID that should be followed.
-   * @return true if the ID is valid (not invalid, not a terminator, and not the same ID),
+   * @brief Finds the slot of a key, the one it has or the empty one where it
+   * would be added.
+   * @param key The key of an ID.
+   * @return The position of the slot.
    */
-  bool valid_id() const { return !invalid && !terminator && !same_id; }
+  size_t Slot(uint32_t key) const {
+    // Fibonacci hashing spreads the consecutive indexes of the symbols
+    auto slot =
+        static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask_;
+    while (keys_[slot] != kEmpty && keys_[slot] != key) {
+      slot = (slot + 1) & mask_;
+    }
+    return slot;
+  }
+
+  std::vector<uint32_t> keys_;   /**< The key of every slot. */
+  std::vector<uint32_t> groups_; /**< The group of every slot. */
+  size_t mask_{0};               /**< The capacity minus one. */
+  bool by_name_;                 /**< If the IDs are keyed by their names. */
+  /// The key of every name, only used when the IDs are keyed by name
+  std::unordered_map<std::string_view, uint32_t> key_by_name_;
 };
 
 /**
  * @class Organizer
  * @brief Class to organize log messages by their IDs.
  *
- * This class takes a list of log messages and organizes them into a chain based on their IDs.
- * It handles the merging of chains, marking messages as visited, and retrieving the organized list.
+ * The messages with the same ID form a group, and a group is followed by the
+ * groups of the next IDs of its messages, in the order of their names. Every
+ * message not yet visited starts a walk over the groups that follow it:
+ * - The messages that point to the terminator and the invalid ones are
+ *   collected when their group is reached.
+ * - The other messages of a group are placed once all the groups that follow
+ *   it are placed, in the reverse of their original order.
+ *
+ * The organized list has the termination messages and the invalid ones, both
+ * in the reverse of the order they were collected, and then the others.
+ *
+ * @tparam Messages The collection of the messages, e.g. PipelineLogMessages,
+ * only their IDs and next IDs are used.
  */
+template <typename Messages>
 class Organizer {
  public:
   /// @brief Default constructor is deleted
@@ -194,222 +245,704 @@ class Organizer {
    * @brief Constructor that initializes the Organizer with a list of log messages.
    * @param log_messages The list of log messages to organize.
    */
-  explicit Organizer(const PipelineLogMessages& log_messages)
+  explicit Organizer(const Messages& log_messages)
       : log_messages_{log_messages},
-        organized_list_{},
-        messages_by_id_{},
-        messages_visited_{} {
-    for (const auto& message : log_messages) {
-      messages_by_id_.insert({message.id(), message});
-      messages_visited_.insert({message.id(), false});
-    }
+        group_by_id_{log_messages.size(),
+                     !InOneSymbolTable(log_messages)} {
+    GroupMessages();
+    LinkGroups();
   }
   /**
-   * @brief Returns the organized list of log messages.
-   * @return The organized list of log messages.
+   * @brief Returns the organized order of the log messages.
+   * @return The positions of the messages, in their organized order.
    * @note This method is meant to be called once, after that the Organizer should be destroyed.
    */
-  PipelineLogMessages GetOrganizedList();
+  std::vector<uint32_t> Order();
+  /**
+   * @brief Returns the walk that reached every message, once it's ordered.
+   * @return The position of the message that started the walk that reached
+   * every message, by message.
+   */
+  std::vector<uint32_t> WalkStarts() const;
 
  private:
+  /**
+   * @struct Step
+   * @brief A group in the walk, with the next of its following groups.
+   */
+  struct Step {
+    uint32_t group;     /**< The group. */
+    uint32_t successor; /**< Position of its next following group. */
+  };
+
   /// The list of log messages to organize
-  const PipelineLogMessages& log_messages_;
-  /// The organized list of log messages
-  PipelineLogMessagesChain organized_list_;
-  /// The map of log messages grouped by ID
-  MessagesById messages_by_id_;
-  /// The map of messages visited (true if the message was already processed)
-  MessagesVisited messages_visited_;
+  const Messages& log_messages_;
+  /// The group of every ID
+  IdTable group_by_id_;
+  /// The ID of every group
+  std::vector<Symbol> group_ids_;
+  /// The group of every message
+  std::vector<uint32_t> message_groups_;
+  /// The kind of every message
+  std::vector<MessageKind> message_kinds_;
+  /// Where the messages of every group start in group_messages_, and the end
+  std::vector<uint32_t> group_begins_;
+  /// The messages of every group, in their original order
+  std::vector<uint32_t> group_messages_;
+  /// Where the following groups of every group start in successors_, and the
+  /// end
+  std::vector<uint32_t> successor_begins_;
+  /// The groups that follow every group, in the order of their names
+  std::vector<uint32_t> successors_;
+  /// The groups that were already reached
+  std::vector<bool> visited_;
+  /// The message that started the walk that reached every group
+  std::vector<uint32_t> group_walk_starts_;
+  /// The message that started the current walk
+  uint32_t walk_start_{0};
+  /// The groups being walked, the last one is the current
+  std::vector<Step> steps_;
+  /// The termination messages, in the order they were collected
+  std::vector<uint32_t> termination_messages_;
+  /// The invalid messages, in the order they were collected
+  std::vector<uint32_t> invalid_messages_;
+  /// The other messages, in their organized order
+  std::vector<uint32_t> chain_messages_;
 
   /**
-   * @brief Creates the organized list of log messages.
-   * @note This method is called internally to create the organized list.
-   * It iterates through the log messages and organizes them into chains.
-   * It marks messages as visited to avoid processing them multiple times.
+   * @brief Groups the messages by their IDs, keeping their original order.
    */
-  void CreateOrganizedList();
+  void GroupMessages();
   /**
-   * @brief Marks a message as visited.
-   * @param id The ID of the message to mark as visited.
-   * This method updates the messages_visited_ map to indicate that the message with the given ID has been processed.
+   * @brief Finds the kind of every message and the groups that follow every
+   * group.
    */
-  void MarkMessageAsVisited(const std::string& id) {
-    messages_visited_.at(id) = true;
-  }
+  void LinkGroups();
   /**
-   * @brief Checks if a message has been visited.
-   * @param id The ID of the message to check.
-   * @return true if the message has been visited, false otherwise.
+   * @brief Walks the groups that follow a group that wasn't reached yet.
+   * @param first_group The group the walk starts from.
    */
-  bool IsMessageVisited(const std::string& id) const {
-    return messages_visited_.at(id);
-  }
+  void Walk(uint32_t first_group);
+  /**
+   * @brief Reaches a group, collecting its termination and invalid messages.
+   * @param group The group.
+   */
+  void Reach(uint32_t group);
   /**
-   * @brief Checks if a message has been visited.
-   * @param message The message to check.
-   * @return true if the message has been visited, false otherwise.
+   * @brief Places the chain messages of a group whose following groups are
+   * all placed.
+   * @param group The group.
    */
-  bool IsMessageVisited(const PipelineLogMessage& message) const {
-    return IsMessageVisited(message.id());
+  void Place(uint32_t group);
+  /**
+   * @brief Retrieves the messages of a group.
+   * @param group The group.
+   * @return The positions of its messages, in their original order.
+   */
+  auto GroupMessagesOf(uint32_t group) const {
+    return std::ranges::subrange(
+        group_messages_.begin() + group_begins_[group],
+        group_messages_.begin() + group_begins_[group + 1]);
   }
+};
+
+
+/**
+ * @class ListRankingOrganizer
+ * @brief Organizes the messages of a pipeline with several threads, when
+ * their IDs form simple chains.
+ *
+ * The walks of the Organizer depend on each other, but when every ID has a
+ * single message, no message points to its own ID, no two messages point to
+ * the same ID and there are no cycles, the messages form disjoint chains, and
+ * the position of every message in the organized list only depends on:
+ * - Its rank, the number of messages before it in its chain.
+ * - The first message in the collection among itself and the ones before it
+ *   in its chain, the message that starts the walk that reaches it.
+ *
+ * Both are computed with a sparse ruling set: the first message of every
+ * chain and every kRulerSpacing-th message start a sublist, the sublists are
+ * walked concurrently, the sublists of every chain are ranked one after the
+ * other, and then the sublists are walked again to rank their messages. The
+ * messages are then moved to their positions concurrently.
+ *
+ * Messages that point to IDs that no message has are ranked as the last ones
+ * of their chains, like the ones that point to the terminator. Any other
+ * structure gives up, and the Organizer must be used instead.
+ *
+ * @tparam Messages The collection of the messages, see Organizer.
+ */
+template <typename Messages>
+class ListRankingOrganizer {
+ public:
+  /// @brief Default constructor is deleted
+  ListRankingOrganizer() = delete;
   /**
-   * @brief Retrieves the elements under the same ID as the current message.
-   * @param current_id The ID of the current message.
-   * @return A pair containing a chain of messages with the same ID and a map of next IDs.
+   * @brief Constructor that initializes the organizer with a list of log
+   * messages.
+   * @param log_messages The list of log messages to organize.
+   * @param part_count The number of parts ranked concurrently, at least one.
+   */
+  ListRankingOrganizer(const Messages& log_messages, size_t part_count)
+      : log_messages_{log_messages}, part_count_{part_count} {}
+  /**
+   * @brief Returns the organized order of the log messages, the same as the
+   * Organizer's.
+   * @return The positions of the messages, in their organized order, or
+   * nothing if the messages don't form simple chains.
+   * @note This method is meant to be called once.
    */
-  ElementsUnderSameId GetElementsUnderSameId(const std::string& current_id);
+  std::optional<std::vector<uint32_t>> Order();
+  /**
+   * @brief Returns the organized order of log messages already linked, e.g.
+   * by the IncrementalOrganizeById, the same as the Organizer's.
+   * @param next_messages The message with the next ID of every message, or
+   * kNoMessage, they must form simple chains except for cycles.
+   * @param previous_messages The message pointing to the ID of every message,
+   * or kNoMessage.
+   * @return The positions of the messages, in their organized order, or
+   * nothing if some messages are in cycles.
+   * @note This method is meant to be called once.
+   */
+  std::optional<std::vector<uint32_t>> Order(
+      std::vector<uint32_t> next_messages,
+      std::vector<uint32_t> previous_messages);
+
+ private:
   /**
-   * @brief Adds branches from the next elements to the current chain.
-   * @param next_ids The map of next IDs to process.
-   * @param current_chain The current chain of messages.
-   * This method iterates through the next IDs and adds their corresponding chains to the current chain.
+   * @struct Sublist
+   * @brief The messages from a ruler to the next one of its chain.
    */
-  void AddBranchesFromNextElements(
-      const std::map<std::string, NextIdInfo>& next_ids,
-      PipelineLogMessagesChain& current_chain);
+  struct Sublist {
+    uint32_t first;          /**< The ruler, the first message. */
+    uint32_t next{kNoGroup}; /**< The sublist that follows, if any. */
+    uint32_t size{0};        /**< The number of messages. */
+    uint32_t min_message{kNoMessage}; /**< The first in the collection. */
+    uint32_t rank{0};                 /**< The rank of the ruler. */
+    uint32_t walk_start{kNoMessage};  /**< Its walk start before the ruler. */
+  };
+
+  /// The list of log messages to organize
+  const Messages& log_messages_;
+  /// The number of parts ranked concurrently
+  size_t part_count_;
+  /// The kind of every message
+  std::vector<MessageKind> message_kinds_;
+  /// The message with the next ID of every message, or kNoMessage
+  std::vector<uint32_t> next_messages_;
+  /// The message whose next ID is the ID of every message, or kNoMessage
+  std::vector<uint32_t> previous_messages_;
+  /// The sublist started by every message, or kNoGroup
+  std::vector<uint32_t> message_sublists_;
+  /// The sublists of all the chains
+  std::vector<Sublist> sublists_;
+  /// The number of messages before every message in its chain
+  std::vector<uint32_t> ranks_;
+  /// The first message in the collection among every message and the ones
+  /// before it in its chain
+  std::vector<uint32_t> walk_starts_;
 
   /**
-   * @brief Retrieves the next elements in the log message chain.
-   * @param current_message The current message to process.
-   * @return A chain of messages that follow the current message in the log message chain.
+   * @brief Links every message to the next one of its chain.
+   * @return False if the messages don't form simple chains.
+   */
+  bool LinkMessages();
+  /**
+   * @brief Ranks the messages of every chain.
+   * @return False if some messages are in cycles.
+   */
+  bool RankMessages();
+  /**
+   * @brief Finds the positions of the messages in the organized list.
+   * @return The positions of the messages, in their organized order.
    */
-  PipelineLogMessagesChain GetNextElements(
-      const PipelineLogMessage& current_message);
+  std::vector<uint32_t> PlaceMessages();
 };
+}  // namespace pipelines::log_message_organizer::organize_by_id
+
+/******************************************************************************
+ * PRIVATE HELPER DECLARATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_organizer::organize_by_id {
+
+/**
+ * @brief Calls a function on contiguous parts of a range, concurrently.
+ * @param part_count The number of parts, at least one.
+ * @param size The size of the range.
+ * @param function The function, called with the beginning and the end of
+ * every part.
+ */
+template <typename Function>
+static void RunInParts(size_t part_count, size_t size,
+                       const Function& function);
+
+/**
+ * @brief Finds the organized order of some messages, with the
+ * ListRankingOrganizer when they are enough for several threads, or else
+ * with the Organizer.
+ * @param log_messages The messages, see Organizer.
+ * @param thread_count The number of threads.
+ * @return The positions of the messages, in their organized order.
+ */
+template <typename Messages>
+static std::vector<uint32_t> OrderMessages(const Messages& log_messages,
+                                           size_t thread_count);
+
+/**
+ * @brief Checks the positions of the messages fit in 32 bits, below the
+ * markers.
+ * @param message_count The number of messages.
+ * @throw OrganizeByIdError If there are more than kMaxMessagesById messages.
+ */
+static void CheckMessageCount(size_t message_count);
+
+/**
+ * @brief Moves the messages to a list in their organized order.
+ * @param log_messages The messages, they are moved.
+ * @param order The positions of the messages, in their organized order.
+ * @param thread_count The number of threads the messages are moved with.
+ * @return The organized list.
+ */
+static PipelineLogMessages MoveInOrder(PipelineLogMessages& log_messages,
+                                       const std::vector<uint32_t>& order,
+                                       size_t thread_count);
 
 }  // namespace pipelines::log_message_organizer::organize_by_id
 
 /******************************************************************************
- * PRIVATE HELPER IMPLEMENTATIONS
+ * PRIVATE HELPER IMPLEMENTATION
  *****************************************************************************/
 
+namespace pipelines::log_message_organizer::organize_by_id {
+
+template <typename Function>
+static void RunInParts(size_t part_count, size_t size,
+                       const Function& function) {
+  const auto part_size = (size + part_count - 1) / part_count;
+  auto run_part = [&](size_t part) {
+    const auto begin = std::min(part * part_size, size);
+    function(begin, std::min(begin + part_size, size));
+  };
+  auto other_parts = std::vector<std::future<void>>{};
+  for (size_t part = 1; part < part_count; ++part) {
+    other_parts.push_back(std::async(std::launch::async, run_part, part));
+  }
+  run_part(0);
+  for (auto& other_part : other_parts) {
+    other_part.get();
+  }
+}
+
+static void CheckMessageCount(size_t message_count) {
+  if (message_count > kMaxMessagesById) {
+    throw OrganizeByIdError(
+        "Too many messages to organize by ID: " +
+        std::to_string(message_count) + ", the most are " +
+        std::to_string(kMaxMessagesById));
+  }
+}
+
+template <typename Messages>
+static std::vector<uint32_t> OrderMessages(const Messages& log_messages,
+                                           size_t thread_count) {
+  CheckMessageCount(log_messages.size());
+  const auto part_count =
+      std::min(thread_count, log_messages.size() / kMinMessagesPerThread);
+  if (part_count > 1) {
+    if (auto order = ListRankingOrganizer{log_messages, part_count}.Order()) {
+      return std::move(*order);
+    }
+  }
+  return Organizer{log_messages}.Order();
+}
+
+static PipelineLogMessages MoveInOrder(PipelineLogMessages& log_messages,
+                                       const std::vector<uint32_t>& order,
+                                       size_t thread_count) {
+  const auto part_count = std::max<size_t>(
+      std::min(thread_count, order.size() / kMinMessagesPerThread), 1);
+  auto organized_messages = PipelineLogMessages(order.size());
+  RunInParts(part_count, order.size(), [&](size_t begin, size_t end) {
+    for (auto position = begin; position < end; ++position) {
+      organized_messages[position] = std::move(log_messages[order[position]]);
+    }
+  });
+  return organized_messages;
+}
+
+}  // namespace pipelines::log_message_organizer::organize_by_id
+
 /******************************************************************************
  * PRIVATE CLASS METHODS IMPLEMENTATION
  *****************************************************************************/
 
 namespace pipelines::log_message_organizer::organize_by_id {
 
-void PipelineLogMessagesChain::Merge(PipelineLogMessagesChain& other) {
-  AddListAtEnd(chain_, std::move(other.chain_));
-  AddListAtEnd(termination_chain_, std::move(other.termination_chain_));
-  AddListAtEnd(invalid_chain_, std::move(other.invalid_chain_));
+template <typename Messages>
+void Organizer<Messages>::GroupMessages() {
+  message_groups_.resize(log_messages_.size());
+  for (size_t message = 0; message < log_messages_.size(); ++message) {
+    const auto id = log_messages_[message].id_symbol();
+    const auto group = group_by_id_.FindOrAdd(
+        id, static_cast<uint32_t>(group_ids_.size()));
+    if (group == group_ids_.size()) {
+      group_ids_.push_back(id);
+    }
+    message_groups_[message] = group;
+  }
+
+  // Counting sort of the messages by group, which keeps their order
+  group_begins_.assign(group_ids_.size() + 1, 0);
+  for (auto group : message_groups_) {
+    ++group_begins_[group + 1];
+  }
+  for (size_t group = 0; group < group_ids_.size(); ++group) {
+    group_begins_[group + 1] += group_begins_[group];
+  }
+  auto next_positions = std::vector<uint32_t>(group_begins_.begin(),
+                                              group_begins_.end() - 1);
+  group_messages_.resize(log_messages_.size());
+  for (size_t message = 0; message < log_messages_.size(); ++message) {
+    group_messages_[next_positions[message_groups_[message]]++] =
+        static_cast<uint32_t>(message);
+  }
+}
+
+template <typename Messages>
+void Organizer<Messages>::LinkGroups() {
+  message_kinds_.resize(log_messages_.size());
+  successor_begins_.assign(group_ids_.size() + 1, 0);
+  successors_.reserve(log_messages_.size());
+
+  for (uint32_t group = 0; group < group_ids_.size(); ++group) {
+    const auto first_successor = successors_.size();
+    for (auto message : GroupMessagesOf(group)) {
+      const auto next_id = log_messages_[message].next_id_symbol();
+      if (IsTerminator(next_id)) {
+        message_kinds_[message] = MessageKind::kTermination;
+      } else if (next_id == group_ids_[group]) {
+        message_kinds_[message] = MessageKind::kChain;
+      } else if (auto next_group = group_by_id_.Find(next_id);
+                 next_group != kNoGroup) {
+        message_kinds_[message] = MessageKind::kChain;
+        successors_.push_back(next_group);
+      } else {
+        message_kinds_[message] = MessageKind::kInvalid;
+      }
+    }
+
+    // Usually a group has a single following group, so this is cheap
+    auto successors = std::ranges::subrange(
+        successors_.begin() + first_successor, successors_.end());
+    std::ranges::sort(successors, [this](auto lhs, auto rhs) {
+      return group_ids_[lhs] < group_ids_[rhs];
+    });
+    successors_.erase(std::unique(successors.begin(), successors.end()),
+                      successors_.end());
+    successor_begins_[group + 1] = static_cast<uint32_t>(successors_.size());
+  }
 }
-void PipelineLogMessagesChain::MergeAfter(PipelineLogMessagesChain& other,
-                                          ChainIterator it) {
-  chain_.splice(std::next(it), std::move(other.chain_));
-  AddListAtEnd(termination_chain_, std::move(other.termination_chain_));
-  AddListAtEnd(invalid_chain_, std::move(other.invalid_chain_));
+
+template <typename Messages>
+void Organizer<Messages>::Walk(uint32_t first_group) {
+  Reach(first_group);
+  steps_.push_back({first_group, successor_begins_[first_group]});
+
+  while (!steps_.empty()) {
+    auto& step = steps_.back();
+    if (step.successor == successor_begins_[step.group + 1]) {
+      Place(step.group);
+      steps_.pop_back();
+      continue;
+    }
+    // A following group can be reached by the ones before it
+    const auto next_group = successors_[step.successor++];
+    if (!visited_[next_group]) {
+      Reach(next_group);
+      steps_.push_back({next_group, successor_begins_[next_group]});
+    }
+  }
 }
 
-void PipelineLogMessagesChain::MergeAtBeginning(
-    PipelineLogMessagesChain& other) {
-  chain_.splice(std::begin(chain_), std::move(other.chain_));
-  AddListAtEnd(termination_chain_, std::move(other.termination_chain_));
-  AddListAtEnd(invalid_chain_, std::move(other.invalid_chain_));
+template <typename Messages>
+void Organizer<Messages>::Reach(uint32_t group) {
+  visited_[group] = true;
+  group_walk_starts_[group] = walk_start_;
+  for (auto message : GroupMessagesOf(group)) {
+    if (message_kinds_[message] == MessageKind::kTermination) {
+      termination_messages_.push_back(message);
+    } else if (message_kinds_[message] == MessageKind::kInvalid) {
+      invalid_messages_.push_back(message);
+    }
+  }
 }
 
-PipelineLogMessagesChain::Chain PipelineLogMessagesChain::CompleteChain() {
-  auto complete_chain = Chain{};
-  AddListAtEnd(complete_chain, std::move(chain_));
-  AddListAtEnd(complete_chain, std::move(invalid_chain_));
-  AddListAtEnd(complete_chain, std::move(termination_chain_));
-  return complete_chain;
+template <typename Messages>
+void Organizer<Messages>::Place(uint32_t group) {
+  for (auto message : GroupMessagesOf(group) | std::views::reverse) {
+    if (message_kinds_[message] == MessageKind::kChain) {
+      chain_messages_.push_back(message);
+    }
+  }
 }
 
-void Organizer::CreateOrganizedList() {
-  for (const auto& message : log_messages_) {
-    if (!IsMessageVisited(message)) {
-      auto current_chain = GetNextElements(message);
-      organized_list_.MergeAtBeginning(current_chain);
+template <typename Messages>
+std::vector<uint32_t> Organizer<Messages>::Order() {
+  visited_.assign(group_ids_.size(), false);
+  group_walk_starts_.assign(group_ids_.size(), kNoMessage);
+  for (uint32_t message = 0; message < message_groups_.size(); ++message) {
+    if (const auto group = message_groups_[message]; !visited_[group]) {
+      walk_start_ = message;
+      Walk(group);
     }
   }
+
+  // Every message is in one of the lists once
+  auto order = std::vector<uint32_t>{};
+  order.reserve(log_messages_.size());
+  order.insert(order.end(), termination_messages_.rbegin(),
+               termination_messages_.rend());
+  order.insert(order.end(), invalid_messages_.rbegin(),
+               invalid_messages_.rend());
+  order.insert(order.end(), chain_messages_.begin(), chain_messages_.end());
+  return order;
 }
 
-PipelineLogMessages Organizer::GetOrganizedList() {
+template <typename Messages>
+std::vector<uint32_t> Organizer<Messages>::WalkStarts() const {
+  auto walk_starts = std::vector<uint32_t>{};
+  walk_starts.reserve(message_groups_.size());
+  for (auto group : message_groups_) {
+    walk_starts.push_back(group_walk_starts_[group]);
+  }
+  return walk_starts;
+}
 
-  CreateOrganizedList();
+template <typename Messages>
+bool ListRankingOrganizer<Messages>::LinkMessages() {
+  // Every ID has a single message, so the groups are the messages
+  auto message_by_id =
+      IdTable{log_messages_.size(), !InOneSymbolTable(log_messages_)};
+  for (uint32_t message = 0; message < log_messages_.size(); ++message) {
+    if (message_by_id.FindOrAdd(log_messages_[message].id_symbol(), message) !=
+        message) {
+      return false;
+    }
+  }
 
-  auto organized_list = organized_list_.CompleteChain();
-  // We need to reverse the order of the messages in the list
-  return {organized_list.rbegin(), organized_list.rend()};
+  message_kinds_.resize(log_messages_.size());
+  next_messages_.resize(log_messages_.size());
+  previous_messages_.assign(log_messages_.size(), kNoMessage);
+  auto simple_chains = std::atomic<bool>{true};
+  RunInParts(part_count_, log_messages_.size(), [&](size_t begin, size_t end) {
+    for (auto message = begin; message < end; ++message) {
+      const auto& log_message = log_messages_[message];
+      const auto next_id = log_message.next_id_symbol();
+      auto next_message = kNoMessage;
+      if (IsTerminator(next_id)) {
+        message_kinds_[message] = MessageKind::kTermination;
+      } else if (next_id == log_message.id_symbol()) {
+        simple_chains.store(false, std::memory_order_relaxed);
+      } else if (next_message = message_by_id.Find(next_id);
+                 next_message == kNoGroup) {
+        message_kinds_[message] = MessageKind::kInvalid;
+      } else {
+        message_kinds_[message] = MessageKind::kChain;
+        // A second message pointing to the same ID merges two chains
+        auto previous = kNoMessage;
+        if (!std::atomic_ref{previous_messages_[next_message]}
+                 .compare_exchange_strong(previous,
+                                          static_cast<uint32_t>(message),
+                                          std::memory_order_relaxed)) {
+          simple_chains.store(false, std::memory_order_relaxed);
+        }
+      }
+      next_messages_[message] =
+          next_message == kNoGroup ? kNoMessage : next_message;
+    }
+  });
+  return simple_chains.load();
 }
 
-ElementsUnderSameId Organizer::GetElementsUnderSameId(
-    const std::string& current_id) {
-  auto same_element_chain = PipelineLogMessagesChain{};
-  auto next_ids = std::map<std::string, NextIdInfo>{};
-
-  // Get all the messages with the same ID
-  auto [it_current_id_first, it_current_id_end] =
-      messages_by_id_.equal_range(current_id);
-
-  // Iterate through the messages with the same ID
-  for (auto it = it_current_id_first; it != it_current_id_end; ++it) {
-    const auto& next_id = it->second.next_id();
-    auto next_id_info = NextIdInfo{};
-
-    if (kTerminator == next_id) {
-      next_id_info.terminator = true;
-      same_element_chain.AddToTerminationChain(it->second);
-    } else if (next_id == current_id) {
-      next_id_info.same_id = true;
-      same_element_chain.AddToChain(it->second);
-    } else if (!messages_by_id_.contains(next_id)) {
-      next_id_info.invalid = true;
-      same_element_chain.AddToInvalidChain(it->second);
+template <typename Messages>
+bool ListRankingOrganizer<Messages>::RankMessages() {
+  message_sublists_.assign(log_messages_.size(), kNoGroup);
+  for (uint32_t message = 0; message < log_messages_.size(); ++message) {
+    if (previous_messages_[message] == kNoMessage ||
+        message % kRulerSpacing == 0) {
+      message_sublists_[message] = static_cast<uint32_t>(sublists_.size());
+      sublists_.push_back({.first = message});
     }
+  }
 
-    if (next_id_info.valid_id()) {
-      same_element_chain.AddToChain(it->second);
-      if (!IsMessageVisited(next_id)) {
-        next_ids.emplace(next_id, next_id_info);
+  // Every sublist is walked up to the next ruler, a message is in a single
+  // one unless it is in a cycle without rulers
+  auto ranked_messages = std::atomic<size_t>{0};
+  RunInParts(part_count_, sublists_.size(), [&](size_t begin, size_t end) {
+    auto part_messages = size_t{0};
+    for (auto position = begin; position < end; ++position) {
+      auto& sublist = sublists_[position];
+      auto message = sublist.first;
+      do {
+        ++sublist.size;
+        sublist.min_message = std::min(sublist.min_message, message);
+        message = next_messages_[message];
+      } while (message != kNoMessage && message_sublists_[message] == kNoGroup);
+      if (message != kNoMessage) {
+        sublist.next = message_sublists_[message];
       }
+      part_messages += sublist.size;
     }
+    ranked_messages += part_messages;
+  });
+  if (ranked_messages != log_messages_.size()) {
+    return false;
   }
 
-  return {same_element_chain, next_ids};
+  // The sublists of every chain, from its first message, are few
+  auto ranked_sublists = size_t{0};
+  for (auto& first_sublist : sublists_) {
+    if (previous_messages_[first_sublist.first] != kNoMessage) {
+      continue;
+    }
+    auto rank = uint32_t{0};
+    auto walk_start = kNoMessage;
+    for (auto sublist = &first_sublist; sublist != nullptr;
+         sublist = sublist->next == kNoGroup ? nullptr
+                                             : &sublists_[sublist->next]) {
+      sublist->rank = rank;
+      sublist->walk_start = walk_start;
+      rank += sublist->size;
+      walk_start = std::min(walk_start, sublist->min_message);
+      ++ranked_sublists;
+    }
+  }
+  if (ranked_sublists != sublists_.size()) {
+    return false;
+  }
+
+  ranks_.resize(log_messages_.size());
+  walk_starts_.resize(log_messages_.size());
+  RunInParts(part_count_, sublists_.size(), [&](size_t begin, size_t end) {
+    for (auto position = begin; position < end; ++position) {
+      const auto& sublist = sublists_[position];
+      auto message = sublist.first;
+      auto walk_start = sublist.walk_start;
+      for (auto rank = sublist.rank; rank < sublist.rank + sublist.size;
+           ++rank) {
+        walk_start = std::min(walk_start, message);
+        ranks_[message] = rank;
+        walk_starts_[message] = walk_start;
+        message = next_messages_[message];
+      }
+    }
+  });
+  return true;
 }
 
-void Organizer::AddBranchesFromNextElements(
-    const std::map<std::string, NextIdInfo>& next_ids,
-    PipelineLogMessagesChain& current_chain) {
-
-  // All branches are added after the current last element in the chain
-  // This guarantees that the order of the messages is preserved because
-  // any possible sub-chain will be added before the previous sub-chain
-  // and if the sub-chain would have conflicting messages, they will already
-  // be marked as visited
-  auto last_element_in_chain = current_chain.BeforeChainEnd();
-  for (const auto& [next_id, next_id_info] : next_ids) {
-    // The next ID can be visited during the last iteration of the loop
-    // so we need to check again if the message was already visited
-    if (!IsMessageVisited(next_id)) {
-      if (auto it = messages_by_id_.find(next_id);
-          it != std::end(messages_by_id_)) {
-        auto next_elements = GetNextElements(it->second);
-
-        current_chain.MergeAfter(next_elements, last_element_in_chain);
+template <typename Messages>
+std::vector<uint32_t> ListRankingOrganizer<Messages>::PlaceMessages() {
+  // The walk that starts at a message places its chain messages from the
+  // last one it reaches to the first, and collects the last message of its
+  // chain if it's the first walk there
+  auto walk_ends = std::vector<uint32_t>(log_messages_.size(), kNoMessage);
+  auto chain_ends = std::vector<uint32_t>(log_messages_.size(), kNoMessage);
+  RunInParts(part_count_, log_messages_.size(), [&](size_t begin, size_t end) {
+    for (auto message = begin; message < end; ++message) {
+      const auto walk_start = walk_starts_[message];
+      const auto next_message = next_messages_[message];
+      if (message_kinds_[message] != MessageKind::kChain) {
+        chain_ends[walk_start] = static_cast<uint32_t>(message);
+      } else if (message_kinds_[next_message] != MessageKind::kChain ||
+                 walk_starts_[next_message] != walk_start) {
+        walk_ends[walk_start] = static_cast<uint32_t>(message);
       }
     }
+  });
+
+  auto termination_messages = std::vector<uint32_t>{};
+  auto invalid_messages = std::vector<uint32_t>{};
+  auto chain_message_count = uint32_t{0};
+  for (uint32_t walk_start = 0; walk_start < log_messages_.size();
+       ++walk_start) {
+    if (const auto chain_end = chain_ends[walk_start];
+        chain_end != kNoMessage) {
+      if (message_kinds_[chain_end] == MessageKind::kTermination) {
+        termination_messages.push_back(chain_end);
+      } else {
+        invalid_messages.push_back(chain_end);
+      }
+    }
+    // Replaced by the position of the first message of the walk, the others
+    // go before it
+    if (auto& walk_end = walk_ends[walk_start]; walk_end != kNoMessage) {
+      chain_message_count += ranks_[walk_end] - ranks_[walk_start] + 1;
+      walk_end = chain_message_count - 1 + ranks_[walk_start];
+    }
   }
+
+  auto order = std::vector<uint32_t>{};
+  order.reserve(log_messages_.size());
+  order.insert(order.end(), termination_messages.rbegin(),
+               termination_messages.rend());
+  order.insert(order.end(), invalid_messages.rbegin(), invalid_messages.rend());
+  const auto position = order.size();
+  order.resize(log_messages_.size());
+  RunInParts(part_count_, log_messages_.size(), [&](size_t begin, size_t end) {
+    for (auto message = begin; message < end; ++message) {
+      if (message_kinds_[message] == MessageKind::kChain) {
+        order[position + walk_ends[walk_starts_[message]] - ranks_[message]] =
+            static_cast<uint32_t>(message);
+      }
+    }
+  });
+  return order;
 }
 
-PipelineLogMessagesChain Organizer::GetNextElements(
-    const PipelineLogMessage& current_message) {
-  auto current_chain = PipelineLogMessagesChain{};
-  const auto& current_id = current_message.id();
+template <typename Messages>
+std::optional<std::vector<uint32_t>> ListRankingOrganizer<Messages>::Order() {
+  if (!LinkMessages() || !RankMessages()) {
+    return std::nullopt;
+  }
+  return PlaceMessages();
+}
 
-  auto [same_element_chain, next_ids] = GetElementsUnderSameId(current_id);
+template <typename Messages>
+std::optional<std::vector<uint32_t>> ListRankingOrganizer<Messages>::Order(
+    std::vector<uint32_t> next_messages,
+    std::vector<uint32_t> previous_messages) {
+  next_messages_ = std::move(next_messages);
+  previous_messages_ = std::move(previous_messages);
+  message_kinds_.resize(log_messages_.size());
+  for (size_t message = 0; message < log_messages_.size(); ++message) {
+    if (IsTerminator(log_messages_[message].next_id_symbol())) {
+      message_kinds_[message] = MessageKind::kTermination;
+    } else if (next_messages_[message] != kNoMessage) {
+      message_kinds_[message] = MessageKind::kChain;
+    } else {
+      message_kinds_[message] = MessageKind::kInvalid;
+    }
+  }
+  if (!RankMessages()) {
+    return std::nullopt;
+  }
+  return PlaceMessages();
+}
 
-  current_chain.Merge(same_element_chain);
-  MarkMessageAsVisited(current_id);
+}  // namespace pipelines::log_message_organizer::organize_by_id
 
-  AddBranchesFromNextElements(next_ids, current_chain);
+namespace pipelines::log_message_organizer {
 
-  return current_chain;
+void IncrementalOrganizeById::StopLinking() {
+  simple_chains_ = false;
+  message_by_id_ = {};
+  waiting_message_by_id_ = {};
+  next_messages_ = {};
+  previous_messages_ = {};
 }
 
-}  // namespace pipelines::log_message_organizer::organize_by_id
+}  // namespace pipelines::log_message_organizer
 
 /******************************************************************************
  * PUBLIC CLASS METHODS IMPLEMENTATION
@@ -417,10 +950,102 @@ PipelineLogMessagesChain Organizer::GetNextElements(
 
 namespace pipelines::log_message_organizer {
 
-PipelineLogMessages OrganizeById::Organize() const {
+PipelineLogMessages OrganizeById::Organize() const& {
+  return OrganizeById{log_messages_, thread_count_}.Organize();
+}
+
+PipelineLogMessages OrganizeById::Organize() && {
+  using namespace pipelines::log_message_organizer::organize_by_id;
+
+  return MoveInOrder(log_messages_, OrderMessages(log_messages_, thread_count_),
+                     thread_count_);
+}
+
+void IncrementalOrganizeById::Insert(PipelineLogMessage log_message) {
+  using namespace pipelines::log_message_organizer::organize_by_id;
+
+  CheckMessageCount(log_messages_.size() + 1);
+  const auto message = static_cast<uint32_t>(log_messages_.size());
+  const auto id = log_message.id_symbol();
+  const auto next_id = log_message.next_id_symbol();
+  log_messages_.push_back(std::move(log_message));
+  if (!simple_chains_) {
+    return;
+  }
+
+  if (!message_by_id_.emplace(id, message).second ||
+      (next_id == id && !IsTerminator(next_id))) {
+    StopLinking();
+    return;
+  }
+  next_messages_.push_back(kNoMessage);
+  previous_messages_.push_back(kNoMessage);
+
+  // The message waiting for the ID isn't invalid anymore
+  if (auto waiting = waiting_message_by_id_.find(id);
+      waiting != waiting_message_by_id_.end()) {
+    if (waiting->second == kSeveralMessages) {
+      StopLinking();
+      return;
+    }
+    next_messages_[waiting->second] = message;
+    previous_messages_[message] = waiting->second;
+    waiting_message_by_id_.erase(waiting);
+  }
+
+  if (IsTerminator(next_id)) {
+    return;
+  }
+  if (auto next = message_by_id_.find(next_id); next != message_by_id_.end()) {
+    if (previous_messages_[next->second] != kNoMessage) {
+      StopLinking();
+      return;
+    }
+    next_messages_[message] = next->second;
+    previous_messages_[next->second] = message;
+  } else if (auto [waiting, added] =
+                 waiting_message_by_id_.emplace(next_id, message);
+             !added) {
+    // They are only invalid until the ID arrives, then they merge
+    waiting->second = kSeveralMessages;
+  }
+}
+
+PipelineLogMessages IncrementalOrganizeById::Snapshot() const {
+  using namespace pipelines::log_message_organizer::organize_by_id;
+
+  auto order = std::optional<std::vector<uint32_t>>{};
+  if (simple_chains_) {
+    order = ListRankingOrganizer{log_messages_, 1}.Order(next_messages_,
+                                                         previous_messages_);
+  }
+  if (!order) {
+    order = Organizer{log_messages_}.Order();
+  }
+
+  auto organized_messages = PipelineLogMessages{};
+  organized_messages.reserve(order->size());
+  for (auto message : *order) {
+    organized_messages.push_back(log_messages_[message]);
+  }
+  return organized_messages;
+}
+
+std::vector<uint32_t> OrderById::Order() const {
+  using namespace pipelines::log_message_organizer::organize_by_id;
+
+  return OrderMessages(message_ids_, thread_count_);
+}
+
+std::vector<uint32_t> OrderById::Order(
+    std::vector<uint32_t>& walk_starts) const {
   using namespace pipelines::log_message_organizer::organize_by_id;
 
-  return Organizer(log_messages_).GetOrganizedList();
+  CheckMessageCount(message_ids_.size());
+  auto organizer = Organizer{message_ids_};
+  auto order = organizer.Order();
+  walk_starts = organizer.WalkStarts();
+  return order;
 }
 
-}  // namespace pipelines::log_message_organizer
\ No newline at end of file
+}  // namespace pipelines::log_message_organizer
@@ -0,0 +1,204 @@
+/**
+ * @file organize_pipelines.cc
+ * @brief Implementation of the OrganizePipelines class.
+ *
+ * This file contains the implementation of the OrganizePipelines class, and
+ * of the work-stealing pool it organizes the pipelines with.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include "log_message_organizer/organize_pipelines.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "log_message_organizer/organize_by_id.h"
+
+/******************************************************************************
+ * CONSTANTS
+ *****************************************************************************/
+
+namespace pipelines::log_message_organizer::organize_pipelines {
+
+/// Minimum number of messages of a task, the smaller pipelines are grouped
+/// so the threads don't spend more time taking tasks than organizing
+constexpr size_t kMinMessagesPerTask = 16 * 1024;
+
+}  // namespace pipelines::log_message_organizer::organize_pipelines
+
+/******************************************************************************
+ * PRIVATE CLASSES
+ *****************************************************************************/
+
+namespace pipelines::log_message_organizer::organize_pipelines {
+
+/**
+ * @struct Task
+ * @brief Consecutive pipelines, in the order they are scheduled.
+ */
+struct Task {
+  size_t begin; /**< The first pipeline. */
+  size_t end;   /**< The pipeline after the last one. */
+};
+
+/**
+ * @class WorkStealingPool
+ * @brief Runs tasks on several threads, each with its own queue of tasks.
+ *
+ * A thread runs the tasks of its queue from the front, and once it's empty it
+ * steals the tasks at the back of the queues of the other threads. All the
+ * tasks are added before running them, so the threads stop when every queue
+ * is empty.
+ */
+class WorkStealingPool {
+ public:
+  /**
+   * @brief Constructs a pool with empty queues.
+   * @param thread_count The number of threads, at least one.
+   */
+  explicit WorkStealingPool(size_t thread_count) : queues_(thread_count) {}
+
+  /**
+   * @brief Adds the tasks, dealing them to the queues in turns, so every
+   * queue starts with its share of the first ones.
+   * @param tasks The tasks, in the order they should run.
+   */
+  void Deal(const std::vector<Task>& tasks) {
+    for (size_t task = 0; task < tasks.size(); ++task) {
+      queues_[task % queues_.size()].tasks.push_back(tasks[task]);
+    }
+  }
+
+  /**
+   * @brief Runs all the tasks, the calling thread is one of the threads.
+   * @param run_task The function that runs a task, called concurrently.
+   */
+  template <typename RunTask>
+  void Run(const RunTask& run_task) {
+    auto work = [this, &run_task](size_t thread) {
+      while (auto task = Take(thread)) {
+        run_task(*task);
+      }
+    };
+    auto other_threads = std::vector<std::future<void>>{};
+    for (size_t thread = 1; thread < queues_.size(); ++thread) {
+      other_threads.push_back(std::async(std::launch::async, work, thread));
+    }
+    work(0);
+    for (auto& other_thread : other_threads) {
+      other_thread.get();
+    }
+  }
+
+ private:
+  /**
+   * @struct Queue
+   * @brief The tasks of a thread.
+   */
+  struct Queue {
+    std::mutex mutex;       /**< Protects the tasks. */
+    std::deque<Task> tasks; /**< The tasks not taken yet. */
+  };
+
+  /**
+   * @brief Takes the next task of a thread, its own or a stolen one.
+   * @param thread The thread.
+   * @return The task, or nothing if every queue is empty.
+   */
+  std::optional<Task> Take(size_t thread) {
+    {
+      auto& own = queues_[thread];
+      auto lock = std::lock_guard{own.mutex};
+      if (!own.tasks.empty()) {
+        auto task = own.tasks.front();
+        own.tasks.pop_front();
+        return task;
+      }
+    }
+    for (size_t offset = 1; offset < queues_.size(); ++offset) {
+      auto& victim = queues_[(thread + offset) % queues_.size()];
+      auto lock = std::lock_guard{victim.mutex};
+      if (!victim.tasks.empty()) {
+        auto task = victim.tasks.back();
+        victim.tasks.pop_back();
+        return task;
+      }
+    }
+    return std::nullopt;
+  }
+
+  std::vector<Queue> queues_; /**< The queue of every thread. */
+};
+
+}  // namespace pipelines::log_message_organizer::organize_pipelines
+
+/******************************************************************************
+ * PUBLIC CLASS METHODS IMPLEMENTATION
+ *****************************************************************************/
+
+namespace pipelines::log_message_organizer {
+
+PipelineLogMessagesByPipeline OrganizePipelines::Organize() const& {
+  return OrganizePipelines{messages_by_pipeline_, thread_count_}.Organize();
+}
+
+PipelineLogMessagesByPipeline OrganizePipelines::Organize() && {
+  using namespace pipelines::log_message_organizer::organize_pipelines;
+
+  // The biggest pipelines first, the map keeps the order of the output
+  auto pipelines = std::vector<PipelineLogMessages*>{};
+  pipelines.reserve(messages_by_pipeline_.size());
+  for (auto& [pipeline_id, messages] : messages_by_pipeline_) {
+    pipelines.push_back(&messages);
+  }
+  std::stable_sort(pipelines.begin(), pipelines.end(),
+                   [](const auto* lhs, const auto* rhs) {
+                     return lhs->size() > rhs->size();
+                   });
+
+  // A pipeline with a thread's share of the messages or more would keep the
+  // other threads waiting, so it's organized alone with all of them
+  auto message_count = size_t{0};
+  for (const auto* messages : pipelines) {
+    message_count += messages->size();
+  }
+  auto first_shared = size_t{0};
+  while (thread_count_ > 1 && first_shared < pipelines.size() &&
+         pipelines[first_shared]->size() * thread_count_ >= message_count) {
+    auto& messages = *pipelines[first_shared++];
+    messages = OrganizeById(std::move(messages), thread_count_).Organize();
+  }
+
+  auto tasks = std::vector<Task>{};
+  auto task_size = size_t{0};
+  for (auto pipeline = first_shared; pipeline < pipelines.size(); ++pipeline) {
+    if (tasks.empty() || task_size >= kMinMessagesPerTask) {
+      tasks.push_back({pipeline, pipeline});
+      task_size = 0;
+    }
+    ++tasks.back().end;
+    task_size += pipelines[pipeline]->size();
+  }
+
+  auto pool = WorkStealingPool{
+      std::clamp<size_t>(thread_count_, 1, std::max<size_t>(tasks.size(), 1))};
+  pool.Deal(tasks);
+  pool.Run([&pipelines](const Task& task) {
+    for (auto pipeline = task.begin; pipeline < task.end; ++pipeline) {
+      auto& messages = *pipelines[pipeline];
+      messages = OrganizeById(std::move(messages)).Organize();
+    }
+  });
+
+  return std::move(messages_by_pipeline_);
+}
+
+}  // namespace pipelines::log_message_organizer
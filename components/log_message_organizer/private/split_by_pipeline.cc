@@ -3,7 +3,8 @@
  * @brief Implementation of the SplitByPipeline class.
  * 
  * This file contains the implementation of the SplitByPipeline class, which is responsible
- * for splitting log messages by their pipeline identifiers.
+ * for splitting log messages by their pipeline identifiers, and of the
+ * IncrementalSplitByPipeline class it uses.
  */
 
 /******************************************************************************
@@ -12,30 +13,262 @@
 
 #include "log_message_organizer/split_by_pipeline.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+/******************************************************************************
+ * CONSTANTS
+ *****************************************************************************/
+
+namespace pipelines::log_message_organizer {
+
+/// Position of the bucket of the symbols that are not pipeline IDs
+constexpr auto kNoBucket = std::numeric_limits<uint32_t>::max();
+
+/// Minimum number of messages split by each thread, fewer aren't worth a
+/// thread
+constexpr size_t kMinMessagesPerThread = 8 * 1024;
+
+}  // namespace pipelines::log_message_organizer
+
 /******************************************************************************
  * PRIVATE HELPER DECLARATIONS
  *****************************************************************************/
 
+namespace pipelines::log_message_organizer {
+
+/**
+ * @brief Creates the map of the pipelines, sorting them by their names.
+ *
+ * The map is filled in order, so every insertion is at its end and no name
+ * is compared while inserting.
+ *
+ * @param pipeline_ids The pipeline IDs, in the order of their buckets.
+ * @param buckets The messages of every pipeline, they are moved to the map.
+ * @return A map of pipeline IDs to their corresponding log messages.
+ */
+static PipelineLogMessagesByPipeline CreateSortedPipelines(
+    const std::vector<Symbol>& pipeline_ids,
+    std::vector<PipelineLogMessages>& buckets);
+
+/**
+ * @brief Splits the log messages by their pipeline IDs, see SplitByPipeline.
+ *
+ * @param log_messages The log messages to split, they are moved.
+ * @param part_count The number of contiguous parts, split concurrently, at
+ * least one.
+ * @return A map of pipeline IDs to their corresponding log messages.
+ */
+static PipelineLogMessagesByPipeline SplitInParts(LogMessages& log_messages,
+                                                  size_t part_count);
+
+}  // namespace pipelines::log_message_organizer
+
+/******************************************************************************
+ * PRIVATE HELPER IMPLEMENTATION
+ *****************************************************************************/
+
+namespace pipelines::log_message_organizer {
+
+static PipelineLogMessagesByPipeline CreateSortedPipelines(
+    const std::vector<Symbol>& pipeline_ids,
+    std::vector<PipelineLogMessages>& buckets) {
+  auto order = std::vector<uint32_t>(pipeline_ids.size());
+  std::iota(order.begin(), order.end(), uint32_t{0});
+  std::sort(order.begin(), order.end(), [&pipeline_ids](auto lhs, auto rhs) {
+    return pipeline_ids[lhs] < pipeline_ids[rhs];
+  });
+
+  auto messages_by_pipeline = PipelineLogMessagesByPipeline{};
+  for (auto bucket : order) {
+    messages_by_pipeline.emplace_hint(messages_by_pipeline.end(),
+                                      pipeline_ids[bucket].name(),
+                                      std::move(buckets[bucket]));
+  }
+  return messages_by_pipeline;
+}
+
+static PipelineLogMessagesByPipeline SplitInParts(LogMessages& log_messages,
+                                                  size_t part_count) {
+  // The buckets are numbered by the first message of each pipeline, which
+  // only looks the symbols up in an array
+  auto pipelines = PipelineBuckets{};
+  auto message_buckets = std::vector<uint32_t>(log_messages.size());
+  for (size_t i = 0; i < log_messages.size(); ++i) {
+    message_buckets[i] =
+        pipelines.FindOrAdd(log_messages[i].pipeline_id_symbol());
+  }
+  const auto& pipeline_ids = pipelines.pipeline_ids();
+
+  const auto part_size = (log_messages.size() + part_count - 1) / part_count;
+  auto part = [&](size_t part_index) {
+    const auto begin = std::min(part_index * part_size, log_messages.size());
+    const auto end = std::min(begin + part_size, log_messages.size());
+    return std::pair{begin, end};
+  };
+  auto run_parts = [part_count](auto function) {
+    auto other_parts = std::vector<std::future<void>>{};
+    for (size_t part_index = 1; part_index < part_count; ++part_index) {
+      other_parts.push_back(
+          std::async(std::launch::async, function, part_index));
+    }
+    function(0);
+    for (auto& other_part : other_parts) {
+      other_part.get();
+    }
+  };
+
+  // First pass: the number of messages of every pipeline in every part
+  auto positions = std::vector<std::vector<uint32_t>>(
+      part_count, std::vector<uint32_t>(pipeline_ids.size()));
+  run_parts([&](size_t part_index) {
+    auto& counts = positions[part_index];
+    auto [begin, end] = part(part_index);
+    for (auto i = begin; i < end; ++i) {
+      ++counts[message_buckets[i]];
+    }
+  });
+
+  // The messages of a part go after the ones of the previous parts, so the
+  // pipelines keep the order of the collection
+  auto buckets = std::vector<PipelineLogMessages>(pipeline_ids.size());
+  for (size_t bucket = 0; bucket < buckets.size(); ++bucket) {
+    auto position = uint32_t{0};
+    for (auto& part_positions : positions) {
+      position += std::exchange(part_positions[bucket], position);
+    }
+    buckets[bucket].resize(position);
+  }
+
+  // Second pass: every message is moved to its position
+  run_parts([&](size_t part_index) {
+    auto& next_positions = positions[part_index];
+    auto [begin, end] = part(part_index);
+    for (auto i = begin; i < end; ++i) {
+      auto& message = log_messages[i];
+      const auto bucket = message_buckets[i];
+      buckets[bucket][next_positions[bucket]++] = PipelineLogMessage{
+          message.id_symbol(), std::move(message).body(),
+          message.next_id_symbol()};
+    }
+  });
+
+  log_messages.clear();
+  return CreateSortedPipelines(pipeline_ids, buckets);
+}
+
+}  // namespace pipelines::log_message_organizer
+
 /******************************************************************************
  * PRIVATE CLASS METHODS IMPLEMENTATION
  *****************************************************************************/
 
+namespace pipelines::log_message_organizer {
+
+uint32_t PipelineBuckets::Add(Symbol pipeline_id) {
+  const auto bucket = static_cast<uint32_t>(pipeline_ids_.size());
+  pipeline_ids_.push_back(pipeline_id);
+  if (!bucket_by_name_.empty()) {
+    bucket_by_name_.emplace(pipeline_id.name(), bucket);
+  }
+  return bucket;
+}
+
+PipelineLogMessages& IncrementalSplitByPipeline::Bucket(Symbol pipeline_id) {
+  const auto bucket = pipelines_.FindOrAdd(pipeline_id);
+  if (bucket == buckets_.size()) {
+    buckets_.emplace_back();
+  }
+  return buckets_[bucket];
+}
+
+}  // namespace pipelines::log_message_organizer
+
 /******************************************************************************
  * PUBLIC CLASS METHODS IMPLEMENTATION
  ******************************************************************************/
 
 namespace pipelines::log_message_organizer {
 
-PipelineLogMessagesByPipeline SplitByPipeline::Split() const {
-  auto messages_by_pipeline = PipelineLogMessagesByPipeline{};
+uint32_t PipelineBuckets::FindOrAdd(Symbol pipeline_id) {
+  if (table_ == nullptr) {
+    table_ = pipeline_id.table();
+  }
+  if (pipeline_id.table() != nullptr && pipeline_id.table() != table_) {
+    // The first symbol of another table starts numbering the pipelines by
+    // their names too
+    if (bucket_by_name_.empty()) {
+      for (uint32_t bucket = 0; bucket < pipeline_ids_.size(); ++bucket) {
+        bucket_by_name_.emplace(pipeline_ids_[bucket].name(), bucket);
+      }
+    }
+    if (auto it = bucket_by_name_.find(pipeline_id.name());
+        it != bucket_by_name_.end()) {
+      return it->second;
+    }
+    return Add(pipeline_id);
+  }
+
+  const auto index = pipeline_id.index();
+  if (index >= bucket_by_index_.size()) {
+    bucket_by_index_.resize(
+        std::max<size_t>(index + 1, 2 * bucket_by_index_.size()), kNoBucket);
+  }
+  auto& bucket = bucket_by_index_[index];
+  if (bucket == kNoBucket) {
+    // The pipeline may have been found through a symbol of another table
+    auto it = bucket_by_name_.find(pipeline_id.name());
+    bucket = it != bucket_by_name_.end() ? it->second : Add(pipeline_id);
+  }
+  return bucket;
+}
+
+void PipelineBuckets::Clear() {
+  table_ = nullptr;
+  bucket_by_index_.clear();
+  bucket_by_name_.clear();
+  pipeline_ids_.clear();
+}
 
-  for (const auto& message : log_messages_) {
-    const auto& pipeline_id = message.pipeline_id();
-    auto& messages = messages_by_pipeline[pipeline_id];
-    messages.emplace_back(message.id(), message.body(), message.next_id());
+void IncrementalSplitByPipeline::Add(const LogMessages& log_messages) {
+  for (const auto& message : log_messages) {
+    Bucket(message.pipeline_id_symbol())
+        .emplace_back(message.id_symbol(), message.body(),
+                      message.next_id_symbol());
   }
+}
+
+void IncrementalSplitByPipeline::Add(LogMessages&& log_messages) {
+  for (auto& message : log_messages) {
+    Bucket(message.pipeline_id_symbol())
+        .emplace_back(message.id_symbol(), std::move(message).body(),
+                      message.next_id_symbol());
+  }
+  log_messages.clear();
+}
 
+PipelineLogMessagesByPipeline IncrementalSplitByPipeline::Finish() {
+  auto messages_by_pipeline =
+      CreateSortedPipelines(pipelines_.pipeline_ids(), buckets_);
+  pipelines_.Clear();
+  buckets_.clear();
   return messages_by_pipeline;
 }
 
-}  // namespace pipelines::log_message_organizer
\ No newline at end of file
+PipelineLogMessagesByPipeline SplitByPipeline::Split() const& {
+  return SplitByPipeline{log_messages_, thread_count_}.Split();
+}
+
+PipelineLogMessagesByPipeline SplitByPipeline::Split() && {
+  const auto part_count =
+      std::min(thread_count_, log_messages_.size() / kMinMessagesPerThread);
+  return SplitInParts(log_messages_, std::max<size_t>(part_count, 1));
+}
+
+}  // namespace pipelines::log_message_organizer
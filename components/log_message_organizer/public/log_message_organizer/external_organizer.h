@@ -0,0 +1,313 @@
+/**
+ * @file external_organizer.h
+ * @brief This file defines the ExternalOrganizer class, which splits and
+ * organizes log messages that don't fit in memory, spilling them to disk.
+ *
+ */
+
+#ifndef COMPONENTS_LOG_MESSAGE_ORGANIZER_PUBLIC_LOG_MESSAGE_ORGANIZER_EXTERNAL_ORGANIZER_H_
+#define COMPONENTS_LOG_MESSAGE_ORGANIZER_PUBLIC_LOG_MESSAGE_ORGANIZER_EXTERNAL_ORGANIZER_H_
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "log_message_organizer/external_sort.h"
+#include "log_message_organizer/organize_by_id.h"
+#include "log_message_organizer/pipeline_log_message.h"
+
+/******************************************************************************
+ * CLASSES
+ *****************************************************************************/
+
+namespace pipelines::log_message_organizer {
+
+/**
+ * @class ExternalOrganizerError
+ * @brief Exception thrown when a spill file can't be written or read.
+ */
+class ExternalOrganizerError : public std::runtime_error {
+ public:
+  /**
+   * @brief Constructor
+   * @param message Error message
+   */
+  explicit ExternalOrganizerError(const std::string& message)
+      : std::runtime_error(message) {}
+};
+
+/**
+ * @class ExternalOrganizer
+ * @brief Splits log messages by their pipeline identifiers and organizes them
+ * by their identifiers, with a bounded amount of memory.
+ *
+ * The messages are copied, with their IDs and decoded bodies, to an
+ * ExternalSort by pipeline, so when organizing the messages of every pipeline
+ * are read in the order they were added, a pipeline at a time. A pipeline
+ * that fits in the memory budget is ordered in memory (OrderById), with its
+ * IDs interned in a SymbolTable of its own. A bigger one is spilled to a file
+ * and ranked on disk:
+ * - The IDs are joined with the next IDs by sorting both (sort-merge join),
+ *   which links every message to the one before it in its chain.
+ * - Every message finds its rank and the first message of its chain in the
+ *   collection by pointer jumping: in every pass it joins the part of the
+ *   chain before it with the part before that one, with two sorts, so the
+ *   chains are ranked in a logarithmic number of passes.
+ * - The messages are sorted by their position in the organized list, the
+ *   same one as the ListRankingOrganizer's, and read back in that order with
+ *   their bodies.
+ *
+ * Like the ListRankingOrganizer, the ranking on disk only works when the
+ * messages form simple chains. The messages with repeated IDs, pointing to
+ * their own ID, to a repeated ID or to the same message as others, are
+ * tangled: they aren't linked on disk, so they are only at the ends of the
+ * chains. The cycles are broken before their first message in the
+ * collection and ranked again. Only the ends of the chains with tangled
+ * messages are kept in memory, with their IDs, and the walks of the
+ * organizer over them find where every message of these chains goes.
+ *
+ * The ends of the tangled chains are kept in memory even if they take more
+ * than the budget, and the pipeline is then reported by
+ * over_budget_pipelines().
+ *
+ * The result is the same as splitting the messages with SplitByPipeline and
+ * organizing every pipeline with OrganizeById. The spill files are removed
+ * with the organizer.
+ */
+class ExternalOrganizer {
+ public:
+  ExternalOrganizer() = delete; /**< Default constructor is deleted. */
+
+  /**
+   * @brief Constructor of an empty organizer.
+   * @param spill_directory The directory of the spill files, it must exist.
+   * @param memory_budget The number of bytes of the messages kept in memory:
+   * by the sort of the messages, by a pipeline ordered in memory, and shared
+   * by the sorts that rank a spilled pipeline.
+   * @param thread_count The number of threads a pipeline is ordered with in
+   * memory, see OrganizeById.
+   */
+  ExternalOrganizer(const std::filesystem::path& spill_directory,
+                    size_t memory_budget, size_t thread_count = 1);
+
+  ExternalOrganizer(const ExternalOrganizer&) = delete;
+  ExternalOrganizer& operator=(const ExternalOrganizer&) = delete;
+
+  /**
+   * @brief Destructor, removes the spill files.
+   */
+  ~ExternalOrganizer();
+
+  /**
+   * @brief Adds log messages, spilling them when they take the budget.
+   * @param log_messages The log messages to add.
+   * @throw ExternalSortError If a spill file can't be written.
+   */
+  void Add(const LogMessages& log_messages);
+
+  /**
+   * @brief Retrieves the number of log messages added so far.
+   * @return The number of log messages.
+   */
+  size_t size() const { return size_; }
+
+  /**
+   * @brief Retrieves the pipelines whose tangled chains took more memory than
+   * the budget while they were organized.
+   * @return The IDs of the pipelines, in the order they were organized.
+   */
+  const std::vector<std::string>& over_budget_pipelines() const {
+    return over_budget_pipelines_;
+  }
+
+  /**
+   * @brief Organizes the log messages, giving them to an output one by one.
+   *
+   * The pipelines are given in the order of their IDs, and the messages of
+   * every pipeline in their organized order.
+   *
+   * @param output The output, called with the pipeline ID, the ID and the
+   * body of every message, which are only valid during the call.
+   * @throw ExternalOrganizerError If a spill file can't be written or read.
+   * @throw ExternalSortError If a spill file of a sort can't be written or
+   * read.
+   * @note This method is meant to be called once.
+   */
+  template <typename Output>
+  void Organize(Output output) {
+    StartOrganizing();
+    while (OrganizeNextPipeline()) {
+      auto id = std::string_view{};
+      auto body = std::string_view{};
+      while (NextOrganizedMessage(id, body)) {
+        output(std::string_view{pipeline_id_}, id, body);
+      }
+    }
+  }
+
+ private:
+  /**
+   * @struct TangledChain
+   * @brief A chain of a spilled pipeline with tangled messages, which are
+   * only its first and last ones, and where the walks of the organizer
+   * reach it.
+   *
+   * The messages from the second one on are its body. A walk that reaches
+   * its first message goes on with the part of the body not visited yet,
+   * and the walk started by the first message of the body in the collection
+   * reaches its last message, unless that part did.
+   */
+  struct TangledChain {
+    uint64_t head;         /**< The position of its first message. */
+    uint64_t second;       /**< The position of the second one, or none. */
+    uint64_t tail_first;   /**< The first of its body in the collection. */
+    uint64_t tail_link;    /**< The Link of its last message. */
+    std::string id;        /**< The ID of its first message. */
+    std::string second_id; /**< The ID of its second message. */
+    std::string next_id;   /**< The next ID of its last message. */
+    uint64_t head_walk;    /**< The walk that reached its first message. */
+    uint64_t head_step;    /**< When its first message was placed. */
+    uint64_t body_walk;    /**< The walk that reached its body, or none. */
+    uint64_t body_step;    /**< When that part of the body was placed. */
+    uint64_t tail_step;    /**< When the walk of tail_first placed it. */
+    uint64_t collected;    /**< When its last message was collected. */
+  };
+
+  /**
+   * @brief Sorts the messages by pipeline and reads the first one.
+   */
+  void StartOrganizing();
+  /**
+   * @brief Reads the messages of the next pipeline and orders them.
+   * @return False if there are no more pipelines.
+   */
+  bool OrganizeNextPipeline();
+  /**
+   * @brief Takes the next message of the current pipeline in the organized
+   * order.
+   * @param id Replaced by the ID of the message.
+   * @param body Replaced by the body of the message.
+   * @return False if the pipeline is over. The ID and the body are only
+   * valid until the next call.
+   */
+  bool NextOrganizedMessage(std::string_view& id, std::string_view& body);
+  /**
+   * @brief Adds a message to the current pipeline, in memory while it fits
+   * in the budget, and to the spill file of the pipeline after that.
+   * @param record The record of the message.
+   */
+  void AddToPipeline(std::string_view record);
+  /**
+   * @brief Reads the next record of the spill file of the current pipeline.
+   * @return The record, valid until the next one is read.
+   */
+  std::string_view ReadSpilledRecord();
+  /**
+   * @brief Orders the current pipeline, which is in memory.
+   */
+  void OrderInMemory();
+  /**
+   * @brief Orders the current pipeline, which is spilled, on disk, and the
+   * ends of the chains of its tangled messages in memory.
+   */
+  void OrderSpilled();
+  /**
+   * @brief Links every message of the spilled pipeline to the one before it
+   * in its chain, unless one of them is tangled.
+   * @param links Where the kind of every message, whether it's tangled and
+   * the one before it are added, by message.
+   */
+  void LinkSpilled(ExternalSort& links);
+  /**
+   * @brief Marks a message of the spilled pipeline as tangled.
+   * @param links The links of the messages, see LinkSpilled().
+   * @param key The key of the message.
+   */
+  void AddTangled(ExternalSort& links, std::string_view key);
+  /**
+   * @brief Ranks the messages of the spilled pipeline, writing the rank, the
+   * first message of the chain in the collection and the head of the chain
+   * of every message to ranks_path_. The cycles are broken before their
+   * first message in the collection, and ranked as chains.
+   * @param links The links of the messages, see LinkSpilled().
+   */
+  void RankSpilled(ExternalSort& links);
+  /**
+   * @brief Sorts the messages of the spilled pipeline in their organized
+   * order into organized_: the ones of simple chains by their ranks, and
+   * the ones of tangled chains by where the walks reach them.
+   */
+  void SortSpilled();
+  /**
+   * @brief Reads the ends of the chains of the spilled pipeline with
+   * tangled messages, reporting the pipeline if they take more than the
+   * memory budget.
+   * @return The chains, by the position of their first message.
+   */
+  std::vector<TangledChain> ReadTangledChains();
+  /**
+   * @brief Walks the tangled chains of the spilled pipeline like the
+   * organizer walks their messages, filling where the walks reach them.
+   * @param chains The chains, by the position of their first message.
+   */
+  static void WalkTangledChains(std::vector<TangledChain>& chains);
+
+  /// The directory of the spill files
+  std::filesystem::path spill_directory_;
+  /// The path of the spill file of a pipeline that doesn't fit in memory
+  std::filesystem::path pipeline_path_;
+  /// The path of the ranks of the messages of a spilled pipeline
+  std::filesystem::path ranks_path_;
+  /// The path of the ranks being computed from the ones in ranks_path_
+  std::filesystem::path next_ranks_path_;
+  /// The number of bytes of the messages kept in memory
+  size_t memory_budget_;
+  /// The number of threads a pipeline is ordered with in memory
+  size_t thread_count_;
+  /// The number of messages added so far
+  size_t size_{0};
+  /// The messages, by pipeline
+  ExternalSort messages_;
+  /// A record of a message, being written or read
+  std::string record_;
+  /// Whether there's a next pipeline
+  bool has_next_message_{false};
+  /// The pipeline of the first message of the next pipeline
+  std::string next_pipeline_id_;
+  /// The record of the first message of the next pipeline
+  std::string next_message_;
+  /// The ID of the current pipeline
+  std::string pipeline_id_;
+  /// The number of messages of the current pipeline
+  size_t pipeline_size_{0};
+  /// The records of the current pipeline, when it's in memory
+  std::string pipeline_records_;
+  /// Where every record of the current pipeline ends in pipeline_records_
+  std::vector<size_t> record_ends_;
+  /// The organized order of the current pipeline, when it's in memory
+  std::vector<uint32_t> pipeline_order_;
+  /// The position in pipeline_order_ of the next message to give
+  size_t next_position_{0};
+  /// The spill file of the current pipeline, when it doesn't fit in memory
+  std::fstream pipeline_file_;
+  /// Whether the spilled pipeline has tangled messages, the ones with
+  /// repeated IDs, pointing to their own ID, to a repeated ID or to the same
+  /// message as others
+  bool has_tangled_messages_{false};
+  /// The pipelines whose tangled chains took more than the memory budget
+  std::vector<std::string> over_budget_pipelines_;
+  /// The records of the current pipeline in their organized order, when it
+  /// was ranked on disk
+  std::optional<ExternalSort> organized_;
+};
+
+}  // namespace pipelines::log_message_organizer
+#endif  // COMPONENTS_LOG_MESSAGE_ORGANIZER_PUBLIC_LOG_MESSAGE_ORGANIZER_EXTERNAL_ORGANIZER_H_
@@ -0,0 +1,229 @@
+/**
+ * @file external_sort.h
+ * @brief This file defines the ExternalSort class, which sorts records that
+ * don't fit in memory, spilling sorted runs of them to disk.
+ *
+ */
+
+#ifndef COMPONENTS_LOG_MESSAGE_ORGANIZER_PUBLIC_LOG_MESSAGE_ORGANIZER_EXTERNAL_SORT_H_
+#define COMPONENTS_LOG_MESSAGE_ORGANIZER_PUBLIC_LOG_MESSAGE_ORGANIZER_EXTERNAL_SORT_H_
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/******************************************************************************
+ * CLASSES
+ *****************************************************************************/
+
+namespace pipelines::log_message_organizer {
+
+/**
+ * @class ExternalSortError
+ * @brief Exception thrown when a run of an ExternalSort can't be written or
+ * read.
+ */
+class ExternalSortError : public std::runtime_error {
+ public:
+  /**
+   * @brief Constructor
+   * @param message Error message
+   */
+  explicit ExternalSortError(const std::string& message)
+      : std::runtime_error(message) {}
+};
+
+/**
+ * @class ExternalSort
+ * @brief Sorts records by their keys with a bounded amount of memory.
+ *
+ * A record is a key and a value, both any bytes. The records are collected
+ * in memory until they take the memory budget, and then sorted and spilled
+ * to a run file. The runs are merged, at most 64 at a time, and the last
+ * merge gives the records one by one. If no run was spilled the records are
+ * sorted and given from memory.
+ *
+ * The keys are compared as strings, byte by byte, so numbers are written in
+ * big endian to be sorted (AppendKey). The sort is stable: records with the
+ * same key keep the order they were added in.
+ *
+ * The class is not copyable, the run files are removed with it.
+ */
+class ExternalSort {
+ public:
+  ExternalSort() = delete; /**< Default constructor is deleted. */
+
+  /**
+   * @brief Constructor of an empty sort.
+   * @param spill_directory The directory of the run files, it must exist.
+   * @param memory_budget The number of bytes of the records collected in
+   * memory, a run has at least one record.
+   */
+  ExternalSort(const std::filesystem::path& spill_directory,
+               size_t memory_budget);
+
+  ExternalSort(const ExternalSort&) = delete;
+  ExternalSort& operator=(const ExternalSort&) = delete;
+
+  /**
+   * @brief Destructor, removes the run files.
+   */
+  ~ExternalSort();
+
+  /**
+   * @brief Adds a record, it's copied.
+   * @param key The key of the record.
+   * @param value The value of the record.
+   * @throw ExternalSortError If a run file can't be written.
+   */
+  void Add(std::string_view key, std::string_view value);
+
+  /**
+   * @brief Sorts the records added, they can't be added after that.
+   * @throw ExternalSortError If a run file can't be written or read.
+   */
+  void Sort();
+
+  /**
+   * @brief Takes the next record in the sorted order, after Sort().
+   * @param key Replaced by the key of the record.
+   * @param value Replaced by the value of the record.
+   * @return False if there are no more records. The key and the value are
+   * only valid until the next call.
+   * @throw ExternalSortError If a run file can't be read.
+   */
+  bool Next(std::string_view& key, std::string_view& value);
+
+  /**
+   * @brief Retrieves the number of records added.
+   * @return The number of records.
+   */
+  size_t size() const { return size_; }
+
+  /**
+   * @brief Appends a number to a key, so keys are sorted by it.
+   * @param key The key.
+   * @param number The number, written in big endian.
+   */
+  static void AppendKey(std::string& key, uint64_t number);
+
+  /**
+   * @brief Reads a number written by AppendKey.
+   * @param key The key, the number is removed from its start.
+   * @return The number.
+   */
+  static uint64_t ReadKey(std::string_view& key);
+
+ private:
+  /**
+   * @struct Entry
+   * @brief A record collected in memory.
+   */
+  struct Entry {
+    uint64_t offset;     /**< The position of the key in records_. */
+    uint64_t key_size;   /**< The size of the key. */
+    uint64_t value_size; /**< The size of the value, after the key. */
+  };
+
+  /**
+   * @struct RecordHeader
+   * @brief The sizes of a record in a run file, its key and value follow it.
+   */
+  struct RecordHeader {
+    uint64_t key_size;   /**< The size of the key. */
+    uint64_t value_size; /**< The size of the value. */
+  };
+
+  /**
+   * @struct RunHead
+   * @brief The next record of an open run.
+   */
+  struct RunHead {
+    std::string record;   /**< The key and the value. */
+    uint64_t key_size{0}; /**< The size of the key. */
+  };
+
+  /**
+   * @brief Retrieves the key of an entry.
+   * @param entry The entry.
+   * @return The key.
+   */
+  std::string_view KeyOf(const Entry& entry) const {
+    return std::string_view{records_}.substr(entry.offset, entry.key_size);
+  }
+  /**
+   * @brief Retrieves the key of a record read from a run.
+   * @param head The record.
+   * @return The key.
+   */
+  static std::string_view KeyOf(const RunHead& head) {
+    return std::string_view{head.record}.substr(0, head.key_size);
+  }
+  /**
+   * @brief Sorts the records in memory and spills them to a new run file.
+   */
+  void SpillRun();
+  /**
+   * @brief Opens some runs to merge them.
+   * @param first The first run.
+   * @param last The run after the last one.
+   */
+  void OpenRuns(size_t first, size_t last);
+  /**
+   * @brief Reads the next record of an open run.
+   * @param run The position of the open run.
+   * @return False if the run is over.
+   */
+  bool ReadHead(uint32_t run);
+  /**
+   * @brief Compares two open runs by their next records, for the heap of the
+   * runs, which keeps the first one to merge on top.
+   * @param lhs The position of an open run.
+   * @param rhs The position of another open run.
+   * @return True if the first run is merged after the second one.
+   */
+  bool MergesAfter(uint32_t lhs, uint32_t rhs) const;
+  /**
+   * @brief Takes the next record of the open runs into current_.
+   * @return False if the runs are over.
+   */
+  bool NextMergedRecord();
+
+  /// The directory of the run files
+  std::filesystem::path spill_directory_;
+  /// The start of the names of the run files
+  std::string spill_name_;
+  /// The number of bytes of the records collected in memory
+  size_t memory_budget_;
+  /// The number of records added
+  size_t size_{0};
+  /// The keys and values collected in memory
+  std::string records_;
+  /// The records collected in memory, in the order they were added
+  std::vector<Entry> entries_;
+  /// The next record given from memory
+  size_t next_entry_{0};
+  /// The run files, in the order they were spilled
+  std::vector<std::filesystem::path> run_paths_;
+  /// The number of run files created, for their names
+  size_t created_runs_{0};
+  /// The open runs, being merged
+  std::vector<std::ifstream> open_runs_;
+  /// The next record of every open run
+  std::vector<RunHead> run_heads_;
+  /// Heap of the open runs that still have records, by their next record
+  std::vector<uint32_t> merge_heap_;
+  /// The last record taken from the open runs
+  RunHead current_;
+};
+
+}  // namespace pipelines::log_message_organizer
+#endif  // COMPONENTS_LOG_MESSAGE_ORGANIZER_PUBLIC_LOG_MESSAGE_ORGANIZER_EXTERNAL_SORT_H_
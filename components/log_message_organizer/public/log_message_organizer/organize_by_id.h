@@ -11,6 +11,14 @@
 /******************************************************************************
  * INCLUDES
  *****************************************************************************/
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include "log_message_organizer/pipeline_log_message.h"
 
 /******************************************************************************
@@ -18,6 +26,26 @@
  *****************************************************************************/
 
 namespace pipelines::log_message_organizer {
+
+/// Most messages the organizers by ID take at once, their positions are 32
+/// bits and the two highest ones are markers
+constexpr size_t kMaxMessagesById = std::numeric_limits<uint32_t>::max() - 1;
+
+/**
+ * @class OrganizeByIdError
+ * @brief Exception thrown when there are more than kMaxMessagesById messages
+ * to organize.
+ */
+class OrganizeByIdError : public std::runtime_error {
+ public:
+  /**
+   * @brief Constructor
+   * @param message Error message
+   */
+  explicit OrganizeByIdError(const std::string& message)
+      : std::runtime_error(message) {}
+};
+
 /**
  * @class OrganizeById
  * @brief This class is responsible for organizing log messages based on their identifiers.
@@ -30,21 +58,186 @@ class OrganizeById {
 
   /**
      * @brief Constructor to initialize the OrganizeById class with log messages.
-     * @param log_messages The collection of log messages to be organized.
+     * @param log_messages The collection of log messages to be organized,
+     * moved into the organizer.
+     * @param thread_count The number of threads a big collection can be
+     * organized with, the result is the same for any number.
      */
-  OrganizeById(const PipelineLogMessages& log_messages)
-      : log_messages_(log_messages) {}
+  OrganizeById(PipelineLogMessages log_messages, size_t thread_count = 1)
+      : log_messages_(std::move(log_messages)), thread_count_(thread_count) {}
 
   /**
      * @brief Organizes the log messages by their IDs.
+     * @return A collection of organized log messages, copies of the ones of
+     * the organizer.
+     * @throw OrganizeByIdError If there are more than kMaxMessagesById
+     * messages.
+     */
+  PipelineLogMessages Organize() const&;
+
+  /**
+     * @brief Organizes the log messages by their IDs, moving them out of an
+     * expiring organizer, e.g. OrganizeById(std::move(messages)).Organize().
      * @return A collection of organized log messages.
+     * @throw OrganizeByIdError If there are more than kMaxMessagesById
+     * messages.
      */
-  PipelineLogMessages Organize() const;
+  PipelineLogMessages Organize() &&;
 
  private:
   // Collection of log messages to be organized.
   PipelineLogMessages log_messages_;
+  // Number of threads a big collection can be organized with.
+  size_t thread_count_;
+};
+
+
+/**
+ * @class MessageIds
+ * @brief The ID and the next ID of a log message, without its body.
+ */
+class MessageIds {
+ public:
+  /**
+     * @brief Constructor of the IDs of a message.
+     * @param id The ID of the message.
+     * @param next_id The ID of the next message.
+     */
+  MessageIds(Symbol id, Symbol next_id) : id_(id), next_id_(next_id) {}
+
+  /**
+     * @brief Retrieves the ID of the message.
+     * @return The interned ID.
+     */
+  Symbol id_symbol() const { return id_; }
+
+  /**
+     * @brief Retrieves the ID of the next message.
+     * @return The interned next ID.
+     */
+  Symbol next_id_symbol() const { return next_id_; }
+
+ private:
+  Symbol id_;      /**< The ID of the message. */
+  Symbol next_id_; /**< The ID of the next message. */
+};
+
+/**
+ * @class OrderById
+ * @brief Finds the order OrganizeById would give to some messages, only from
+ * their IDs.
+ *
+ * It's meant for messages whose bodies are elsewhere, e.g. spilled to disk,
+ * so only the IDs have to be in memory.
+ */
+class OrderById {
+ public:
+  OrderById() = delete; /**< Default constructor is deleted. */
+
+  /**
+     * @brief Constructor to initialize the OrderById class with the IDs of
+     * the messages.
+     * @param message_ids The IDs of the messages, in their original order.
+     * @param thread_count The number of threads a big collection can be
+     * ordered with, see OrganizeById.
+     */
+  explicit OrderById(std::vector<MessageIds> message_ids,
+                     size_t thread_count = 1)
+      : message_ids_(std::move(message_ids)), thread_count_(thread_count) {}
+
+  /**
+     * @brief Finds the organized order of the messages.
+     * @return The positions of the messages in the original order, in the
+     * order of OrganizeById.
+     * @throw OrganizeByIdError If there are more than kMaxMessagesById
+     * messages.
+     */
+  std::vector<uint32_t> Order() const;
+
+  /**
+     * @brief Finds the organized order of the messages, and the walk that
+     * reached every message.
+     *
+     * The organizer walks the IDs that follow every message not yet reached,
+     * in the original order. The messages reached by different walks are in
+     * separate parts of every section of the organized list (termination,
+     * invalid and chain messages), in the reverse order of the walks for the
+     * first two sections and in their order for the last one, so the order
+     * of messages organized separately can be merged, see ExternalOrganizer.
+     * @param walk_starts Replaced by the position of the message that started
+     * the walk that reached every message, by message.
+     * @return The positions of the messages in the original order, in the
+     * order of OrganizeById.
+     * @throw OrganizeByIdError If there are more than kMaxMessagesById
+     * messages.
+     */
+  std::vector<uint32_t> Order(std::vector<uint32_t>& walk_starts) const;
+
+ private:
+  // IDs of the messages to be ordered.
+  std::vector<MessageIds> message_ids_;
+  // Number of threads a big collection can be ordered with.
+  size_t thread_count_;
 };
 
+/**
+ * @class IncrementalOrganizeById
+ * @brief Organizes log messages by their identifiers as they arrive.
+ *
+ * The messages are inserted one at a time, and a snapshot gives the same
+ * organized list as an OrganizeById with the messages inserted so far, in the
+ * order they were inserted.
+ *
+ * Every insertion links the message to the message with its next ID, and the
+ * message waiting for its ID to the message, so the messages form chains
+ * that grow at both ends, and a message that pointed to a missing ID becomes
+ * valid when the ID arrives. An insertion costs amortized constant time, and a
+ * snapshot ranks the chains in linear time without hashing any ID again.
+ * Once the messages don't form simple chains, e.g. two messages have the same
+ * ID, the snapshots organize all the messages from scratch.
+ */
+class IncrementalOrganizeById {
+ public:
+  /**
+     * @brief Inserts a log message.
+     * @param log_message The log message, moved into the organizer.
+     * @throw OrganizeByIdError If there are already kMaxMessagesById
+     * messages.
+     */
+  void Insert(PipelineLogMessage log_message);
+
+  /**
+     * @brief Organizes the log messages inserted so far.
+     * @return A collection of organized log messages, copies of the ones of
+     * the organizer.
+     */
+  PipelineLogMessages Snapshot() const;
+
+  /**
+     * @brief Retrieves the number of log messages inserted so far.
+     * @return The number of log messages.
+     */
+  size_t size() const { return log_messages_.size(); }
+
+ private:
+  /**
+     * @brief Stops linking the messages, once they don't form simple chains.
+     */
+  void StopLinking();
+
+  // Log messages inserted so far, in their order.
+  PipelineLogMessages log_messages_;
+  // Position of the message of every ID.
+  std::unordered_map<Symbol, uint32_t> message_by_id_;
+  // Position of the message waiting for every missing ID, or kSeveralMessages.
+  std::unordered_map<Symbol, uint32_t> waiting_message_by_id_;
+  // Position of the message with the next ID of every message, or kNoMessage.
+  std::vector<uint32_t> next_messages_;
+  // Position of the message pointing to the ID of every message, or
+  // kNoMessage.
+  std::vector<uint32_t> previous_messages_;
+  // Whether the messages still form simple chains.
+  bool simple_chains_{true};
+};
 }  // namespace pipelines::log_message_organizer
 #endif  // COMPONENTS_LOG_MESSAGE_ORGANIZER_PUBLIC_LOG_MESSAGE_ORGANIZER_ORGANIZE_BY_ID_H_
\ No newline at end of file
@@ -0,0 +1,77 @@
+/**
+ * @file organize_pipelines.h
+ * @brief This file defines the OrganizePipelines class, which organizes the
+ * messages of every pipeline by their identifiers, concurrently.
+ * 
+ */
+
+#ifndef COMPONENTS_LOG_MESSAGE_ORGANIZER_PUBLIC_LOG_MESSAGE_ORGANIZER_ORGANIZE_PIPELINES_H_
+#define COMPONENTS_LOG_MESSAGE_ORGANIZER_PUBLIC_LOG_MESSAGE_ORGANIZER_ORGANIZE_PIPELINES_H_
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include <cstddef>
+#include <utility>
+#include "log_message_organizer/pipeline_log_message.h"
+
+/******************************************************************************
+ * CLASSES 
+ *****************************************************************************/
+
+namespace pipelines::log_message_organizer {
+
+/**
+ * @class OrganizePipelines
+ * @brief This class organizes the log messages of every pipeline by their
+ * identifiers, see OrganizeById.
+ *
+ * The pipelines are independent, so they are organized concurrently by a
+ * work-stealing pool. The biggest pipelines are scheduled first, each on its
+ * own, and the small ones are grouped in tasks of a similar size. Every
+ * thread starts with its share of the tasks, and takes the tasks of the
+ * others when it runs out, so a few huge pipelines don't leave the other
+ * threads idle. The result is the same for any number of threads.
+ */
+class OrganizePipelines {
+ public:
+  OrganizePipelines() = delete; /**< Default constructor is deleted. */
+
+  /**
+    * @brief Constructor to initialize the OrganizePipelines class with the
+    * log messages of the pipelines.
+    * @param messages_by_pipeline The log messages of every pipeline, moved
+    * into the organizer.
+    * @param thread_count The number of threads used to organize, fewer are
+    * used when there is little to organize.
+    */
+  explicit OrganizePipelines(PipelineLogMessagesByPipeline messages_by_pipeline,
+                             size_t thread_count = 1)
+      : messages_by_pipeline_(std::move(messages_by_pipeline)),
+        thread_count_(thread_count) {}
+
+  /**
+    * @brief Organizes the log messages of every pipeline by their IDs.
+    * @return The organized log messages of every pipeline, copies of the
+    * ones of the organizer.
+    */
+  PipelineLogMessagesByPipeline Organize() const&;
+
+  /**
+    * @brief Organizes the log messages of every pipeline by their IDs,
+    * moving them out of an expiring organizer.
+    * @return The organized log messages of every pipeline.
+    */
+  PipelineLogMessagesByPipeline Organize() &&;
+
+ private:
+  /// The log messages of every pipeline
+  PipelineLogMessagesByPipeline messages_by_pipeline_;
+  /// The number of threads used to organize
+  size_t thread_count_;
+};
+
+}  // namespace pipelines::log_message_organizer
+
+#endif  // COMPONENTS_LOG_MESSAGE_ORGANIZER_PUBLIC_LOG_MESSAGE_ORGANIZER_ORGANIZE_PIPELINES_H_
@@ -10,8 +10,12 @@
 #include <map>
 #include <ostream>
 #include <string>
+#include <tuple>
+#include <utility>
 #include <vector>
+#include "log_message/body.h"
 #include "log_message/message.h"
+#include "log_message/symbol.h"
 
 /******************************************************************************
  * TYPE DEFINITIONS
@@ -27,6 +31,14 @@ using LogMessage = pipelines::log_message::Message;
  * @brief Type alias for a collection of log messages with their pipeline IDs.
  */
 using LogMessages = std::vector<LogMessage>;
+/**
+ * @brief Type alias for an interned identifier of a log message.
+ */
+using Symbol = pipelines::log_message::Symbol;
+/**
+ * @brief Type alias for the body of a log message.
+ */
+using Body = pipelines::log_message::Body;
 /** 
  * @brief Type alias for a collection of log messages that belong to a pipeline.
  */
@@ -52,41 +64,73 @@ namespace pipelines::log_message_organizer {
  * @class PipelineLogMessage
  * @brief This class represents a log message that belongs to a singular pipeline.
  * 
- * It contains the message ID, body and the next ID of the message.
+ * It contains the message ID, body and the next ID of the message. The IDs are
+ * interned Symbols, so they are cheap to compare and to use as keys.
  */
 class PipelineLogMessage {
  public:
   constexpr PipelineLogMessage() = default; /**< Default constructor. */
 
+#if defined(PIPELINES_TESTING)
+  /**
+       * @brief Constructor to initialize a PipelineLogMessage with the given
+       * parameters, only for the tests: the IDs are interned in the global
+       * table, which is never released.
+       * @param id The ID of the log message.
+       * @param body The body of the log message, moved into the message.
+       * @param next_id The ID of the next log message.
+       */
+  PipelineLogMessage(const std::string& id, std::string body,
+                     const std::string& next_id)
+      : id_(id), body_(std::move(body)), next_id_(next_id) {}
+#endif
+
   /**
-       * @brief Constructor to initialize a PipelineLogMessage with the given parameters.
+       * @brief Constructor to initialize a PipelineLogMessage with interned IDs.
        * @param id The ID of the log message.
        * @param body The body of the log message.
        * @param next_id The ID of the next log message.
        */
-  constexpr PipelineLogMessage(const std::string& id, const std::string& body,
-                               const std::string& next_id)
-      : id_(id), body_(body), next_id_(next_id) {}
+  PipelineLogMessage(Symbol id, Body body, Symbol next_id)
+      : id_(id), body_(std::move(body)), next_id_(next_id) {}
 
   /**
    * @brief Getter for the ID of the log message.
    * 
    * @return The ID of the log message.
    */
-  const std::string& id() const { return id_; }
+  const std::string& id() const { return id_.name(); }
   /**
    * @brief Getter for the body of the log message.
    * 
    * @return The body of the log message.
-   * @note The body is expected to be a decoded string.
+   * @note The body is decoded, or decodes itself when used.
    */
-  const std::string& body() const { return body_; }
+  const Body& body() const& { return body_; }
+  /**
+   * @brief Moves the body out of an expiring log message.
+   * 
+   * @return The body of the log message.
+   */
+  Body body() && { return std::move(body_); }
   /**
    * @brief Getter for the ID of the next log message.
    * 
    * @return The ID of the next log message.
    */
-  const std::string& next_id() const { return next_id_; }
+  const std::string& next_id() const { return next_id_.name(); }
+  /**
+   * @brief Getter for the interned ID of the log message.
+   * 
+   * @return The ID symbol of the log message.
+   */
+  Symbol id_symbol() const { return id_; }
+  /**
+   * @brief Getter for the interned ID of the next log message.
+   * 
+   * @return The ID symbol of the next log message.
+   */
+  Symbol next_id_symbol() const { return next_id_; }
 
   /**
    * @brief Equality operator to compare two Message objects.
@@ -126,9 +170,9 @@ class PipelineLogMessage {
   }
 
  private:
-  std::string id_;      /**< The ID of the log message. */
-  std::string body_;    /**< The body of the log message. */
-  std::string next_id_; /**< The ID of the next log message. */
+  Symbol id_;         /**< The ID of the log message. */
+  Body body_;         /**< The body of the log message. */
+  Symbol next_id_;    /**< The ID of the next log message. */
 };
 
 }  // namespace pipelines::log_message_organizer
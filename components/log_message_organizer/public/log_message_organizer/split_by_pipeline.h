@@ -1,7 +1,8 @@
 /**
  * @file split_by_pipeline.h
  * @brief This file defines the SplitByPipeline class, which is responsible for
- * splitting log messages by their pipeline identifiers.
+ * splitting log messages by their pipeline identifiers, and the
+ * IncrementalSplitByPipeline class, which does the same as the messages arrive.
  * 
  */
 
@@ -12,6 +13,12 @@
  * INCLUDES
  *****************************************************************************/
 
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include "log_message_organizer/pipeline_log_message.h"
 
 /******************************************************************************
@@ -20,12 +27,114 @@
 
 namespace pipelines::log_message_organizer {
 
+/**
+ * @class PipelineBuckets
+ * @brief Numbers the pipelines in the order they are found.
+ *
+ * The pipelines are found through the dense index of the symbol of their ID,
+ * so finding one doesn't hash or compare any string. The indexes of different
+ * tables overlap, so they are only used for the table of the first pipeline,
+ * the symbols of the other tables are found by their names.
+ */
+class PipelineBuckets {
+ public:
+  /**
+    * @brief Finds the bucket of a pipeline, adding it if it's new.
+    * @param pipeline_id The interned pipeline ID, of any table.
+    * @return The position of the bucket, the buckets are numbered from 0.
+    */
+  uint32_t FindOrAdd(Symbol pipeline_id);
+
+  /**
+    * @brief Gets the pipeline IDs found so far.
+    * @return The pipeline IDs, in the order of their buckets.
+    */
+  const std::vector<Symbol>& pipeline_ids() const { return pipeline_ids_; }
+
+  /**
+    * @brief Forgets all the pipelines.
+    */
+  void Clear();
+
+ private:
+  /**
+    * @brief Adds the bucket of a new pipeline.
+    * @param pipeline_id The interned pipeline ID.
+    * @return The position of the bucket.
+    */
+  uint32_t Add(Symbol pipeline_id);
+
+  /// The table whose indexes are used, of the first pipeline ID
+  const log_message::SymbolTable* table_ = nullptr;
+  /// The position of the bucket of every pipeline ID of table_, by the index
+  /// of its symbol, kNoBucket for the symbols that are not pipeline IDs
+  std::vector<uint32_t> bucket_by_index_;
+  /// The position of the bucket of every pipeline ID by its name, only filled
+  /// once a symbol of another table is found
+  std::unordered_map<std::string_view, uint32_t> bucket_by_name_;
+  /// The pipeline IDs, in the order of their buckets
+  std::vector<Symbol> pipeline_ids_;
+};
+
+/**
+ * @class IncrementalSplitByPipeline
+ * @brief Splits log messages by their pipeline identifiers as they arrive.
+ *
+ * The messages can be added in several calls, e.g. as soon as they are parsed,
+ * so they don't have to be collected first. Each pipeline keeps its messages
+ * in the order they were added.
+ *
+ * Every pipeline has a bucket, found with PipelineBuckets, so adding a
+ * message doesn't hash or compare any string. The pipelines are only sorted
+ * by their names once, by Finish().
+ */
+class IncrementalSplitByPipeline {
+ public:
+  /**
+    * @brief Adds log messages to the pipelines.
+    * @param log_messages The log messages to add, copied.
+    */
+  void Add(const LogMessages& log_messages);
+
+  /**
+    * @brief Adds log messages to the pipelines, moving their bodies.
+    * @param log_messages The log messages to add.
+    */
+  void Add(LogMessages&& log_messages);
+
+  /**
+    * @brief Retrieves the messages added so far, the splitter is left empty.
+    * @return A map of pipeline IDs to their corresponding log messages.
+    */
+  PipelineLogMessagesByPipeline Finish();
+
+ private:
+  /**
+    * @brief Finds the bucket of a pipeline, adding it if it's new.
+    * @param pipeline_id The interned pipeline ID.
+    * @return The bucket of the pipeline.
+    */
+  PipelineLogMessages& Bucket(Symbol pipeline_id);
+
+  /// The pipelines found so far
+  PipelineBuckets pipelines_;
+  /// The messages added so far, by pipeline
+  std::vector<PipelineLogMessages> buckets_;
+};
+
 /**
  * @class SplitByPipeline
  * @brief This class is responsible for splitting log messages by their pipeline identifiers.
  * 
  * It provides a method to split a collection of log messages into separate collections
  * based on their pipeline IDs.
+ *
+ * The messages are partitioned in two passes over contiguous parts of the
+ * collection: the messages of each pipeline are counted in every part, and
+ * then moved to their final positions in the pipelines, which are allocated
+ * once with their exact sizes. With more than one thread the parts are
+ * processed concurrently, the result is the same for any number of threads.
+ * The pipelines are only sorted by their names at the end.
  */
 class SplitByPipeline {
  public:
@@ -33,19 +142,31 @@ class SplitByPipeline {
 
   /**
     * @brief Constructor to initialize the SplitByPipeline class with log messages.
-    * @param log_messages The collection of log messages to be split.
+    * @param log_messages The collection of log messages to be split, moved
+    * into the splitter.
+    * @param thread_count The number of threads used to split, fewer are used
+    * for small collections.
     */
-  explicit SplitByPipeline(const LogMessages& log_messages)
-      : log_messages_(log_messages) {}
+  explicit SplitByPipeline(LogMessages log_messages, size_t thread_count = 1)
+      : log_messages_(std::move(log_messages)), thread_count_(thread_count) {}
 
   /**
     * @brief Splits the log messages by their pipeline IDs.
+    * @return A map of pipeline IDs to their corresponding log messages,
+    * copies of the ones of the splitter.
+    */
+  PipelineLogMessagesByPipeline Split() const&;
+
+  /**
+    * @brief Splits the log messages by their pipeline IDs, moving them out of
+    * an expiring splitter, e.g. SplitByPipeline(std::move(messages)).Split().
     * @return A map of pipeline IDs to their corresponding log messages.
     */
-  PipelineLogMessagesByPipeline Split() const;
+  PipelineLogMessagesByPipeline Split() &&;
 
  private:
   LogMessages log_messages_; /**< Collection of log messages to be split. */
+  size_t thread_count_;      /**< The number of threads used to split. */
 };
 
 }  // namespace pipelines::log_message_organizer
@@ -0,0 +1,193 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+#include <utility>
+#include "log_message_organizer/organize_by_id.h"
+#include "log_message_organizer/split_by_pipeline.h"
+#include "log_message_parser/ascii_body_parser.h"
+#include "log_message_parser/hex16_body_parser.h"
+#include "log_message_parser/semantics.h"
+#include "log_message_parser/static_parser.h"
+#include "log_message_parser/structure.h"
+
+using ::testing::Eq;
+using ::testing::Le;
+
+namespace pipelines::log_message_organizer::test {
+
+/// Size of the decoded bodies, no other allocation of the data path has the
+/// size of their strings
+constexpr size_t kBodySize = 1000;
+
+/// Number of messages of each encoding
+constexpr size_t kMessagesPerEncoding = 8;
+
+/// Set while the allocations of the bodies are counted
+static std::atomic<bool> counting{false};
+
+/// Number of allocations with the size of a decoded body
+static std::atomic<size_t> body_allocation_count{0};
+
+}  // namespace pipelines::log_message_organizer::test
+
+// The replaced operator new returns memory from malloc, so operator delete
+// must release it with free. GCC inlines the pair in optimized builds and
+// reports the free as mismatched with new even though both are replaced.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size) {
+  using namespace pipelines::log_message_organizer::test;
+  // A string of kBodySize characters allocates one more for the terminator
+  if (counting.load(std::memory_order_relaxed) && size == kBodySize + 1) {
+    body_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (auto* pointer = std::malloc(size == 0 ? 1 : size)) {
+    return pointer;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace pipelines::log_message_organizer::test {
+
+/// The parser of the encodings used by the application
+using ApplicationParser = log_message_parser::semantics::StaticParser<
+    log_message_parser::semantics::Encoding<
+        "0", log_message_parser::semantics::AsciiBodyParser>,
+    log_message_parser::semantics::Encoding<
+        "1", log_message_parser::semantics::Hex16BodyParser>>;
+
+/**
+ * Structure messages of two pipelines, in reverse order, with ascii and
+ * hexadecimal bodies that all decode to kBodySize characters.
+ */
+inline log_message_parser::structure::LogMessages CreateInput() {
+  auto input = log_message_parser::structure::LogMessages{};
+  const auto message_count = 2 * kMessagesPerEncoding;
+  for (size_t i = message_count; i > 0; --i) {
+    const auto pipeline = std::to_string(i % 2);
+    const auto id = std::to_string(i);
+    const auto next_id = i + 2 > message_count ? "-1" : std::to_string(i + 2);
+    if (i <= kMessagesPerEncoding) {
+      input.emplace_back(pipeline, id, "0", std::string(kBodySize, 'a'),
+                         next_id);
+    } else {
+      input.emplace_back(pipeline, id, "1", std::string(2 * kBodySize, '6'),
+                         next_id);
+    }
+  }
+  return input;
+}
+
+/**
+ * Parses, splits, organizes and prints the bodies of the messages, copying
+ * them from one step to the next.
+ * @return The printed bodies.
+ */
+inline std::string PrintCopies(
+    const log_message_parser::structure::LogMessages& input) {
+  auto output = std::ostringstream{};
+  const auto semantic_parse_result = ApplicationParser{}.Parse(input);
+  const auto splitter = SplitByPipeline{semantic_parse_result.messages()};
+  for (const auto& [pipeline_id, messages] : splitter.Split()) {
+    const auto organizer = OrganizeById{messages};
+    for (const auto& message : organizer.Organize()) {
+      output << message.body();
+    }
+  }
+  return output.str();
+}
+
+/**
+ * Parses, splits, organizes and prints the messages like the application,
+ * moving them from one step to the next, and counts the allocations of the
+ * bodies.
+ * @return The number of allocations with the size of a body.
+ */
+inline size_t CountBodyAllocations(
+    const log_message_parser::structure::LogMessages& input,
+    log_message_parser::semantics::BodyDecoding body_decoding,
+    std::ostream& output) {
+  body_allocation_count = 0;
+  counting = true;
+
+  auto semantic_parse_result = ApplicationParser{body_decoding}.Parse(input);
+  auto messages_by_pipeline =
+      SplitByPipeline(std::move(semantic_parse_result).messages()).Split();
+  for (auto& [pipeline_id, messages] : messages_by_pipeline) {
+    messages = OrganizeById(std::move(messages)).Organize();
+  }
+  for (const auto& [pipeline_id, messages] : messages_by_pipeline) {
+    for (const auto& message : messages) {
+      output << message.body();
+    }
+  }
+
+  counting = false;
+  return body_allocation_count;
+}
+
+}  // namespace pipelines::log_message_organizer::test
+
+class BodyAllocationsTest : public ::testing::Test {};
+
+TEST_F(BodyAllocationsTest, EachBodyIsAllocatedOnceBetweenParseAndPrint) {
+  using pipelines::log_message_organizer::test::CountBodyAllocations;
+  using pipelines::log_message_organizer::test::CreateInput;
+  using pipelines::log_message_organizer::test::PrintCopies;
+  using pipelines::log_message_organizer::test::kBodySize;
+  using pipelines::log_message_organizer::test::kMessagesPerEncoding;
+  using pipelines::log_message_parser::semantics::BodyDecoding;
+
+  auto input = CreateInput();
+  auto output = std::ostringstream{};
+  output.str(std::string(4 * kMessagesPerEncoding * kBodySize, ' '));
+  output.seekp(0);
+
+  auto body_allocations =
+      CountBodyAllocations(input, BodyDecoding::kEager, output);
+
+  ASSERT_THAT(body_allocations, Le(input.size()));
+  ASSERT_THAT(output.str().substr(0, 2 * kMessagesPerEncoding * kBodySize),
+              Eq(PrintCopies(input)));
+}
+
+TEST_F(BodyAllocationsTest, LazyBodiesAreOnlyDecodedIntoThePrintBuffer) {
+  using pipelines::log_message_organizer::test::CountBodyAllocations;
+  using pipelines::log_message_organizer::test::CreateInput;
+  using pipelines::log_message_organizer::test::PrintCopies;
+  using pipelines::log_message_organizer::test::kBodySize;
+  using pipelines::log_message_organizer::test::kMessagesPerEncoding;
+  using pipelines::log_message_parser::semantics::BodyDecoding;
+
+  auto input = CreateInput();
+  auto output = std::ostringstream{};
+  output.str(std::string(4 * kMessagesPerEncoding * kBodySize, ' '));
+  output.seekp(0);
+
+  auto body_allocations =
+      CountBodyAllocations(input, BodyDecoding::kLazy, output);
+
+  ASSERT_THAT(body_allocations, Le(1));
+  ASSERT_THAT(output.str().substr(0, 2 * kMessagesPerEncoding * kBodySize),
+              Eq(PrintCopies(input)));
+}
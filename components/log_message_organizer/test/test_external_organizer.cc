@@ -0,0 +1,227 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "log_message/message.h"
+#include "log_message_organizer/external_organizer.h"
+#include "log_message_organizer/organize_by_id.h"
+#include "log_message_organizer/split_by_pipeline.h"
+
+using ::testing::Eq;
+using ::testing::IsTrue;
+
+namespace pipelines::log_message_organizer::test {
+
+/**
+ * Messages of several pipelines, interleaved, with chains in both directions,
+ * messages with the same ID, cycles and invalid next IDs.
+ */
+inline LogMessages CreateMixedMessages(size_t message_count) {
+  auto messages = LogMessages{};
+  for (size_t i = 0; i < message_count; ++i) {
+    const auto pipeline = "pipeline" + std::to_string(i % 7);
+    const auto id = std::to_string(i % 5 == 0 ? i / 2 : i);
+    auto next_id = std::to_string(i % 3 == 0 ? i + 7 : i - 7);
+    if (i % 11 == 0) {
+      next_id = "-1";
+    } else if (i % 13 == 0) {
+      next_id = "missing";
+    }
+    messages.emplace_back(pipeline, id, "body " + std::to_string(i), next_id);
+  }
+  return messages;
+}
+
+/**
+ * Messages of several pipelines, shuffled, that form simple chains: chains
+ * that end with the terminator, chains that end with a missing ID, some of
+ * them the same one, and single messages.
+ */
+inline LogMessages CreateChainMessages(size_t chain_count) {
+  auto messages = LogMessages{};
+  for (size_t chain = 0; chain < chain_count; ++chain) {
+    const auto pipeline = "pipeline" + std::to_string(chain % 3);
+    const auto length = chain % 4 == 0 ? 1 : 1 + chain % 50;
+    for (size_t i = 0; i < length; ++i) {
+      const auto id = std::to_string(chain) + "_" + std::to_string(i);
+      auto next_id = std::to_string(chain) + "_" + std::to_string(i + 1);
+      if (i + 1 == length) {
+        next_id = chain % 5 == 0 ? "missing" + std::to_string(chain % 2)
+                                 : "-1";
+      }
+      messages.emplace_back(pipeline, id, "body " + id, next_id);
+    }
+  }
+  std::shuffle(messages.begin(), messages.end(), std::mt19937{42});
+  return messages;
+}
+
+/**
+ * Messages of several pipelines, shuffled, that form simple chains of up to
+ * max_length messages, with a few chains tangled in every way: a repeated
+ * ID, a message pointing to its own ID, two messages pointing to the same
+ * one, and a cycle.
+ */
+inline LogMessages CreateTangledMessages(size_t chain_count,
+                                         size_t max_length = 20) {
+  auto messages = LogMessages{};
+  for (size_t chain = 0; chain < chain_count; ++chain) {
+    const auto pipeline = "pipeline" + std::to_string(chain % 3);
+    const auto length = 1 + chain % max_length;
+    const auto name = [chain](size_t i) {
+      return std::to_string(chain) + "_" + std::to_string(i);
+    };
+    for (size_t i = 0; i < length; ++i) {
+      auto next_id = i + 1 == length ? std::string{"-1"} : name(i + 1);
+      if (i + 1 == length && chain % 40 == 7) {
+        next_id = name(i);
+      } else if (i + 1 == length && chain % 40 == 9) {
+        next_id = name(0);
+      }
+      messages.emplace_back(pipeline, name(i), "body " + name(i), next_id);
+    }
+    if (chain % 40 == 3) {
+      messages.emplace_back(pipeline, name(length / 2), "repeated",
+                            name(length - 1));
+    } else if (chain % 40 == 5) {
+      messages.emplace_back(pipeline, name(length), "merge", name(1));
+    }
+  }
+  std::shuffle(messages.begin(), messages.end(), std::mt19937{42});
+  return messages;
+}
+
+/**
+ * A directory of its own for the spill files of a test, removed at the end.
+ */
+class SpillDirectory {
+ public:
+  SpillDirectory()
+      : path_(std::filesystem::temp_directory_path() /
+              ("test_external_organizer_" +
+               std::to_string(
+                   ::testing::UnitTest::GetInstance()->random_seed()))) {
+    std::filesystem::create_directories(path_);
+  }
+  ~SpillDirectory() { std::filesystem::remove_all(path_); }
+
+  const std::filesystem::path& path() const { return path_; }
+
+ private:
+  std::filesystem::path path_;
+};
+
+}  // namespace pipelines::log_message_organizer::test
+
+class ExternalOrganizerTest : public ::testing::Test {
+ protected:
+  /**
+   * Organizes messages with an ExternalOrganizer and checks the result is
+   * the same as with SplitByPipeline and OrganizeById, and that the spill
+   * files are removed.
+   */
+  static void ExpectSameResultAsInMemory(
+      const pipelines::log_message_organizer::LogMessages& input,
+      size_t memory_budget,
+      std::vector<std::string>* over_budget_pipelines = nullptr) {
+    using pipelines::log_message_organizer::ExternalOrganizer;
+    using pipelines::log_message_organizer::OrganizeById;
+    using pipelines::log_message_organizer::PipelineLogMessagesByPipeline;
+    using pipelines::log_message_organizer::SplitByPipeline;
+    using pipelines::log_message_organizer::test::SpillDirectory;
+
+    auto expected_output = SplitByPipeline{input}.Split();
+    for (auto& [pipeline_id, messages] : expected_output) {
+      messages = OrganizeById(std::move(messages)).Organize();
+    }
+
+    auto spill_directory = SpillDirectory{};
+    auto output = PipelineLogMessagesByPipeline{};
+    {
+      auto organizer = ExternalOrganizer{spill_directory.path(), memory_budget};
+      organizer.Add(input);
+      ASSERT_THAT(organizer.size(), Eq(input.size()));
+      organizer.Organize([&output](std::string_view pipeline_id,
+                                   std::string_view id,
+                                   std::string_view body) {
+        output[std::string{pipeline_id}].emplace_back(
+            std::string{id}, std::string{body}, "");
+      });
+      if (over_budget_pipelines != nullptr) {
+        *over_budget_pipelines = organizer.over_budget_pipelines();
+      }
+    }
+
+    ASSERT_THAT(output.size(), Eq(expected_output.size()));
+    for (const auto& [pipeline_id, messages] : expected_output) {
+      const auto& output_messages = output[pipeline_id];
+      ASSERT_THAT(output_messages.size(), Eq(messages.size()));
+      for (size_t i = 0; i < messages.size(); ++i) {
+        ASSERT_THAT(output_messages[i].id(), Eq(messages[i].id()));
+        ASSERT_THAT(output_messages[i].body(), Eq(messages[i].body()));
+      }
+    }
+    ASSERT_THAT(std::filesystem::is_empty(spill_directory.path()), IsTrue());
+  }
+};
+
+TEST_F(ExternalOrganizerTest, SameResultAsInMemory) {
+  using pipelines::log_message_organizer::test::CreateMixedMessages;
+
+  // The pipelines don't form simple chains, but they fit in the budget so
+  // they are ordered in memory
+  const auto input = CreateMixedMessages(5000);
+  for (size_t memory_budget : {4000000, 400000}) {
+    ExpectSameResultAsInMemory(input, memory_budget);
+  }
+}
+
+TEST_F(ExternalOrganizerTest, TangledChainsWalkedByTheirEnds) {
+  using pipelines::log_message_organizer::test::CreateTangledMessages;
+
+  // The pipelines are ranked on disk, the cycles broken and ranked again,
+  // and only the ends of the tangled chains are walked in memory
+  const auto input = CreateTangledMessages(400);
+  for (size_t memory_budget : {4000000, 40000}) {
+    ExpectSameResultAsInMemory(input, memory_budget);
+  }
+}
+
+TEST_F(ExternalOrganizerTest, TangledChainsBiggerThanTheBudget) {
+  using pipelines::log_message_organizer::test::CreateTangledMessages;
+
+  // The messages of the tangled chains take several times the budget, but
+  // their ends fit in it
+  const auto input = CreateTangledMessages(200, 500);
+  auto over_budget_pipelines = std::vector<std::string>{};
+  ExpectSameResultAsInMemory(input, 40000, &over_budget_pipelines);
+  EXPECT_THAT(over_budget_pipelines.empty(), IsTrue());
+}
+
+TEST_F(ExternalOrganizerTest, TangledMessagesBiggerThanTheBudget) {
+  using pipelines::log_message_organizer::test::CreateMixedMessages;
+
+  // Almost every message is tangled, so even the ends of their chains don't
+  // fit in the budget, they are walked anyway and the pipelines reported
+  const auto input = CreateMixedMessages(5000);
+  auto over_budget_pipelines = std::vector<std::string>{};
+  ExpectSameResultAsInMemory(input, 4000, &over_budget_pipelines);
+  EXPECT_THAT(over_budget_pipelines.size(), Eq(7));
+}
+
+TEST_F(ExternalOrganizerTest, SimpleChainsRankedOnDisk) {
+  using pipelines::log_message_organizer::test::CreateChainMessages;
+
+  // The pipelines that don't fit in the budget are ranked on disk, with
+  // runs spilled by every sort
+  const auto input = CreateChainMessages(300);
+  for (size_t memory_budget : {4000000, 40000, 400}) {
+    ExpectSameResultAsInMemory(input, memory_budget);
+  }
+}
@@ -0,0 +1,103 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "log_message_organizer/external_sort.h"
+
+using ::testing::ElementsAreArray;
+using ::testing::Eq;
+using ::testing::IsFalse;
+using ::testing::IsTrue;
+
+class ExternalSortTest : public ::testing::Test {
+ protected:
+  /**
+   * Creates an empty directory for the run files of a test.
+   */
+  void SetUp() override {
+    directory_ = std::filesystem::temp_directory_path() /
+                 ("external_sort_test_" +
+                  std::string{::testing::UnitTest::GetInstance()
+                                  ->current_test_info()
+                                  ->name()});
+    std::filesystem::remove_all(directory_);
+    std::filesystem::create_directory(directory_);
+  }
+
+  void TearDown() override { std::filesystem::remove_all(directory_); }
+
+  /**
+   * Records with repeated keys, the values count the records added.
+   */
+  static std::vector<std::pair<std::string, std::string>> CreateRecords() {
+    auto records = std::vector<std::pair<std::string, std::string>>{};
+    for (uint64_t i = 0; i < 5000; ++i) {
+      auto key = std::string{};
+      pipelines::log_message_organizer::ExternalSort::AppendKey(
+          key, (i * 7919) % 613);
+      records.emplace_back(key, "value " + std::to_string(i));
+    }
+    return records;
+  }
+
+  std::filesystem::path directory_; /**< The directory of the test. */
+};
+
+TEST_F(ExternalSortTest, SortedAndStable) {
+  using pipelines::log_message_organizer::ExternalSort;
+
+  const auto records = CreateRecords();
+  auto expected = records;
+  std::stable_sort(
+      expected.begin(), expected.end(),
+      [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+  // In memory, a few runs, and more runs than are merged at once
+  for (size_t memory_budget : {1000000, 40000, 400}) {
+    auto sorted = std::vector<std::pair<std::string, std::string>>{};
+    {
+      auto sort = ExternalSort{directory_, memory_budget};
+      for (const auto& [key, value] : records) {
+        sort.Add(key, value);
+      }
+      ASSERT_THAT(sort.size(), Eq(records.size()));
+      sort.Sort();
+      auto key = std::string_view{};
+      auto value = std::string_view{};
+      while (sort.Next(key, value)) {
+        sorted.emplace_back(key, value);
+      }
+    }
+    ASSERT_THAT(sorted, ElementsAreArray(expected));
+    ASSERT_THAT(std::filesystem::is_empty(directory_), IsTrue());
+  }
+}
+
+TEST_F(ExternalSortTest, Empty) {
+  using pipelines::log_message_organizer::ExternalSort;
+
+  auto sort = ExternalSort{directory_, 400};
+  sort.Sort();
+  auto key = std::string_view{};
+  auto value = std::string_view{};
+  ASSERT_THAT(sort.Next(key, value), IsFalse());
+}
+
+TEST_F(ExternalSortTest, KeysAreReadBack) {
+  using pipelines::log_message_organizer::ExternalSort;
+
+  auto key = std::string{};
+  ExternalSort::AppendKey(key, 0x0102030405060708);
+  ExternalSort::AppendKey(key, 42);
+  auto view = std::string_view{key};
+  ASSERT_THAT(ExternalSort::ReadKey(view), Eq(0x0102030405060708));
+  ASSERT_THAT(ExternalSort::ReadKey(view), Eq(42));
+  ASSERT_THAT(view.empty(), IsTrue());
+}
@@ -1,6 +1,12 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <algorithm>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "log_message/symbol.h"
 #include "log_message_organizer/organize_by_id.h"
 
 using ::testing::Contains;
@@ -14,13 +20,13 @@ static bool MessageLessThan(
   return lhs.id() < rhs.id();
 }
 
-static constexpr pipelines::log_message_organizer::PipelineLogMessage
+static pipelines::log_message_organizer::PipelineLogMessage
 CreateMessageIndexNextIndex(const std::string& id, const std::string& next_id) {
   return pipelines::log_message_organizer::PipelineLogMessage{id, "body",
                                                               next_id};
 }
 
-static constexpr pipelines::log_message_organizer::PipelineLogMessage
+static pipelines::log_message_organizer::PipelineLogMessage
 CreateFinalMessage(const std::string& id) {
   return pipelines::log_message_organizer::PipelineLogMessage{id, "body", "-1"};
 }
@@ -1023,3 +1029,226 @@ TEST_F(OrganizeByIdTest, FiveMessagesCyclic) {
   ASSERT_THAT(result, SizeIs(input.size()));
   ASSERT_THAT(result, UnorderedElementsAreArray(input));
 }
+
+TEST_F(OrganizeByIdTest, LongChainDoesNotOverflowTheStack) {
+  using pipelines::log_message_organizer::OrganizeById;
+  using pipelines::log_message_organizer::PipelineLogMessages;
+
+  // Every message is reached from the first one, so the whole chain is walked
+  // at once. A recursive walk takes a frame per message, and 200000 frames of
+  // even 64 bytes are more than the 8 MiB of a default stack, so this is
+  // enough to overflow it; the explicit stack is on the heap, and doesn't
+  // depend on the length
+  constexpr auto kChainLength = 200000;
+  auto input = PipelineLogMessages{};
+  input.reserve(kChainLength);
+  for (auto i = 1; i < kChainLength; ++i) {
+    input.push_back(
+        CreateMessageIndexNextIndex(std::to_string(i), std::to_string(i + 1)));
+  }
+  input.push_back(CreateFinalMessage(std::to_string(kChainLength)));
+
+  auto result = OrganizeById(std::move(input)).Organize();
+
+  ASSERT_THAT(result, SizeIs(kChainLength));
+  for (auto i = 0; i < kChainLength; ++i) {
+    ASSERT_THAT(result[i].id(), Eq(std::to_string(kChainLength - i)));
+  }
+}
+
+/**
+ * Chains of 1 to 100 messages, in a shuffled order, ending in the terminator
+ * or in an ID that no message has.
+ */
+static pipelines::log_message_organizer::PipelineLogMessages
+CreateShuffledChains(size_t message_count) {
+  auto input = pipelines::log_message_organizer::PipelineLogMessages{};
+  auto random = std::mt19937{42};
+  auto chain_lengths = std::uniform_int_distribution<size_t>{1, 100};
+  for (size_t first = 0; first < message_count;) {
+    const auto last = std::min(first + chain_lengths(random), message_count);
+    for (auto message = first; message + 1 < last; ++message) {
+      input.push_back(CreateMessageIndexNextIndex(std::to_string(message),
+                                                  std::to_string(message + 1)));
+    }
+    if (random() % 2 == 0) {
+      input.push_back(CreateFinalMessage(std::to_string(last - 1)));
+    } else {
+      input.push_back(
+          CreateMessageIndexNextIndex(std::to_string(last - 1), "missing"));
+    }
+    first = last;
+  }
+  std::ranges::shuffle(input, random);
+  return input;
+}
+
+TEST_F(OrganizeByIdTest, ThreadsGiveTheSameResult) {
+  using pipelines::log_message_organizer::OrganizeById;
+
+  // The simple chains are ranked concurrently
+  auto input = CreateShuffledChains(70000);
+  auto expected_output = OrganizeById{input}.Organize();
+  for (size_t thread_count : {0, 2, 4, 16}) {
+    ASSERT_THAT(OrganizeById(input, thread_count).Organize(),
+                Eq(expected_output));
+  }
+}
+
+TEST_F(OrganizeByIdTest, ThreadsGiveUpOnTheOtherStructures) {
+  using pipelines::log_message_organizer::OrganizeById;
+
+  // These are organized like with a single thread
+  auto with_duplicate = CreateShuffledChains(70000);
+  with_duplicate.push_back(CreateFinalMessage("123"));
+  auto with_self_loop = CreateShuffledChains(70000);
+  with_self_loop.push_back(CreateMessageIndexNextIndex("self", "self"));
+  auto with_merge = CreateShuffledChains(70000);
+  with_merge.push_back(CreateMessageIndexNextIndex("merge1", "merged"));
+  with_merge.push_back(CreateMessageIndexNextIndex("merge2", "merged"));
+  with_merge.push_back(CreateFinalMessage("merged"));
+  auto with_cycle = CreateShuffledChains(70000);
+  with_cycle.push_back(CreateMessageIndexNextIndex("cycle1", "cycle2"));
+  with_cycle.push_back(CreateMessageIndexNextIndex("cycle2", "cycle1"));
+
+  for (const auto& input :
+       {with_duplicate, with_self_loop, with_merge, with_cycle}) {
+    ASSERT_THAT(OrganizeById(input, 4).Organize(),
+                Eq(OrganizeById{input}.Organize()));
+  }
+}
+
+TEST_F(OrganizeByIdTest, IncrementalSnapshotsAreTheBatchResult) {
+  using pipelines::log_message_organizer::IncrementalOrganizeById;
+  using pipelines::log_message_organizer::OrganizeById;
+  using pipelines::log_message_organizer::PipelineLogMessages;
+
+  // The messages arrive before and after the ones with their next IDs
+  auto input = CreateShuffledChains(2000);
+  auto organizer = IncrementalOrganizeById{};
+  auto inserted = PipelineLogMessages{};
+  for (const auto& message : input) {
+    organizer.Insert(message);
+    inserted.push_back(message);
+    if (inserted.size() % 97 == 0) {
+      ASSERT_THAT(organizer.Snapshot(), Eq(OrganizeById{inserted}.Organize()));
+    }
+  }
+  ASSERT_THAT(organizer.size(), Eq(input.size()));
+  ASSERT_THAT(organizer.Snapshot(), Eq(OrganizeById{inserted}.Organize()));
+}
+
+TEST_F(OrganizeByIdTest, IncrementalSnapshotsOfTheOtherStructures) {
+  using pipelines::log_message_organizer::IncrementalOrganizeById;
+  using pipelines::log_message_organizer::OrganizeById;
+  using pipelines::log_message_organizer::PipelineLogMessages;
+
+  // Two messages waiting for the same ID only merge when it arrives
+  auto waiting_for_same_id = PipelineLogMessages{
+      CreateMessageIndexNextIndex("1", "3"),
+      CreateMessageIndexNextIndex("2", "3"), CreateFinalMessage("3")};
+  auto with_cycle = PipelineLogMessages{
+      CreateMessageIndexNextIndex("1", "2"), CreateFinalMessage("0"),
+      CreateMessageIndexNextIndex("2", "3"),
+      CreateMessageIndexNextIndex("3", "1")};
+  auto with_duplicate = PipelineLogMessages{
+      CreateMessageIndexNextIndex("1", "2"), CreateFinalMessage("2"),
+      CreateMessageIndexNextIndex("1", "-1")};
+  auto with_self_loop = PipelineLogMessages{
+      CreateMessageIndexNextIndex("1", "2"),
+      CreateMessageIndexNextIndex("2", "2"), CreateFinalMessage("-1")};
+
+  for (const auto& input :
+       {waiting_for_same_id, with_cycle, with_duplicate, with_self_loop}) {
+    auto organizer = IncrementalOrganizeById{};
+    auto inserted = PipelineLogMessages{};
+    for (const auto& message : input) {
+      organizer.Insert(message);
+      inserted.push_back(message);
+      ASSERT_THAT(organizer.Snapshot(), Eq(OrganizeById{inserted}.Organize()));
+    }
+  }
+}
+
+TEST_F(OrganizeByIdTest, IdsOfAnOwnedSymbolTable) {
+  using pipelines::log_message::Body;
+  using pipelines::log_message::Symbol;
+  using pipelines::log_message::SymbolTable;
+  using pipelines::log_message_organizer::IncrementalOrganizeById;
+  using pipelines::log_message_organizer::OrganizeById;
+  using pipelines::log_message_organizer::PipelineLogMessage;
+  using pipelines::log_message_organizer::PipelineLogMessages;
+
+  // The terminator is found by its name, not by the global symbol
+  auto table = SymbolTable{};
+  auto intern = [&table](const std::string& id, const std::string& next_id) {
+    return PipelineLogMessage{Symbol{id, table}, Body{std::string{"body"}},
+                              Symbol{next_id, table}};
+  };
+  auto input = PipelineLogMessages{intern("3", "-1"), intern("1", "2"),
+                                   intern("2", "3")};
+  auto ids = [](const PipelineLogMessages& messages) {
+    auto result = std::vector<std::string>{};
+    for (const auto& message : messages) {
+      result.push_back(message.id());
+    }
+    return result;
+  };
+
+  // The same order as the messages with global symbols
+  auto global_input = PipelineLogMessages{
+      CreateFinalMessage("3"), CreateMessageIndexNextIndex("1", "2"),
+      CreateMessageIndexNextIndex("2", "3")};
+  auto expected = ids(OrganizeById{global_input}.Organize());
+  ASSERT_THAT(expected, SizeIs(3));
+  ASSERT_THAT(ids(OrganizeById{input}.Organize()), Eq(expected));
+  auto organizer = IncrementalOrganizeById{};
+  for (const auto& message : input) {
+    organizer.Insert(message);
+  }
+  ASSERT_THAT(ids(organizer.Snapshot()), Eq(expected));
+}
+
+TEST_F(OrganizeByIdTest, IdsOfSeveralSymbolTables) {
+  using pipelines::log_message::Symbol;
+  using pipelines::log_message::SymbolTable;
+  using pipelines::log_message_organizer::IncrementalOrganizeById;
+  using pipelines::log_message_organizer::OrganizeById;
+  using pipelines::log_message_organizer::PipelineLogMessage;
+  using pipelines::log_message_organizer::PipelineLogMessages;
+
+  // The messages are interned alternately in two tables, whose indexes
+  // overlap, e.g. x and y in one table and p and q in the other one
+  auto tables = std::vector<SymbolTable>(2);
+  auto reintern = [&tables](const PipelineLogMessages& messages) {
+    auto result = PipelineLogMessages{};
+    for (const auto& message : messages) {
+      auto& table = tables[result.size() % 2];
+      result.emplace_back(Symbol{message.id(), table}, message.body(),
+                          Symbol{message.next_id(), table});
+    }
+    return result;
+  };
+
+  auto global_input = PipelineLogMessages{
+      CreateMessageIndexNextIndex("x", "y"),
+      CreateMessageIndexNextIndex("p", "q"), CreateFinalMessage("y")};
+  auto input = reintern(global_input);
+  ASSERT_THAT(input[0].id_symbol().index(), Eq(input[1].id_symbol().index()));
+  auto expected_output = OrganizeById{global_input}.Organize();
+  ASSERT_THAT(OrganizeById{input}.Organize(), Eq(expected_output));
+  auto organizer = IncrementalOrganizeById{};
+  for (const auto& message : input) {
+    organizer.Insert(message);
+  }
+  ASSERT_THAT(organizer.Snapshot(), Eq(expected_output));
+
+  // The simple chains ranked concurrently too
+  global_input = CreateShuffledChains(70000);
+  input = reintern(global_input);
+  expected_output = OrganizeById{global_input}.Organize();
+  for (size_t thread_count : {1, 4}) {
+    ASSERT_THAT(OrganizeById(input, thread_count).Organize(),
+                Eq(expected_output));
+  }
+}
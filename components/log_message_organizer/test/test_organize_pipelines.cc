@@ -0,0 +1,76 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <string>
+
+#include "log_message_organizer/organize_by_id.h"
+#include "log_message_organizer/organize_pipelines.h"
+
+using ::testing::Eq;
+
+namespace pipelines::log_message_organizer::test {
+
+/**
+ * Pipelines of very different sizes, like the ones of real logs: a few with
+ * many messages and many with three, with their messages out of order.
+ */
+inline PipelineLogMessagesByPipeline CreateSkewedPipelines() {
+  auto messages_by_pipeline = PipelineLogMessagesByPipeline{};
+  for (size_t pipeline = 0; pipeline < 3000; ++pipeline) {
+    const auto size = size_t{pipeline % 1000 == 0 ? 20000u : 3u};
+    auto& messages =
+        messages_by_pipeline["pipeline" + std::to_string(pipeline)];
+    for (size_t i = size; i > 0; --i) {
+      const auto next_id = i == size ? "-1" : std::to_string(i + 1);
+      messages.emplace_back(std::to_string(i), "body " + std::to_string(i),
+                            next_id);
+    }
+  }
+  return messages_by_pipeline;
+}
+
+}  // namespace pipelines::log_message_organizer::test
+
+class OrganizePipelinesTest : public ::testing::Test {};
+
+TEST_F(OrganizePipelinesTest, EmptyInput) {
+  using pipelines::log_message_organizer::OrganizePipelines;
+  using pipelines::log_message_organizer::PipelineLogMessagesByPipeline;
+
+  for (size_t thread_count : {1, 4}) {
+    ASSERT_THAT(
+        OrganizePipelines(PipelineLogMessagesByPipeline{}, thread_count)
+            .Organize(),
+        Eq(PipelineLogMessagesByPipeline{}));
+  }
+}
+
+TEST_F(OrganizePipelinesTest, OrganizesEveryPipelineById) {
+  using pipelines::log_message_organizer::OrganizeById;
+  using pipelines::log_message_organizer::OrganizePipelines;
+  using pipelines::log_message_organizer::PipelineLogMessagesByPipeline;
+
+  auto input = PipelineLogMessagesByPipeline{
+      {"pipeline1", {{"2", "World!", "-1"}, {"1", "Hello,", "2"}}},
+      {"pipeline2", {{"4", "Universe!", "-1"}, {"3", "Goodbye,", "4"}}},
+  };
+  auto expected_output = PipelineLogMessagesByPipeline{};
+  for (const auto& [pipeline_id, messages] : input) {
+    expected_output[pipeline_id] = OrganizeById{messages}.Organize();
+  }
+
+  ASSERT_THAT(OrganizePipelines{input}.Organize(), Eq(expected_output));
+}
+
+TEST_F(OrganizePipelinesTest, ThreadsGiveTheSameResult) {
+  using pipelines::log_message_organizer::OrganizePipelines;
+  using pipelines::log_message_organizer::test::CreateSkewedPipelines;
+
+  auto input = CreateSkewedPipelines();
+  auto expected_output = OrganizePipelines{input}.Organize();
+
+  for (size_t thread_count : {0, 2, 3, 16}) {
+    ASSERT_THAT(OrganizePipelines(input, thread_count).Organize(),
+                Eq(expected_output));
+  }
+}
@@ -1,7 +1,11 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <cstddef>
+#include <string>
+#include <string_view>
 
 #include "log_message/message.h"
+#include "log_message/symbol.h"
 #include "log_message_organizer/split_by_pipeline.h"
 
 using ::testing::Eq;
@@ -61,3 +65,88 @@ TEST_F(SplitByPipelineTest, MultiplePipelines) {
   auto splitter = SplitByPipeline{input};
   ASSERT_THAT(splitter.Split(), Eq(expected_output));
 }
+
+TEST_F(SplitByPipelineTest, IncrementalKeepsTheOrderOfTheAddedMessages) {
+  using pipelines::log_message_organizer::IncrementalSplitByPipeline;
+  using pipelines::log_message_organizer::LogMessages;
+  using pipelines::log_message_organizer::PipelineLogMessagesByPipeline;
+
+  auto splitter = IncrementalSplitByPipeline{};
+  splitter.Add(LogMessages{
+      {"pipeline1", "1", "Hello, World!", "2"},
+      {"pipeline2", "3", "Hello, Universe!", "4"},
+  });
+  splitter.Add(LogMessages{});
+  splitter.Add(LogMessages{
+      {"pipeline2", "4", "Goodbye, Universe!", "-1"},
+      {"pipeline1", "2", "Goodbye, World!", "-1"},
+  });
+  auto expected_output = PipelineLogMessagesByPipeline{
+      {"pipeline1",
+       {{"1", "Hello, World!", "2"}, {"2", "Goodbye, World!", "-1"}}},
+      {"pipeline2",
+       {{"3", "Hello, Universe!", "4"}, {"4", "Goodbye, Universe!", "-1"}}},
+  };
+
+  ASSERT_THAT(splitter.Finish(), Eq(expected_output));
+  ASSERT_THAT(splitter.Finish(), Eq(PipelineLogMessagesByPipeline{}));
+}
+
+TEST_F(SplitByPipelineTest, ThreadsGiveTheSameResult) {
+  using pipelines::log_message_organizer::LogMessages;
+  using pipelines::log_message_organizer::SplitByPipeline;
+
+  // Enough messages for several threads, spread over many pipelines, with
+  // repeated IDs whose order must be kept
+  auto input = LogMessages{};
+  for (size_t i = 0; i < 100000; ++i) {
+    input.emplace_back("pipeline" + std::to_string(i * 7919 % 5003),
+                       std::to_string(i % 1000), "body " + std::to_string(i),
+                       std::to_string(i % 1000 + 1));
+  }
+  auto expected_output = SplitByPipeline{input}.Split();
+
+  for (size_t thread_count : {0, 2, 4, 16}) {
+    ASSERT_THAT(SplitByPipeline(input, thread_count).Split(),
+                Eq(expected_output));
+  }
+  ASSERT_THAT(expected_output.size(), Eq(5003));
+}
+
+TEST_F(SplitByPipelineTest, PipelinesOfDifferentSymbolTables) {
+  using pipelines::log_message::SymbolTable;
+  using pipelines::log_message_organizer::IncrementalSplitByPipeline;
+  using pipelines::log_message_organizer::LogMessage;
+  using pipelines::log_message_organizer::LogMessages;
+  using pipelines::log_message_organizer::PipelineLogMessagesByPipeline;
+  using pipelines::log_message_organizer::SplitByPipeline;
+  using pipelines::log_message_organizer::Symbol;
+
+  // Both tables give the index 1 to their first pipeline
+  auto table = SymbolTable{};
+  auto other_table = SymbolTable{};
+  auto message = [](std::string_view pipeline_id, std::string_view id,
+                    std::string_view next_id, SymbolTable& symbol_table) {
+    return LogMessage{Symbol{pipeline_id, symbol_table},
+                      Symbol{id, symbol_table},
+                      "body " + std::string{id},
+                      Symbol{next_id, symbol_table}};
+  };
+  auto input = LogMessages{
+      message("alpha", "1", "2", table),
+      message("beta", "3", "-1", other_table),
+      message("alpha", "2", "-1", other_table),
+      message("beta", "4", "3", table),
+      {"alpha", "5", "body 5", "1"},
+  };
+  auto expected_output = PipelineLogMessagesByPipeline{
+      {"alpha",
+       {{"1", "body 1", "2"}, {"2", "body 2", "-1"}, {"5", "body 5", "1"}}},
+      {"beta", {{"3", "body 3", "-1"}, {"4", "body 4", "3"}}},
+  };
+
+  ASSERT_THAT(SplitByPipeline{input}.Split(), Eq(expected_output));
+  auto splitter = IncrementalSplitByPipeline{};
+  splitter.Add(input);
+  ASSERT_THAT(splitter.Finish(), Eq(expected_output));
+}
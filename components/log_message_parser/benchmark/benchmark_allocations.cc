@@ -0,0 +1,204 @@
+/**
+ * @file benchmark_allocations.cc
+ * @brief Counts the heap allocations done by the structure and semantics
+ * parsers for every message.
+ *
+ * The global operator new is replaced by one that counts the calls, so the
+ * numbers include everything the parsers allocate: the fields, the
+ * collections and the buffers. The parsers are run once on a generated input,
+ * and the count is divided by the number of messages parsed.
+ *
+ * Usage: benchmark_allocations [number of messages]
+ */
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <span>
+#include <sstream>
+#include <string>
+#include "log_message/symbol.h"
+#include "log_message_parser/ascii_body_parser.h"
+#include "log_message_parser/hex16_body_parser.h"
+#include "log_message_parser/semantics.h"
+#include "log_message_parser/structure.h"
+#include "log_message_parser/structure_incremental.h"
+#include "log_message_parser/structure_view.h"
+
+/******************************************************************************
+ * ALLOCATION COUNTING
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::benchmark {
+
+/// Number of calls to the global operator new
+static std::atomic<size_t> allocation_count{0};
+
+/// Number of bytes requested to the global operator new
+static std::atomic<size_t> allocated_bytes{0};
+
+}  // namespace pipelines::log_message_parser::benchmark
+
+void* operator new(std::size_t size) {
+  using namespace pipelines::log_message_parser::benchmark;
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  if (auto* pointer = std::malloc(size == 0 ? 1 : size)) {
+    return pointer;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+  std::free(pointer);
+}
+
+/******************************************************************************
+ * PRIVATE HELPER DECLARATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::benchmark {
+
+/**
+ * @brief Creates an input with long UUID-like IDs and bodies, so no field
+ * fits in the small string buffer of std::string. Half of the bodies are
+ * ASCII and half are hexadecimal.
+ * @param message_count The number of messages.
+ * @return The input.
+ */
+static std::string CreateInput(size_t message_count);
+
+/**
+ * @brief Runs the function and prints the allocations it did per message.
+ * @param name The name of the measurement.
+ * @param function The function to measure, returns the number of messages.
+ */
+template <typename Function>
+static void PrintAllocationsPerMessage(const char* name, Function function);
+
+}  // namespace pipelines::log_message_parser::benchmark
+
+/******************************************************************************
+ * PRIVATE HELPER IMPLEMENTATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::benchmark {
+
+static std::string CreateInput(size_t message_count) {
+  auto uuid = [](size_t id) {
+    auto text = std::to_string(id);
+    return std::string(36 - text.size(), '0') + text;
+  };
+
+  auto input = std::string{};
+  for (size_t id = 0; id < message_count; ++id) {
+    input += "pipeline-" + std::to_string(id % 16) + " " + uuid(id) +
+             (id % 2 == 0
+                  ? " 0 [a body that is too long for the small buffer] "
+                  : " 1 [6120626F6479207468617420697320746F6F206C6F6E67] ") +
+             uuid(id + 1) + "\n";
+  }
+  return input;
+}
+
+template <typename Function>
+static void PrintAllocationsPerMessage(const char* name, Function function) {
+  const auto count_before = allocation_count.load();
+  const auto bytes_before = allocated_bytes.load();
+  const auto messages = static_cast<double>(function());
+  const auto count = allocation_count.load() - count_before;
+  const auto bytes = allocated_bytes.load() - bytes_before;
+
+  std::printf("%-24s %16.3f %16.1f\n", name,
+              static_cast<double>(count) / messages,
+              static_cast<double>(bytes) / messages);
+}
+
+}  // namespace pipelines::log_message_parser::benchmark
+
+/******************************************************************************
+ * MAIN
+ *****************************************************************************/
+
+int main(int argc, char* argv[]) {
+  using namespace pipelines::log_message_parser;
+  using benchmark::CreateInput;
+  using benchmark::PrintAllocationsPerMessage;
+
+  auto message_count =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10) : size_t{100000};
+  const auto input = CreateInput(message_count);
+
+  std::printf("%-24s %16s %16s\n", "parser", "allocations/msg", "bytes/msg");
+
+  PrintAllocationsPerMessage("stream", [&input] {
+    auto input_stream = std::istringstream{input};
+    return structure::Parser{input_stream}.Parse().messages().size();
+  });
+
+  PrintAllocationsPerMessage("stream, 4 threads", [&input] {
+    auto input_stream = std::istringstream{input};
+    return structure::Parser{input_stream, 4}.Parse().messages().size();
+  });
+
+  PrintAllocationsPerMessage("view", [&input] {
+    return structure::ViewParser{std::span<const char>{input}}
+        .Parse()
+        .messages()
+        .size();
+  });
+
+  PrintAllocationsPerMessage("incremental, 64 KiB", [&input] {
+    constexpr auto kBlockSize = size_t{64 * 1024};
+    auto parser = structure::IncrementalParser{};
+    auto messages = size_t{0};
+    for (size_t i = 0; i < input.size(); i += kBlockSize) {
+      auto block = std::span<const char>{input}.subspan(
+          i, std::min(kBlockSize, input.size() - i));
+      messages += parser.Feed(block).messages().size();
+    }
+    return messages + parser.Finish().messages().size();
+  });
+
+  auto symbol_table = pipelines::log_message::SymbolTable{};
+  auto semantics_parser =
+      semantics::Parser{semantics::BodyDecoding::kEager, 1,
+                        semantics::ErrorMessages::kFull, symbol_table};
+  semantics_parser.RegisterBodyParser(
+      "0", std::make_unique<semantics::AsciiBodyParser>());
+  semantics_parser.RegisterBodyParser(
+      "1", std::make_unique<semantics::Hex16BodyParser>());
+  const auto view_result =
+      structure::ViewParser{std::span<const char>{input}}.Parse();
+  // The IDs are interned by a first run, so only the parsing is counted
+  semantics_parser.Parse(view_result.messages());
+
+  PrintAllocationsPerMessage("semantics", [&] {
+    return semantics_parser.Parse(view_result.messages()).messages().size();
+  });
+
+  PrintAllocationsPerMessage("semantics, lazy", [&] {
+    auto lazy_parser =
+        semantics::Parser{semantics::BodyDecoding::kLazy, 1,
+                          semantics::ErrorMessages::kFull, symbol_table};
+    lazy_parser.RegisterBodyParser(
+        "0", std::make_unique<semantics::AsciiBodyParser>());
+    lazy_parser.RegisterBodyParser(
+        "1", std::make_unique<semantics::Hex16BodyParser>());
+    return lazy_parser.Parse(view_result.messages()).messages().size();
+  });
+
+  return 0;
+}
@@ -0,0 +1,196 @@
+/**
+ * @file benchmark_error_rate.cc
+ * @brief Measures how the parsing throughput changes with the rate of
+ * malformed records.
+ *
+ * The malformed records are reported as results, not as exceptions, so the
+ * throughput should stay about the same for any error rate. The semantics
+ * parser is measured with the body parsers registered at runtime and with
+ * them fixed at compile time, the StaticParser, and with the StaticParser
+ * when the errors are only counted, without their messages.
+ *
+ * Usage: benchmark_error_rate [size in MiB]
+ */
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <span>
+#include <sstream>
+#include <string>
+#include "log_message/symbol.h"
+#include "log_message_parser/ascii_body_parser.h"
+#include "log_message_parser/hex16_body_parser.h"
+#include "log_message_parser/semantics.h"
+#include "log_message_parser/static_parser.h"
+#include "log_message_parser/structure.h"
+#include "log_message_parser/structure_view.h"
+
+/******************************************************************************
+ * PRIVATE HELPER DECLARATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::benchmark {
+
+/**
+ * @brief Creates an input where the given fraction of the records is
+ * malformed, in the structure or in the body.
+ * @param size The approximate size of the input, in bytes.
+ * @param error_rate The fraction of malformed records, from 0 to 1.
+ * @return The input.
+ */
+static std::string CreateInput(size_t size, double error_rate);
+
+/**
+ * @brief Runs the function a few times and returns the fastest run.
+ * @param function The function to measure.
+ * @return The duration of the fastest run, in seconds.
+ */
+template <typename Function>
+static double FastestRun(Function function);
+
+}  // namespace pipelines::log_message_parser::benchmark
+
+/******************************************************************************
+ * PRIVATE HELPER IMPLEMENTATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::benchmark {
+
+static std::string CreateInput(size_t size, double error_rate) {
+  // Errors in the structure and in the semantics. Most structure errors make
+  // the parser look for the end of the message in the next lines, these are
+  // the ones that stay in their own line.
+  constexpr auto kMalformedRecords = std::array<std::string_view, 5>{
+      "4 17 0 this has no brackets 18\n",
+      "4 17 0 {wrong brackets} 18\n",
+      "4 17 1 [4F4G] 18\n",
+      "4 17 1 [4F4B1] 18\n",
+      "4 17 7 [unknown encoding] 18\n",
+  };
+
+  auto generator = std::mt19937{42};
+  auto is_malformed = std::bernoulli_distribution{error_rate};
+  auto malformed_kind = std::uniform_int_distribution<size_t>{
+      0, kMalformedRecords.size() - 1};
+
+  auto input = std::string{};
+  input.reserve(size + 64);
+  for (size_t id = 0; input.size() < size; ++id) {
+    if (is_malformed(generator)) {
+      input += kMalformedRecords[malformed_kind(generator)];
+    } else if (id % 2 == 0) {
+      input += std::to_string(id % 16) + " " + std::to_string(id) +
+               " 0 [some ascii body] " + std::to_string(id + 1) + "\n";
+    } else {
+      input += std::to_string(id % 16) + " " + std::to_string(id) +
+               " 1 [626F6479] " + std::to_string(id + 1) + "\n";
+    }
+  }
+  return input;
+}
+
+template <typename Function>
+static double FastestRun(Function function) {
+  constexpr auto kRuns = 3;
+
+  auto fastest = std::chrono::duration<double>::max();
+  for (int run = 0; run < kRuns; ++run) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    fastest = std::min<std::chrono::duration<double>>(
+        fastest, std::chrono::steady_clock::now() - start);
+  }
+  return fastest.count();
+}
+
+}  // namespace pipelines::log_message_parser::benchmark
+
+/******************************************************************************
+ * MAIN
+ *****************************************************************************/
+
+int main(int argc, char* argv[]) {
+  using namespace pipelines::log_message_parser;
+  using benchmark::CreateInput;
+  using benchmark::FastestRun;
+
+  constexpr auto kErrorRates =
+      std::array<double, 6>{0.0, 0.01, 0.05, 0.10, 0.20, 0.50};
+  constexpr auto kMebibyte = 1024.0 * 1024.0;
+
+  auto size_in_mebibytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 16;
+  auto size = static_cast<size_t>(size_in_mebibytes * kMebibyte);
+
+  auto symbol_table = pipelines::log_message::SymbolTable{};
+  auto semantics_parser =
+      semantics::Parser{semantics::BodyDecoding::kEager, 1,
+                        semantics::ErrorMessages::kFull, symbol_table};
+  semantics_parser.RegisterBodyParser(
+      "0", std::make_unique<semantics::AsciiBodyParser>());
+  semantics_parser.RegisterBodyParser(
+      "1", std::make_unique<semantics::Hex16BodyParser>());
+
+  using AsciiEncoding = semantics::Encoding<"0", semantics::AsciiBodyParser>;
+  using Hex16Encoding = semantics::Encoding<"1", semantics::Hex16BodyParser>;
+  auto static_semantics_parser =
+      semantics::StaticParser<AsciiEncoding, Hex16Encoding>{
+          semantics::BodyDecoding::kEager, 1, semantics::ErrorMessages::kFull,
+          symbol_table};
+  auto counting_semantics_parser =
+      semantics::StaticParser<AsciiEncoding, Hex16Encoding>{
+          semantics::BodyDecoding::kEager, 1, semantics::ErrorMessages::kNone,
+          symbol_table};
+
+  std::printf("%10s %16s %16s %18s %18s %18s\n", "errors", "stream (MiB/s)",
+              "view (MiB/s)", "semantics (M/s)", "static (M/s)",
+              "counted (M/s)");
+
+  for (auto error_rate : kErrorRates) {
+    const auto input = CreateInput(size, error_rate);
+    const auto mebibytes = static_cast<double>(input.size()) / kMebibyte;
+
+    auto stream_seconds = FastestRun([&input] {
+      auto input_stream = std::istringstream{input};
+      auto result = structure::Parser{input_stream}.Parse();
+      return result.messages().size();
+    });
+
+    auto view_result =
+        structure::ViewParser{std::span<const char>{input}}.Parse();
+    auto view_seconds = FastestRun([&input] {
+      auto result = structure::ViewParser{std::span<const char>{input}}.Parse();
+      return result.messages().size();
+    });
+
+    const auto& messages = view_result.messages();
+    auto semantics_seconds = FastestRun([&semantics_parser, &messages] {
+      return semantics_parser.Parse(messages).messages().size();
+    });
+
+    auto static_seconds = FastestRun([&static_semantics_parser, &messages] {
+      return static_semantics_parser.Parse(messages).messages().size();
+    });
+
+    auto counted_seconds = FastestRun([&counting_semantics_parser, &messages] {
+      return counting_semantics_parser.Parse(messages).errors().size();
+    });
+
+    const auto millions = static_cast<double>(messages.size()) / 1e6;
+    std::printf("%9.0f%% %16.1f %16.1f %18.2f %18.2f %18.2f\n",
+                error_rate * 100, mebibytes / stream_seconds,
+                mebibytes / view_seconds, millions / semantics_seconds,
+                millions / static_seconds, millions / counted_seconds);
+  }
+
+  return 0;
+}
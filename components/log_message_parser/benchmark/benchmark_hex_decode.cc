@@ -0,0 +1,167 @@
+/**
+ * @file benchmark_hex_decode.cc
+ * @brief Measures the throughput of the hexadecimal body parser on big
+ * bodies.
+ *
+ * The same body is parsed over and over, as one contiguous string and broken
+ * in lines of 64 characters. The previous implementation, which removed the
+ * whitespace, checked every character and then converted every pair with
+ * std::stoi, is measured as a reference.
+ *
+ * Usage: benchmark_hex_decode [body size in KiB]
+ */
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <random>
+#include <string>
+#include "log_message_parser/hex16_body_parser.h"
+
+/******************************************************************************
+ * PRIVATE HELPER DECLARATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::benchmark {
+
+/**
+ * @brief Creates a hexadecimal body of random bytes.
+ * @param size The number of hexadecimal characters.
+ * @param line_length Number of characters between two newlines, 0 for none.
+ * @return The body.
+ */
+static std::string CreateBody(size_t size, size_t line_length);
+
+/**
+ * @brief Parses a body the way the parser did before the single pass kernel.
+ * @param body The hexadecimal body, assumed valid.
+ * @return The decoded body.
+ */
+static std::string ParseThreePasses(const std::string& body);
+
+/**
+ * @brief Runs the function a few times and returns the fastest run.
+ * @param function The function to measure.
+ * @return The duration of the fastest run, in seconds.
+ */
+template <typename Function>
+static double FastestRun(Function function);
+
+}  // namespace pipelines::log_message_parser::benchmark
+
+/******************************************************************************
+ * PRIVATE HELPER IMPLEMENTATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::benchmark {
+
+static std::string CreateBody(size_t size, size_t line_length) {
+  constexpr auto kDigits = std::string_view{"0123456789abcdef"};
+  auto generator = std::mt19937{42};
+  auto digit = std::uniform_int_distribution<size_t>{0, kDigits.size() - 1};
+
+  auto body = std::string{};
+  body.reserve(size + size / std::max<size_t>(line_length, 1));
+  for (size_t i = 0; i < size; ++i) {
+    if (line_length != 0 && i != 0 && i % line_length == 0) {
+      body.push_back('\n');
+    }
+    body.push_back(kDigits[digit(generator)]);
+  }
+  return body;
+}
+
+static std::string ParseThreePasses(const std::string& body) {
+  auto no_whitespace_body = std::string{};
+  std::copy_if(body.begin(), body.end(), std::back_inserter(no_whitespace_body),
+               [](char c) { return !std::isspace(c); });
+  if (!std::all_of(no_whitespace_body.begin(), no_whitespace_body.end(),
+                   [](char c) { return std::isxdigit(c); })) {
+    return {};
+  }
+  auto parsed_body = std::string{};
+  parsed_body.reserve(no_whitespace_body.size() / 2);
+  for (size_t i = 0; i < no_whitespace_body.size(); i += 2) {
+    parsed_body.push_back(static_cast<char>(
+        std::stoi(no_whitespace_body.substr(i, 2), nullptr, 16)));
+  }
+  return parsed_body;
+}
+
+template <typename Function>
+static double FastestRun(Function function) {
+  constexpr auto kRuns = 5;
+
+  auto fastest = std::chrono::duration<double>::max();
+  for (int run = 0; run < kRuns; ++run) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    fastest = std::min<std::chrono::duration<double>>(
+        fastest, std::chrono::steady_clock::now() - start);
+  }
+  return fastest.count();
+}
+
+}  // namespace pipelines::log_message_parser::benchmark
+
+/******************************************************************************
+ * MAIN
+ *****************************************************************************/
+
+int main(int argc, char* argv[]) {
+  using namespace pipelines::log_message_parser;
+  using benchmark::CreateBody;
+  using benchmark::FastestRun;
+  using benchmark::ParseThreePasses;
+
+  constexpr auto kRepetitions = 64;
+  constexpr auto kGigabyte = 1e9;
+
+  auto size_in_kibibytes = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 256;
+  auto size = static_cast<size_t>(size_in_kibibytes * 1024);
+  auto parser = semantics::Hex16BodyParser{};
+
+  std::printf("%-12s %18s %18s %18s\n", "body", "three passes GB/s",
+              "TryParse GB/s", "Validate GB/s");
+
+  for (auto line_length : {size_t{0}, size_t{64}}) {
+    const auto body = CreateBody(size, line_length);
+    const auto gigabytes =
+        static_cast<double>(body.size()) * kRepetitions / kGigabyte;
+
+    auto decoded_size = size_t{0};
+    auto three_passes_seconds = FastestRun([&] {
+      for (int i = 0; i < kRepetitions; ++i) {
+        decoded_size += ParseThreePasses(body).size();
+      }
+    });
+    auto try_parse_seconds = FastestRun([&] {
+      for (int i = 0; i < kRepetitions; ++i) {
+        decoded_size += parser.TryParse(body)->size();
+      }
+    });
+    auto validate_seconds = FastestRun([&] {
+      for (int i = 0; i < kRepetitions; ++i) {
+        decoded_size += parser.Validate(body).has_value() ? 0 : 1;
+      }
+    });
+
+    std::printf("%-12s %18.3f %18.3f %18.3f\n",
+                line_length == 0 ? "contiguous" : "64 per line",
+                gigabytes / three_passes_seconds, gigabytes / try_parse_seconds,
+                gigabytes / validate_seconds);
+    if (decoded_size == 0) {
+      std::printf("Nothing was decoded\n");
+    }
+  }
+
+  return 0;
+}
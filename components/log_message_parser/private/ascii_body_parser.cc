@@ -10,6 +10,39 @@
 #include "log_message_parser/ascii_body_parser.h"
 #include "log_message_parser/semantics.h"
 
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+/******************************************************************************
+ * PRIVATE HELPER DECLARATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::semantics {
+
+/**
+ * @brief Decodes an ASCII body, copying it as it is.
+ *
+ * @param encoded The ASCII body.
+ * @param decoded The string the body is appended to.
+ */
+static void DecodeAscii(std::string_view encoded, std::string& decoded);
+
+}  // namespace pipelines::log_message_parser::semantics
+
+/******************************************************************************
+ * PRIVATE HELPER IMPLEMENTATION
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::semantics {
+
+static void DecodeAscii(std::string_view encoded, std::string& decoded) {
+  decoded.append(encoded);
+}
+
+}  // namespace pipelines::log_message_parser::semantics
+
 /******************************************************************************
  * PUBLIC CLASS METHODS IMPLEMENTATION
  *****************************************************************************/
@@ -20,4 +53,24 @@ std::string AsciiBodyParser::Parse(const std::string& body) const {
   return body;
 }
 
+BodyParseIntoResult AsciiBodyParser::ParseInto(
+    std::string_view body, std::string& /*buffer*/) const {
+  return body;
+}
+
+void AsciiBodyParser::ParseBatch(std::span<const std::string_view> bodies,
+                                 std::string& /*buffer*/,
+                                 BodyParseBatchResults& results) const {
+  results.assign(bodies.begin(), bodies.end());
+}
+
+std::optional<BodyError> AsciiBodyParser::Validate(
+    std::string_view /*body*/) const {
+  return std::nullopt;
+}
+
+Body::Decoder AsciiBodyParser::decoder() const {
+  return DecodeAscii;
+}
+
 }  // namespace pipelines::log_message_parser::semantics
\ No newline at end of file
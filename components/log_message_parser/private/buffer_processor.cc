@@ -0,0 +1,460 @@
+/**
+ * @file buffer_processor.cc
+ * @brief Implementation of the BufferProcessor class.
+ *
+ * See parsing.md for the description of the algorithm. Every scan over the
+ * buffer is a query to the StructuralIndex, so the characters in between the
+ * interesting ones are never looked at one by one.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include "buffer_processor.h"
+#include <span>
+#include <string>
+#include "stream_read_error.h"
+
+/******************************************************************************
+ * PRIVATE HELPER DECLARATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+/**
+ * @brief Checks if a character marks the end of a line.
+ * @param character The character to check.
+ * @return true if the character is a newline or carriage return.
+ */
+static constexpr bool IsEndOfLine(char character);
+
+/**
+ * @brief Trims whitespace from both sides of a view.
+ * @param view The view to trim.
+ * @return A view without the leading and trailing whitespace.
+ */
+static std::string_view Trim(std::string_view view);
+
+/**
+ * @brief Adds a read error to the collection of parsing errors.
+ * @param error The error found while reading.
+ * @param errors The collection of parsing errors.
+ * @return Nothing, so it can be returned in place of a message.
+ */
+static std::nullopt_t ReportError(const StreamReadError& error,
+                                  ParseErrors& errors);
+
+/**
+ * @brief Completes a message once the search for its body ended, skipping the
+ * rest of it if its body was too long.
+ * @param buffer_processor The BufferProcessor instance to read from.
+ * @param message The start and the header of the message.
+ * @param body_and_next_id The result of the search for the body.
+ * @param errors The collection of parsing errors.
+ * @return The positions of the fields, or nothing if the message is invalid.
+ */
+static std::optional<LogMessageFields> CompleteStructureLogMessage(
+    BufferProcessor& buffer_processor, const UnfinishedMessage& message,
+    const ReadResult<std::pair<FieldRange, FieldRange>>& body_and_next_id,
+    ParseErrors& errors);
+
+}  // namespace pipelines::log_message_parser::structure
+
+/******************************************************************************
+ * PRIVATE HELPER IMPLEMENTATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+static constexpr bool IsEndOfLine(char character) {
+  return character == '\n' || character == '\r';
+}
+
+static std::string_view Trim(std::string_view view) {
+  constexpr auto kWhitespace = std::string_view{" \t\n\v\f\r"};
+  auto first = view.find_first_not_of(kWhitespace);
+  if (first == std::string_view::npos) {
+    return {};
+  }
+  auto last = view.find_last_not_of(kWhitespace);
+  return view.substr(first, last - first + 1);
+}
+
+static std::nullopt_t ReportError(const StreamReadError& error,
+                                  ParseErrors& errors) {
+  constexpr auto kFileEndPrefix =
+      std::string_view{"File ended while parsing: "};
+  constexpr auto kBadFormatPrefix = std::string_view{"Bad format: "};
+  constexpr auto kBodyTooLongPrefix = std::string_view{"Body too long: "};
+  auto prefix = kBadFormatPrefix;
+  if (error.kind == StreamReadErrorKind::kFileEnd) {
+    prefix = kFileEndPrefix;
+  } else if (error.kind == StreamReadErrorKind::kBodyTooLong) {
+    prefix = kBodyTooLongPrefix;
+  }
+
+  auto error_message = std::string{};
+  error_message.reserve(prefix.size() + error.message.size());
+  error_message.append(prefix).append(error.message);
+  errors.emplace_back(error_message, error.line_number);
+  return std::nullopt;
+}
+
+static std::optional<LogMessageFields> CompleteStructureLogMessage(
+    BufferProcessor& buffer_processor, const UnfinishedMessage& message,
+    const ReadResult<std::pair<FieldRange, FieldRange>>& body_and_next_id,
+    ParseErrors& errors) {
+  if (!body_and_next_id) {
+    if (body_and_next_id.error().kind == StreamReadErrorKind::kBodyTooLong) {
+      buffer_processor.SkipToNextHeader(message.start.position,
+                                        message.start.line_number);
+    }
+    return ReportError(body_and_next_id.error(), errors);
+  }
+
+  return LogMessageFields{message.pipeline_id, message.id, message.encoding,
+                          body_and_next_id->first, body_and_next_id->second};
+}
+
+}  // namespace pipelines::log_message_parser::structure
+
+/******************************************************************************
+ * FUNCTION IMPLEMENTATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+std::optional<LogMessageFields> AttemptToReadStructureLogMessage(
+    BufferProcessor& buffer_processor, ParseErrors& errors) {
+  auto unfinished_message = std::optional<UnfinishedMessage>{};
+  return AttemptToReadStructureLogMessage(buffer_processor, errors,
+                                          unfinished_message);
+}
+
+std::optional<LogMessageFields> AttemptToReadStructureLogMessage(
+    BufferProcessor& buffer_processor, ParseErrors& errors,
+    std::optional<UnfinishedMessage>& unfinished_message) {
+  unfinished_message.reset();
+  auto message = UnfinishedMessage{};
+  message.start = {buffer_processor.position(), buffer_processor.line_number()};
+
+  auto pipeline_id = buffer_processor.AttemptToReadPipelineId();
+  if (!pipeline_id) {
+    return ReportError(pipeline_id.error(), errors);
+  }
+  message.pipeline_id = *pipeline_id;
+  auto id = buffer_processor.AttemptToReadId();
+  if (!id) {
+    return ReportError(id.error(), errors);
+  }
+  message.id = *id;
+  auto encoding = buffer_processor.AttemptToReadEncoding();
+  if (!encoding) {
+    return ReportError(encoding.error(), errors);
+  }
+  message.encoding = *encoding;
+
+  auto body_and_next_id = buffer_processor.AttemptToReadBodyAndNextId();
+  if (const auto& body_search = buffer_processor.body_search()) {
+    message.body_search = *body_search;
+    unfinished_message = message;
+  }
+  return CompleteStructureLogMessage(buffer_processor, message,
+                                     body_and_next_id, errors);
+}
+
+std::optional<LogMessageFields> ResumeStructureLogMessage(
+    BufferProcessor& buffer_processor, ParseErrors& errors,
+    UnfinishedMessage& unfinished_message) {
+  auto body_and_next_id =
+      buffer_processor.ResumeBodyAndNextId(unfinished_message.body_search);
+  unfinished_message.body_search = *buffer_processor.body_search();
+  return CompleteStructureLogMessage(buffer_processor, unfinished_message,
+                                     body_and_next_id, errors);
+}
+
+void AdvanceUntilEndOfLine(BufferProcessor& buffer_processor,
+                           ParseErrors& errors) {
+  auto line_number = buffer_processor.line_number();
+  auto line =
+      Trim(buffer_processor.View(buffer_processor.ReadUntilEndOfLine()));
+
+  if (!line.empty()) {
+    auto error_message = "There is unparsed data in line " +
+                         std::to_string(line_number) + ": \"" +
+                         std::string(line) + "\"";
+    errors.emplace_back(error_message, line_number);
+  }
+}
+
+}  // namespace pipelines::log_message_parser::structure
+
+/******************************************************************************
+ * CLASS METHODS IMPLEMENTATION
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+bool BufferProcessor::Refill() {
+  if (input_source_ == nullptr || input_source_ended_) {
+    return false;
+  }
+
+  // Only the record being parsed needs to stay in the window
+  window_.erase(0, discard_position_);
+  window_offset_ += discard_position_;
+  position_ -= discard_position_;
+  discard_position_ = 0;
+
+  auto old_size = window_.size();
+  window_.resize(old_size + kRefillSize);
+  auto read = input_source_->Read(
+      std::span<char>{window_.data() + old_size, kRefillSize});
+  window_.resize(old_size + read);
+
+  buffer_ = window_;
+  index_.Reset(buffer_);
+
+  if (read == 0) {
+    input_source_ended_ = true;
+    return false;
+  }
+  return true;
+}
+
+void BufferProcessor::SkipWhitespace() {
+  AdvanceUntil([](const BlockMasks& masks) { return ~masks.whitespace; });
+}
+
+FieldRange BufferProcessor::ReadUntilWhitespace() {
+  auto start = InputPosition();
+  AdvanceUntil([](const BlockMasks& masks) { return masks.whitespace; });
+  return RangeFrom(start);
+}
+
+void BufferProcessor::ReadUntilCloseBracket() {
+  AdvanceUntil([](const BlockMasks& masks) { return masks.close_bracket; });
+}
+
+bool BufferProcessor::ReadUntilCloseBracketWithinLimits(
+    size_t body_start, size_t body_line_number) {
+  const auto end = body_limits_.max_bytes == 0
+                       ? kNoLimit
+                       : body_start + body_limits_.max_bytes + 1;
+  const auto max_newlines =
+      body_limits_.max_lines == 0 ? kNoLimit : body_limits_.max_lines - 1;
+
+  while (InputPosition() < end &&
+         line_number_ - body_line_number <= max_newlines) {
+    if (body_limits_.max_lines == 0) {
+      AdvanceUntil([](const BlockMasks& masks) { return masks.close_bracket; },
+                   end);
+    } else {
+      // Every newline has to be counted before going past it
+      AdvanceUntil(
+          [](const BlockMasks& masks) {
+            return masks.close_bracket | masks.newline;
+          },
+          end);
+    }
+    if (InputPosition() >= end) {
+      return false;
+    }
+    if (HasBufferEnded() || CurrentCharacter() == ']') {
+      return true;
+    }
+    AdvanceCurrentCharacter();
+  }
+  return false;
+}
+
+bool BufferProcessor::LooksLikeHeader() {
+  constexpr auto kHeaderFields = 3;
+
+  auto skip_blanks = [](const BlockMasks& masks) {
+    return ~masks.whitespace | masks.end_of_line;
+  };
+  for (int field = 0; field < kHeaderFields; ++field) {
+    AdvanceUntil(skip_blanks);
+    if (HasBufferEnded() || IsEndOfLine(CurrentCharacter())) {
+      return false;
+    }
+    AdvanceUntil([](const BlockMasks& masks) { return masks.whitespace; });
+  }
+  AdvanceUntil(skip_blanks);
+  return !HasBufferEnded() && CurrentCharacter() == '[';
+}
+
+void BufferProcessor::SkipToNextHeader(size_t position, size_t line_number) {
+  position_ = position - window_offset_;
+  line_number_ = line_number;
+  unfinished_skip_.reset();
+
+  while (true) {
+    AdvanceUntil([](const BlockMasks& masks) { return masks.newline; });
+    if (HasBufferEnded()) {
+      unfinished_skip_ = InputLocation{InputPosition(), line_number_};
+      return;
+    }
+
+    // Nothing before the end of this line is needed anymore
+    discard_position_ = position_;
+    const auto end_of_line = InputLocation{InputPosition(), line_number_};
+    AdvanceCurrentCharacter();
+
+    if (LooksLikeHeader()) {
+      position_ = end_of_line.position - window_offset_;
+      line_number_ = end_of_line.line_number;
+      return;
+    }
+    if (has_reached_end_) {
+      // More input could still make this line look like a header
+      unfinished_skip_ = end_of_line;
+      return;
+    }
+  }
+}
+
+FieldRange BufferProcessor::ReadUntilWhitespaceOrCloseBracket() {
+  auto start = InputPosition();
+  AdvanceUntil([](const BlockMasks& masks) {
+    return masks.whitespace | masks.close_bracket;
+  });
+  return RangeFrom(start);
+}
+
+FieldRange BufferProcessor::ReadUntilEndOfLine() {
+  auto start = InputPosition();
+  AdvanceUntil([](const BlockMasks& masks) { return masks.end_of_line; });
+  return RangeFrom(start);
+}
+
+bool BufferProcessor::ReadOnlyWhitespaceUntilEndOfLine() {
+  AdvanceUntil([](const BlockMasks& masks) {
+    return masks.end_of_line | ~masks.whitespace;
+  });
+  return HasBufferEnded() || IsEndOfLine(CurrentCharacter());
+}
+
+ReadResult<FieldRange> BufferProcessor::AttemptToReadContinuousString(
+    const std::string_view& error_message) {
+  auto line_number = line_number_;
+  SkipWhitespace();
+
+  auto continuous_string = ReadUntilWhitespace();
+
+  if (continuous_string.length == 0) {
+    return FileEndError(error_message, line_number);
+  }
+
+  return continuous_string;
+}
+
+ReadResult<FieldRange> BufferProcessor::AttemptToReadPipelineId() {
+  return AttemptToReadContinuousString("Failed to read pipeline ID");
+}
+
+ReadResult<FieldRange> BufferProcessor::AttemptToReadId() {
+  return AttemptToReadContinuousString("Failed to read ID");
+}
+
+ReadResult<FieldRange> BufferProcessor::AttemptToReadEncoding() {
+  return AttemptToReadContinuousString("Failed to read encoding");
+}
+
+ReadResult<std::pair<FieldRange, FieldRange>>
+BufferProcessor::AttemptToReadBodyAndNextId() {
+  auto line_number = line_number_;
+  body_search_.reset();
+
+  SkipWhitespace();
+
+  if (HasBufferEnded()) {
+    return FileEndError("File ended while parsing body", line_number);
+  }
+  if (CurrentCharacter() != '[') {
+    return BadFormatError("Expected an opening bracket", line_number_);
+  }
+
+  return SearchForMatchingBrackets(line_number);
+}
+
+bool BufferProcessor::IsDone() {
+  SkipWhitespace();
+  return HasBufferEnded();
+}
+
+ReadResult<std::pair<FieldRange, FieldRange>>
+BufferProcessor::ResumeBodyAndNextId(const BodySearch& body_search) {
+  position_ = body_search.resume.position - window_offset_;
+  line_number_ = body_search.resume.line_number;
+  body_search_ = body_search;
+  return ContinueBodySearch();
+}
+
+ReadResult<std::pair<FieldRange, FieldRange>>
+BufferProcessor::SearchForMatchingBrackets(size_t line_number) {
+  AdvanceCurrentCharacter();
+  const auto body_start = InputLocation{InputPosition(), line_number_};
+  body_search_ = BodySearch{body_start, line_number, body_start};
+  return ContinueBodySearch();
+}
+
+ReadResult<std::pair<FieldRange, FieldRange>>
+BufferProcessor::ContinueBodySearch() {
+  auto& search = *body_search_;
+  const auto line_number = search.line_number;
+  const auto body_start = search.body.position;
+  const auto body_line_number = search.body.line_number;
+  const auto has_body_limits =
+      body_limits_.max_bytes != 0 || body_limits_.max_lines != 0;
+  auto next_id = FieldRange{};
+  auto found_closing_bracket = false;
+  auto body = RangeFrom(body_start);
+
+  // The body is everything between the opening bracket and the first closing
+  // bracket that is followed by a continuous string and an end of line.
+  while (!HasBufferEnded() && !found_closing_bracket) {
+    // The closing brackets before this position were rejected by what
+    // followed them in the same line, more input can't change that
+    search.resume = {InputPosition(), line_number_};
+    if (!has_body_limits) {
+      ReadUntilCloseBracket();
+    } else if (!ReadUntilCloseBracketWithinLimits(body_start,
+                                                  body_line_number)) {
+      return body_limits_.max_lines != 0 &&
+                     line_number_ - body_line_number >= body_limits_.max_lines
+                 ? BodyTooLongError("Exceeded the maximum number of body lines",
+                                    line_number)
+                 : BodyTooLongError("Exceeded the maximum body size",
+                                    line_number);
+    }
+    if (HasBufferEnded()) {
+      // There is no closing bracket in what was read
+      search.resume = {InputPosition(), line_number_};
+    } else {
+      body = RangeFrom(body_start);
+      AdvanceCurrentCharacter();
+      SkipWhitespace();
+      auto continuous_string = ReadUntilWhitespaceOrCloseBracket();
+      if (HasBufferEnded() || CurrentCharacter() != ']') {
+        if (ReadOnlyWhitespaceUntilEndOfLine()) {
+          next_id = continuous_string;
+          found_closing_bracket = true;
+        }
+      }
+    }
+  }
+  if (!found_closing_bracket) {
+    return FileEndError("Expected a closing bracket ", line_number);
+  }
+
+  if (next_id.length == 0) {
+    return FileEndError("Couldn't find next id", line_number);
+  }
+
+  return std::pair{body, next_id};
+}
+
+}  // namespace pipelines::log_message_parser::structure
@@ -0,0 +1,541 @@
+/**
+ * @file buffer_processor.h
+ * @brief Declares the BufferProcessor class, the second stage of the structure
+ * parser.
+ *
+ * The BufferProcessor assembles the fields of the log messages by jumping
+ * over the bitmaps produced by the StructuralIndex, instead of looking at the
+ * input one character at a time. It works either over a buffer that is
+ * completely in memory (e.g. a memory mapped file) or over a window that is
+ * refilled from an InputSource.
+ */
+
+#ifndef COMPONENT_LOG_MESSAGE_PARSER_PRIVATE_BUFFER_PROCESSOR_H_
+#define COMPONENT_LOG_MESSAGE_PARSER_PRIVATE_BUFFER_PROCESSOR_H_
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "log_message_parser/input_source.h"
+#include "log_message_parser/structure.h"
+#include "stream_read_error.h"
+#include "structural_index.h"
+
+/******************************************************************************
+ * TYPE DEFINITIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+/**
+ * @struct FieldRange
+ * @brief Position of a field in the processed input.
+ *
+ * The offset is relative to the beginning of the input, not to the current
+ * window, so it stays valid when the window is refilled.
+ */
+struct FieldRange {
+  size_t offset{0}; /**< Offset of the first character of the field. */
+  size_t length{0}; /**< Number of characters of the field. */
+};
+
+/**
+ * @struct LogMessageFields
+ * @brief Positions of the five fields of a structured log message.
+ */
+struct LogMessageFields {
+  FieldRange pipeline_id; /**< The ID of the pipeline. */
+  FieldRange id;          /**< The ID of the log message. */
+  FieldRange encoding;    /**< The encoding type of the log message body. */
+  FieldRange body;        /**< The body content of the log message. */
+  FieldRange next_id;     /**< The ID of the next log message. */
+};
+
+/**
+ * @struct InputLocation
+ * @brief A position in the processed input and its line number.
+ */
+struct InputLocation {
+  size_t position{0};    /**< Offset from the beginning of the input. */
+  size_t line_number{1}; /**< Line number of the position. */
+};
+
+/**
+ * @struct BodySearch
+ * @brief How far the search for the closing bracket of a body went.
+ *
+ * Everything the search looked at before the resume location gives the same
+ * result whatever is appended to the input, so if the search reached the end
+ * of the input it can continue from there instead of from the body start.
+ */
+struct BodySearch {
+  InputLocation body;    /**< The first character of the body. */
+  size_t line_number{1}; /**< The line number of the errors of the body. */
+  InputLocation resume;  /**< Where the search continues. */
+};
+
+/**
+ * @struct UnfinishedMessage
+ * @brief A message whose body search reached the end of the input, so its
+ * reading can continue when more input is appended.
+ */
+struct UnfinishedMessage {
+  InputLocation start;    /**< The start of the message. */
+  FieldRange pipeline_id; /**< The ID of the pipeline. */
+  FieldRange id;          /**< The ID of the log message. */
+  FieldRange encoding;    /**< The encoding type of the log message body. */
+  BodySearch body_search; /**< How far the search for the body went. */
+};
+
+}  // namespace pipelines::log_message_parser::structure
+
+/******************************************************************************
+ * CLASSES
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+/**
+ * @class BufferProcessor
+ * @brief Processes structured log messages from a buffer.
+ *
+ * This class provides methods for reading and parsing structured log messages
+ * from a buffer. The fields are returned as FieldRange, which can be turned
+ * into views with View() as long as the processor has not been refilled since
+ * then, i.e. until the start of the next record.
+ */
+class BufferProcessor {
+ public:
+  /**
+    * @brief Constructs a BufferProcessor over a buffer completely in memory.
+    * @param buffer The buffer to process, it must outlive the processor and
+    * any view returned by it.
+    */
+  explicit BufferProcessor(std::string_view buffer)
+      : buffer_(buffer), index_(buffer) {}
+
+  /**
+    * @brief Constructs a BufferProcessor that starts in the middle of a buffer
+    * completely in memory.
+    * @param buffer The buffer to process, it must outlive the processor and
+    * any view returned by it.
+    * @param position The position where the processing starts.
+    * @param line_number The line number of that position.
+    */
+  BufferProcessor(std::string_view buffer, size_t position, size_t line_number)
+      : buffer_(buffer),
+        index_(buffer),
+        position_(position),
+        line_number_(line_number) {}
+
+  /**
+    * @brief Constructs a BufferProcessor that reads the input source in
+    * windows of kRefillSize bytes.
+    * @param input_source The input source to process.
+    */
+  explicit BufferProcessor(InputSource& input_source)
+      : input_source_(&input_source) {}
+
+  /**
+    * @brief Attempts to read the pipeline ID from the buffer.
+    * @return The position of the pipeline ID, or a FileEndError if it cannot
+    * be read.
+    */
+  ReadResult<FieldRange> AttemptToReadPipelineId();
+
+  /**
+    * @brief Attempts to read the ID from the buffer.
+    * @return The position of the ID, or a FileEndError if it cannot be read.
+    */
+  ReadResult<FieldRange> AttemptToReadId();
+
+  /**
+    * @brief Attempts to read the encoding from the buffer.
+    * @return The position of the encoding, or a FileEndError if it cannot be
+    * read.
+    */
+  ReadResult<FieldRange> AttemptToReadEncoding();
+
+  /**
+    * @brief Attempts to read the body and the next id from the buffer.
+    * @return The positions of the body and of the next ID, a FileEndError if
+    * the body cannot be read or a BadFormatError if its format is invalid.
+    */
+  ReadResult<std::pair<FieldRange, FieldRange>> AttemptToReadBodyAndNextId();
+
+  /**
+    * @brief Continues the search for the body and the next id of a message
+    * where a previous search stopped at the end of the input.
+    * @param body_search The state of the previous search, see body_search().
+    * @return The same result AttemptToReadBodyAndNextId() would give if it
+    * read the body from its start.
+    * @pre The resume location must not have been discarded.
+    */
+  ReadResult<std::pair<FieldRange, FieldRange>> ResumeBodyAndNextId(
+      const BodySearch& body_search);
+
+  /**
+    * @brief Reads characters from the buffer until the end of the line.
+    * @return The position of the characters read.
+    */
+  FieldRange ReadUntilEndOfLine();
+
+  /**
+    * @brief Skips the lines of a message whose body exceeded the limits,
+    * until the next line that looks like the start of a message.
+    *
+    * The processor stops at the end of the line before that one, or at the
+    * end of the input if there is none. Everything before the skipped lines
+    * is discarded as they are read, so the memory used stays bounded.
+    *
+    * @param position The position where the skipping starts, the rest of its
+    * line is skipped.
+    * @param line_number The line number of that position.
+    * @pre The position must not have been discarded.
+    */
+  void SkipToNextHeader(size_t position, size_t line_number);
+
+  /**
+    * @brief Checks if the buffer processing is complete.
+    * @return true if the buffer has been fully processed, false otherwise.
+    */
+  bool IsDone();
+
+  /**
+    * @brief Allows everything before the current position to be dropped the
+    * next time the window is refilled.
+    * @note Any FieldRange read before this call can't be viewed anymore.
+    */
+  void DiscardProcessed() { discard_position_ = position_; }
+
+  /**
+    * @brief Retrieves the content of a field.
+    * @param field The position of the field.
+    * @return A view of the field, valid until the window is refilled.
+    */
+  std::string_view View(FieldRange field) const {
+    return buffer_.substr(field.offset - window_offset_, field.length);
+  }
+
+  /**
+    * @brief Retrieves the current position, relative to the beginning of the
+    * input.
+    * @return The current position as a size_t.
+    */
+  size_t position() const { return InputPosition(); }
+
+  /**
+    * @brief Retrieves the current line number in the buffer.
+    * @return The current line number as a size_t.
+    */
+  size_t line_number() const { return line_number_; }
+
+  /**
+    * @brief Checks if the processing looked past the last character of the
+    * input, i.e. if anything read so far could change if more input was
+    * appended to it.
+    * @return true if the end of the input was reached, false otherwise.
+    */
+  bool has_reached_end() const { return has_reached_end_; }
+
+  /**
+    * @brief Sets the limits on the size of the message bodies.
+    * @param body_limits The limits, by default there are none.
+    */
+  void set_body_limits(BodyLimits body_limits) { body_limits_ = body_limits; }
+
+  /**
+    * @brief Retrieves where the skipping of lines should continue if more
+    * input is appended, when the last SkipToNextHeader() reached the end of
+    * the input before finding the start of a message.
+    * @return The location to continue from, or nothing if the skipping
+    * finished.
+    */
+  const std::optional<InputLocation>& unfinished_skip() const {
+    return unfinished_skip_;
+  }
+
+  /**
+    * @brief Retrieves how far the last search for a body went, if the last
+    * message read got to its body.
+    * @return The state of the search, or nothing if it didn't start.
+    */
+  const std::optional<BodySearch>& body_search() const { return body_search_; }
+
+ private:
+  /// Number of bytes read from the input stream at every refill
+  static constexpr size_t kRefillSize = 64 * 1024;
+
+  /// Input position used when a scan has no limit
+  static constexpr size_t kNoLimit = std::numeric_limits<size_t>::max();
+
+  InputSource* input_source_ = nullptr; /**< The source the window is read
+                                             from, if any. */
+  std::string window_;            /**< The window read from the source. */
+  bool input_source_ended_ = false; /**< If the source has no more data. */
+  std::string_view buffer_;       /**< The buffer being processed. */
+  StructuralIndex index_;         /**< The bitmaps of the buffer. */
+  size_t window_offset_ = 0;      /**< Offset of the buffer in the input. */
+  size_t position_ = 0;           /**< The position of the current character. */
+  size_t discard_position_ = 0;   /**< Everything before it can be dropped. */
+  size_t line_number_ = 1;        /**< The current line number in the buffer. */
+  bool has_reached_end_ = false;  /**< If the end of the input was reached. */
+  BodyLimits body_limits_;        /**< The limits on the size of the bodies. */
+  std::optional<InputLocation> unfinished_skip_; /**< Where the skipping of
+                                                      lines should continue. */
+  std::optional<BodySearch> body_search_; /**< How far the last search for a
+                                               body went. */
+
+  /**
+    * @brief Reads more data from the input source into the window, dropping
+    * the data before the discard position.
+    * @return true if any data was read, false otherwise.
+    */
+  bool Refill();
+
+  /**
+    * @brief Advances until the first character selected by the selector,
+    * keeping track of the line number and refilling the window if needed.
+    * @param selector Callable that receives the BlockMasks of a block and
+    * returns a bitmap with the characters where the scan should stop.
+    * @param limit The input position where the scan stops if nothing was
+    * found, no more input is read after it.
+    */
+  template <typename Selector>
+  void AdvanceUntil(Selector selector, size_t limit = kNoLimit) {
+    while (true) {
+      const auto end = limit - std::min(limit, window_offset_);
+      auto [position, newlines] = index_.Find(position_, selector, end);
+      position_ = position;
+      line_number_ += newlines;
+      if (position_ < buffer_.size() || position_ >= end) {
+        return;
+      }
+      if (!Refill()) {
+        has_reached_end_ = true;
+        return;
+      }
+    }
+  }
+
+  /**
+    * @brief Advances the current character, keeping track of the line number.
+    * @pre The buffer must not have ended.
+    */
+  void AdvanceCurrentCharacter() {
+    if (buffer_[position_] == '\n') {
+      ++line_number_;
+    }
+    ++position_;
+  }
+
+  /**
+    * @brief Checks if the buffer has ended, refilling the window if needed.
+    * @return true if the buffer has ended, false otherwise.
+    */
+  bool HasBufferEnded() {
+    if (position_ < buffer_.size() || Refill()) {
+      return false;
+    }
+    has_reached_end_ = true;
+    return true;
+  }
+
+  /**
+    * @brief Retrieves the current character.
+    * @return The current character.
+    * @pre The buffer must not have ended.
+    */
+  char CurrentCharacter() const { return buffer_[position_]; }
+
+  /**
+    * @brief Retrieves the current position relative to the beginning of the
+    * input, which unlike position_ is not changed by a refill.
+    * @return The current position in the input.
+    */
+  size_t InputPosition() const { return window_offset_ + position_; }
+
+  /**
+    * @brief Creates the range from a start position to the current position.
+    * @param start The start position, as returned by InputPosition().
+    * @return The range from the start to the current position.
+    */
+  FieldRange RangeFrom(size_t start) const {
+    return {start, InputPosition() - start};
+  }
+
+  /**
+    * @brief Skips whitespace characters in the buffer.
+    */
+  void SkipWhitespace();
+
+  /**
+    * @brief Reads characters from the buffer until whitespace is encountered.
+    * @return The position of the characters read.
+    */
+  FieldRange ReadUntilWhitespace();
+
+  /**
+   * @brief Reads characters from the buffer until a closing bracket is found.
+   */
+  void ReadUntilCloseBracket();
+
+  /**
+   * @brief Reads characters from the buffer until a closing bracket is found,
+   * as long as the body stays within the BodyLimits.
+   * @param body_start The input position of the first character of the body.
+   * @param body_line_number The line number of that position.
+   * @return false if the limits were exceeded before a closing bracket.
+   */
+  bool ReadUntilCloseBracketWithinLimits(size_t body_start,
+                                         size_t body_line_number);
+
+  /**
+   * @brief Checks if the rest of the line starts with three continuous strings
+   * and an opening bracket, like the start of a message.
+   * @return true if it does. The position is left somewhere in the line.
+   */
+  bool LooksLikeHeader();
+
+  /**
+   * @brief Reads characters until whitespace or a closing bracket is found.
+   * @return The position of all the content until that character (character
+   * not included).
+   */
+  FieldRange ReadUntilWhitespaceOrCloseBracket();
+
+  /**
+   * @brief Reads whitespace until the end of the line.
+   * @return true if only whitespace was found until the end of the line.
+   */
+  bool ReadOnlyWhitespaceUntilEndOfLine();
+
+  /**
+   * @brief Attempt to read a continuous string or report given error.
+   * @param error_message The error message to report if reading fails.
+   * @return The position of the continuous string read from the buffer, or a
+   * FileEndError if the end of the buffer is reached unexpectedly.
+   */
+  ReadResult<FieldRange> AttemptToReadContinuousString(
+      const std::string_view& error_message);
+
+  /**
+   * @brief Read the buffer until it finds the matching closing bracket.
+   * @param line_number The line number where the search started.
+   * @return The positions of the body and the next id, a FileEndError if
+   * the end of the buffer is reached unexpectedly or a BodyTooLongError if
+   * the body exceeds the limits.
+   * @pre The buffer must be positioned at an opening bracket '['.
+   */
+  ReadResult<std::pair<FieldRange, FieldRange>> SearchForMatchingBrackets(
+      size_t line_number);
+
+  /**
+   * @brief Continues the search of body_search_ from the current position,
+   * updating its resume location as it goes.
+   * @return The result of the search, see SearchForMatchingBrackets().
+   */
+  ReadResult<std::pair<FieldRange, FieldRange>> ContinueBodySearch();
+};
+
+}  // namespace pipelines::log_message_parser::structure
+
+/******************************************************************************
+ * FUNCTION DECLARATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+/**
+ * @brief Attempts to read a structured log message from the buffer.
+ * @param buffer_processor The BufferProcessor instance to read from.
+ * @param errors The collection of parsing errors where any errors will be
+ * stored.
+ * @return The positions of the fields, or nothing if the message is invalid.
+ */
+std::optional<LogMessageFields> AttemptToReadStructureLogMessage(
+    BufferProcessor& buffer_processor, ParseErrors& errors);
+
+/**
+ * @brief Attempts to read a structured log message from the buffer, keeping
+ * how far its body was read in case the end of the input is reached.
+ * @param buffer_processor The BufferProcessor instance to read from.
+ * @param errors The collection of parsing errors where any errors will be
+ * stored.
+ * @param unfinished_message Set to the message if the search for its body
+ * started, see ResumeStructureLogMessage().
+ * @return The positions of the fields, or nothing if the message is invalid.
+ */
+std::optional<LogMessageFields> AttemptToReadStructureLogMessage(
+    BufferProcessor& buffer_processor, ParseErrors& errors,
+    std::optional<UnfinishedMessage>& unfinished_message);
+
+/**
+ * @brief Continues reading a message whose body search reached the end of
+ * the input, after more input was appended.
+ * @param buffer_processor The BufferProcessor instance to read from.
+ * @param errors The collection of parsing errors where any errors will be
+ * stored.
+ * @param unfinished_message The message, updated with how far its body was
+ * read this time.
+ * @return The same result AttemptToReadStructureLogMessage() would give if
+ * it read the message from its start.
+ */
+std::optional<LogMessageFields> ResumeStructureLogMessage(
+    BufferProcessor& buffer_processor, ParseErrors& errors,
+    UnfinishedMessage& unfinished_message);
+
+/**
+  * @brief Advances the buffer until the end of the line. If anything other
+  * than whitespace is found, it will add an error to the error collection.
+  * @param buffer_processor The BufferProcessor instance to read from.
+  * @param errors The collection of parsing errors where any errors will be
+  * stored.
+  */
+void AdvanceUntilEndOfLine(BufferProcessor& buffer_processor,
+                           ParseErrors& errors);
+
+/**
+ * @brief Reads all the structured log messages from the buffer.
+ *
+ * This is the loop shared by all the structure parsers, they only differ in
+ * how the fields of a message are stored.
+ *
+ * @param buffer_processor The BufferProcessor instance to read from.
+ * @param errors The collection of parsing errors where any errors will be
+ * stored.
+ * @param on_message Callable that receives the pipeline ID, ID, encoding, body
+ * and next ID of every valid message, as views that are only valid during the
+ * call.
+ */
+template <typename OnMessage>
+void ProcessLogMessages(BufferProcessor& buffer_processor, ParseErrors& errors,
+                        OnMessage on_message) {
+  while (!buffer_processor.IsDone()) {
+    buffer_processor.DiscardProcessed();
+
+    if (auto fields =
+            AttemptToReadStructureLogMessage(buffer_processor, errors)) {
+      on_message(buffer_processor.View(fields->pipeline_id),
+                 buffer_processor.View(fields->id),
+                 buffer_processor.View(fields->encoding),
+                 buffer_processor.View(fields->body),
+                 buffer_processor.View(fields->next_id));
+    }
+
+    AdvanceUntilEndOfLine(buffer_processor, errors);
+  }
+}
+
+}  // namespace pipelines::log_message_parser::structure
+
+#endif  // COMPONENT_LOG_MESSAGE_PARSER_PRIVATE_BUFFER_PROCESSOR_H_
@@ -0,0 +1,288 @@
+/**
+ * @file chunked_parser.cc
+ * @brief Implementation of the concurrent chunked structure parser.
+ *
+ * The only state the parse loop keeps between two messages is the position
+ * where the next message starts (and its line number, which only depends on
+ * the position). So if the parsing of a chunk, started at a guessed position,
+ * reaches a message start that the parsing of the previous chunks also
+ * reaches, everything it produced from there on is exactly what the
+ * sequential parser would have produced.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include "chunked_parser.h"
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <vector>
+#include "buffer_processor.h"
+
+/******************************************************************************
+ * PRIVATE TYPES
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+/**
+ * @struct ParsedRecord
+ * @brief Where a message started and what it produced.
+ */
+struct ParsedRecord {
+  size_t start{0};         /**< Position of the first character. */
+  size_t first_message{0}; /**< Index of its message in the chunk result. */
+  size_t first_error{0};   /**< Index of its first error in the chunk result. */
+};
+
+/**
+ * @struct ChunkResult
+ * @brief Messages and errors parsed from one chunk.
+ */
+struct ChunkResult {
+  std::vector<ParsedRecord> records; /**< Every message read, in order. */
+  LogMessageViews messages;          /**< The valid messages. */
+  ParseErrors errors;                /**< The errors found. */
+  size_t end{0};      /**< Position where the next message starts. */
+  size_t end_line{1}; /**< Line number of that position. */
+};
+
+}  // namespace pipelines::log_message_parser::structure
+
+/******************************************************************************
+ * PRIVATE HELPER DECLARATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+/**
+ * @brief Splits the buffer in chunks that start at the beginning of a line.
+ * @param buffer The buffer to split.
+ * @param thread_count The maximum number of chunks.
+ * @param minimum_chunk_size The smallest chunk size.
+ * @return The start of every chunk, followed by the size of the buffer.
+ */
+static std::vector<size_t> SplitInChunks(std::string_view buffer,
+                                         size_t thread_count,
+                                         size_t minimum_chunk_size);
+
+/**
+ * @brief Computes the line number where every chunk starts.
+ * @param buffer The buffer that was split.
+ * @param boundaries The chunk boundaries, as returned by SplitInChunks.
+ * @return The line number of the start of every chunk.
+ */
+static std::vector<size_t> CountLines(std::string_view buffer,
+                                      const std::vector<size_t>& boundaries);
+
+/**
+ * @brief Parses the messages that start between the given position and the
+ * end of the chunk. The last message can extend past the end of the chunk.
+ * @param buffer The whole buffer.
+ * @param position The position where the parsing starts.
+ * @param line_number The line number of that position.
+ * @param chunk_end The end of the chunk.
+ * @param known_records If not null, the parsing stops as soon as it reaches
+ * the start of one of these records.
+ * @param body_limits The limits on the size of the message bodies.
+ * @return The messages and errors parsed.
+ */
+static ChunkResult ParseChunk(std::string_view buffer, size_t position,
+                              size_t line_number, size_t chunk_end,
+                              const std::vector<ParsedRecord>* known_records,
+                              BodyLimits body_limits);
+
+/**
+ * @brief Finds the record that starts at the given position.
+ * @param records The records, sorted by start.
+ * @param position The position to look for.
+ * @return The iterator to the record, or the end iterator if there is none.
+ */
+static std::vector<ParsedRecord>::const_iterator FindRecord(
+    const std::vector<ParsedRecord>& records, size_t position);
+
+/**
+ * @brief Appends the messages and errors of a chunk, from the given record on.
+ * @param chunk The chunk result.
+ * @param record The first record to append.
+ * @param messages The collection where the messages are appended.
+ * @param errors The collection where the errors are appended.
+ */
+static void AppendFromRecord(const ChunkResult& chunk,
+                             std::vector<ParsedRecord>::const_iterator record,
+                             LogMessageViews& messages, ParseErrors& errors);
+
+}  // namespace pipelines::log_message_parser::structure
+
+/******************************************************************************
+ * PRIVATE HELPER IMPLEMENTATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+static std::vector<size_t> SplitInChunks(std::string_view buffer,
+                                         size_t thread_count,
+                                         size_t minimum_chunk_size) {
+  auto chunk_count = std::clamp<size_t>(
+      buffer.size() / std::max<size_t>(minimum_chunk_size, 1), 1,
+      std::max<size_t>(thread_count, 1));
+
+  auto boundaries = std::vector<size_t>{0};
+  for (size_t i = 1; i < chunk_count; ++i) {
+    auto target =
+        std::max(i * (buffer.size() / chunk_count), boundaries.back());
+    auto newline = static_cast<const char*>(std::memchr(
+        buffer.data() + target, '\n', buffer.size() - target));
+    if (newline == nullptr) {
+      break;
+    }
+    auto boundary = static_cast<size_t>(newline - buffer.data()) + 1;
+    if (boundary < buffer.size() && boundary > boundaries.back()) {
+      boundaries.push_back(boundary);
+    }
+  }
+  boundaries.push_back(buffer.size());
+  return boundaries;
+}
+
+static std::vector<size_t> CountLines(std::string_view buffer,
+                                      const std::vector<size_t>& boundaries) {
+  auto counts = std::vector<std::future<size_t>>{};
+  for (size_t i = 0; i + 2 < boundaries.size(); ++i) {
+    counts.push_back(std::async(std::launch::async, [&buffer, &boundaries, i] {
+      auto chunk =
+          buffer.substr(boundaries[i], boundaries[i + 1] - boundaries[i]);
+      return static_cast<size_t>(std::ranges::count(chunk, '\n'));
+    }));
+  }
+
+  auto line_numbers = std::vector<size_t>{1};
+  for (auto& count : counts) {
+    line_numbers.push_back(line_numbers.back() + count.get());
+  }
+  return line_numbers;
+}
+
+static ChunkResult ParseChunk(std::string_view buffer, size_t position,
+                              size_t line_number, size_t chunk_end,
+                              const std::vector<ParsedRecord>* known_records,
+                              BodyLimits body_limits) {
+  auto result = ChunkResult{};
+  auto buffer_processor = BufferProcessor{buffer, position, line_number};
+  buffer_processor.set_body_limits(body_limits);
+
+  while (!buffer_processor.IsDone()) {
+    auto start = buffer_processor.position();
+    if (start >= chunk_end ||
+        (known_records != nullptr &&
+         FindRecord(*known_records, start) != known_records->end())) {
+      break;
+    }
+    result.records.push_back(
+        {start, result.messages.size(), result.errors.size()});
+
+    if (auto fields =
+            AttemptToReadStructureLogMessage(buffer_processor, result.errors)) {
+      result.messages.emplace_back(buffer_processor.View(fields->pipeline_id),
+                                   buffer_processor.View(fields->id),
+                                   buffer_processor.View(fields->encoding),
+                                   buffer_processor.View(fields->body),
+                                   buffer_processor.View(fields->next_id));
+    }
+
+    AdvanceUntilEndOfLine(buffer_processor, result.errors);
+  }
+
+  result.end = buffer_processor.position();
+  result.end_line = buffer_processor.line_number();
+  return result;
+}
+
+static std::vector<ParsedRecord>::const_iterator FindRecord(
+    const std::vector<ParsedRecord>& records, size_t position) {
+  auto record = std::ranges::lower_bound(records, position, {},
+                                         &ParsedRecord::start);
+  if (record != records.end() && record->start == position) {
+    return record;
+  }
+  return records.end();
+}
+
+static void AppendFromRecord(const ChunkResult& chunk,
+                             std::vector<ParsedRecord>::const_iterator record,
+                             LogMessageViews& messages, ParseErrors& errors) {
+  if (record == chunk.records.end()) {
+    return;
+  }
+  messages.insert(messages.end(),
+                  chunk.messages.begin() +
+                      static_cast<std::ptrdiff_t>(record->first_message),
+                  chunk.messages.end());
+  errors.insert(
+      errors.end(),
+      chunk.errors.begin() + static_cast<std::ptrdiff_t>(record->first_error),
+      chunk.errors.end());
+}
+
+}  // namespace pipelines::log_message_parser::structure
+
+/******************************************************************************
+ * FUNCTION IMPLEMENTATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+void ParseInChunks(std::string_view buffer, size_t thread_count,
+                   LogMessageViews& messages, ParseErrors& errors,
+                   BodyLimits body_limits, size_t minimum_chunk_size) {
+  const auto boundaries =
+      SplitInChunks(buffer, thread_count, minimum_chunk_size);
+  const auto chunk_count = boundaries.size() - 1;
+  const auto line_numbers = CountLines(buffer, boundaries);
+
+  // Every chunk but the first one guesses that a message starts at its
+  // beginning, the first chunk is parsed by the calling thread
+  auto speculative_chunks = std::vector<std::future<ChunkResult>>{};
+  for (size_t i = 1; i < chunk_count; ++i) {
+    speculative_chunks.push_back(std::async(std::launch::async, [&, i] {
+      return ParseChunk(buffer, boundaries[i], line_numbers[i],
+                        boundaries[i + 1], nullptr, body_limits);
+    }));
+  }
+
+  auto first_chunk =
+      ParseChunk(buffer, 0, 1, boundaries[1], nullptr, body_limits);
+  AppendFromRecord(first_chunk, first_chunk.records.begin(), messages, errors);
+  auto position = first_chunk.end;
+  auto line_number = first_chunk.end_line;
+
+  for (size_t i = 1; i < chunk_count; ++i) {
+    auto chunk = speculative_chunks[i - 1].get();
+    if (position >= boundaries[i + 1]) {
+      // A message of the previous chunks covered this whole chunk
+      continue;
+    }
+
+    auto record = FindRecord(chunk.records, position);
+    if (record == chunk.records.end()) {
+      // The guess was wrong, parse again until the chunk agrees with us
+      auto reparsed = ParseChunk(buffer, position, line_number,
+                                 boundaries[i + 1], &chunk.records,
+                                 body_limits);
+      AppendFromRecord(reparsed, reparsed.records.begin(), messages, errors);
+      position = reparsed.end;
+      line_number = reparsed.end_line;
+      record = FindRecord(chunk.records, position);
+    }
+
+    if (record != chunk.records.end()) {
+      AppendFromRecord(chunk, record, messages, errors);
+      position = chunk.end;
+      line_number = chunk.end_line;
+    }
+  }
+}
+
+}  // namespace pipelines::log_message_parser::structure
@@ -0,0 +1,60 @@
+/**
+ * @file chunked_parser.h
+ * @brief Declares the function that parses a buffer in chunks, concurrently.
+ */
+
+#ifndef COMPONENT_LOG_MESSAGE_PARSER_PRIVATE_CHUNKED_PARSER_H_
+#define COMPONENT_LOG_MESSAGE_PARSER_PRIVATE_CHUNKED_PARSER_H_
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include <cstddef>
+#include <string_view>
+
+#include "log_message_parser/structure.h"
+#include "log_message_parser/structure_view.h"
+
+/******************************************************************************
+ * CONSTANTS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+/// Smallest chunk worth giving to a thread, smaller inputs use fewer threads
+constexpr size_t kMinimumChunkSize = 1024 * 1024;
+
+}  // namespace pipelines::log_message_parser::structure
+
+/******************************************************************************
+ * FUNCTION DECLARATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+/**
+ * @brief Parses the structured log messages of a buffer using several threads.
+ *
+ * The buffer is split in chunks at line boundaries and every chunk is parsed
+ * assuming a message starts at its beginning. Since a body can span several
+ * lines that is not always true, so the chunks are then stitched together in
+ * order: a chunk is only used from the first message where the parsing of
+ * the previous chunks actually stopped, and the part in between is parsed
+ * again. The result is always the same as parsing the buffer sequentially.
+ *
+ * @param buffer The buffer to parse, the messages point into it.
+ * @param thread_count The maximum number of threads to use.
+ * @param messages The collection where the parsed messages are stored.
+ * @param errors The collection where the parsing errors are stored.
+ * @param body_limits The limits on the size of the message bodies.
+ * @param minimum_chunk_size The smallest chunk given to a thread.
+ */
+void ParseInChunks(std::string_view buffer, size_t thread_count,
+                   LogMessageViews& messages, ParseErrors& errors,
+                   BodyLimits body_limits = {},
+                   size_t minimum_chunk_size = kMinimumChunkSize);
+
+}  // namespace pipelines::log_message_parser::structure
+
+#endif  // COMPONENT_LOG_MESSAGE_PARSER_PRIVATE_CHUNKED_PARSER_H_
@@ -1,6 +1,9 @@
 /**
  * @file hex16_body_parser.cc
  * @brief Implementation of the Hex16BodyParser class.
+ *
+ * The whitespace removal, the validation and the decoding are done in a
+ * single pass over the body by DecodeHex, see hex_decoder.h.
  */
 
 /******************************************************************************
@@ -10,12 +13,12 @@
 #include "log_message_parser/hex16_body_parser.h"
 #include "log_message_parser/semantics.h"
 
-#include <algorithm>
-#include <iterator>
-#include <locale>
-#include <ranges>
-#include <sstream>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <utility>
+#include "hex_decoder.h"
 
 /******************************************************************************
  * PRIVATE HELPER DECLARATIONS
@@ -23,46 +26,33 @@
 namespace pipelines::log_message_parser::semantics {
 
 /**
- * @brief Removes all whitespace characters from the given string.
+ * @brief Decodes a hexadecimal body, appending the bytes to a string.
  *
- * @param str The input string.
- * @return A new string with all whitespace characters removed.
+ * @param encoded The hexadecimal body.
+ * @param decoded The string the decoded bytes are appended to.
+ * @return The lengths and the validity of the body, if it's invalid the
+ * string is left as it was.
  */
-static std::string RemoveWhitespace(const std::string& str);
+static HexDecodeResult AppendDecodedHex(std::string_view encoded,
+                                        std::string& decoded);
 
 /**
- * @brief Checks if all characters in the given string are hexadecimal digits.
+ * @brief Decodes a valid hexadecimal body, ignoring its whitespace.
  *
- * @param str The input string.
- * @return true if all characters are hexadecimal digits, false otherwise.
+ * @param encoded The hexadecimal body, validated by Validate().
+ * @param decoded The string the decoded bytes are appended to.
  */
-static bool AreAllCharactersHex(const std::string& str);
+static void DecodeHex16(std::string_view encoded, std::string& decoded);
 
 /**
- * @brief Converts a hexadecimal string to its corresponding byte representation.
+ * @brief Creates the error of an invalid body, the odd length is checked
+ * before the non hexadecimal characters. Only the reason is kept, the
+ * message with the body is built when it's shown.
  *
- * @param str The input hexadecimal string.
- * @return A new string containing the byte representation of the input string.
- */
-static std::string FromHexStr(const std::string& str);
-
-/**
- * @brief Creates an error message for an odd-length hexadecimal string.
- *
- * @param body The original string.
- * @param length The length of the string.
- * @return A formatted error message.
- */
-static std::string CreateOddLengthErrorMessage(const std::string& body,
-                                               size_t length);
-
-/**
- * @brief Creates an error message for a non-hexadecimal string.
- * 
- * @param body The original string.
- * @return A formatted error message.
+ * @param result The result of decoding the string.
+ * @return The error.
  */
-static std::string CreateNonHexErrorMessage(const std::string& body);
+static BodyError CreateError(const HexDecodeResult& result);
 
 }  // namespace pipelines::log_message_parser::semantics
 
@@ -72,43 +62,25 @@ static std::string CreateNonHexErrorMessage(const std::string& body);
 
 namespace pipelines::log_message_parser::semantics {
 
-static std::string RemoveWhitespace(const std::string& str) {
-  std::string result;
-  std::ranges::copy_if(str, std::back_inserter(result),
-                       [](char c) { return !std::isspace(c); });
+static HexDecodeResult AppendDecodedHex(std::string_view encoded,
+                                        std::string& decoded) {
+  const auto initial_size = decoded.size();
+  decoded.resize(initial_size + encoded.size() / 2);
+  auto result = DecodeHex(encoded, decoded.data() + initial_size);
+  decoded.resize(initial_size + (result.is_valid() ? result.decoded_size : 0));
   return result;
 }
 
-static bool AreAllCharactersHex(const std::string& str) {
-  return std::all_of(str.begin(), str.end(),
-                     [](char c) { return std::isxdigit(c); });
+static void DecodeHex16(std::string_view encoded, std::string& decoded) {
+  AppendDecodedHex(encoded, decoded);
 }
 
-static std::string FromHexStr(const std::string& str) {
-  std::string parsed_body;
-  parsed_body.reserve(str.size() / 2);
-  for (size_t i = 0; i < str.size(); i += 2) {
-    auto byte_str = str.substr(i, 2);
-    char byte = static_cast<char>(std::stoi(byte_str, nullptr, 16));
-    parsed_body.push_back(byte);
+static BodyError CreateError(const HexDecodeResult& result) {
+  if ((result.hex_length % 2) != 0) {
+    return BodyError("Hexadecimal string has an odd number of characters",
+                     result.hex_length);
   }
-  return parsed_body;
-}
-
-static std::string CreateOddLengthErrorMessage(const std::string& body,
-                                               size_t length) {
-  std::ostringstream oss;
-  oss << "Hexadecimal string has an odd number of characters: " << length
-      << "\n"
-      << "Original string: " << body;
-  return oss.str();
-}
-
-static std::string CreateNonHexErrorMessage(const std::string& body) {
-  std::ostringstream oss;
-  oss << "Hexadecimal string contains non-hexadecimal characters\n"
-      << "Original string: " << body;
-  return oss.str();
+  return BodyError("Hexadecimal string contains non-hexadecimal characters");
 }
 
 }  // namespace pipelines::log_message_parser::semantics
@@ -120,16 +92,63 @@ static std::string CreateNonHexErrorMessage(const std::string& body) {
 namespace pipelines::log_message_parser::semantics {
 
 std::string Hex16BodyParser::Parse(const std::string& body) const {
-  auto no_whitespace_body = RemoveWhitespace(body);
-  auto hex_length = no_whitespace_body.size();
-  if ((hex_length % 2) != 0) {
-    throw BodyParserError(CreateOddLengthErrorMessage(body, hex_length));
+  auto parsed_body = TryParse(body);
+  if (!parsed_body) {
+    throw parsed_body.error().ToException(body);
+  }
+  return std::move(*parsed_body);
+}
+
+BodyParseResult Hex16BodyParser::TryParse(const std::string& body) const {
+  auto parsed_body = std::string{};
+  if (auto result = AppendDecodedHex(body, parsed_body); !result.is_valid()) {
+    return Unexpected{CreateError(result)};
+  }
+  return parsed_body;
+}
+
+BodyParseIntoResult Hex16BodyParser::ParseInto(std::string_view body,
+                                               std::string& buffer) const {
+  buffer.clear();
+  if (auto result = AppendDecodedHex(body, buffer); !result.is_valid()) {
+    return Unexpected{CreateError(result)};
+  }
+  return std::string_view{buffer};
+}
+
+void Hex16BodyParser::ParseBatch(std::span<const std::string_view> bodies,
+                                 std::string& buffer,
+                                 BodyParseBatchResults& results) const {
+  results.clear();
+  buffer.clear();
+  // Every body decodes to at most half of its size, so with this capacity
+  // the buffer never moves and the views stay valid
+  auto capacity = size_t{0};
+  for (auto body : bodies) {
+    capacity += body.size() / 2;
   }
-  if (!AreAllCharactersHex(no_whitespace_body)) {
-    throw BodyParserError(CreateNonHexErrorMessage(body));
+  buffer.reserve(capacity);
+
+  for (auto body : bodies) {
+    const auto offset = buffer.size();
+    if (auto result = AppendDecodedHex(body, buffer); result.is_valid()) {
+      results.emplace_back(std::string_view{buffer}.substr(offset));
+    } else {
+      results.emplace_back(Unexpected{CreateError(result)});
+    }
   }
+}
 
-  return FromHexStr(no_whitespace_body);
+std::optional<BodyError> Hex16BodyParser::Validate(
+    std::string_view body) const {
+  if (auto result = DecodeHex(body, nullptr); !result.is_valid()) {
+    return CreateError(result);
+  }
+  return std::nullopt;
 }
 
-}  // namespace pipelines::log_message_parser::semantics
\ No newline at end of file
+Body::Decoder Hex16BodyParser::decoder() const {
+  return DecodeHex16;
+}
+
+}  // namespace pipelines::log_message_parser::semantics
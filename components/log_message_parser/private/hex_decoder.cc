@@ -0,0 +1,303 @@
+/**
+ * @file hex_decoder.cc
+ * @brief Implementation of the hexadecimal body decoder and its kernels.
+ *
+ * Every kernel decodes exactly the same bytes, they only differ in the
+ * instructions used. The kernel is chosen once, the first time a body is
+ * decoded, depending on what the running CPU supports.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include "hex_decoder.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define PIPELINES_HEX_SSSE3 1
+#define PIPELINES_HEX_AVX2 1
+#endif
+
+/******************************************************************************
+ * CONSTANTS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::semantics {
+
+/// Value in kHexValues of the characters that aren't hexadecimal digits
+constexpr int8_t kInvalid = -1;
+
+/// Value in kHexValues of the whitespace characters, they are skipped
+constexpr int8_t kWhitespace = -2;
+
+/// Value of every character: the value of a digit, kInvalid or kWhitespace
+constexpr auto kHexValues = [] {
+  auto values = std::array<int8_t, 256>{};
+  values.fill(kInvalid);
+  for (auto c : {' ', '\t', '\n', '\v', '\f', '\r'}) {
+    values[static_cast<unsigned char>(c)] = kWhitespace;
+  }
+  for (int8_t digit = 0; digit < 10; ++digit) {
+    values['0' + digit] = digit;
+  }
+  for (int8_t letter = 0; letter < 6; ++letter) {
+    values['a' + letter] = static_cast<int8_t>(10 + letter);
+    values['A' + letter] = static_cast<int8_t>(10 + letter);
+  }
+  return values;
+}();
+
+}  // namespace pipelines::log_message_parser::semantics
+
+/******************************************************************************
+ * PRIVATE HELPER DECLARATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::semantics {
+
+/**
+ * @brief Selects the fastest kernel supported by the running CPU.
+ * @return The selected kernel, or nullptr if there is none.
+ */
+static HexBlocksKernel SelectKernel();
+
+/**
+ * @brief Counts the characters that aren't whitespace.
+ * @param input The characters.
+ * @param size The number of characters.
+ * @return The number of characters that aren't whitespace.
+ */
+static size_t CountNonWhitespace(const char* input, size_t size);
+
+/**
+ * @brief Validates and decodes a hexadecimal body, with the given kernel for
+ * the blocks made only of hexadecimal digits.
+ * @param kernel The kernel, or nullptr to handle every character one at a
+ * time.
+ * @param encoded The hexadecimal body.
+ * @param output Where the decoded bytes are written, can be null.
+ * @return The lengths and the validity of the body.
+ */
+static HexDecodeResult DecodeHexWith(HexBlocksKernel kernel,
+                                     std::string_view encoded, char* output);
+
+#if defined(PIPELINES_HEX_SSSE3)
+/**
+ * @brief Decodes the leading blocks of hex digits using SSSE3 instructions,
+ * 16 characters at a time.
+ * @param input The characters.
+ * @param size The number of characters.
+ * @param output Where the decoded bytes are written, can be null.
+ * @return The number of characters consumed.
+ */
+static size_t DecodeHexBlocksSsse3(const char* input, size_t size,
+                                   char* output);
+#endif
+
+#if defined(PIPELINES_HEX_AVX2)
+/**
+ * @brief Decodes the leading blocks of hex digits using AVX2 instructions,
+ * 32 characters at a time.
+ * @param input The characters.
+ * @param size The number of characters.
+ * @param output Where the decoded bytes are written, can be null.
+ * @return The number of characters consumed.
+ */
+static size_t DecodeHexBlocksAvx2(const char* input, size_t size,
+                                  char* output);
+#endif
+
+}  // namespace pipelines::log_message_parser::semantics
+
+/******************************************************************************
+ * PRIVATE HELPER IMPLEMENTATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::semantics {
+
+static size_t CountNonWhitespace(const char* input, size_t size) {
+  return static_cast<size_t>(
+      std::count_if(input, input + size, [](char c) {
+        return kHexValues[static_cast<unsigned char>(c)] != kWhitespace;
+      }));
+}
+
+static HexDecodeResult DecodeHexWith(HexBlocksKernel kernel,
+                                     std::string_view encoded, char* output) {
+  auto result = HexDecodeResult{};
+  const auto* input = encoded.data();
+  const auto size = encoded.size();
+  auto high_digit = int8_t{-1};
+
+  auto position = size_t{0};
+  while (position < size) {
+    // The kernels decode whole bytes, so a pending high digit (e.g. "4 F")
+    // has to be completed first
+    if (kernel != nullptr && high_digit < 0) {
+      const auto consumed =
+          kernel(input + position, size - position,
+                 output == nullptr ? nullptr : output + result.decoded_size);
+      position += consumed;
+      result.hex_length += consumed;
+      result.decoded_size += consumed / 2;
+    }
+
+    // The kernel stopped at whitespace, an invalid character or the end, the
+    // characters are handled one at a time until the next byte is decoded
+    while (position < size) {
+      const auto character = static_cast<unsigned char>(input[position++]);
+      const auto value = kHexValues[character];
+      if (value == kWhitespace) {
+        continue;
+      }
+      ++result.hex_length;
+      if (value == kInvalid) {
+        // The error reports the hex length, so the rest is still counted
+        result.are_all_characters_hex = false;
+        result.hex_length +=
+            CountNonWhitespace(input + position, size - position);
+        return result;
+      }
+      if (high_digit < 0) {
+        high_digit = value;
+      } else {
+        if (output != nullptr) {
+          output[result.decoded_size] =
+              static_cast<char>((high_digit << 4) | value);
+        }
+        ++result.decoded_size;
+        high_digit = -1;
+        break;
+      }
+    }
+  }
+  return result;
+}
+
+#if defined(PIPELINES_HEX_SSSE3)
+__attribute__((target("ssse3"))) static size_t DecodeHexBlocksSsse3(
+    const char* input, size_t size, char* output) {
+  const auto zero = _mm_set1_epi8('0');
+  const auto nine = _mm_set1_epi8(9);
+  const auto lower_case = _mm_set1_epi8(0x20);
+  const auto letter_a = _mm_set1_epi8('a');
+  const auto five = _mm_set1_epi8(5);
+  const auto ten = _mm_set1_epi8(10);
+  // Multiplies the high digit of every pair by 16 and adds the low one
+  const auto pair_weights = _mm_set1_epi16(0x0110);
+
+  auto consumed = size_t{0};
+  for (; size - consumed >= 16; consumed += 16) {
+    const auto chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + consumed));
+    // Unsigned range checks, '0' to '9' and 'a' to 'f' after lower casing
+    const auto digit = _mm_sub_epi8(chunk, zero);
+    const auto is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, nine), digit);
+    const auto letter = _mm_sub_epi8(_mm_or_si128(chunk, lower_case), letter_a);
+    const auto is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letter, five), letter);
+    const auto are_hex = static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_or_si128(is_digit, is_letter)));
+    // The whole block is decoded, but only the pairs before the first other
+    // character are consumed, the rest of the output is overwritten later
+    if (output != nullptr) {
+      const auto values =
+          _mm_or_si128(_mm_and_si128(is_digit, digit),
+                       _mm_and_si128(is_letter, _mm_add_epi8(letter, ten)));
+      const auto bytes = _mm_maddubs_epi16(values, pair_weights);
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(output + consumed / 2),
+                       _mm_packus_epi16(bytes, bytes));
+    }
+    if (are_hex != 0xFFFF) {
+      return consumed + (std::countr_one(are_hex) & ~1U);
+    }
+  }
+  return consumed;
+}
+#endif
+
+#if defined(PIPELINES_HEX_AVX2)
+__attribute__((target("avx2"))) static size_t DecodeHexBlocksAvx2(
+    const char* input, size_t size, char* output) {
+  const auto zero = _mm256_set1_epi8('0');
+  const auto nine = _mm256_set1_epi8(9);
+  const auto lower_case = _mm256_set1_epi8(0x20);
+  const auto letter_a = _mm256_set1_epi8('a');
+  const auto five = _mm256_set1_epi8(5);
+  const auto ten = _mm256_set1_epi8(10);
+  // Multiplies the high digit of every pair by 16 and adds the low one
+  const auto pair_weights = _mm256_set1_epi16(0x0110);
+
+  auto consumed = size_t{0};
+  for (; size - consumed >= 32; consumed += 32) {
+    const auto chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + consumed));
+    // Unsigned range checks, '0' to '9' and 'a' to 'f' after lower casing
+    const auto digit = _mm256_sub_epi8(chunk, zero);
+    const auto is_digit =
+        _mm256_cmpeq_epi8(_mm256_min_epu8(digit, nine), digit);
+    const auto letter =
+        _mm256_sub_epi8(_mm256_or_si256(chunk, lower_case), letter_a);
+    const auto is_letter =
+        _mm256_cmpeq_epi8(_mm256_min_epu8(letter, five), letter);
+    const auto are_hex = static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_or_si256(is_digit, is_letter)));
+    // The whole block is decoded, but only the pairs before the first other
+    // character are consumed, the rest of the output is overwritten later
+    if (output != nullptr) {
+      const auto values = _mm256_or_si256(
+          _mm256_and_si256(is_digit, digit),
+          _mm256_and_si256(is_letter, _mm256_add_epi8(letter, ten)));
+      const auto bytes = _mm256_maddubs_epi16(values, pair_weights);
+      // The packing works per 128 bit lane, the two halves are joined after
+      const auto packed = _mm256_permute4x64_epi64(
+          _mm256_packus_epi16(bytes, bytes), 0b00001000);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(output + consumed / 2),
+                       _mm256_castsi256_si128(packed));
+    }
+    if (are_hex != 0xFFFFFFFF) {
+      return consumed + (std::countr_one(are_hex) & ~1U);
+    }
+  }
+  return consumed;
+}
+#endif
+
+static HexBlocksKernel SelectKernel() {
+#if defined(PIPELINES_HEX_AVX2)
+  if (__builtin_cpu_supports("avx2")) {
+    return DecodeHexBlocksAvx2;
+  }
+#endif
+#if defined(PIPELINES_HEX_SSSE3)
+  if (__builtin_cpu_supports("ssse3")) {
+    return DecodeHexBlocksSsse3;
+  }
+#endif
+  return nullptr;
+}
+
+}  // namespace pipelines::log_message_parser::semantics
+
+/******************************************************************************
+ * FUNCTION IMPLEMENTATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::semantics {
+
+HexDecodeResult DecodeHex(std::string_view encoded, char* output) {
+  static const auto kernel = SelectKernel();
+  return DecodeHexWith(kernel, encoded, output);
+}
+
+HexDecodeResult DecodeHexScalar(std::string_view encoded, char* output) {
+  return DecodeHexWith(nullptr, encoded, output);
+}
+
+}  // namespace pipelines::log_message_parser::semantics
@@ -0,0 +1,98 @@
+/**
+ * @file hex_decoder.h
+ * @brief Declares the functions that validate and decode the hexadecimal
+ * bodies.
+ *
+ * A hex body is validated and decoded in a single pass: the input is read in
+ * blocks of 16 or 32 bytes with SIMD instructions (AVX2 or SSSE3, with a
+ * portable fallback), and a block made only of hexadecimal digits is
+ * validated and decoded with a few instructions. When a block has whitespace
+ * or an invalid character, the characters from there are handled one at a
+ * time until the next byte is decoded, and then the kernel takes over again.
+ */
+
+#ifndef COMPONENT_LOG_MESSAGE_PARSER_PRIVATE_HEX_DECODER_H_
+#define COMPONENT_LOG_MESSAGE_PARSER_PRIVATE_HEX_DECODER_H_
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include <cstddef>
+#include <string_view>
+
+/******************************************************************************
+ * TYPE DEFINITIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::semantics {
+
+/**
+ * @struct HexDecodeResult
+ * @brief Result of validating and decoding a hexadecimal body.
+ */
+struct HexDecodeResult {
+  /// Number of characters that are not whitespace, the hex length
+  size_t hex_length{0};
+  /// False if any of those characters isn't a hexadecimal digit
+  bool are_all_characters_hex{true};
+  /// Number of bytes written to the output
+  size_t decoded_size{0};
+
+  /**
+   * @brief Checks if the body was valid, and so completely decoded.
+   * @return true if the hex length is even and all characters are hex.
+   */
+  bool is_valid() const {
+    return are_all_characters_hex && (hex_length % 2) == 0;
+  }
+};
+
+/**
+ * @brief Type of the functions that decode the leading blocks of a body made
+ * only of hexadecimal digits.
+ *
+ * They return the number of characters consumed, an even number, and stop
+ * at the first pair that has any other character. They may write up to a
+ * block of output past the bytes consumed, which is overwritten later. The
+ * output can be null, then the blocks are only validated.
+ */
+using HexBlocksKernel = size_t (*)(const char* input, size_t size,
+                                   char* output);
+
+}  // namespace pipelines::log_message_parser::semantics
+
+/******************************************************************************
+ * FUNCTION DECLARATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::semantics {
+
+/**
+ * @brief Validates and decodes a hexadecimal body, ignoring the whitespace
+ * as defined by std::isspace for the "C" locale.
+ *
+ * The decoding stops at the first invalid character, but the rest of the
+ * body is still scanned to compute the hex length.
+ *
+ * @param encoded The hexadecimal body.
+ * @param output Where the decoded bytes are written, it must have room for
+ * encoded.size() / 2 bytes, the ones after the decoded size are scratch
+ * space. It can be null to only validate the body.
+ * @return The lengths and the validity of the body.
+ */
+HexDecodeResult DecodeHex(std::string_view encoded, char* output);
+
+/**
+ * @brief Same as DecodeHex, but one character at a time, without any SIMD
+ * kernel. It's the reference the kernels are tested against.
+ *
+ * @param encoded The hexadecimal body.
+ * @param output Where the decoded bytes are written, can be null.
+ * @return The lengths and the validity of the body.
+ */
+HexDecodeResult DecodeHexScalar(std::string_view encoded, char* output);
+
+}  // namespace pipelines::log_message_parser::semantics
+
+#endif  // COMPONENT_LOG_MESSAGE_PARSER_PRIVATE_HEX_DECODER_H_
@@ -0,0 +1,545 @@
+/**
+ * @file input_source.cc
+ * @brief Implementation of the input source backends.
+ *
+ * Only the stream backend is portable, the other ones use POSIX calls and
+ * fall back to it on other platforms.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include "log_message_parser/input_source.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define PIPELINES_HAS_POSIX_IO 1
+#endif
+
+/******************************************************************************
+ * CONSTANTS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser {
+
+/// Size of the memory mapped windows, a multiple of any page size
+constexpr size_t kMapWindowSize = 4 * 1024 * 1024;
+
+/// Alignment of the buffers and of the reads done with O_DIRECT
+constexpr size_t kDirectAlignment = 4096;
+
+/// Size of every read done with O_DIRECT, a multiple of the alignment
+constexpr size_t kDirectBlockSize = 1024 * 1024;
+
+}  // namespace pipelines::log_message_parser
+
+/******************************************************************************
+ * PRIVATE CLASSES
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser {
+
+/**
+ * @class FileStreamInputSource
+ * @brief Input source that reads a file with a std::ifstream.
+ */
+class FileStreamInputSource : public InputSource {
+ public:
+  /**
+   * @brief Opens the given file.
+   * @param path The path of the file.
+   * @throws InputSourceError if the file can't be opened.
+   */
+  explicit FileStreamInputSource(const std::string& path)
+      : file_(path), stream_source_(file_) {
+    if (!file_.is_open()) {
+      throw InputSourceError("Error opening file: " + path);
+    }
+  }
+
+  /**
+   * @brief Reads the next block of data from the file.
+   * @param destination Where the data is written to.
+   * @return The number of bytes read, 0 only at the end of the file.
+   */
+  size_t Read(std::span<char> destination) override {
+    return stream_source_.Read(destination);
+  }
+
+ private:
+  std::ifstream file_;              /**< The opened file. */
+  StreamInputSource stream_source_; /**< Reads from the opened file. */
+};
+
+#if defined(PIPELINES_HAS_POSIX_IO)
+
+/**
+ * @class DescriptorInputSource
+ * @brief Input source that reads a file descriptor with read().
+ */
+class DescriptorInputSource : public InputSource {
+ public:
+  /**
+   * @brief Constructs a source over an opened file descriptor.
+   * @param file_descriptor The file descriptor to read from.
+   * @param owned If the file descriptor should be closed by the source.
+   */
+  DescriptorInputSource(int file_descriptor, bool owned)
+      : file_descriptor_(file_descriptor), owned_(owned) {
+#if defined(POSIX_FADV_SEQUENTIAL)
+    // Doubles the read ahead of the kernel, ignored for pipes
+    ::posix_fadvise(file_descriptor_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+  }
+
+  /**
+   * @brief Closes the file descriptor, if it is owned.
+   */
+  ~DescriptorInputSource() override {
+    if (owned_) {
+      ::close(file_descriptor_);
+    }
+  }
+
+  DescriptorInputSource(const DescriptorInputSource&) = delete;
+  DescriptorInputSource& operator=(const DescriptorInputSource&) = delete;
+
+  /**
+   * @brief Reads the next block of data from the file descriptor.
+   * @param destination Where the data is written to.
+   * @return The number of bytes read, 0 only at the end of the file.
+   * @throws InputSourceError if the file can't be read.
+   */
+  size_t Read(std::span<char> destination) override;
+
+ private:
+  int file_descriptor_; /**< The file descriptor to read from. */
+  bool owned_;          /**< If the file descriptor is closed by the source. */
+};
+
+/**
+ * @class MappedWindowInputSource
+ * @brief Input source that maps a regular file one window at a time.
+ *
+ * Only one window is mapped at a time, so the address space used doesn't
+ * depend on the file size, and the kernel is asked to read the next window
+ * ahead while the current one is being consumed.
+ */
+class MappedWindowInputSource : public InputSource {
+ public:
+  /**
+   * @brief Constructs a source over an opened regular file.
+   * @param file_descriptor The file descriptor of the file, closed by the
+   * source.
+   * @param file_size The size of the file.
+   */
+  MappedWindowInputSource(int file_descriptor, size_t file_size)
+      : file_descriptor_(file_descriptor), file_size_(file_size) {}
+
+  /**
+   * @brief Unmaps the current window and closes the file.
+   */
+  ~MappedWindowInputSource() override {
+    Unmap();
+    ::close(file_descriptor_);
+  }
+
+  MappedWindowInputSource(const MappedWindowInputSource&) = delete;
+  MappedWindowInputSource& operator=(const MappedWindowInputSource&) = delete;
+
+  /**
+   * @brief Copies the next block of data from the mapped windows.
+   * @param destination Where the data is written to.
+   * @return The number of bytes read, 0 only at the end of the file.
+   * @throws InputSourceError if a window can't be mapped.
+   */
+  size_t Read(std::span<char> destination) override;
+
+ private:
+  int file_descriptor_;         /**< The file descriptor of the file. */
+  size_t file_size_;            /**< The size of the file. */
+  const char* window_ = nullptr; /**< The mapped window, if any. */
+  size_t window_offset_ = 0;    /**< Offset of the window in the file. */
+  size_t window_size_ = 0;      /**< Size of the mapped window. */
+  size_t position_ = 0;         /**< Next position to read in the window. */
+
+  /**
+   * @brief Unmaps the current window, if any.
+   */
+  void Unmap() {
+    if (window_ != nullptr) {
+      ::munmap(const_cast<char*>(window_), window_size_);
+      window_ = nullptr;
+    }
+  }
+
+  /**
+   * @brief Maps the window that starts at the given offset.
+   * @param offset The offset of the window, a multiple of kMapWindowSize.
+   * @throws InputSourceError if the window can't be mapped.
+   */
+  void MapWindow(size_t offset);
+};
+
+#if defined(O_DIRECT)
+
+/**
+ * @class DirectInputSource
+ * @brief Input source that reads a file with O_DIRECT.
+ *
+ * O_DIRECT requires the buffer, the size and the offset of every read to be
+ * aligned, so the file is read in aligned blocks into an internal buffer and
+ * copied from there.
+ */
+class DirectInputSource : public InputSource {
+ public:
+  /**
+   * @brief Constructs a source over a file opened with O_DIRECT.
+   * @param file_descriptor The file descriptor of the file, closed by the
+   * source.
+   */
+  explicit DirectInputSource(int file_descriptor)
+      : file_descriptor_(file_descriptor),
+        buffer_(static_cast<char*>(
+                    std::aligned_alloc(kDirectAlignment, kDirectBlockSize)),
+                &std::free) {
+    if (buffer_ == nullptr) {
+      ::close(file_descriptor_);
+      throw InputSourceError("Error allocating the O_DIRECT buffer");
+    }
+  }
+
+  /**
+   * @brief Closes the file.
+   */
+  ~DirectInputSource() override { ::close(file_descriptor_); }
+
+  DirectInputSource(const DirectInputSource&) = delete;
+  DirectInputSource& operator=(const DirectInputSource&) = delete;
+
+  /**
+   * @brief Copies the next block of data from the aligned buffer, reading
+   * more from the file when it is empty.
+   * @param destination Where the data is written to.
+   * @return The number of bytes read, 0 only at the end of the file.
+   * @throws InputSourceError if the file can't be read.
+   */
+  size_t Read(std::span<char> destination) override;
+
+ private:
+  int file_descriptor_; /**< The file descriptor of the file. */
+  std::unique_ptr<char, decltype(&std::free)> buffer_; /**< Aligned buffer. */
+  size_t buffer_position_ = 0; /**< Next position to copy from the buffer. */
+  size_t buffer_size_ = 0;     /**< Number of valid bytes in the buffer. */
+};
+
+#endif
+
+#endif
+
+}  // namespace pipelines::log_message_parser
+
+/******************************************************************************
+ * PRIVATE HELPER DECLARATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser {
+
+#if defined(PIPELINES_HAS_POSIX_IO)
+/**
+ * @brief Calls read() until it succeeds or fails with something other than
+ * an interruption.
+ * @param file_descriptor The file descriptor to read from.
+ * @param destination Where the data is written to.
+ * @param size The maximum number of bytes to read.
+ * @return The value returned by read().
+ */
+static ssize_t ReadRetryingInterruptions(int file_descriptor, char* destination,
+                                         size_t size);
+
+/**
+ * @brief Opens a file for reading.
+ * @param path The path of the file.
+ * @param flags Extra flags passed to open().
+ * @return The file descriptor.
+ * @throws InputSourceError if the file can't be opened.
+ */
+static int OpenFile(const std::string& path, int flags);
+
+/**
+ * @brief Opens a file with the mmap backend.
+ * @param path The path of the file.
+ * @return The opened source, or a read() one if the file can't be mapped.
+ */
+static std::unique_ptr<InputSource> OpenMappedFile(const std::string& path);
+
+/**
+ * @brief Opens a file with the O_DIRECT backend.
+ * @param path The path of the file.
+ * @return The opened source, or a read() one if O_DIRECT can't be used.
+ */
+static std::unique_ptr<InputSource> OpenDirectFile(const std::string& path);
+#endif
+
+}  // namespace pipelines::log_message_parser
+
+/******************************************************************************
+ * PRIVATE HELPER IMPLEMENTATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser {
+
+#if defined(PIPELINES_HAS_POSIX_IO)
+
+static ssize_t ReadRetryingInterruptions(int file_descriptor, char* destination,
+                                         size_t size) {
+  auto read = ssize_t{0};
+  do {
+    read = ::read(file_descriptor, destination, size);
+  } while (read < 0 && errno == EINTR);
+  return read;
+}
+
+static int OpenFile(const std::string& path, int flags) {
+  auto file_descriptor = ::open(path.c_str(), O_RDONLY | flags);
+  if (file_descriptor < 0) {
+    throw InputSourceError("Error opening file: " + path);
+  }
+  return file_descriptor;
+}
+
+static std::unique_ptr<InputSource> OpenMappedFile(const std::string& path) {
+  auto file_descriptor = OpenFile(path, 0);
+
+  struct stat file_status {};
+  if (::fstat(file_descriptor, &file_status) == 0 &&
+      S_ISREG(file_status.st_mode) && file_status.st_size > 0) {
+    return std::make_unique<MappedWindowInputSource>(
+        file_descriptor, static_cast<size_t>(file_status.st_size));
+  }
+  // Pipes, character devices and empty files can't be mapped
+  return std::make_unique<DescriptorInputSource>(file_descriptor, true);
+}
+
+static std::unique_ptr<InputSource> OpenDirectFile(const std::string& path) {
+#if defined(O_DIRECT)
+  auto file_descriptor = ::open(path.c_str(), O_RDONLY | O_DIRECT);
+  if (file_descriptor >= 0) {
+    return std::make_unique<DirectInputSource>(file_descriptor);
+  }
+  if (errno != EINVAL) {
+    throw InputSourceError("Error opening file: " + path);
+  }
+  // The file system doesn't support O_DIRECT (e.g. tmpfs)
+#endif
+  return std::make_unique<DescriptorInputSource>(OpenFile(path, 0), true);
+}
+
+#endif
+
+}  // namespace pipelines::log_message_parser
+
+/******************************************************************************
+ * CLASS METHODS IMPLEMENTATION
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser {
+
+size_t StreamInputSource::Read(std::span<char> destination) {
+  auto* stream_buffer = input_stream_.rdbuf();
+  if (stream_buffer == nullptr) {
+    return 0;
+  }
+  auto read = stream_buffer->sgetn(
+      destination.data(), static_cast<std::streamsize>(destination.size()));
+  return read > 0 ? static_cast<size_t>(read) : 0;
+}
+
+#if defined(PIPELINES_HAS_POSIX_IO)
+
+size_t DescriptorInputSource::Read(std::span<char> destination) {
+  auto read = ReadRetryingInterruptions(file_descriptor_, destination.data(),
+                                        destination.size());
+  if (read < 0) {
+    throw InputSourceError(std::string("Error reading input: ") +
+                           std::strerror(errno));
+  }
+  return static_cast<size_t>(read);
+}
+
+void MappedWindowInputSource::MapWindow(size_t offset) {
+  Unmap();
+  window_offset_ = offset;
+  window_size_ = std::min(kMapWindowSize, file_size_ - offset);
+  position_ = 0;
+
+  auto* mapping = ::mmap(nullptr, window_size_, PROT_READ, MAP_PRIVATE,
+                         file_descriptor_, static_cast<off_t>(offset));
+  if (mapping == MAP_FAILED) {
+    throw InputSourceError(std::string("Error mapping input: ") +
+                           std::strerror(errno));
+  }
+  ::madvise(mapping, window_size_, MADV_SEQUENTIAL);
+  ::madvise(mapping, window_size_, MADV_WILLNEED);
+  window_ = static_cast<const char*>(mapping);
+
+#if defined(POSIX_FADV_WILLNEED)
+  // Starts reading the next window while this one is consumed
+  auto next_offset = offset + window_size_;
+  if (next_offset < file_size_) {
+    ::posix_fadvise(file_descriptor_, static_cast<off_t>(next_offset),
+                    static_cast<off_t>(kMapWindowSize), POSIX_FADV_WILLNEED);
+  }
+#endif
+}
+
+size_t MappedWindowInputSource::Read(std::span<char> destination) {
+  if (window_ == nullptr || position_ == window_size_) {
+    auto next_offset = window_ == nullptr ? 0 : window_offset_ + window_size_;
+    if (next_offset >= file_size_) {
+      Unmap();
+      return 0;
+    }
+    MapWindow(next_offset);
+  }
+
+  auto size = std::min(destination.size(), window_size_ - position_);
+  std::memcpy(destination.data(), window_ + position_, size);
+  position_ += size;
+  return size;
+}
+
+#if defined(O_DIRECT)
+
+size_t DirectInputSource::Read(std::span<char> destination) {
+  if (buffer_position_ == buffer_size_) {
+    auto read = ReadRetryingInterruptions(file_descriptor_, buffer_.get(),
+                                          kDirectBlockSize);
+    if (read < 0 && errno == EINVAL) {
+      // Some file systems only refuse O_DIRECT on the first read
+      auto flags = ::fcntl(file_descriptor_, F_GETFL);
+      ::fcntl(file_descriptor_, F_SETFL, flags & ~O_DIRECT);
+      read = ReadRetryingInterruptions(file_descriptor_, buffer_.get(),
+                                       kDirectBlockSize);
+    }
+    if (read < 0) {
+      throw InputSourceError(std::string("Error reading input: ") +
+                             std::strerror(errno));
+    }
+    buffer_position_ = 0;
+    buffer_size_ = static_cast<size_t>(read);
+  }
+
+  auto size = std::min(destination.size(), buffer_size_ - buffer_position_);
+  std::memcpy(destination.data(), buffer_.get() + buffer_position_, size);
+  buffer_position_ += size;
+  return size;
+}
+
+#endif
+
+#endif
+
+FollowedFile::FollowedFile(const std::string& path) : path_(path) { Open(); }
+
+size_t FollowedFile::Read(std::span<char> destination) {
+  auto read = source_->Read(destination);
+  offset_ += read;
+  return read;
+}
+
+bool FollowedFile::ReopenIfReplaced() {
+  auto status = StatusOfPath();
+  if (!status) {
+    // The file is being rotated, the new one will be checked the next time
+    return false;
+  }
+  if (status->device == opened_file_.device &&
+      status->inode == opened_file_.inode && status->size >= offset_) {
+    return false;
+  }
+  Open();
+  return true;
+}
+
+void FollowedFile::Open() {
+#if defined(PIPELINES_HAS_POSIX_IO)
+  auto file_descriptor = OpenFile(path_, 0);
+  struct stat file_status {};
+  ::fstat(file_descriptor, &file_status);
+  opened_file_ = {static_cast<uint64_t>(file_status.st_dev),
+                  static_cast<uint64_t>(file_status.st_ino),
+                  static_cast<uint64_t>(file_status.st_size)};
+  source_ = std::make_unique<DescriptorInputSource>(file_descriptor, true);
+#else
+  // Without file identities, only truncations can be detected
+  source_ = std::make_unique<FileStreamInputSource>(path_);
+  opened_file_ = {};
+#endif
+  offset_ = 0;
+}
+
+std::optional<FollowedFile::FileStatus> FollowedFile::StatusOfPath() const {
+#if defined(PIPELINES_HAS_POSIX_IO)
+  struct stat file_status {};
+  if (::stat(path_.c_str(), &file_status) != 0) {
+    return std::nullopt;
+  }
+  return FileStatus{static_cast<uint64_t>(file_status.st_dev),
+                    static_cast<uint64_t>(file_status.st_ino),
+                    static_cast<uint64_t>(file_status.st_size)};
+#else
+  auto error = std::error_code{};
+  auto size = std::filesystem::file_size(path_, error);
+  if (error) {
+    return std::nullopt;
+  }
+  return FileStatus{0, 0, static_cast<uint64_t>(size)};
+#endif
+}
+
+}  // namespace pipelines::log_message_parser
+
+/******************************************************************************
+ * FUNCTION IMPLEMENTATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser {
+
+std::unique_ptr<InputSource> OpenInputSource(const std::string& path,
+                                             InputMode mode) {
+#if defined(PIPELINES_HAS_POSIX_IO)
+  switch (mode) {
+    case InputMode::kStream:
+      return std::make_unique<FileStreamInputSource>(path);
+    case InputMode::kRead:
+      return std::make_unique<DescriptorInputSource>(OpenFile(path, 0), true);
+    case InputMode::kMemoryMap:
+      return OpenMappedFile(path);
+    case InputMode::kDirect:
+      return OpenDirectFile(path);
+    case InputMode::kStdin:
+      return std::make_unique<DescriptorInputSource>(STDIN_FILENO, false);
+  }
+  return std::make_unique<FileStreamInputSource>(path);
+#else
+  if (mode == InputMode::kStdin) {
+    return std::make_unique<StreamInputSource>(std::cin);
+  }
+  return std::make_unique<FileStreamInputSource>(path);
+#endif
+}
+
+}  // namespace pipelines::log_message_parser
@@ -0,0 +1,114 @@
+/**
+ * @file mapped_file.cc
+ * @brief Implementation of the MappedFile class.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include "log_message_parser/mapped_file.h"
+
+#include <fstream>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define PIPELINES_HAS_MMAP 1
+#endif
+
+/******************************************************************************
+ * PRIVATE HELPER DECLARATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser {
+
+/**
+ * @brief Reads the whole file into memory.
+ * @param path The path of the file to read.
+ * @return The contents of the file.
+ * @throws MappedFileError if the file cannot be opened.
+ */
+static std::vector<char> ReadWholeFile(const std::string& path);
+
+}  // namespace pipelines::log_message_parser
+
+/******************************************************************************
+ * PRIVATE HELPER IMPLEMENTATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser {
+
+static std::vector<char> ReadWholeFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    throw MappedFileError("Error opening file: " + path);
+  }
+  return {std::istreambuf_iterator<char>(file),
+          std::istreambuf_iterator<char>()};
+}
+
+}  // namespace pipelines::log_message_parser
+
+/******************************************************************************
+ * PUBLIC CLASS METHODS IMPLEMENTATION
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser {
+
+#if defined(PIPELINES_HAS_MMAP)
+
+MappedFile::MappedFile(const std::string& path) {
+  auto file_descriptor = ::open(path.c_str(), O_RDONLY);
+  if (file_descriptor < 0) {
+    throw MappedFileError("Error opening file: " + path);
+  }
+
+  struct stat file_status {};
+  if (::fstat(file_descriptor, &file_status) != 0) {
+    ::close(file_descriptor);
+    throw MappedFileError("Error reading the size of file: " + path);
+  }
+
+  size_ = static_cast<size_t>(file_status.st_size);
+  if (S_ISREG(file_status.st_mode) && size_ > 0) {
+    auto* mapping =
+        ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+    if (mapping != MAP_FAILED) {
+      ::madvise(mapping, size_, MADV_SEQUENTIAL);
+      data_ = static_cast<const char*>(mapping);
+      mapped_ = true;
+    }
+  }
+  ::close(file_descriptor);
+
+  // Pipes, character devices and empty files can't be mapped
+  if (!mapped_) {
+    contents_ = ReadWholeFile(path);
+    data_ = contents_.data();
+    size_ = contents_.size();
+  }
+}
+
+MappedFile::~MappedFile() {
+  if (mapped_) {
+    ::munmap(const_cast<char*>(data_), size_);
+  }
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path)
+    : contents_(ReadWholeFile(path)) {
+  data_ = contents_.data();
+  size_ = contents_.size();
+}
+
+MappedFile::~MappedFile() = default;
+
+#endif
+
+}  // namespace pipelines::log_message_parser
@@ -0,0 +1,173 @@
+/**
+ * @file pipeline_partitions.cc
+ * @brief Implementation of the PipelinePartitions class.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include "log_message_parser/pipeline_partitions.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <ios>
+#include <memory>
+#include <random>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include "log_message_parser/field_arena.h"
+
+/******************************************************************************
+ * PRIVATE HELPER DECLARATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser {
+
+/**
+ * @brief Opens a partition file, empty, to be written and read back.
+ * @param partition Replaced by the open partition file.
+ * @param path The path of the partition file.
+ * @throws PipelinePartitionsError if the file cannot be created.
+ */
+static void OpenPartition(std::fstream& partition,
+                          const std::filesystem::path& path);
+
+}  // namespace pipelines::log_message_parser
+
+/******************************************************************************
+ * PRIVATE HELPER IMPLEMENTATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser {
+
+static void OpenPartition(std::fstream& partition,
+                          const std::filesystem::path& path) {
+  partition.close();
+  partition.open(path, std::ios::in | std::ios::out | std::ios::binary |
+                           std::ios::trunc);
+  if (!partition.is_open()) {
+    throw PipelinePartitionsError("Error creating the partition file: " +
+                                  path.string());
+  }
+}
+
+}  // namespace pipelines::log_message_parser
+
+/******************************************************************************
+ * PRIVATE CLASS METHODS IMPLEMENTATION
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser {
+
+size_t PipelinePartitions::PartitionOf(std::string_view pipeline_id) const {
+  return std::hash<std::string_view>{}(pipeline_id) % partitions_.size();
+}
+
+}  // namespace pipelines::log_message_parser
+
+/******************************************************************************
+ * PUBLIC CLASS METHODS IMPLEMENTATION
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser {
+
+PipelinePartitions::PipelinePartitions(
+    const std::filesystem::path& spill_directory, size_t partition_count)
+    : partitions_(std::max<size_t>(partition_count, 1)),
+      partition_bytes_(partitions_.size(), 0) {
+  // Several instances can share the directory
+  auto random = std::random_device{};
+  const auto name = "pipelines_" + std::to_string(random()) + "_" +
+                    std::to_string(random()) + "_partition_";
+  for (size_t partition = 0; partition < partitions_.size(); ++partition) {
+    const auto& path = paths_.emplace_back(
+        spill_directory / (name + std::to_string(partition)));
+    OpenPartition(partitions_[partition], path);
+  }
+}
+
+PipelinePartitions::~PipelinePartitions() {
+  partitions_.clear();
+  auto error = std::error_code{};
+  for (const auto& path : paths_) {
+    std::filesystem::remove(path, error);
+  }
+}
+
+void PipelinePartitions::Add(const structure::LogMessage& message) {
+  static_assert(std::is_trivially_copyable_v<RecordHeader>);
+
+  const auto partition_number = PartitionOf(message.pipeline_id());
+  auto& partition = partitions_[partition_number];
+  const auto header = RecordHeader{
+      static_cast<uint32_t>(message.pipeline_id().size()),
+      static_cast<uint32_t>(message.id().size()),
+      static_cast<uint32_t>(message.encoding().size()),
+      static_cast<uint32_t>(message.next_id().size()),
+      message.body().size()};
+  partition.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  partition_bytes_[partition_number] += sizeof(header);
+  for (auto field : {message.pipeline_id(), message.id(), message.encoding(),
+                     message.body(), message.next_id()}) {
+    partition.write(field.data(), static_cast<std::streamsize>(field.size()));
+    partition_bytes_[partition_number] += field.size();
+  }
+  if (!partition) {
+    throw PipelinePartitionsError("Error writing the partition file: " +
+                                  paths_[partition_number].string());
+  }
+  ++size_;
+}
+
+structure::LogMessages PipelinePartitions::Read(size_t partition) {
+  auto& partition_file = partitions_[partition];
+  const auto& path = paths_[partition];
+
+  partition_file.flush();
+  auto buffer = std::string(std::filesystem::file_size(path), '\0');
+  partition_file.seekg(0);
+  if (!partition_file.read(buffer.data(),
+                           static_cast<std::streamsize>(buffer.size()))) {
+    throw PipelinePartitionsError("Error reading the partition file: " +
+                                  path.string());
+  }
+  // The messages of the partition are read, so it starts empty again
+  OpenPartition(partition_file, path);
+  partition_bytes_[partition] = 0;
+
+  // The fields are views into the partition, kept alive by the arena
+  auto arena = std::make_shared<structure::FieldArena>();
+  auto records = arena->Adopt(std::move(buffer));
+  auto messages = structure::LogMessages{};
+  while (!records.empty()) {
+    auto header = RecordHeader{};
+    if (records.size() < sizeof(header)) {
+      throw PipelinePartitionsError("Truncated partition file: " +
+                                    path.string());
+    }
+    std::memcpy(&header, records.data(), sizeof(header));
+    records.remove_prefix(sizeof(header));
+    auto next_field = [&](uint64_t size) {
+      if (records.size() < size) {
+        throw PipelinePartitionsError("Truncated partition file: " +
+                                      path.string());
+      }
+      auto field = records.substr(0, size);
+      records.remove_prefix(size);
+      return field;
+    };
+    auto pipeline_id = next_field(header.pipeline_id_size);
+    auto id = next_field(header.id_size);
+    auto encoding = next_field(header.encoding_size);
+    auto body = next_field(header.body_size);
+    auto next_id = next_field(header.next_id_size);
+    messages.emplace_back(arena, pipeline_id, id, encoding, body, next_id);
+  }
+  return messages;
+}
+
+}  // namespace pipelines::log_message_parser
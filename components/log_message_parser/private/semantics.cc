@@ -15,61 +15,100 @@
 #include "log_message_parser/semantics.h"
 #include "log_message_parser/structure.h"
 
-#include <sstream>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "log_message_parser/body_batches.h"
 
 /******************************************************************************
- * PRIVATE HELPER DECLARATIONS
+ * PRIVATE CLASSES
  *****************************************************************************/
 
 namespace pipelines::log_message_parser::semantics {
-/**
-   * @brief Create an error message when a body is not successfully parsed.
-   * 
-   * @param structure_message The structure message that failed to parse.
-   * @param encoding The encoding used for parsing.
-   * @param error The error encountered during parsing.
-   * @return A formatted error message.
-   */
-static std::string CreateBodyParseErrorMessage(
-    const structure::LogMessage& structure_message, const std::string& encoding,
-    const BodyParserError& error);
 
 /**
- * @brief Create an error message when an encoding is not supported.
+ * @class RegisteredBodyParsers
+ * @brief The registry of the body parsers registered at runtime, see
+ * ParseInBatches.
  *
- * @param structure_message The structure message that failed to parse.
- * @param encoding The encoding used for parsing.
- * @return A formatted error message.
+ * The encodings are few, so they are compared one by one instead of searching
+ * the map.
  */
-static std::string CreateUnsupportedEncodingErrorMessage(
-    const structure::LogMessage& structure_message,
-    const std::string& encoding);
+class RegisteredBodyParsers {
+ public:
+  /**
+   * @brief Constructs the registry of the registered body parsers.
+   * @param body_parsers The map of the registered body parsers.
+   */
+  template <typename BodyParserMap>
+  explicit RegisteredBodyParsers(const BodyParserMap& body_parsers) {
+    for (const auto& [encoding, body_parser] : body_parsers) {
+      encodings_.emplace_back(encoding);
+      body_parsers_.push_back(body_parser.get());
+    }
+  }
 
-}  // namespace pipelines::log_message_parser::semantics
+  /**
+   * @brief Retrieves the number of body parsers.
+   * @return The number of body parsers.
+   */
+  size_t size() const { return body_parsers_.size(); }
 
-/******************************************************************************
- * PRIVATE HELPER IMPLEMENTATION
- *****************************************************************************/
+  /**
+   * @brief Finds the body parser of an encoding.
+   * @param encoding The encoding of a message.
+   * @return The number of the body parser, or kNoBatch if there is none.
+   */
+  size_t Find(std::string_view encoding) const {
+    for (size_t body_parser = 0; body_parser < encodings_.size();
+         ++body_parser) {
+      if (encodings_[body_parser] == encoding) {
+        return body_parser;
+      }
+    }
+    return kNoBatch;
+  }
 
-namespace pipelines::log_message_parser::semantics {
+  /**
+   * @brief Parses a batch of bodies, see BodyParser::ParseBatch.
+   * @param body_parser The number of the body parser.
+   * @param bodies The bodies to parse.
+   * @param buffer The buffer where the parsed bodies may be written.
+   * @param results Replaced by the result of every body.
+   */
+  void ParseBatch(size_t body_parser, std::span<const std::string_view> bodies,
+                  std::string& buffer, BodyParseBatchResults& results) const {
+    body_parsers_[body_parser]->ParseBatch(bodies, buffer, results);
+  }
 
-static std::string CreateBodyParseErrorMessage(
-    const structure::LogMessage& structure_message, const std::string& encoding,
-    const BodyParserError& error) {
-  std::ostringstream oss;
-  oss << "Failed to parse body for log message: \"" << structure_message
-      << "\" with encoding \"" << encoding << "\": " << error.what();
-  return oss.str();
-}
+  /**
+   * @brief Checks a body, see BodyParser::Validate.
+   * @param body_parser The number of the body parser.
+   * @param body The body to check.
+   * @return The error that prevents parsing the body, if any.
+   */
+  std::optional<BodyError> Validate(size_t body_parser,
+                                    std::string_view body) const {
+    return body_parsers_[body_parser]->Validate(body);
+  }
 
-static std::string CreateUnsupportedEncodingErrorMessage(
-    const structure::LogMessage& structure_message,
-    const std::string& encoding) {
-  std::ostringstream oss;
-  oss << "Encoding \"" << encoding << "\" is not supported for log message: \""
-      << structure_message << "\"";
-  return oss.str();
-}
+  /**
+   * @brief Retrieves the decoder of a body parser, see BodyParser::decoder.
+   * @param body_parser The number of the body parser.
+   * @return The decoder, or nullptr if there is none.
+   */
+  Body::Decoder decoder(size_t body_parser) const {
+    return body_parsers_[body_parser]->decoder();
+  }
+
+ private:
+  std::vector<std::string_view> encodings_;     /**< Registered encodings. */
+  std::vector<const BodyParser*> body_parsers_; /**< Their body parsers. */
+};
 
 }  // namespace pipelines::log_message_parser::semantics
 
@@ -81,39 +120,23 @@ namespace pipelines::log_message_parser::semantics {
 
 ParseResult Parser::Parse(
     const structure::LogMessages& structure_log_messages) {
-  auto parsed_messages = LogMessages{};
-  auto errors = ParseErrors{};
-
-  for (const auto& structure_message : structure_log_messages) {
-    const auto& pipeline_id = structure_message.pipeline_id();
-    const auto& id = structure_message.id();
-    const auto& encoding = structure_message.encoding();
-    const auto& body = structure_message.body();
-    const auto& next_id = structure_message.next_id();
-
-    // Check if a body parser is registered for the given encoding.
-    if (auto it = body_parsers_.find(encoding); it != end(body_parsers_)) {
-      try {
-        // Parse the body using the registered parser.
-        auto parsed_body = it->second->Parse(body);
-        parsed_messages.emplace_back(pipeline_id, id, parsed_body, next_id);
-
-      } catch (const BodyParserError& e) {
-        // Handle parsing errors and record them.
-        auto error_message =
-            CreateBodyParseErrorMessage(structure_message, encoding, e);
-        errors.emplace_back(error_message);
-      }
-    } else {
-      // Handle unsupported encoding errors.
-      auto error_message =
-          CreateUnsupportedEncodingErrorMessage(structure_message, encoding);
-      errors.emplace_back(error_message);
-    }
-  }
+  return ParseInBatches(RegisteredBodyParsers{body_parsers_}, body_decoding_,
+                        error_messages_, *symbol_table_,
+                        structure_log_messages, nullptr, thread_count_);
+}
+
+ParseResult Parser::Parse(
+    const structure::LogMessageViews& structure_log_messages,
+    std::shared_ptr<const void> input_owner) {
+  return ParseInBatches(RegisteredBodyParsers{body_parsers_}, body_decoding_,
+                        error_messages_, *symbol_table_,
+                        structure_log_messages, input_owner, thread_count_);
+}
 
-  // Return the result containing parsed messages and errors.
-  return {parsed_messages, errors};
+MessageErrors Parser::Validate(
+    const structure::LogMessages& structure_log_messages) const {
+  return ValidateMessages(RegisteredBodyParsers{body_parsers_},
+                          error_messages_, structure_log_messages);
 }
 
 }  // namespace pipelines::log_message_parser::semantics
@@ -0,0 +1,101 @@
+/**
+ * @file stream_read_error.h
+ * @brief Private error type reported by the BufferProcessor.
+ *
+ * The errors are returned as values and turned into ParseError entries by the
+ * structure parsers, so they never leave the library. Their messages are
+ * string literals, so reporting one costs no more than reading a valid field.
+ */
+
+#ifndef COMPONENT_LOG_MESSAGE_PARSER_PRIVATE_STREAM_READ_ERROR_H_
+#define COMPONENT_LOG_MESSAGE_PARSER_PRIVATE_STREAM_READ_ERROR_H_
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include <cstddef>
+#include <string_view>
+
+#include "log_message_parser/expected.h"
+
+/******************************************************************************
+ * TYPE DEFINITIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+/**
+ * @enum StreamReadErrorKind
+ * @brief The kinds of errors found while reading a structured log message.
+ */
+enum class StreamReadErrorKind {
+  kFileEnd,   /**< The input ended before the message was complete. */
+  kBadFormat, /**< The input doesn't follow the message format. */
+  kBodyTooLong, /**< The body is bigger than the BodyLimits allow. */
+};
+
+/**
+ * @struct StreamReadError
+ * @brief Represents an error encountered while reading from a stream.
+ */
+struct StreamReadError {
+  StreamReadErrorKind kind; /**< The kind of the error. */
+  std::string_view message; /**< The error message, a string literal. */
+  size_t line_number{0};    /**< The line where the error occurred. */
+};
+
+/**
+ * @brief The result of reading a part of a structured log message.
+ * @tparam T The type of what is read.
+ */
+template <typename T>
+using ReadResult = Expected<T, StreamReadError>;
+
+}  // namespace pipelines::log_message_parser::structure
+
+/******************************************************************************
+ * FUNCTION DECLARATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+/**
+ * @brief Creates an error caused by reaching the end of the input unexpectedly.
+ * @param message The error message, a string literal.
+ * @param line_number The line number where the error occurred.
+ * @return The error, ready to be returned as a ReadResult.
+ */
+inline Unexpected<StreamReadError> FileEndError(std::string_view message,
+                                                size_t line_number) {
+  return Unexpected{
+      StreamReadError{StreamReadErrorKind::kFileEnd, message, line_number}};
+}
+
+/**
+ * @brief Creates an error caused by a bad format in the input.
+ * @param message The error message, a string literal.
+ * @param line_number The line number where the error occurred.
+ * @return The error, ready to be returned as a ReadResult.
+ */
+inline Unexpected<StreamReadError> BadFormatError(std::string_view message,
+                                                  size_t line_number) {
+  return Unexpected{
+      StreamReadError{StreamReadErrorKind::kBadFormat, message, line_number}};
+}
+
+/**
+ * @brief Creates an error caused by a body that exceeds the BodyLimits.
+ * @param message The error message, a string literal.
+ * @param line_number The line number where the error occurred.
+ * @return The error, ready to be returned as a ReadResult.
+ */
+inline Unexpected<StreamReadError> BodyTooLongError(std::string_view message,
+                                                    size_t line_number) {
+  return Unexpected{StreamReadError{StreamReadErrorKind::kBodyTooLong, message,
+                                    line_number}};
+}
+
+}  // namespace pipelines::log_message_parser::structure
+
+#endif  // COMPONENT_LOG_MESSAGE_PARSER_PRIVATE_STREAM_READ_ERROR_H_
@@ -0,0 +1,292 @@
+/**
+ * @file structural_index.cc
+ * @brief Implementation of the structural index kernels.
+ *
+ * Every kernel produces exactly the same bitmaps, they only differ in the
+ * instructions used. The kernel is chosen once, the first time a block is
+ * indexed, depending on what the running CPU supports.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include "structural_index.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <immintrin.h>
+#define PIPELINES_INDEX_SSE2 1
+#if defined(__GNUC__) || defined(__clang__)
+#define PIPELINES_INDEX_AVX2 1
+#endif
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define PIPELINES_INDEX_NEON 1
+#endif
+
+/******************************************************************************
+ * CONSTANTS AND TYPEDEFS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+/// Type of the functions that classify a block
+using IndexBlockKernel = BlockMasks (*)(const char*);
+
+/// Byte used to pad the last block, it doesn't belong to any class
+constexpr char kPaddingCharacter = 'x';
+
+}  // namespace pipelines::log_message_parser::structure
+
+/******************************************************************************
+ * PRIVATE HELPER DECLARATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+/**
+ * @brief Selects the fastest kernel supported by the running CPU.
+ * @return The selected kernel.
+ */
+static IndexBlockKernel SelectKernel();
+
+#if defined(PIPELINES_INDEX_SSE2)
+/**
+ * @brief Classifies a block using SSE2 instructions, 16 bytes at a time.
+ * @param block Pointer to exactly kIndexBlockSize bytes.
+ * @return The bitmaps of the block.
+ */
+static BlockMasks IndexBlockSse2(const char* block);
+#endif
+
+#if defined(PIPELINES_INDEX_AVX2)
+/**
+ * @brief Classifies a block using AVX2 instructions, 32 bytes at a time.
+ * @param block Pointer to exactly kIndexBlockSize bytes.
+ * @return The bitmaps of the block.
+ */
+static BlockMasks IndexBlockAvx2(const char* block);
+#endif
+
+#if defined(PIPELINES_INDEX_NEON)
+/**
+ * @brief Classifies a block using NEON instructions, 16 bytes at a time.
+ * @param block Pointer to exactly kIndexBlockSize bytes.
+ * @return The bitmaps of the block.
+ */
+static BlockMasks IndexBlockNeon(const char* block);
+#endif
+
+}  // namespace pipelines::log_message_parser::structure
+
+/******************************************************************************
+ * PRIVATE HELPER IMPLEMENTATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+#if defined(PIPELINES_INDEX_SSE2)
+static BlockMasks IndexBlockSse2(const char* block) {
+  auto masks = BlockMasks{};
+  const auto space = _mm_set1_epi8(' ');
+  const auto tab = _mm_set1_epi8('\t');
+  const auto control_range = _mm_set1_epi8('\r' - '\t');
+  const auto newline = _mm_set1_epi8('\n');
+  const auto carriage_return = _mm_set1_epi8('\r');
+  const auto close_bracket = _mm_set1_epi8(']');
+
+  for (size_t i = 0; i < kIndexBlockSize; i += 16) {
+    const auto chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+    // '\t' to '\r' are contiguous, so one unsigned range check covers them
+    const auto control = _mm_sub_epi8(chunk, tab);
+    const auto is_control =
+        _mm_cmpeq_epi8(_mm_min_epu8(control, control_range), control);
+    const auto is_whitespace =
+        _mm_or_si128(is_control, _mm_cmpeq_epi8(chunk, space));
+    const auto is_newline = _mm_cmpeq_epi8(chunk, newline);
+    const auto is_end_of_line =
+        _mm_or_si128(is_newline, _mm_cmpeq_epi8(chunk, carriage_return));
+
+    auto to_mask = [i](__m128i matches) {
+      return static_cast<uint64_t>(
+                 static_cast<uint16_t>(_mm_movemask_epi8(matches)))
+             << i;
+    };
+    masks.whitespace |= to_mask(is_whitespace);
+    masks.close_bracket |= to_mask(_mm_cmpeq_epi8(chunk, close_bracket));
+    masks.end_of_line |= to_mask(is_end_of_line);
+    masks.newline |= to_mask(is_newline);
+  }
+  return masks;
+}
+#endif
+
+#if defined(PIPELINES_INDEX_AVX2)
+__attribute__((target("avx2"))) static BlockMasks IndexBlockAvx2(
+    const char* block) {
+  auto masks = BlockMasks{};
+  const auto space = _mm256_set1_epi8(' ');
+  const auto tab = _mm256_set1_epi8('\t');
+  const auto control_range = _mm256_set1_epi8('\r' - '\t');
+  const auto newline = _mm256_set1_epi8('\n');
+  const auto carriage_return = _mm256_set1_epi8('\r');
+  const auto close_bracket = _mm256_set1_epi8(']');
+
+  for (size_t i = 0; i < kIndexBlockSize; i += 32) {
+    const auto chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i));
+    // '\t' to '\r' are contiguous, so one unsigned range check covers them
+    const auto control = _mm256_sub_epi8(chunk, tab);
+    const auto is_control =
+        _mm256_cmpeq_epi8(_mm256_min_epu8(control, control_range), control);
+    const auto is_whitespace =
+        _mm256_or_si256(is_control, _mm256_cmpeq_epi8(chunk, space));
+    const auto is_newline = _mm256_cmpeq_epi8(chunk, newline);
+    const auto is_end_of_line =
+        _mm256_or_si256(is_newline, _mm256_cmpeq_epi8(chunk, carriage_return));
+
+    auto to_mask = [i](__m256i matches) __attribute__((target("avx2"))) {
+      return static_cast<uint64_t>(
+                 static_cast<uint32_t>(_mm256_movemask_epi8(matches)))
+             << i;
+    };
+    masks.whitespace |= to_mask(is_whitespace);
+    masks.close_bracket |= to_mask(_mm256_cmpeq_epi8(chunk, close_bracket));
+    masks.end_of_line |= to_mask(is_end_of_line);
+    masks.newline |= to_mask(is_newline);
+  }
+  return masks;
+}
+#endif
+
+#if defined(PIPELINES_INDEX_NEON)
+static BlockMasks IndexBlockNeon(const char* block) {
+  const auto bit_weights = uint8x16_t{1, 2, 4, 8, 16, 32, 64, 128,
+                                      1, 2, 4, 8, 16, 32, 64, 128};
+  // Same reduction as simdjson, folds 4x16 comparison results into 64 bits
+  auto to_mask = [&bit_weights](const std::array<uint8x16_t, 4>& matches) {
+    auto sum0 = vpaddq_u8(vandq_u8(matches[0], bit_weights),
+                          vandq_u8(matches[1], bit_weights));
+    auto sum1 = vpaddq_u8(vandq_u8(matches[2], bit_weights),
+                          vandq_u8(matches[3], bit_weights));
+    sum0 = vpaddq_u8(sum0, sum1);
+    sum0 = vpaddq_u8(sum0, sum0);
+    return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+  };
+
+  auto whitespace = std::array<uint8x16_t, 4>{};
+  auto close_bracket = std::array<uint8x16_t, 4>{};
+  auto end_of_line = std::array<uint8x16_t, 4>{};
+  auto newline = std::array<uint8x16_t, 4>{};
+
+  for (size_t i = 0; i < 4; ++i) {
+    const auto chunk =
+        vld1q_u8(reinterpret_cast<const uint8_t*>(block + (i * 16)));
+    const auto is_control =
+        vcleq_u8(vsubq_u8(chunk, vdupq_n_u8('\t')), vdupq_n_u8('\r' - '\t'));
+    newline[i] = vceqq_u8(chunk, vdupq_n_u8('\n'));
+    whitespace[i] = vorrq_u8(is_control, vceqq_u8(chunk, vdupq_n_u8(' ')));
+    close_bracket[i] = vceqq_u8(chunk, vdupq_n_u8(']'));
+    end_of_line[i] = vorrq_u8(newline[i], vceqq_u8(chunk, vdupq_n_u8('\r')));
+  }
+
+  auto masks = BlockMasks{};
+  masks.whitespace = to_mask(whitespace);
+  masks.close_bracket = to_mask(close_bracket);
+  masks.end_of_line = to_mask(end_of_line);
+  masks.newline = to_mask(newline);
+  return masks;
+}
+#endif
+
+static IndexBlockKernel SelectKernel() {
+#if defined(PIPELINES_INDEX_AVX2)
+  if (__builtin_cpu_supports("avx2")) {
+    return IndexBlockAvx2;
+  }
+#endif
+#if defined(PIPELINES_INDEX_SSE2)
+  return IndexBlockSse2;
+#elif defined(PIPELINES_INDEX_NEON)
+  return IndexBlockNeon;
+#else
+  return IndexBlockScalar;
+#endif
+}
+
+}  // namespace pipelines::log_message_parser::structure
+
+/******************************************************************************
+ * FUNCTION IMPLEMENTATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+BlockMasks IndexBlockScalar(const char* block) {
+  auto masks = BlockMasks{};
+  for (size_t i = 0; i < kIndexBlockSize; ++i) {
+    const auto character = block[i];
+    const auto bit = uint64_t{1} << i;
+    switch (character) {
+      case '\n':
+        masks.newline |= bit;
+        masks.end_of_line |= bit;
+        masks.whitespace |= bit;
+        break;
+      case '\r':
+        masks.end_of_line |= bit;
+        masks.whitespace |= bit;
+        break;
+      case ' ':
+      case '\t':
+      case '\v':
+      case '\f':
+        masks.whitespace |= bit;
+        break;
+      case ']':
+        masks.close_bracket |= bit;
+        break;
+      default:
+        break;
+    }
+  }
+  return masks;
+}
+
+BlockMasks IndexBlock(const char* block) {
+  static const auto kernel = SelectKernel();
+  return kernel(block);
+}
+
+}  // namespace pipelines::log_message_parser::structure
+
+/******************************************************************************
+ * CLASS METHODS IMPLEMENTATION
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+const BlockMasks& StructuralIndex::MasksAt(size_t position) {
+  const auto block = position / kIndexBlockSize;
+  if (block != cached_block_) {
+    const auto block_start = block * kIndexBlockSize;
+    if (buffer_.size() - block_start >= kIndexBlockSize) {
+      cached_masks_ = IndexBlock(buffer_.data() + block_start);
+    } else {
+      // The last block is copied, so the kernels never read past the buffer
+      auto padded_block = std::array<char, kIndexBlockSize>{};
+      padded_block.fill(kPaddingCharacter);
+      std::memcpy(padded_block.data(), buffer_.data() + block_start,
+                  buffer_.size() - block_start);
+      cached_masks_ = IndexBlock(padded_block.data());
+    }
+    cached_block_ = block;
+  }
+  return cached_masks_;
+}
+
+}  // namespace pipelines::log_message_parser::structure
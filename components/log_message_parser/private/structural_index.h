@@ -0,0 +1,185 @@
+/**
+ * @file structural_index.h
+ * @brief Declares the StructuralIndex class, the first stage of the structure
+ * parser.
+ *
+ * The log grammar only cares about a handful of characters: whitespace, the
+ * brackets and the end of the lines. Instead of looking at the input one
+ * character at a time, the first stage classifies 64 bytes at a time with
+ * SIMD instructions (AVX2, SSE2 or NEON, with a portable fallback) and stores
+ * the result as one bitmap per character class. The second stage, the
+ * BufferProcessor, then jumps from one interesting position to the next using
+ * bit scans over those bitmaps.
+ */
+
+#ifndef COMPONENT_LOG_MESSAGE_PARSER_PRIVATE_STRUCTURAL_INDEX_H_
+#define COMPONENT_LOG_MESSAGE_PARSER_PRIVATE_STRUCTURAL_INDEX_H_
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+
+/******************************************************************************
+ * CONSTANTS AND TYPE DEFINITIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+/// Number of bytes classified at once, one bit per byte in every bitmap
+constexpr size_t kIndexBlockSize = 64;
+
+/**
+ * @struct BlockMasks
+ * @brief Bitmaps of the character classes of one block of the input.
+ *
+ * Bit i of every bitmap refers to the byte i of the block.
+ */
+struct BlockMasks {
+  /// Whitespace as defined by std::isspace for the "C" locale
+  uint64_t whitespace{0};
+  /// Closing brackets ']'
+  uint64_t close_bracket{0};
+  /// End of line characters, '\n' and '\r'
+  uint64_t end_of_line{0};
+  /// Newline characters '\n', used to count the lines
+  uint64_t newline{0};
+};
+
+/**
+ * @struct IndexScanResult
+ * @brief Result of a scan over the structural index.
+ */
+struct IndexScanResult {
+  /// Position of the first byte that matched, or the size of the input
+  size_t position{0};
+  /// Number of newlines between the start of the scan and position
+  size_t newlines{0};
+};
+
+}  // namespace pipelines::log_message_parser::structure
+
+/******************************************************************************
+ * FUNCTION DECLARATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+/**
+ * @brief Classifies one block of the input, using the fastest kernel
+ * supported by the running CPU.
+ * @param block Pointer to exactly kIndexBlockSize bytes.
+ * @return The bitmaps of the block.
+ */
+BlockMasks IndexBlock(const char* block);
+
+/**
+ * @brief Classifies one block of the input with the portable kernel.
+ * @param block Pointer to exactly kIndexBlockSize bytes.
+ * @return The bitmaps of the block.
+ * @note Exposed so the SIMD kernels can be checked against it.
+ */
+BlockMasks IndexBlockScalar(const char* block);
+
+}  // namespace pipelines::log_message_parser::structure
+
+/******************************************************************************
+ * CLASSES
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+/**
+ * @class StructuralIndex
+ * @brief Lazily computed structural bitmaps of a buffer.
+ *
+ * The blocks are classified on demand while the parser advances, so the index
+ * never needs more memory than one block, independently of the input size.
+ */
+class StructuralIndex {
+ public:
+  /**
+   * @brief Constructs an index for the given buffer.
+   * @param buffer The buffer to index.
+   */
+  explicit StructuralIndex(std::string_view buffer = {}) : buffer_(buffer) {}
+
+  /**
+   * @brief Points the index to a new buffer, e.g. after it was refilled.
+   * @param buffer The buffer to index.
+   */
+  void Reset(std::string_view buffer) {
+    buffer_ = buffer;
+    cached_block_ = kNoBlock;
+  }
+
+  /**
+   * @brief Finds the first position, at or after the given one, selected by
+   * the selector.
+   * @param position The position where the scan starts.
+   * @param selector Callable that receives the BlockMasks of a block and
+   * returns a bitmap with the bytes where the scan should stop.
+   * @param end The position where the scan stops if nothing was found, it's
+   * clamped to the buffer size.
+   * @return The position found, or the end if there was none, and the number
+   * of newlines skipped on the way.
+   */
+  template <typename Selector>
+  IndexScanResult Find(size_t position, Selector selector,
+                       size_t end = std::numeric_limits<size_t>::max());
+
+  /**
+   * @brief Retrieves the bitmaps of the block that contains the position.
+   * @param position A position inside the buffer.
+   * @return The bitmaps of the block.
+   */
+  const BlockMasks& MasksAt(size_t position);
+
+ private:
+  /// Marker for an empty block cache
+  static constexpr size_t kNoBlock = std::numeric_limits<size_t>::max();
+
+  std::string_view buffer_;          /**< The indexed buffer. */
+  size_t cached_block_ = kNoBlock;   /**< Block whose masks are cached. */
+  BlockMasks cached_masks_{};        /**< Masks of the cached block. */
+};
+
+template <typename Selector>
+IndexScanResult StructuralIndex::Find(size_t position, Selector selector,
+                                      size_t end) {
+  end = std::min(end, buffer_.size());
+  auto newlines = size_t{0};
+  while (position < end) {
+    const auto& masks = MasksAt(position);
+    const auto block_start = position - (position % kIndexBlockSize);
+    const auto from_position = ~uint64_t{0} << (position - block_start);
+    const auto bytes_in_block = std::min(kIndexBlockSize, end - block_start);
+    const auto in_buffer = bytes_in_block == kIndexBlockSize
+                               ? ~uint64_t{0}
+                               : (uint64_t{1} << bytes_in_block) - 1;
+
+    const auto candidates = selector(masks) & from_position & in_buffer;
+    if (candidates != 0) {
+      const auto offset = static_cast<size_t>(std::countr_zero(candidates));
+      const auto before_found = (uint64_t{1} << offset) - 1;
+      newlines += static_cast<size_t>(
+          std::popcount(masks.newline & from_position & before_found));
+      return {block_start + offset, newlines};
+    }
+
+    newlines += static_cast<size_t>(
+        std::popcount(masks.newline & from_position & in_buffer));
+    position = block_start + bytes_in_block;
+  }
+  return {std::max(position, end), newlines};
+}
+
+}  // namespace pipelines::log_message_parser::structure
+
+#endif  // COMPONENT_LOG_MESSAGE_PARSER_PRIVATE_STRUCTURAL_INDEX_H_
@@ -5,10 +5,12 @@
  * which processes log messages from an input stream and extracts relevant
  * information such as pipeline ID, message ID, encoding, body, and next ID.
  * 
- * It uses the StreamProcessor class to read and parse the log messages,
- * handling errors and formatting details. The parser also provides error
- * handling for cases where the input format is invalid or the end of the
- * stream is reached unexpectedly.
+ * It uses the BufferProcessor class over a window that is refilled from the
+ * stream, so the stream is read in large blocks and every field is copied
+ * only once, when the message is complete, into a FieldArena shared by all
+ * the messages of the parse. The error handling is shared with
+ * the zero-copy parser. With more than one thread the stream is read into
+ * memory and parsed in chunks, see chunked_parser.h.
  * 
  */
 
@@ -17,13 +19,12 @@
  *****************************************************************************/
 
 #include "log_message_parser/structure.h"
-#include <algorithm>
-#include <iterator>
-#include <locale>
-#include <ranges>
-#include <sstream>
-#include <stdexcept>
+#include <span>
 #include <string>
+#include <string_view>
+#include <utility>
+#include "buffer_processor.h"
+#include "chunked_parser.h"
 
 /******************************************************************************
  * PRIVATE HELPER DECLARATIONS
@@ -31,303 +32,12 @@
 
 namespace pipelines::log_message_parser::structure {
 
-// Forward declaration of the StreamProcessor class
-class StreamProcessor;
-
-// Private helper function declarations
-/**
- * @brief Trims whitespace on the right from a string.
- * @param str The string to trim.
- * @return A new string with whitespace removed.
- */
-static std::string TrimRight(std::string str);
-
-/**
- * @brief Trims whitespace on the left from a string.
- * @param str The string to trim.
- * @return A new string with whitespace removed.
- * 
- */
-static std::string TrimLeft(std::string str);
-
-/**
- * @brief Trims whitespace from a string.
- * @param str The string to trim.
- * @return A new string with whitespace removed.
- */
-static std::string Trim(std::string str);
-
 /**
- * @brief Attempts to read a structured log message from the stream.
- * @param stream_processor The StreamProcessor instance to read from.
- * @param structure_messages The collection of parsed log message where the message will be stored.
- * @param error The collection of parsing errors where any errors will be stored.
+ * @brief Reads everything that is left in the input source.
+ * @param input_source The input source to read from.
+ * @return The content of the input source.
  */
-static void AttemptToReadStructureLogMessage(StreamProcessor& stream_processor,
-                                             LogMessages& structure_messages,
-                                             ParseErrors& error);
-
-/**
-  * @brief Advances the stream until the end of the line. If anything other than whitespace is found, it will
-  * add an error to the error collection.
-  * @param stream_processor The StreamProcessor instance to read from.
-  * @param error The collection of parsing errors where any errors will be stored.
-  */
-static void AdvanceUntilEndOfLine(StreamProcessor& stream_processor,
-                                  ParseErrors& error);
-
-}  // namespace pipelines::log_message_parser::structure
-
-/******************************************************************************
- * PRIVATE CLASSES
- *****************************************************************************/
-
-namespace pipelines::log_message_parser::structure {
-/**
- * @class StreamReadError
- * @brief Represents an error encountered while reading from a stream.
- *
- * This class encapsulates information about a stream reading error, including
- * the error message and the line number where the error occurred.
- */
-class StreamReadError : public std::runtime_error {
- public:
-  /**
-    * @brief Constructs a StreamReadError with the given message and line number.
-    * @param message The error message.
-    * @param line_number The line number where the error occurred.
-    */
-  StreamReadError(const std::string& message, size_t line_number)
-      : std::runtime_error(message), line_number_(line_number) {}
-
-  /**
-    * @brief Retrieves the line number where the error occurred.
-    * @return The line number as a size_t.
-    */
-  size_t line_number() const { return line_number_; }
-
- private:
-  size_t line_number_ = 0; /**< The line number where the error occurred. */
-};
-
-/**
- * @class FileEndError
- * @brief Represents an error caused by reaching the end of a file unexpectedly.
- *
- * This class extends StreamReadError to provide specific error handling for
- * cases where the end of a file is reached while reading.
- */
-class FileEndError : public StreamReadError {
- public:
-  /**
-    * @brief Constructs a FileEndError with the given message and line number.
-    * @param message The error message.
-    * @param line_number The line number where the error occurred.
-    */
-  FileEndError(const std::string& message, size_t line_number)
-      : StreamReadError(message, line_number) {}
-};
-
-/**
- * @class BadFormatError
- * @brief Represents an error caused by encountering a bad format in the input.
- *
- * This class extends StreamReadError to provide specific error handling for
- * cases where the input format is invalid.
- */
-class BadFormatError : public StreamReadError {
- public:
-  /**
-    * @brief Constructs a BadFormatError with the given message and line number.
-    * @param message The error message.
-    * @param line_number The line number where the error occurred.
-    */
-  BadFormatError(const std::string& message, size_t line_number)
-      : StreamReadError(message, line_number) {}
-};
-
-/**
- * @class StreamProcessor
- * @brief Processes structured log messages from an input stream.
- *
- * This class provides methods for reading and parsing structured log messages
- * from an input stream. It handles whitespace, brackets, and other formatting
- * details to extract the components of a log message.
- */
-class StreamProcessor {
- public:
-  /**
-    * @brief Constructs a StreamProcessor with the given input stream.
-    * @param input_stream The input stream to process.
-    */
-  explicit StreamProcessor(std::istream& input_stream)
-      : current_character_(std::istreambuf_iterator<char>(input_stream)),
-        end_character_(std::istreambuf_iterator<char>()) {}
-
-  /**
-    * @brief Attempts to read the pipeline ID from the stream.
-    * @return The pipeline ID as a string.
-    * @throws FileEndError if the pipeline ID cannot be read.
-    */
-  std::string AttemptToReadPipelineId();
-
-  /**
-    * @brief Attempts to read the ID from the stream.
-    * @return The ID as a string.
-    * @throws FileEndError if the ID cannot be read.
-    */
-  std::string AttemptToReadId();
-
-  /**
-    * @brief Attempts to read the encoding from the stream.
-    * @return The encoding as a string.
-    * @throws FileEndError if the encoding cannot be read.
-    */
-  std::string AttemptToReadEncoding();
-
-  /**
-    * @brief Attempts to read the body from the stream.
-    * @return The body as a string.
-    * @throws FileEndError if the body cannot be read.
-    * @throws BadFormatError if the body format is invalid.
-    */
-  std::pair<std::string, std::string> AttemptToReadBodyAndNextId();
-
-  /**
-    * @brief Attempts to read the next ID from the stream.
-    * @return The next ID as a string.
-    * @throws FileEndError if the next ID cannot be read.
-    */
-  std::string AttemptToReadNextId();
-
-  /**
-    * @brief Reads characters from the stream until the end of the line.
-    * @return A string containing the characters read.
-    */
-  std::string ReadUntilEndOfLine();
-
-  /**
-   * @brief Reads characters from the stream until the character is found.
-   * @param character The character to stop reading at.
-   * @return A string containing all the content until that character (character not included).
-   * @throws FileEndError if the end of the file is reached unexpectedly.
-   */
-  std::string ReadUntilCharacter(char character);
-
-  /**
-   * @brief Reads characters from the stream until whitespace or a specific character is found.
-   * @param character The character to stop reading at.
-   * @return A string containing all the content until that character (character not included).
-   * @throws FileEndError if the end of the file is reached unexpectedly.
-   */
-  std::string ReadUntilWhitespaceOrCharacter(char character);
-
-  /**
-    * @brief Checks if the stream processing is complete.
-    * @return true if the stream has been fully processed, false otherwise.
-    */
-  bool IsDone();
-
-  /**
-    * @brief Retrieves the current line number in the stream.
-    * @return The current line number as a size_t.
-    */
-  size_t line_number() const { return line_number_; }
-
- private:
-  std::istreambuf_iterator<char>
-      current_character_; /**< Iterator for the current character in the stream. */
-  std::istreambuf_iterator<char>
-      end_character_;      /**< Iterator for the end of the stream. */
-  size_t line_number_ = 1; /**< The current line number in the stream. */
-
-  /**
-    * @brief Advances the current character iterator.
-    * 
-    * This method increments the current character iterator and updates the
-    * line number if a newline character is encountered.
-    * It is used to move through the input stream while processing characters.
-    */
-  void AdvanceCurrentCharacter() {
-    if (current_character_ != end_character_) {
-      if (*current_character_ == '\n') {
-        ++line_number_;
-      }
-      ++current_character_;
-    }
-  }
-
-  /**
-    * @brief Checks if the stream has ended.
-    * @return true if the stream has ended, false otherwise.
-    */
-  bool HasStreamEnded() { return current_character_ == end_character_; }
-
-  /**
-    * @brief Checks if the current character is the end of a line.
-    * @return true if the current character is a newline or carriage return, false otherwise.
-    */
-  bool IsEndOfLine() {
-    return *current_character_ == '\n' || *current_character_ == '\r';
-  }
-
-  /**
-    * @brief Checks if the current character is an opening bracket.
-    * @return true if the current character is '[', false otherwise.
-    */
-  bool IsOpenBracket() { return *current_character_ == '['; }
-
-  /**
-    * @brief Checks if the current character is a closing bracket.
-    * @return true if the current character is ']', false otherwise.
-    */
-  bool IsCloseBracket() { return *current_character_ == ']'; }
-
-  /**
-    * @brief Skips whitespace characters in the stream.
-    */
-  void SkipWhitespace() {
-    while (!HasStreamEnded() && std::isspace(*current_character_)) {
-      AdvanceCurrentCharacter();
-    }
-  }
-
-  /**
-    * @brief Reads characters from the stream until whitespace is encountered.
-    * @return A string containing the characters read.
-    */
-  std::string ReadUntilWhitespace();
-
-  /**
-    * @brief Attempts to read a continuous string from the stream.
-    * @return The continuous string read from the stream.
-    * @throws FileEndError if the end of the file is reached unexpectedly.
-    */
-  std::string AttemptToReadContinuousString();
-
-  /**
-   * @brief Attempt to read a continuous string or report given error.
-   * @param error_message The error message to report if reading fails.
-   * @return The continuous string read from the stream.
-   * @throws FileEndError if the end of the file is reached unexpectedly.
-   */
-  std::string AttemptToReadContinuousStringOrThrow(
-      const std::string& error_message);
-
-  /**
-   * @brief Read the stream until it find the a matching number of open and close brackets.
-   * @param line_number The line number where the search started.
-   * @return The body read from the stream.
-   * @throws FileEndError if the end of the file is reached unexpectedly.
-   * @pre The stream must be positioned at an opening bracket '['.
-   */
-  std::pair<std::string, std::string> SearchForMatchingBrackets(
-      size_t line_number);
-
-  std::pair<bool, std::string> ReadOnlyWhitespaceUntilEndOfLine();
-
-  std::string ReadUntilNonWhitespace();
-};
+static std::string ReadWholeInput(InputSource& input_source);
 
 }  // namespace pipelines::log_message_parser::structure
 
@@ -337,233 +47,19 @@ class StreamProcessor {
 
 namespace pipelines::log_message_parser::structure {
 
-static std::string TrimRight(std::string str) {
-  str.erase(std::ranges::find_if(str | std::views::reverse,
-                                 [](char c) { return !std::isspace(c); })
-                .base(),
-            end(str));
-  return str;
-}
+static std::string ReadWholeInput(InputSource& input_source) {
+  constexpr auto kBlockSize = size_t{1024 * 1024};
 
-static std::string TrimLeft(std::string str) {
-  str.erase(begin(str),
-            std::ranges::find_if(str, [](char c) { return !std::isspace(c); }));
-  return str;
-}
-
-static std::string Trim(std::string str) {
-  return TrimLeft(TrimRight(str));
-}
-
-static void AttemptToReadStructureLogMessage(StreamProcessor& stream_processor,
-                                             LogMessages& structure_messages,
-                                             ParseErrors& errors) {
-  try {
-    auto pipeline_id = stream_processor.AttemptToReadPipelineId();
-    auto id = stream_processor.AttemptToReadId();
-    auto encoding = stream_processor.AttemptToReadEncoding();
-    auto [body, next_id] = stream_processor.AttemptToReadBodyAndNextId();
-
-    structure_messages.emplace_back(pipeline_id, id, encoding, body, next_id);
-  } catch (const FileEndError& e) {
-    auto error_message = "File ended while parsing: " + std::string(e.what());
-    errors.emplace_back(error_message, e.line_number());
-  } catch (const BadFormatError& e) {
-    auto error_message = "Bad format: " + std::string(e.what());
-    errors.emplace_back(error_message, e.line_number());
-  }
-}
-
-static void AdvanceUntilEndOfLine(StreamProcessor& stream_processor,
-                                  ParseErrors& errors) {
-  auto line_number = stream_processor.line_number();
-  auto line = stream_processor.ReadUntilEndOfLine();
-
-  line = Trim(line);
-
-  if (!line.empty()) {
-    auto error_message = "There is unparsed data in line " +
-                         std::to_string(line_number) + ": \"" + line + "\"";
-    errors.emplace_back(error_message, line_number);
-  }
-}
-
-}  // namespace pipelines::log_message_parser::structure
-
-/******************************************************************************
- * PRIVATE CLASS METHODS IMPLEMENTATION
- *****************************************************************************/
-
-namespace pipelines::log_message_parser::structure {
-
-std::string StreamProcessor::ReadUntilWhitespace() {
-  auto result = std::ostringstream();
-  while (!HasStreamEnded() && !std::isspace(*current_character_)) {
-    result << *current_character_;
-    AdvanceCurrentCharacter();
-  }
-  return result.str();
-}
-
-std::string StreamProcessor::AttemptToReadContinuousString() {
-  auto line_number = line_number_;
-  SkipWhitespace();
-
-  auto continuous_string = ReadUntilWhitespace();
-
-  if (continuous_string.empty()) {
-    throw FileEndError("File ended while reading continuous string",
-                       line_number);
-  }
-
-  return continuous_string;
-}
-
-std::string StreamProcessor::AttemptToReadContinuousStringOrThrow(
-    const std::string& error_message) {
-  try {
-    return AttemptToReadContinuousString();
-  } catch (const FileEndError& e) {
-    throw FileEndError(error_message, e.line_number());
-  }
-}
-
-std::string StreamProcessor::AttemptToReadPipelineId() {
-  return AttemptToReadContinuousStringOrThrow("Failed to read pipeline ID");
-}
-
-std::string StreamProcessor::AttemptToReadId() {
-  return AttemptToReadContinuousStringOrThrow("Failed to read ID");
-}
-
-std::string StreamProcessor::AttemptToReadEncoding() {
-  return AttemptToReadContinuousStringOrThrow("Failed to read encoding");
-}
-
-std::pair<std::string, std::string>
-StreamProcessor::AttemptToReadBodyAndNextId() {
-  auto body_next_id = std::pair<std::string, std::string>{};
-  auto line_number = line_number_;
-
-  SkipWhitespace();
-
-  if (IsOpenBracket()) {
-    body_next_id = SearchForMatchingBrackets(line_number);
-  } else if (!HasStreamEnded()) {
-    line_number = line_number_;
-    throw BadFormatError("Expected an opening bracket", line_number);
-  } else {
-    throw FileEndError("File ended while parsing body", line_number);
-  }
-
-  return body_next_id;
-}
-
-std::string StreamProcessor::AttemptToReadNextId() {
-  return AttemptToReadContinuousStringOrThrow("Failed to read next ID");
-}
-
-std::string StreamProcessor::ReadUntilEndOfLine() {
-  auto result = std::ostringstream();
-  while (!HasStreamEnded() && !IsEndOfLine()) {
-    result << *current_character_;
-    AdvanceCurrentCharacter();
-  }
-  return result.str();
-}
-
-std::string StreamProcessor::ReadUntilCharacter(char character) {
-  auto result = std::ostringstream();
-  while (!HasStreamEnded() && *current_character_ != character) {
-    result << *current_character_;
-    AdvanceCurrentCharacter();
-  }
-  return result.str();
-}
-
-std::string StreamProcessor::ReadUntilWhitespaceOrCharacter(char character) {
-  auto result = std::ostringstream();
-  while (!HasStreamEnded() && (*current_character_ != character) &&
-         !std::isspace(*current_character_)) {
-    result << *current_character_;
-    AdvanceCurrentCharacter();
-  }
-  return result.str();
-}
-
-std::pair<bool, std::string>
-StreamProcessor::ReadOnlyWhitespaceUntilEndOfLine() {
-  auto result = std::ostringstream();
-  auto valid = true;
-  while (!HasStreamEnded() && !IsEndOfLine()) {
-    if (!std::isspace(*current_character_)) {
-      valid = false;
-      break;
-    }
-    result << *current_character_;
-    AdvanceCurrentCharacter();
-  }
-  return {valid, result.str()};
-}
-
-std::string StreamProcessor::ReadUntilNonWhitespace() {
-  auto result = std::ostringstream();
-  while (!HasStreamEnded() && std::isspace(*current_character_)) {
-    result << *current_character_;
-    AdvanceCurrentCharacter();
-  }
-  return result.str();
-}
-
-bool StreamProcessor::IsDone() {
-  SkipWhitespace();
-  return HasStreamEnded();
-}
-
-std::pair<std::string, std::string> StreamProcessor::SearchForMatchingBrackets(
-    size_t line_number) {
-  auto body = std::ostringstream();
-  auto next_id = std::ostringstream();
-
-  auto found_closing_bracket = false;
-  AdvanceCurrentCharacter();
-  while (!HasStreamEnded() && !found_closing_bracket) {
-    auto content_until_bracket = ReadUntilCharacter(']');
-    if (!HasStreamEnded()) {
-
-      body << content_until_bracket;
-      AdvanceCurrentCharacter();
-      auto whitespace1 = ReadUntilNonWhitespace();
-      auto continous_string = ReadUntilWhitespaceOrCharacter(']');
-      if (*current_character_ == ']') {
-        body << "]";
-        body << whitespace1;
-        body << continous_string;
-      } else {
-        auto [valid, whitespace2] = ReadOnlyWhitespaceUntilEndOfLine();
-        if (valid) {
-          next_id << continous_string;
-          found_closing_bracket = true;
-        } else {
-          body << "]";
-          body << whitespace1;
-          body << continous_string;
-          body << whitespace2;
-        }
-      }
-    }
-  }
-  if (!found_closing_bracket) {
-    throw FileEndError("Expected a closing bracket ", line_number);
-  }
-
-  auto next_id_str = next_id.str();
-
-  if (next_id_str.empty()) {
-    throw FileEndError("Couldn't find next id", line_number);
-  }
-
-  return {body.str(), next_id.str()};
+  auto input = std::string{};
+  auto size = size_t{0};
+  auto read = size_t{0};
+  do {
+    input.resize(size + kBlockSize);
+    read = input_source.Read(std::span<char>{input.data() + size, kBlockSize});
+    size += read;
+  } while (read > 0);
+  input.resize(size);
+  return input;
 }
 
 }  // namespace pipelines::log_message_parser::structure
@@ -577,17 +73,37 @@ namespace pipelines::log_message_parser::structure {
 ParseResult Parser::Parse() {
   auto structure_messages = LogMessages{};
   auto errors = ParseErrors{};
+  auto arena = std::make_shared<FieldArena>();
+
+  if (thread_count_ > 1) {
+    // The chunks need random access, so the whole input is read first, into
+    // the arena, and the messages point into it
+    auto input = arena->Adopt(ReadWholeInput(*input_source_));
+    auto message_views = LogMessageViews{};
+    ParseInChunks(input, thread_count_, message_views, errors, body_limits_);
+
+    structure_messages.reserve(message_views.size());
+    for (const auto& message : message_views) {
+      structure_messages.emplace_back(arena, message.pipeline_id(),
+                                      message.id(), message.encoding(),
+                                      message.body(), message.next_id());
+    }
+  } else {
+    auto add_message = [&structure_messages, &arena](
+                           std::string_view pipeline_id, std::string_view id,
+                           std::string_view encoding, std::string_view body,
+                           std::string_view next_id) {
+      structure_messages.emplace_back(
+          arena, arena->Store(pipeline_id), arena->Store(id),
+          arena->Store(encoding), arena->Store(body), arena->Store(next_id));
+    };
 
-  auto stream_processor = StreamProcessor{input_stream_};
-
-  while (!stream_processor.IsDone()) {
-    AttemptToReadStructureLogMessage(stream_processor, structure_messages,
-                                     errors);
-
-    AdvanceUntilEndOfLine(stream_processor, errors);
+    auto buffer_processor = BufferProcessor{*input_source_};
+    buffer_processor.set_body_limits(body_limits_);
+    ProcessLogMessages(buffer_processor, errors, add_message);
   }
 
-  return {structure_messages, errors};
+  return {std::move(structure_messages), std::move(errors)};
 }
 
-}  // namespace pipelines::log_message_parser::structure
\ No newline at end of file
+}  // namespace pipelines::log_message_parser::structure
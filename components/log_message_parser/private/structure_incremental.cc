@@ -0,0 +1,200 @@
+/**
+ * @file structure_incremental.cc
+ * @brief Implementation of the push based structured log message parser.
+ *
+ * The pending input is parsed as if it was the whole input. A message whose
+ * parsing never looked past the last character of the pending input would be
+ * parsed the same way whatever comes after it, so it's complete. The first
+ * message that looks past it is incomplete, so it and its errors are dropped,
+ * and it's parsed again when more input arrives. If it got to its body, the
+ * search for the end of the body continues where it stopped instead of from
+ * the start of the message, so a big body arriving in many blocks is only
+ * scanned once.
+ *
+ * A body that exceeds the BodyLimits is an error whatever comes after it, so
+ * its error is returned at once, and only the lines being skipped after it
+ * are kept, see BufferProcessor::SkipToNextHeader(). A block without an end
+ * of line completes no message, so it's only parsed once the pending input
+ * has grown by the maximum body size since the last parse. A body that never
+ * reaches an end of line then keeps at most about twice that size, and the
+ * skipped tail after it is dropped as it arrives.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include "log_message_parser/structure_incremental.h"
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include "buffer_processor.h"
+
+/******************************************************************************
+ * PRIVATE HELPER DECLARATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+/**
+ * @brief Checks if a block contains the end of a line.
+ * @param data The block to check.
+ * @return true if the block contains a newline or carriage return.
+ */
+static bool ContainsEndOfLine(std::span<const char> data);
+
+/**
+ * @brief Moves the positions of an unfinished message back, when the input
+ * before it is dropped.
+ * @param message The unfinished message.
+ * @param offset The number of characters dropped before it.
+ * @return The message with its positions moved.
+ */
+static UnfinishedMessage Rebase(UnfinishedMessage message, size_t offset);
+
+}  // namespace pipelines::log_message_parser::structure
+
+/******************************************************************************
+ * PRIVATE HELPER IMPLEMENTATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+static bool ContainsEndOfLine(std::span<const char> data) {
+  return std::ranges::any_of(data, [](char character) {
+    return character == '\n' || character == '\r';
+  });
+}
+
+static UnfinishedMessage Rebase(UnfinishedMessage message, size_t offset) {
+  for (auto* position :
+       {&message.start.position, &message.pipeline_id.offset,
+        &message.id.offset, &message.encoding.offset,
+        &message.body_search.body.position,
+        &message.body_search.resume.position}) {
+    *position -= offset;
+  }
+  return message;
+}
+
+}  // namespace pipelines::log_message_parser::structure
+
+/******************************************************************************
+ * PUBLIC CLASS METHODS IMPLEMENTATION
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+ParseResult IncrementalParser::Feed(std::span<const char> data) {
+  pending_.append(data.data(), data.size());
+
+  // A message is only complete after the end of the line of its next ID. The
+  // last parse looked until the end of the pending input, so that end of line
+  // can only be in the new data. A body over the size limit is an error
+  // without it, so the pending input is also parsed every time it grows by
+  // the limit, which bounds it even if no end of line ever arrives.
+  const auto has_grown_past_body_limit =
+      body_limits_.max_bytes != 0 &&
+      pending_.size() - parsed_size_ > body_limits_.max_bytes;
+  if (!ContainsEndOfLine(data) && !has_grown_past_body_limit) {
+    return {{}, {}};
+  }
+  return ParsePending(false);
+}
+
+ParseResult IncrementalParser::Finish() {
+  auto result = ParsePending(true);
+  pending_.clear();
+  parsed_size_ = 0;
+  line_number_ = 1;
+  is_skipping_lines_ = false;
+  unfinished_message_.reset();
+  return result;
+}
+
+}  // namespace pipelines::log_message_parser::structure
+
+/******************************************************************************
+ * PRIVATE CLASS METHODS IMPLEMENTATION
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+ParseResult IncrementalParser::ParsePending(bool has_input_ended) {
+  auto structure_messages = LogMessages{};
+  auto errors = ParseErrors{};
+  auto arena = std::make_shared<FieldArena>();
+
+  auto buffer_processor = BufferProcessor{pending_, 0, line_number_};
+  buffer_processor.set_body_limits(body_limits_);
+  if (is_skipping_lines_) {
+    buffer_processor.SkipToNextHeader(0, line_number_);
+  }
+
+  auto parsed_position = size_t{0};
+  auto parsed_line_number = line_number_;
+  auto is_message_incomplete = false;
+  auto unfinished_message = std::optional<UnfinishedMessage>{};
+  if (unfinished_message_) {
+    unfinished_message = *unfinished_message_;
+    unfinished_message_.reset();
+  }
+
+  while (!is_message_incomplete && !buffer_processor.unfinished_skip() &&
+         !buffer_processor.IsDone()) {
+    parsed_position = buffer_processor.position();
+    parsed_line_number = buffer_processor.line_number();
+
+    auto first_error = errors.size();
+    auto fields = unfinished_message
+                      ? ResumeStructureLogMessage(buffer_processor, errors,
+                                                  *unfinished_message)
+                      : AttemptToReadStructureLogMessage(
+                            buffer_processor, errors, unfinished_message);
+    AdvanceUntilEndOfLine(buffer_processor, errors);
+
+    is_message_incomplete = !has_input_ended &&
+                            buffer_processor.has_reached_end() &&
+                            !buffer_processor.unfinished_skip();
+    if (is_message_incomplete) {
+      errors.erase(errors.begin() + static_cast<std::ptrdiff_t>(first_error),
+                   errors.end());
+      break;
+    }
+    unfinished_message.reset();
+    if (fields) {
+      // The pending input is dropped below, so the fields are copied
+      structure_messages.emplace_back(
+          arena, arena->Store(buffer_processor.View(fields->pipeline_id)),
+          arena->Store(buffer_processor.View(fields->id)),
+          arena->Store(buffer_processor.View(fields->encoding)),
+          arena->Store(buffer_processor.View(fields->body)),
+          arena->Store(buffer_processor.View(fields->next_id)));
+    }
+  }
+
+  is_skipping_lines_ =
+      !has_input_ended && buffer_processor.unfinished_skip().has_value();
+  if (is_skipping_lines_) {
+    parsed_position = buffer_processor.unfinished_skip()->position;
+    parsed_line_number = buffer_processor.unfinished_skip()->line_number;
+  } else if (!is_message_incomplete) {
+    // Only whitespace is left, it can be dropped as well
+    parsed_position = buffer_processor.position();
+    parsed_line_number = buffer_processor.line_number();
+  } else if (unfinished_message) {
+    // The message is kept relative to the pending input that's left
+    unfinished_message_ = std::make_shared<const UnfinishedMessage>(
+        Rebase(*unfinished_message, parsed_position));
+  }
+
+  pending_.erase(0, parsed_position);
+  parsed_size_ = pending_.size();
+  line_number_ = parsed_line_number;
+  return {std::move(structure_messages), std::move(errors)};
+}
+
+}  // namespace pipelines::log_message_parser::structure
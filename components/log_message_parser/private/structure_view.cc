@@ -0,0 +1,35 @@
+/**
+ * @file structure_view.cc
+ * @brief Implementation of the zero-copy structured log message parser.
+ *
+ * It reads the log messages straight from contiguous memory, keeping views
+ * into it instead of copies, splitting the work between threads if asked to.
+ * The error handling is shared with the stream based parser.
+ */
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include "log_message_parser/structure_view.h"
+#include <string_view>
+#include <utility>
+#include "chunked_parser.h"
+
+/******************************************************************************
+ * PUBLIC CLASS METHODS IMPLEMENTATION
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+ViewParseResult ViewParser::Parse() const {
+  auto structure_messages = LogMessageViews{};
+  auto errors = ParseErrors{};
+
+  ParseInChunks(std::string_view{input_.data(), input_.size()}, thread_count_,
+                structure_messages, errors, body_limits_);
+
+  return {std::move(structure_messages), std::move(errors), mapped_file_};
+}
+
+}  // namespace pipelines::log_message_parser::structure
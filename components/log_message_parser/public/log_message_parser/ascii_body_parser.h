@@ -13,7 +13,10 @@
  * INCLUDES
  *****************************************************************************/
 
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include "log_message_parser/semantics.h"
 
 /******************************************************************************
@@ -40,6 +43,43 @@ class AsciiBodyParser : public BodyParser {
      * @return The parsed body as a string.
      */
   std::string Parse(const std::string& body) const override;
+
+  /**
+   * @brief Parses the given ASCII-encoded body without copying it.
+   *
+   * @param body The ASCII-encoded body to parse.
+   * @param buffer Unused, the body doesn't need any transformation.
+   * @return A view of the body itself.
+   */
+  BodyParseIntoResult ParseInto(std::string_view body,
+                                std::string& buffer) const override;
+
+  /**
+   * @brief Parses a batch of ASCII-encoded bodies without copying them.
+   *
+   * @param bodies The ASCII-encoded bodies to parse.
+   * @param buffer Unused, the bodies don't need any transformation.
+   * @param results The views of the bodies themselves.
+   */
+  void ParseBatch(std::span<const std::string_view> bodies,
+                  std::string& buffer,
+                  BodyParseBatchResults& results) const override;
+
+  /**
+   * @brief Checks the given ASCII-encoded body, any body is valid.
+   *
+   * @param body The ASCII-encoded body to check.
+   * @return Always no error.
+   */
+  std::optional<BodyError> Validate(std::string_view body) const override;
+
+  /**
+   * @brief Retrieves the function that decodes the bodies, it copies them as
+   * they are.
+   *
+   * @return The decoder of ASCII bodies.
+   */
+  Body::Decoder decoder() const override;
 };
 
 }  // namespace pipelines::log_message_parser::semantics
@@ -0,0 +1,426 @@
+/**
+ * @file body_batches.h
+ * @brief Defines the parsing of the bodies in batches, shared by the semantics
+ * parsers.
+ *
+ * The messages are handled in windows: the bodies of a window are grouped by
+ * encoding, each group is parsed with a single call to its body parser, and
+ * then the messages and the errors are created in the original order. The
+ * Parser, with body parsers registered at runtime, and the StaticParser, with
+ * body parsers fixed at compile time, only differ in how an encoding is
+ * mapped to its body parser, which is given by a registry.
+ *
+ * With more than one thread the messages are split in contiguous parts, each
+ * part is parsed by its own thread and the results are concatenated in the
+ * order of the parts, so the result is the same for any number of threads.
+ */
+
+#ifndef COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_BODY_BATCHES_H_
+#define COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_BODY_BATCHES_H_
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cstddef>
+#include <future>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "log_message/symbol.h"
+#include "log_message_parser/semantics.h"
+#include "log_message_parser/structure.h"
+#include "log_message_parser/structure_view.h"
+
+/******************************************************************************
+ * CONSTANTS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::semantics {
+
+/// Number of messages grouped in batches at a time, it bounds the memory of
+/// the batch buffers while still calling each body parser rarely
+constexpr size_t kBatchWindow = 1024;
+
+/// Smallest number of messages worth giving to a thread, fewer messages use
+/// fewer threads
+constexpr size_t kMinMessagesPerThread = 8 * kBatchWindow;
+
+/// Batch index of the messages whose encoding isn't supported
+constexpr size_t kNoBatch = std::numeric_limits<size_t>::max();
+
+}  // namespace pipelines::log_message_parser::semantics
+
+/******************************************************************************
+ * TYPE DEFINITIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::semantics {
+
+/**
+ * @struct BodyBatch
+ * @brief The bodies of one registered encoding in a window of messages.
+ */
+struct BodyBatch {
+  Body::Decoder decoder{nullptr};       /**< Set for the lazy decoding. */
+  std::vector<std::string_view> bodies; /**< The bodies of the window. */
+  BodyParseBatchResults results;        /**< The result of every body. */
+  std::string buffer;                   /**< Where the bodies are parsed. */
+};
+
+/**
+ * @struct BodyLocation
+ * @brief Where the body of a message is in the batches of its window.
+ */
+struct BodyLocation {
+  size_t batch; /**< Index of the batch, kNoBatch if unsupported. */
+  size_t index; /**< Index of the body in the batch. */
+};
+
+}  // namespace pipelines::log_message_parser::semantics
+
+/******************************************************************************
+ * FUNCTION DECLARATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::semantics {
+
+/**
+ * @brief Create an error message when a body is not successfully parsed.
+ *
+ * @param structure_message The structure message that failed to parse.
+ * @param encoding The encoding used for parsing.
+ * @param error The error encountered during parsing.
+ * @return A formatted error message.
+ */
+template <typename StructureLogMessage>
+std::string CreateBodyParseErrorMessage(
+    const StructureLogMessage& structure_message, std::string_view encoding,
+    const BodyError& error);
+
+/**
+ * @brief Create an error message when an encoding is not supported.
+ *
+ * @param structure_message The structure message that failed to parse.
+ * @param encoding The encoding used for parsing.
+ * @return A formatted error message.
+ */
+template <typename StructureLogMessage>
+std::string CreateUnsupportedEncodingErrorMessage(
+    const StructureLogMessage& structure_message, std::string_view encoding);
+
+/**
+ * @brief Gets what keeps the body of a structure message alive.
+ *
+ * @param structure_message The structure message.
+ * @param input_owner Unused, the message keeps its own fields alive.
+ * @return The arena of the message.
+ */
+inline std::shared_ptr<const void> BodyOwner(
+    const structure::LogMessage& structure_message,
+    const std::shared_ptr<const void>& input_owner);
+
+/**
+ * @brief Gets what keeps the body of a structure message view alive.
+ *
+ * @param structure_message The structure message view.
+ * @param input_owner What keeps the viewed input alive.
+ * @return The owner of the input.
+ */
+inline std::shared_ptr<const void> BodyOwner(
+    const structure::LogMessageView& structure_message,
+    const std::shared_ptr<const void>& input_owner);
+
+/**
+ * @brief Parses contiguous structured log messages in windows, appending the
+ * results, see ParseInBatches.
+ *
+ * @param registry The registry of the body parsers.
+ * @param body_decoding When the bodies are decoded.
+ * @param error_messages Whether the errors carry their messages.
+ * @param symbol_table Where the IDs are interned.
+ * @param structure_log_messages The structured log messages to parse.
+ * @param input_owner What keeps the viewed input alive, for lazy bodies.
+ * @param parsed_messages Where the parsed messages are appended.
+ * @param errors Where the errors are appended.
+ */
+template <typename Registry, typename StructureLogMessage>
+void ParseWindows(const Registry& registry, BodyDecoding body_decoding,
+                  ErrorMessages error_messages,
+                  log_message::SymbolTable& symbol_table,
+                  std::span<const StructureLogMessage> structure_log_messages,
+                  const std::shared_ptr<const void>& input_owner,
+                  LogMessages& parsed_messages, ParseErrors& errors);
+
+/**
+ * @brief Parses a collection of structured log messages, owning or views,
+ * with the body parsers of a registry.
+ *
+ * The registry numbers its body parsers from 0 to size() - 1, and provides:
+ * - size(), the number of body parsers;
+ * - Find(encoding), the number of the body parser of an encoding, or
+ *   kNoBatch if it isn't supported;
+ * - ParseBatch(number, bodies, buffer, results), Validate(number, body) and
+ *   decoder(number), which call the same methods of that body parser.
+ *
+ * With more than one thread the registry and its body parsers are used by
+ * all the threads at the same time.
+ *
+ * @param registry The registry of the body parsers.
+ * @param body_decoding When the bodies are decoded.
+ * @param error_messages Whether the errors carry their messages.
+ * @param symbol_table Where the IDs are interned, by all the threads.
+ * @param structure_log_messages The structured log messages to parse.
+ * @param input_owner What keeps the viewed input alive, for lazy bodies.
+ * @param thread_count The maximum number of threads to use.
+ * @return A ParseResult containing the parsed messages and errors.
+ */
+template <typename Registry, typename StructureLogMessages>
+ParseResult ParseInBatches(const Registry& registry, BodyDecoding body_decoding,
+                           ErrorMessages error_messages,
+                           log_message::SymbolTable& symbol_table,
+                           const StructureLogMessages& structure_log_messages,
+                           const std::shared_ptr<const void>& input_owner,
+                           size_t thread_count = 1);
+
+/**
+ * @brief Checks a collection of structured log messages with the body parsers
+ * of a registry, without creating the messages, see ParseInBatches.
+ *
+ * @param registry The registry of the body parsers.
+ * @param error_messages Whether the errors carry their messages.
+ * @param structure_log_messages The structured log messages to check.
+ * @return The error ParseInBatches reports for every message, none for the
+ * ones it parses.
+ */
+template <typename Registry, typename StructureLogMessages>
+MessageErrors ValidateMessages(
+    const Registry& registry, ErrorMessages error_messages,
+    const StructureLogMessages& structure_log_messages);
+
+}  // namespace pipelines::log_message_parser::semantics
+
+/******************************************************************************
+ * FUNCTION IMPLEMENTATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::semantics {
+
+template <typename StructureLogMessage>
+std::string CreateBodyParseErrorMessage(
+    const StructureLogMessage& structure_message, std::string_view encoding,
+    const BodyError& error) {
+  std::ostringstream oss;
+  oss << "Failed to parse body for log message: \"" << structure_message
+      << "\" with encoding \"" << encoding
+      << "\": " << error.Message(structure_message.body());
+  return oss.str();
+}
+
+template <typename StructureLogMessage>
+std::string CreateUnsupportedEncodingErrorMessage(
+    const StructureLogMessage& structure_message, std::string_view encoding) {
+  std::ostringstream oss;
+  oss << "Encoding \"" << encoding << "\" is not supported for log message: \""
+      << structure_message << "\"";
+  return oss.str();
+}
+
+inline std::shared_ptr<const void> BodyOwner(
+    const structure::LogMessage& structure_message,
+    const std::shared_ptr<const void>& /*input_owner*/) {
+  return structure_message.arena();
+}
+
+inline std::shared_ptr<const void> BodyOwner(
+    const structure::LogMessageView& /*structure_message*/,
+    const std::shared_ptr<const void>& input_owner) {
+  return input_owner;
+}
+
+template <typename Registry, typename StructureLogMessage>
+void ParseWindows(const Registry& registry, BodyDecoding body_decoding,
+                  ErrorMessages error_messages,
+                  log_message::SymbolTable& symbol_table,
+                  std::span<const StructureLogMessage> structure_log_messages,
+                  const std::shared_ptr<const void>& input_owner,
+                  LogMessages& parsed_messages, ParseErrors& errors) {
+  // Reused by every window, so parsing a body only allocates the message's own
+  auto batches = std::vector<BodyBatch>(registry.size());
+  auto locations = std::vector<BodyLocation>{};
+  if (body_decoding == BodyDecoding::kLazy) {
+    for (size_t batch = 0; batch < batches.size(); ++batch) {
+      batches[batch].decoder = registry.decoder(batch);
+    }
+  }
+
+  const auto size = structure_log_messages.size();
+  parsed_messages.reserve(parsed_messages.size() + size);
+  for (size_t window = 0; window < size; window += kBatchWindow) {
+    const auto window_end = std::min(size, window + kBatchWindow);
+
+    // Group the bodies by encoding, remembering where each one went
+    locations.clear();
+    for (auto& batch : batches) {
+      batch.bodies.clear();
+    }
+    for (size_t i = window; i < window_end; ++i) {
+      const auto& structure_message = structure_log_messages[i];
+      auto batch = registry.Find(structure_message.encoding());
+      if (batch == kNoBatch) {
+        locations.push_back({kNoBatch, 0});
+        continue;
+      }
+      locations.push_back({batch, batches[batch].bodies.size()});
+      batches[batch].bodies.emplace_back(structure_message.body());
+    }
+
+    // Parse every batch with a single call, the lazy bodies are only
+    // validated when the messages are created
+    for (size_t batch = 0; batch < batches.size(); ++batch) {
+      auto& body_batch = batches[batch];
+      if (body_batch.decoder == nullptr && !body_batch.bodies.empty()) {
+        registry.ParseBatch(batch, body_batch.bodies, body_batch.buffer,
+                            body_batch.results);
+      }
+    }
+
+    // Create the messages and the errors in the original order
+    for (size_t i = window; i < window_end; ++i) {
+      const auto& structure_message = structure_log_messages[i];
+      const auto& pipeline_id = structure_message.pipeline_id();
+      const auto& id = structure_message.id();
+      const auto& encoding = structure_message.encoding();
+      const auto& body = structure_message.body();
+      const auto& next_id = structure_message.next_id();
+      const auto& location = locations[i - window];
+
+      if (location.batch == kNoBatch) {
+        // Handle unsupported encoding errors.
+        errors.emplace_back(
+            error_messages == ErrorMessages::kFull
+                ? CreateUnsupportedEncodingErrorMessage(structure_message,
+                                                        encoding)
+                : std::string{});
+        continue;
+      }
+
+      const auto& batch = batches[location.batch];
+      if (batch.decoder != nullptr) {
+        // Only check the body, it's decoded from the input when it's used
+        if (auto error = registry.Validate(location.batch, body)) {
+          errors.emplace_back(error_messages == ErrorMessages::kFull
+                                  ? CreateBodyParseErrorMessage(
+                                        structure_message, encoding, *error)
+                                  : std::string{});
+        } else {
+          parsed_messages.emplace_back(
+              log_message::Symbol{pipeline_id, symbol_table},
+              log_message::Symbol{id, symbol_table},
+              Body{body, batch.decoder,
+                   BodyOwner(structure_message, input_owner)},
+              log_message::Symbol{next_id, symbol_table});
+        }
+      } else if (const auto& parsed_body = batch.results[location.index]) {
+        // The IDs are interned, only the body is owned by the message
+        parsed_messages.emplace_back(
+            log_message::Symbol{pipeline_id, symbol_table},
+            log_message::Symbol{id, symbol_table}, std::string(*parsed_body),
+            log_message::Symbol{next_id, symbol_table});
+      } else {
+        // Handle parsing errors and record them.
+        errors.emplace_back(error_messages == ErrorMessages::kFull
+                                ? CreateBodyParseErrorMessage(
+                                      structure_message, encoding,
+                                      parsed_body.error())
+                                : std::string{});
+      }
+    }
+  }
+}
+
+template <typename Registry, typename StructureLogMessages>
+ParseResult ParseInBatches(const Registry& registry, BodyDecoding body_decoding,
+                           ErrorMessages error_messages,
+                           log_message::SymbolTable& symbol_table,
+                           const StructureLogMessages& structure_log_messages,
+                           const std::shared_ptr<const void>& input_owner,
+                           size_t thread_count) {
+  using StructureLogMessage = typename StructureLogMessages::value_type;
+  using Part = std::pair<LogMessages, ParseErrors>;
+
+  const auto messages =
+      std::span<const StructureLogMessage>{structure_log_messages};
+  const auto part_count =
+      std::clamp<size_t>(messages.size() / kMinMessagesPerThread, 1,
+                         std::max<size_t>(thread_count, 1));
+  const auto part_size = (messages.size() + part_count - 1) / part_count;
+  auto parse_part = [&](size_t part) {
+    auto result = Part{};
+    auto begin = std::min(messages.size(), part * part_size);
+    auto end = std::min(messages.size(), begin + part_size);
+    ParseWindows(registry, body_decoding, error_messages, symbol_table,
+                 messages.subspan(begin, end - begin), input_owner,
+                 result.first, result.second);
+    return result;
+  };
+
+  // The first part is parsed by the calling thread, the others are appended
+  // to it in order
+  auto parts = std::vector<std::future<Part>>{};
+  for (size_t part = 1; part < part_count; ++part) {
+    parts.push_back(std::async(std::launch::async, parse_part, part));
+  }
+  auto [parsed_messages, errors] = parse_part(0);
+  for (auto& future_part : parts) {
+    auto part = future_part.get();
+    parsed_messages.insert(parsed_messages.end(),
+                           std::make_move_iterator(part.first.begin()),
+                           std::make_move_iterator(part.first.end()));
+    errors.insert(errors.end(), std::make_move_iterator(part.second.begin()),
+                  std::make_move_iterator(part.second.end()));
+  }
+
+  // Return the result containing parsed messages and errors.
+  return {std::move(parsed_messages), std::move(errors)};
+}
+
+template <typename Registry, typename StructureLogMessages>
+MessageErrors ValidateMessages(
+    const Registry& registry, ErrorMessages error_messages,
+    const StructureLogMessages& structure_log_messages) {
+  auto errors = MessageErrors{};
+  errors.reserve(structure_log_messages.size());
+  for (const auto& structure_message : structure_log_messages) {
+    const auto& encoding = structure_message.encoding();
+    auto& error = errors.emplace_back();
+    auto body_parser = registry.Find(encoding);
+    if (body_parser == kNoBatch) {
+      error.emplace(
+          error_messages == ErrorMessages::kFull
+              ? CreateUnsupportedEncodingErrorMessage(structure_message,
+                                                      encoding)
+              : std::string{});
+    } else if (auto body_error =
+                   registry.Validate(body_parser, structure_message.body())) {
+      error.emplace(error_messages == ErrorMessages::kFull
+                        ? CreateBodyParseErrorMessage(structure_message,
+                                                      encoding, *body_error)
+                        : std::string{});
+    }
+  }
+  return errors;
+}
+
+}  // namespace pipelines::log_message_parser::semantics
+
+#endif  // COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_BODY_BATCHES_H_
@@ -0,0 +1,149 @@
+/**
+ * @file expected.h
+ * @brief Declares Expected, a value or the error that prevented computing it.
+ *
+ * The parsers report malformed input as part of their results, so a bad
+ * record is part of the normal flow and not an exceptional situation. Using
+ * exceptions for them made the files with many bad records much slower to
+ * parse than the ones without them. Expected follows the interface of
+ * C++23's std::expected, so it can be replaced by it once the project moves
+ * to that standard.
+ */
+
+#ifndef COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_EXPECTED_H_
+#define COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_EXPECTED_H_
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include <utility>
+#include <variant>
+
+/******************************************************************************
+ * CLASSES
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser {
+
+/**
+ * @class Unexpected
+ * @brief Wraps an error, so it can be converted into an Expected.
+ * @tparam E The type of the error.
+ */
+template <typename E>
+class Unexpected {
+ public:
+  /**
+   * @brief Constructs an Unexpected with the given error.
+   * @param error The error.
+   */
+  explicit Unexpected(E error) : error_(std::move(error)) {}
+
+  /**
+   * @brief Retrieves the error.
+   * @return The error.
+   */
+  E& error() { return error_; }
+
+ private:
+  E error_; /**< The error. */
+};
+
+/**
+ * @class Expected
+ * @brief Holds either a value or the error that prevented computing it.
+ * @tparam T The type of the value.
+ * @tparam E The type of the error.
+ */
+template <typename T, typename E>
+class Expected {
+ public:
+  /**
+   * @brief Constructs an Expected holding a value.
+   * @param value The value.
+   */
+  Expected(T value) : storage_(std::in_place_index<0>, std::move(value)) {}
+
+  /**
+   * @brief Constructs an Expected holding an error.
+   * @param unexpected The error.
+   */
+  Expected(Unexpected<E> unexpected)
+      : storage_(std::in_place_index<1>, std::move(unexpected.error())) {}
+
+  /**
+   * @brief Checks if the Expected holds a value.
+   * @return true if it holds a value, false if it holds an error.
+   */
+  bool has_value() const { return storage_.index() == 0; }
+
+  /**
+   * @brief Checks if the Expected holds a value.
+   * @return true if it holds a value, false if it holds an error.
+   */
+  explicit operator bool() const { return has_value(); }
+
+  /**
+   * @brief Retrieves the value.
+   * @return The value.
+   * @pre The Expected must hold a value.
+   */
+  T& value() { return *std::get_if<0>(&storage_); }
+
+  /**
+   * @brief Retrieves the value.
+   * @return The value.
+   * @pre The Expected must hold a value.
+   */
+  const T& value() const { return *std::get_if<0>(&storage_); }
+
+  /**
+   * @brief Retrieves the value.
+   * @return The value.
+   * @pre The Expected must hold a value.
+   */
+  T& operator*() { return value(); }
+
+  /**
+   * @brief Retrieves the value.
+   * @return The value.
+   * @pre The Expected must hold a value.
+   */
+  const T& operator*() const { return value(); }
+
+  /**
+   * @brief Accesses the members of the value.
+   * @return A pointer to the value.
+   * @pre The Expected must hold a value.
+   */
+  T* operator->() { return &value(); }
+
+  /**
+   * @brief Accesses the members of the value.
+   * @return A pointer to the value.
+   * @pre The Expected must hold a value.
+   */
+  const T* operator->() const { return &value(); }
+
+  /**
+   * @brief Retrieves the error.
+   * @return The error.
+   * @pre The Expected must hold an error.
+   */
+  E& error() { return *std::get_if<1>(&storage_); }
+
+  /**
+   * @brief Retrieves the error.
+   * @return The error.
+   * @pre The Expected must hold an error.
+   */
+  const E& error() const { return *std::get_if<1>(&storage_); }
+
+ private:
+  std::variant<T, E> storage_; /**< The value or the error. */
+};
+
+}  // namespace pipelines::log_message_parser
+
+#endif  // COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_EXPECTED_H_
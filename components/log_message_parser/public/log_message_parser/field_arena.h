@@ -0,0 +1,131 @@
+/**
+ * @file field_arena.h
+ * @brief Storage for the fields of the structured log messages.
+ *
+ * This file contains the declaration of the FieldArena class. The structure
+ * parsers copy the fields of every message into an arena shared by all the
+ * messages of a parse, instead of giving every field its own string, so
+ * parsing a message doesn't allocate and the memory of all the fields is
+ * released at once, when the last message that uses the arena is destroyed.
+ */
+
+#ifndef COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_FIELD_ARENA_H_
+#define COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_FIELD_ARENA_H_
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/******************************************************************************
+ * CLASSES
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+/**
+ * @class FieldArena
+ * @brief Append only storage for the bytes of the message fields.
+ *
+ * The fields are copied one after the other into slabs, which start small
+ * and double in size up to kMaxSlabSize, so a small parse uses little memory
+ * and a big one only allocates every few thousand messages. A stored field
+ * never moves, the views returned stay valid as long as the arena exists.
+ * It is not thread safe, only one thread can store fields at a time.
+ */
+class FieldArena {
+ public:
+  /// Size of the first slab, unless another one is given
+  static constexpr size_t kFirstSlabSize = 4 * 1024;
+
+  /// Maximum size of a slab, bigger fields get a slab of their own size
+  static constexpr size_t kMaxSlabSize = 1024 * 1024;
+
+  /**
+   * @brief Constructs an empty arena, it allocates nothing until a field is
+   * stored.
+   * @param first_slab_size The size of the first slab, e.g. the exact size
+   * of the fields when it's known in advance.
+   */
+  explicit FieldArena(size_t first_slab_size = kFirstSlabSize)
+      : next_slab_size_(std::max<size_t>(first_slab_size, 1)) {}
+
+  FieldArena(const FieldArena&) = delete;
+  FieldArena& operator=(const FieldArena&) = delete;
+
+  /**
+   * @brief Copies a field into the arena.
+   * @param field The field to copy.
+   * @return A view of the copy, valid as long as the arena.
+   */
+  std::string_view Store(std::string_view field) {
+    if (field.empty()) {
+      return {};
+    }
+    if (field.size() > available_) {
+      AddSlab(field.size());
+    }
+    auto* copy = free_;
+    std::memcpy(copy, field.data(), field.size());
+    free_ += field.size();
+    available_ -= field.size();
+    return {copy, field.size()};
+  }
+
+  /**
+   * @brief Moves a whole buffer into the arena, without copying it, so the
+   * fields can point into it directly.
+   * @param buffer The buffer to keep.
+   * @return A view of the buffer, valid as long as the arena.
+   */
+  std::string_view Adopt(std::string buffer) {
+    return adopted_buffers_.emplace_back(std::move(buffer));
+  }
+
+  /**
+   * @brief Retrieves the number of bytes allocated by the arena.
+   * @return The size of all the slabs and adopted buffers.
+   */
+  size_t allocated_bytes() const {
+    auto bytes = allocated_slab_bytes_;
+    for (const auto& buffer : adopted_buffers_) {
+      bytes += buffer.size();
+    }
+    return bytes;
+  }
+
+ private:
+  std::vector<std::unique_ptr<char[]>> slabs_; /**< The slabs, in order. */
+  std::deque<std::string> adopted_buffers_; /**< Buffers moved in, a deque
+                                                 never moves its elements. */
+  char* free_ = nullptr;             /**< First free byte of the last slab. */
+  size_t available_ = 0;             /**< Free bytes in the last slab. */
+  size_t next_slab_size_;            /**< Size of the next slab. */
+  size_t allocated_slab_bytes_ = 0;  /**< Size of all the slabs. */
+
+  /**
+   * @brief Allocates a new slab, the free space of the last one is lost.
+   * @param minimum_size The size of the field that didn't fit.
+   */
+  void AddSlab(size_t minimum_size) {
+    const auto size = std::max(minimum_size, next_slab_size_);
+    slabs_.push_back(std::make_unique_for_overwrite<char[]>(size));
+    free_ = slabs_.back().get();
+    available_ = size;
+    allocated_slab_bytes_ += size;
+    next_slab_size_ = std::min(next_slab_size_ * 2, kMaxSlabSize);
+  }
+};
+
+}  // namespace pipelines::log_message_parser::structure
+
+#endif  // COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_FIELD_ARENA_H_
@@ -14,7 +14,10 @@
  * INCLUDES
  *****************************************************************************/
 
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
 #include "log_message_parser/semantics.h"
 
 /******************************************************************************
@@ -45,6 +48,58 @@ class Hex16BodyParser : public BodyParser {
    * @return A string containing the parsed result.
    */
   std::string Parse(const std::string& body) const override;
+
+  /**
+   * @brief Parses a hexadecimal 16-bit formatted body message, without
+   * throwing.
+   *
+   * Same as Parse(), but the errors are returned instead of thrown.
+   *
+   * @param body The body message to be parsed, represented as a string.
+   * @return The parsed result, or the error that prevented parsing it.
+   */
+  BodyParseResult TryParse(const std::string& body) const override;
+
+  /**
+   * @brief Parses a hexadecimal 16-bit formatted body message into a buffer,
+   * without allocating once the buffer is big enough.
+   *
+   * @param body The body message to be parsed.
+   * @param buffer The buffer where the parsed result is written.
+   * @return A view of the buffer, or the error TryParse() would return.
+   */
+  BodyParseIntoResult ParseInto(std::string_view body,
+                                std::string& buffer) const override;
+
+  /**
+   * @brief Parses a batch of hexadecimal 16-bit formatted body messages into
+   * a buffer, reserving it once for the whole batch.
+   *
+   * @param bodies The body messages to be parsed.
+   * @param buffer The buffer where the parsed results are written.
+   * @param results The views of the buffer, or the errors TryParse() would
+   * return.
+   */
+  void ParseBatch(std::span<const std::string_view> bodies,
+                  std::string& buffer,
+                  BodyParseBatchResults& results) const override;
+
+  /**
+   * @brief Checks a hexadecimal 16-bit formatted body message, without
+   * decoding it or copying it.
+   *
+   * @param body The body message to be checked.
+   * @return The same error TryParse() would return, if any.
+   */
+  std::optional<BodyError> Validate(std::string_view body) const override;
+
+  /**
+   * @brief Retrieves the function that decodes the validated bodies, it
+   * ignores the whitespace like Parse().
+   *
+   * @return The decoder of hexadecimal 16-bit bodies.
+   */
+  Body::Decoder decoder() const override;
 };
 
 }  // namespace pipelines::log_message_parser::semantics
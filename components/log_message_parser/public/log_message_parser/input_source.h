@@ -0,0 +1,208 @@
+/**
+ * @file input_source.h
+ * @brief Declares the sources the structure parser can read its input from.
+ *
+ * The structure parser reads its input in big blocks, and how those blocks
+ * are read matters a lot for big files: a file that is already in the page
+ * cache is read faster with mmap, while a cold multi-GB file is better read
+ * with O_DIRECT, so it doesn't evict everything else from the cache. This file
+ * declares the InputSource interface and the factory for the available
+ * backends.
+ */
+
+#ifndef COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_INPUT_SOURCE_H_
+#define COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_INPUT_SOURCE_H_
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+
+/******************************************************************************
+ * TYPE DEFINITIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser {
+
+/**
+ * @enum InputMode
+ * @brief The ways an input file can be read.
+ */
+enum class InputMode {
+  kStream,    /**< std::ifstream, works everywhere. */
+  kRead,      /**< Big read() calls, with sequential access advice. */
+  kMemoryMap, /**< Windows of mmap, with sequential and read ahead advice. */
+  kDirect,    /**< O_DIRECT reads into aligned buffers, bypassing the cache. */
+  kStdin,     /**< The standard input, the path is ignored. */
+};
+
+}  // namespace pipelines::log_message_parser
+
+/******************************************************************************
+ * CLASSES
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser {
+
+/**
+ * @class InputSourceError
+ * @brief Represents an error opening or reading an input source.
+ */
+class InputSourceError : public std::runtime_error {
+ public:
+  /**
+   * @brief Constructs an InputSourceError with the given message.
+   * @param message The error message.
+   */
+  explicit InputSourceError(const std::string& message)
+      : std::runtime_error(message) {}
+};
+
+/**
+ * @class InputSource
+ * @brief Abstract base class for the sources of input data.
+ *
+ * An input source is read sequentially, from the beginning to the end, in
+ * blocks chosen by the caller.
+ */
+class InputSource {
+ public:
+  /**
+   * @brief Virtual destructor for the InputSource class.
+   */
+  virtual ~InputSource() = default;
+
+  /**
+   * @brief Reads the next block of data.
+   * @param destination Where the data is written to.
+   * @return The number of bytes read, 0 only at the end of the input.
+   * @throws InputSourceError if the input can't be read.
+   */
+  virtual size_t Read(std::span<char> destination) = 0;
+};
+
+/**
+ * @class StreamInputSource
+ * @brief Input source that reads from a std::istream.
+ */
+class StreamInputSource : public InputSource {
+ public:
+  /**
+   * @brief Constructs a StreamInputSource over the given stream.
+   * @param input_stream The stream to read from, it must outlive the source.
+   */
+  explicit StreamInputSource(std::istream& input_stream)
+      : input_stream_(input_stream) {}
+
+  /**
+   * @brief Reads the next block of data from the stream.
+   * @param destination Where the data is written to.
+   * @return The number of bytes read, 0 only at the end of the stream.
+   */
+  size_t Read(std::span<char> destination) override;
+
+ private:
+  std::istream& input_stream_; /**< The stream to read from. */
+};
+
+/**
+ * @class FollowedFile
+ * @brief Reads a file that keeps growing, like tail -f.
+ *
+ * Unlike an InputSource, reaching the end of the file only means that no new
+ * data was appended yet. The file is also reopened when it's replaced by
+ * another one (e.g. log rotation) or truncated.
+ */
+class FollowedFile {
+ public:
+  /**
+   * @brief Opens the given file.
+   * @param path The path of the file.
+   * @throws InputSourceError if the file can't be opened.
+   */
+  explicit FollowedFile(const std::string& path);
+
+  /**
+   * @brief Reads the next block of the data appended to the file.
+   * @param destination Where the data is written to.
+   * @return The number of bytes read, 0 if no new data is available.
+   * @throws InputSourceError if the file can't be read.
+   */
+  size_t Read(std::span<char> destination);
+
+  /**
+   * @brief Checks if the file was replaced or truncated, and reopens it from
+   * its beginning if it was.
+   *
+   * It should only be called after Read() returned 0, so nothing is lost from
+   * the end of the old file.
+   *
+   * @return true if the file was reopened, false otherwise.
+   * @throws InputSourceError if the new file can't be opened.
+   */
+  bool ReopenIfReplaced();
+
+ private:
+  /**
+   * @struct FileStatus
+   * @brief Identifies a file, independently of its path, and its size.
+   */
+  struct FileStatus {
+    uint64_t device{0}; /**< The device that has the file. */
+    uint64_t inode{0};  /**< The number of the file in the device. */
+    uint64_t size{0};   /**< The size of the file. */
+  };
+
+  std::string path_;                    /**< The path of the file. */
+  std::unique_ptr<InputSource> source_; /**< Reads the opened file. */
+  FileStatus opened_file_;              /**< Identifies the opened file. */
+  uint64_t offset_ = 0;                 /**< Number of bytes read from it. */
+
+  /**
+   * @brief Opens the file in the path, from its beginning.
+   * @throws InputSourceError if the file can't be opened.
+   */
+  void Open();
+
+  /**
+   * @brief Retrieves the status of the file that is currently in the path.
+   * @return The status, or nothing if there is no file in the path.
+   */
+  std::optional<FileStatus> StatusOfPath() const;
+};
+
+}  // namespace pipelines::log_message_parser
+
+/******************************************************************************
+ * FUNCTION DECLARATIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser {
+
+/**
+ * @brief Opens a file with the given backend.
+ *
+ * Backends that are not available on the platform, or that can't be used with
+ * the file (e.g. mmap of a pipe, or O_DIRECT on a file system that doesn't
+ * support it), fall back to the read() backend, or to the stream one if read()
+ * is not available either.
+ *
+ * @param path The path of the file, ignored for InputMode::kStdin.
+ * @param mode How the file should be read.
+ * @return The opened source.
+ * @throws InputSourceError if the file can't be opened.
+ */
+std::unique_ptr<InputSource> OpenInputSource(const std::string& path,
+                                             InputMode mode);
+
+}  // namespace pipelines::log_message_parser
+
+#endif  // COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_INPUT_SOURCE_H_
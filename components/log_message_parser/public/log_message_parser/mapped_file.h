@@ -0,0 +1,93 @@
+/**
+ * @file mapped_file.h
+ * @brief Defines the MappedFile class, a read only memory mapping of a file.
+ *
+ * The mapping is used by the zero-copy structure parser, which returns views
+ * into the mapped memory instead of copying every field.
+ */
+
+#ifndef COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_MAPPED_FILE_H_
+#define COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_MAPPED_FILE_H_
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/******************************************************************************
+ * CLASSES
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser {
+
+/**
+ * @class MappedFileError
+ * @brief Represents an error while opening or mapping a file.
+ */
+class MappedFileError : public std::runtime_error {
+ public:
+  /**
+   * @brief Constructs a MappedFileError with the given message.
+   * @param message The error message.
+   */
+  explicit MappedFileError(const std::string& message)
+      : std::runtime_error(message) {}
+};
+
+/**
+ * @class MappedFile
+ * @brief A read only view of a whole file in memory.
+ *
+ * On POSIX systems the file is memory mapped, so the data is only paged in
+ * when it is accessed and it is shared with the page cache. On other platforms
+ * the file is read into memory once.
+ *
+ * The class is not copyable, share it through a std::shared_ptr when the data
+ * must outlive the scope where it was created.
+ */
+class MappedFile {
+ public:
+  MappedFile() = delete; /**< Default constructor is deleted. */
+
+  /**
+   * @brief Maps the given file into memory.
+   * @param path The path of the file to map.
+   * @throws MappedFileError if the file cannot be opened or mapped.
+   */
+  explicit MappedFile(const std::string& path);
+
+  /**
+   * @brief Unmaps the file.
+   */
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;            /**< Not copyable. */
+  MappedFile& operator=(const MappedFile&) = delete; /**< Not copyable. */
+
+  /**
+   * @brief Retrieves the contents of the file.
+   * @return A span over the whole file.
+   */
+  std::span<const char> data() const { return {data_, size_}; }
+
+  /**
+   * @brief Retrieves the size of the file.
+   * @return The size of the file in bytes.
+   */
+  size_t size() const { return size_; }
+
+ private:
+  const char* data_ = nullptr; /**< Start of the mapped memory. */
+  size_t size_ = 0;            /**< Size of the mapped memory. */
+  bool mapped_ = false;        /**< If the data is owned by a mapping. */
+  std::vector<char> contents_; /**< Used when the file could not be mapped. */
+};
+
+}  // namespace pipelines::log_message_parser
+
+#endif  // COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_MAPPED_FILE_H_
@@ -0,0 +1,159 @@
+/**
+ * @file pipeline_partitions.h
+ * @brief Defines the PipelinePartitions class, which hash partitions
+ * structured log messages by their pipeline IDs into temporary files.
+ *
+ * The partitions are read back one at a time, so an input bigger than the
+ * memory can be parsed and organized a partition at a time.
+ */
+
+#ifndef COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_PIPELINE_PARTITIONS_H_
+#define COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_PIPELINE_PARTITIONS_H_
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "log_message_parser/structure.h"
+
+/******************************************************************************
+ * CLASSES
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser {
+
+/**
+ * @class PipelinePartitionsError
+ * @brief Represents an error while writing or reading a partition file.
+ */
+class PipelinePartitionsError : public std::runtime_error {
+ public:
+  /**
+   * @brief Constructs a PipelinePartitionsError with the given message.
+   * @param message The error message.
+   */
+  explicit PipelinePartitionsError(const std::string& message)
+      : std::runtime_error(message) {}
+};
+
+/**
+ * @class PipelinePartitions
+ * @brief Temporary files with the structured log messages, partitioned by the
+ * hash of their pipeline IDs.
+ *
+ * All the messages of a pipeline are in the same partition, in the order they
+ * were added. The fields are written as they are, so reading a partition back
+ * gives the same structured messages, e.g. to parse their semantics then.
+ * Once all the messages are added, different partitions can be read
+ * concurrently.
+ *
+ * The class is not copyable, the partition files are removed with it.
+ */
+class PipelinePartitions {
+ public:
+  PipelinePartitions() = delete; /**< Default constructor is deleted. */
+
+  /**
+   * @brief Creates the partition files.
+   * @param spill_directory The directory of the partition files, it must
+   * exist.
+   * @param partition_count The number of partitions, every one keeps a file
+   * open.
+   * @throws PipelinePartitionsError if a partition file cannot be created.
+   */
+  PipelinePartitions(const std::filesystem::path& spill_directory,
+                     size_t partition_count);
+
+  /**
+   * @brief Removes the partition files.
+   */
+  ~PipelinePartitions();
+
+  PipelinePartitions(const PipelinePartitions&) = delete; /**< Not copyable. */
+  PipelinePartitions& operator=(const PipelinePartitions&) =
+      delete; /**< Not copyable. */
+
+  /**
+   * @brief Appends a structured log message to the partition of its pipeline.
+   * @param message The structured log message.
+   * @throws PipelinePartitionsError if the partition file cannot be written.
+   */
+  void Add(const structure::LogMessage& message);
+
+  /**
+   * @brief Reads back the structured log messages of a partition.
+   *
+   * The messages share a single arena with the whole partition.
+   *
+   * @param partition The number of the partition.
+   * @return The messages of the partition, in the order they were added.
+   * @throws PipelinePartitionsError if the partition file cannot be read.
+   */
+  structure::LogMessages Read(size_t partition);
+
+  /**
+   * @brief Retrieves the number of partitions.
+   * @return The number of partitions.
+   */
+  size_t partition_count() const { return partitions_.size(); }
+
+  /**
+   * @brief Retrieves the size of a partition file, about the memory its
+   * messages take when they are read back.
+   * @param partition The number of the partition.
+   * @return The number of bytes written to the partition since it was last
+   * read.
+   */
+  size_t partition_bytes(size_t partition) const {
+    return partition_bytes_[partition];
+  }
+
+  /**
+   * @brief Retrieves the number of messages added to all the partitions.
+   * @return The number of messages.
+   */
+  size_t size() const { return size_; }
+
+ private:
+  /**
+   * @struct RecordHeader
+   * @brief The sizes of the fields of a message in a partition file, the
+   * fields follow it in the same order.
+   */
+  struct RecordHeader {
+    uint32_t pipeline_id_size; /**< The size of the pipeline ID. */
+    uint32_t id_size;          /**< The size of the ID. */
+    uint32_t encoding_size;    /**< The size of the encoding. */
+    uint32_t next_id_size;     /**< The size of the next ID. */
+    uint64_t body_size;        /**< The size of the body. */
+  };
+
+  /**
+   * @brief Finds the partition of a pipeline.
+   * @param pipeline_id The ID of the pipeline.
+   * @return The number of the partition.
+   */
+  size_t PartitionOf(std::string_view pipeline_id) const;
+
+  /// The paths of the partition files
+  std::vector<std::filesystem::path> paths_;
+  /// The partition files, written and then read back
+  std::vector<std::fstream> partitions_;
+  /// The number of bytes written to every partition file
+  std::vector<size_t> partition_bytes_;
+  /// The number of messages added
+  size_t size_{0};
+};
+
+}  // namespace pipelines::log_message_parser
+
+#endif  // COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_PIPELINE_PARTITIONS_H_
@@ -14,15 +14,24 @@
  * INCLUDES
  *****************************************************************************/
 
+#include <cstddef>
 #include <map>
 #include <memory>
+#include <optional>
 #include <ostream>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#include "log_message/body.h"
 #include "log_message/message.h"
+#include "log_message/symbol.h"
+#include "log_message_parser/expected.h"
 #include "log_message_parser/structure.h"
+#include "log_message_parser/structure_view.h"
 
 /******************************************************************************
  * TYPE DEFINITIONS
@@ -36,6 +45,28 @@ using LogMessages =
     ::std::vector<LogMessage>; /**< Collection of log messages. */
 using ParseErrors =
     ::std::vector<class ParseError>; /**< Collection of parsing errors. */
+/// The error of every message, if any
+using MessageErrors = ::std::vector<::std::optional<class ParseError>>;
+using Body = ::pipelines::log_message::Body; /**< Alias for message bodies. */
+
+/**
+ * @brief When the bodies of the messages are decoded.
+ */
+enum class BodyDecoding {
+  kEager, /**< The bodies are decoded while the messages are parsed. */
+  kLazy,  /**< The bodies are only validated, and decoded when used. */
+};
+
+/**
+ * @brief Whether the errors carry their messages.
+ *
+ * Creating the message of an error copies the whole structure message, so
+ * when only the errors are counted they are left without it.
+ */
+enum class ErrorMessages {
+  kFull, /**< Every error describes the message that failed. */
+  kNone, /**< The errors are empty, only their number is meaningful. */
+};
 
 }  // namespace pipelines::log_message_parser::semantics
 
@@ -84,20 +115,32 @@ class ParseResult {
    * @param messages The successfully parsed log messages.
    * @param errors The errors encountered during parsing.
    */
-  ParseResult(const LogMessages& messages, const ParseErrors& errors)
-      : messages_(messages), errors_(errors) {}
+  ParseResult(LogMessages messages, ParseErrors errors)
+      : messages_(std::move(messages)), errors_(std::move(errors)) {}
 
   /**
    * @brief Retrieves the parsed log messages.
    * @return A reference to the collection of parsed log messages.
    */
-  const LogMessages& messages() const { return messages_; }
+  const LogMessages& messages() const& { return messages_; }
+
+  /**
+   * @brief Moves the parsed log messages out of an expiring result.
+   * @return The collection of parsed log messages.
+   */
+  LogMessages messages() && { return std::move(messages_); }
 
   /**
    * @brief Retrieves the parsing errors.
    * @return A reference to the collection of parsing errors.
    */
-  const ParseErrors& errors() const { return errors_; }
+  const ParseErrors& errors() const& { return errors_; }
+
+  /**
+   * @brief Moves the parsing errors out of an expiring result.
+   * @return The collection of parsing errors.
+   */
+  ParseErrors errors() && { return std::move(errors_); }
 
   /**
    * @brief Checks if any errors were encountered during parsing.
@@ -127,12 +170,115 @@ class BodyParserError : public std::runtime_error {
       : std::runtime_error(message) {}
 };
 
+/**
+ * @class BodyError
+ * @brief Why a body can't be parsed, returned instead of a BodyParserError.
+ *
+ * An invalid body must cost about the same as a valid one, so the error is
+ * only a reason, a string literal, and an optional number that belongs to
+ * it, e.g. a length. The message, with the body, is only built when it's
+ * going to be shown. The errors thrown by Parse() are kept as they are.
+ */
+class BodyError {
+ public:
+  /**
+   * @brief Constructs a BodyError with a reason and no number.
+   * @param reason Why the body can't be parsed, a string literal.
+   */
+  explicit BodyError(const char* reason) : reason_(reason) {}
+
+  /**
+   * @brief Constructs a BodyError with a reason and its number.
+   * @param reason Why the body can't be parsed, a string literal.
+   * @param detail The number that belongs to the reason, e.g. a length.
+   */
+  BodyError(const char* reason, size_t detail)
+      : reason_(reason), detail_(detail) {}
+
+  /**
+   * @brief Constructs a BodyError from the error thrown by Parse(), which
+   * already has its whole message.
+   * @param error The error thrown by Parse().
+   */
+  BodyError(const BodyParserError& error)
+      : message_(std::make_shared<const std::string>(error.what())) {
+    reason_ = message_->c_str();
+  }
+
+  /**
+   * @brief Retrieves why the body can't be parsed, without the body.
+   * @return The reason, or the whole message of a thrown error.
+   */
+  const char* what() const { return reason_; }
+
+  /**
+   * @brief Builds the message of the error: the reason, its number and the
+   * body, or the message of a thrown error.
+   * @param body The body that couldn't be parsed.
+   * @return The message of the error.
+   */
+  std::string Message(std::string_view body) const {
+    if (message_) {
+      return *message_;
+    }
+    auto message = std::string{reason_};
+    if (detail_) {
+      message += ": " + std::to_string(*detail_);
+    }
+    message += "\nOriginal string: ";
+    message += body;
+    return message;
+  }
+
+  /**
+   * @brief Creates the exception thrown by Parse() for this error.
+   * @param body The body that couldn't be parsed.
+   * @return The exception, with the message of the error.
+   */
+  BodyParserError ToException(std::string_view body) const {
+    return BodyParserError(Message(body));
+  }
+
+ private:
+  /// Why the body can't be parsed, a literal or the message of a thrown error
+  const char* reason_;
+  /// The number that belongs to the reason, if any
+  std::optional<size_t> detail_;
+  /// The whole message of a thrown error, shared so the error stays cheap to
+  /// copy
+  std::shared_ptr<const std::string> message_;
+};
+
+/**
+ * @brief The result of parsing a body, the parsed body or the error that
+ * prevented parsing it.
+ */
+using BodyParseResult = Expected<std::string, BodyError>;
+
+/**
+ * @brief The result of parsing a body into a buffer, a view of the parsed
+ * body or the error that prevented parsing it.
+ */
+using BodyParseIntoResult = Expected<std::string_view, BodyError>;
+
+/**
+ * @brief The results of parsing a batch of bodies, one for each body and in
+ * the same order.
+ */
+using BodyParseBatchResults = std::vector<BodyParseIntoResult>;
+
 /**
  * @class BodyParser
  * @brief Abstract base class for body parsers.
  *
  * This class defines the interface for body parsers, which are responsible
  * for parsing the body of a log message based on a specific encoding.
+ *
+ * A semantics Parser with more than one thread calls the methods of the same
+ * body parser from all its threads at the same time, so they must be safe to
+ * call concurrently. The const methods must not modify any state shared
+ * between calls without synchronization, the ascii and hex parsers have no
+ * state at all.
  */
 class BodyParser {
  public:
@@ -148,6 +294,121 @@ class BodyParser {
    * @throws BodyParserError if parsing fails.
    */
   virtual std::string Parse(const std::string& body) const = 0;
+
+  /**
+   * @brief Parses the given body message, returning the error instead of
+   * throwing it.
+   *
+   * This is what the semantics Parser calls, so invalid bodies cost about the
+   * same as valid ones. The default implementation calls Parse() and catches
+   * the error, parsers that can fail should override it without using
+   * exceptions.
+   *
+   * @param body The body message to parse.
+   * @return The parsed body, or the error that prevented parsing it.
+   */
+  virtual BodyParseResult TryParse(const std::string& body) const {
+    try {
+      return Parse(body);
+    } catch (const BodyParserError& e) {
+      return Unexpected{BodyError{e}};
+    }
+  }
+
+  /**
+   * @brief Parses the given body message into a buffer owned by the caller,
+   * so the buffer can be reused for every body.
+   *
+   * The parsed body is written to the buffer, replacing its content, unless
+   * the body doesn't need any transformation, then the view points into the
+   * body itself. The default implementation calls TryParse() and copies the
+   * result into the buffer, so the parsers that only implement Parse() or
+   * TryParse() still work, the others should override it without allocating.
+   *
+   * @param body The body message to parse.
+   * @param buffer The buffer where the parsed body may be written.
+   * @return A view of the parsed body, valid until the buffer or the body
+   * change, or the error that prevented parsing it.
+   */
+  virtual BodyParseIntoResult ParseInto(std::string_view body,
+                                        std::string& buffer) const {
+    auto parsed_body = TryParse(std::string(body));
+    if (!parsed_body) {
+      return Unexpected{std::move(parsed_body.error())};
+    }
+    buffer.assign(*parsed_body);
+    return std::string_view{buffer};
+  }
+
+  /**
+   * @brief Parses a batch of bodies, all of this parser's encoding, into a
+   * buffer owned by the caller.
+   *
+   * The semantics Parser calls it once for every batch instead of calling
+   * ParseInto() for every body. The parsed bodies are written to the buffer,
+   * replacing its content, and the views point into the buffer or into the
+   * bodies themselves. The default implementation calls ParseInto() for
+   * every body and copies the results into the buffer, parsers that decode
+   * many small bodies should override it to avoid the per body overhead.
+   *
+   * @param bodies The bodies to parse.
+   * @param buffer The buffer where the parsed bodies may be written.
+   * @param results Replaced by the result of every body, the views are valid
+   * until the buffer or the bodies change.
+   */
+  virtual void ParseBatch(std::span<const std::string_view> bodies,
+                          std::string& buffer,
+                          BodyParseBatchResults& results) const {
+    results.clear();
+    buffer.clear();
+    // The buffer grows while the bodies are copied into it, so the views are
+    // only created at the end, from the offset where each body starts
+    auto parsed_body_buffer = std::string{};
+    auto offsets = std::vector<size_t>{};
+    offsets.reserve(bodies.size() + 1);
+    for (auto body : bodies) {
+      offsets.push_back(buffer.size());
+      if (auto parsed_body = ParseInto(body, parsed_body_buffer)) {
+        buffer.append(*parsed_body);
+        results.emplace_back(std::string_view{});
+      } else {
+        results.emplace_back(Unexpected{std::move(parsed_body.error())});
+      }
+    }
+    offsets.push_back(buffer.size());
+
+    for (size_t i = 0; i < results.size(); ++i) {
+      if (results[i]) {
+        *results[i] = std::string_view{buffer}.substr(
+            offsets[i], offsets[i + 1] - offsets[i]);
+      }
+    }
+  }
+
+  /**
+   * @brief Checks that the given body can be parsed, without parsing it.
+   *
+   * Used for the lazy decoding, the default implementation parses the body
+   * and drops the result.
+   *
+   * @param body The body message to check.
+   * @return The error that prevents parsing the body, if any.
+   */
+  virtual std::optional<BodyError> Validate(std::string_view body) const {
+    if (auto parsed_body = TryParse(std::string(body)); !parsed_body) {
+      return parsed_body.error();
+    }
+    return std::nullopt;
+  }
+
+  /**
+   * @brief Retrieves the function that decodes the bodies accepted by
+   * Validate() when they are used.
+   *
+   * @return The decoder, or nullptr if the parser doesn't support the lazy
+   * decoding, then its bodies are always parsed up front.
+   */
+  virtual Body::Decoder decoder() const { return nullptr; }
 };
 
 /**
@@ -164,13 +425,43 @@ class Parser {
   using BodyParserPtr =
       std::unique_ptr<BodyParser>; /**< Pointer to a body parser. */
   using BodyParserMap =
-      std::map<std::string, BodyParserPtr>; /** Map of body parsers. */
+      std::map<std::string, BodyParserPtr,
+               std::less<>>; /** Map of body parsers. */
 
  public:
   /**
-   * @brief Default constructor for the Parser class.
+   * @brief Constructor for the Parser class.
+   * @param body_decoding When the bodies are decoded. With the lazy decoding
+   * the messages only point into the parsed structure messages, and share the
+   * ownership of their memory.
+   * @param thread_count The number of threads used to parse, the registered
+   * body parsers are called from all of them at the same time. The result is
+   * the same for any number of threads.
+   * @param error_messages Whether the errors carry their messages.
+   * @param symbol_table Where the IDs of the parsed messages are interned, it
+   * must outlive the parser and the messages.
    */
-  Parser() = default;
+  Parser(BodyDecoding body_decoding, size_t thread_count,
+         ErrorMessages error_messages, log_message::SymbolTable& symbol_table)
+      : body_decoding_(body_decoding),
+        thread_count_(thread_count),
+        error_messages_(error_messages),
+        symbol_table_(&symbol_table) {}
+
+#if defined(PIPELINES_TESTING)
+  /**
+   * @brief Constructor that interns the IDs in the global table, only for
+   * the tests.
+   * @param body_decoding When the bodies are decoded.
+   * @param thread_count The number of threads used to parse.
+   * @param error_messages Whether the errors carry their messages.
+   */
+  explicit Parser(BodyDecoding body_decoding = BodyDecoding::kEager,
+                  size_t thread_count = 1,
+                  ErrorMessages error_messages = ErrorMessages::kFull)
+      : Parser(body_decoding, thread_count, error_messages,
+               log_message::SymbolTable::Global()) {}
+#endif
 
   /**
    * @brief Registers a body parser for a specific encoding.
@@ -189,8 +480,33 @@ class Parser {
    */
   ParseResult Parse(const structure::LogMessages& structure_log_messages);
 
+  /**
+   * @brief Parses the structured log messages produced by the zero-copy parser.
+   * @param structure_log_messages The structured log message views to parse.
+   * @param input_owner Keeps the viewed input alive for the lazily decoded
+   * bodies, e.g. the MappedFile. If it's null the caller is responsible for
+   * keeping the input alive while the messages are used.
+   * @return A ParseResult containing the parsed messages and errors.
+   */
+  ParseResult Parse(const structure::LogMessageViews& structure_log_messages,
+                    std::shared_ptr<const void> input_owner = nullptr);
+
+  /**
+   * @brief Checks the structured log messages without creating them, so no
+   * ID is interned and no body is decoded.
+   * @param structure_log_messages The structured log messages to check.
+   * @return The error Parse() reports for every message, none for the ones
+   * it parses.
+   */
+  MessageErrors Validate(
+      const structure::LogMessages& structure_log_messages) const;
+
  private:
-  BodyParserMap body_parsers_; /**< Registered body parsers. */
+  BodyParserMap body_parsers_;   /**< Registered body parsers. */
+  BodyDecoding body_decoding_;   /**< When the bodies are decoded. */
+  size_t thread_count_;          /**< The number of threads used to parse. */
+  ErrorMessages error_messages_; /**< Whether the errors carry messages. */
+  log_message::SymbolTable* symbol_table_; /**< Where the IDs are interned. */
 };
 
 }  // namespace pipelines::log_message_parser::semantics
@@ -0,0 +1,330 @@
+/**
+ * @file static_parser.h
+ * @brief Defines the StaticParser class, a semantics parser whose body
+ * parsers are fixed at compile time.
+ *
+ * The encodings and their body parsers are template arguments, e.g.
+ * StaticParser<Encoding<"0", AsciiBodyParser>, Encoding<"1",
+ * Hex16BodyParser>>. The encoding of a message is packed with its length into
+ * an integer and compared against the packed codes, constants that the
+ * compiler can turn into a switch on the length and the bytes of the
+ * encoding, and the body parsers are called directly instead of through their
+ * virtual methods. The parsing itself is the same as the
+ * Parser's, see body_batches.h, so both give the same results. The Parser is
+ * still the one to use when the body parsers are only known at runtime.
+ */
+
+#ifndef COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_STATIC_PARSER_H_
+#define COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_STATIC_PARSER_H_
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "log_message_parser/body_batches.h"
+#include "log_message_parser/semantics.h"
+#include "log_message_parser/structure.h"
+#include "log_message_parser/structure_view.h"
+
+/******************************************************************************
+ * CLASSES
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::semantics {
+
+/**
+ * @struct EncodingCode
+ * @brief An encoding code that can be used as a template argument, built from
+ * a string literal.
+ * @tparam N The size of the string literal, including the null terminator.
+ */
+template <size_t N>
+struct EncodingCode {
+  /**
+   * @brief Constructs the code from a string literal.
+   * @param code The string literal.
+   */
+  constexpr EncodingCode(const char (&code)[N]) {
+    std::copy_n(code, N, characters);
+  }
+
+  /**
+   * @brief Retrieves the code as a string.
+   * @return The code, without the null terminator.
+   */
+  constexpr std::string_view view() const { return {characters, N - 1}; }
+
+  char characters[N]{}; /**< The characters of the string literal. */
+};
+
+/// Longest encoding code that is packed into an integer, see PackEncodingCode
+constexpr size_t kMaxPackedCodeSize = 7;
+
+/// Packed value of the encoding codes longer than kMaxPackedCodeSize
+constexpr auto kLongEncodingCode = std::numeric_limits<uint64_t>::max();
+
+/**
+ * @brief Packs an encoding code into an integer, its length in the highest
+ * byte and its characters in the others, so two codes are equal if their
+ * packed values are.
+ * @param code The encoding code.
+ * @return The packed code, or kLongEncodingCode if the code is longer than
+ * kMaxPackedCodeSize.
+ */
+constexpr uint64_t PackEncodingCode(std::string_view code) {
+  if (code.size() > kMaxPackedCodeSize) {
+    return kLongEncodingCode;
+  }
+  auto packed = uint64_t{code.size()} << 56;
+  for (size_t i = 0; i < code.size(); ++i) {
+    packed |= uint64_t{static_cast<unsigned char>(code[i])} << (8 * i);
+  }
+  return packed;
+}
+
+/**
+ * @struct Encoding
+ * @brief Associates an encoding code with the body parser of its bodies.
+ * @tparam Code The encoding code, e.g. "1".
+ * @tparam EncodingBodyParser The body parser, it must derive from BodyParser
+ * and be default constructible.
+ */
+template <EncodingCode Code, typename EncodingBodyParser>
+struct Encoding {
+  static_assert(std::is_base_of_v<BodyParser, EncodingBodyParser>,
+                "The body parser of an encoding must derive from BodyParser");
+
+  /// The encoding code
+  static constexpr std::string_view kCode = Code.view();
+
+  /// The encoding code packed, see PackEncodingCode
+  static constexpr uint64_t kPackedCode = PackEncodingCode(kCode);
+
+  /// The body parser of the bodies with this encoding
+  using BodyParserType = EncodingBodyParser;
+};
+
+/**
+ * @class StaticBodyParsers
+ * @brief The registry of the body parsers fixed at compile time, see
+ * ParseInBatches.
+ * @tparam Encodings The encodings, instances of Encoding.
+ */
+template <typename... Encodings>
+class StaticBodyParsers {
+ public:
+  /**
+   * @brief Retrieves the number of body parsers.
+   * @return The number of encodings.
+   */
+  static constexpr size_t size() { return sizeof...(Encodings); }
+
+  /**
+   * @brief Finds the body parser of an encoding.
+   *
+   * The encoding is packed once, and compared against the packed codes as
+   * integers; only the codes too long to be packed compare their strings.
+   *
+   * @param encoding The encoding of a message.
+   * @return The number of the body parser, its position in the template
+   * arguments, or kNoBatch if there is none.
+   */
+  static constexpr size_t Find(std::string_view encoding) {
+    const auto packed = PackEncodingCode(encoding);
+    auto body_parser = kNoBatch;
+    auto position = size_t{0};
+    ((packed == Encodings::kPackedCode &&
+              (packed != kLongEncodingCode || encoding == Encodings::kCode)
+          ? (body_parser = position, true)
+          : (++position, false)) ||
+     ...);
+    return body_parser;
+  }
+
+  /**
+   * @brief Parses a batch of bodies, see BodyParser::ParseBatch.
+   * @param body_parser The number of the body parser.
+   * @param bodies The bodies to parse.
+   * @param buffer The buffer where the parsed bodies may be written.
+   * @param results Replaced by the result of every body.
+   */
+  void ParseBatch(size_t body_parser, std::span<const std::string_view> bodies,
+                  std::string& buffer, BodyParseBatchResults& results) const {
+    Visit(body_parser, [&](const auto& parser) {
+      using BodyParserType = std::remove_cvref_t<decltype(parser)>;
+      parser.BodyParserType::ParseBatch(bodies, buffer, results);
+    });
+  }
+
+  /**
+   * @brief Checks a body, see BodyParser::Validate.
+   * @param body_parser The number of the body parser.
+   * @param body The body to check.
+   * @return The error that prevents parsing the body, if any.
+   */
+  std::optional<BodyError> Validate(size_t body_parser,
+                                    std::string_view body) const {
+    auto error = std::optional<BodyError>{};
+    Visit(body_parser, [&](const auto& parser) {
+      using BodyParserType = std::remove_cvref_t<decltype(parser)>;
+      error = parser.BodyParserType::Validate(body);
+    });
+    return error;
+  }
+
+  /**
+   * @brief Retrieves the decoder of a body parser, see BodyParser::decoder.
+   * @param body_parser The number of the body parser.
+   * @return The decoder, or nullptr if there is none.
+   */
+  Body::Decoder decoder(size_t body_parser) const {
+    auto decoder = Body::Decoder{nullptr};
+    Visit(body_parser, [&](const auto& parser) {
+      using BodyParserType = std::remove_cvref_t<decltype(parser)>;
+      decoder = parser.BodyParserType::decoder();
+    });
+    return decoder;
+  }
+
+ private:
+  /**
+   * @brief Calls a function with one of the body parsers.
+   *
+   * The calls through the qualified names of the body parsers are direct,
+   * the type of every body parser is known.
+   *
+   * @param body_parser The number of the body parser.
+   * @param function The function, called with the body parser.
+   */
+  template <typename Function>
+  void Visit(size_t body_parser, Function function) const {
+    [&]<size_t... Positions>(std::index_sequence<Positions...>) {
+      ((body_parser == Positions
+            ? (function(std::get<Positions>(body_parsers_)), true)
+            : false) ||
+       ...);
+    }(std::index_sequence_for<Encodings...>{});
+  }
+
+  /// The body parsers, in the order of the encodings
+  std::tuple<typename Encodings::BodyParserType...> body_parsers_;
+};
+
+/**
+ * @class StaticParser
+ * @brief Semantics parser of the log messages, with a body parser for each
+ * of the given encodings.
+ *
+ * It gives the same results as a Parser with the same body parsers
+ * registered, without looking them up or calling them through virtual
+ * methods.
+ *
+ * @tparam Encodings The encodings, instances of Encoding with different
+ * codes.
+ */
+template <typename... Encodings>
+class StaticParser {
+  static_assert(
+      [] {
+        auto codes = std::array<std::string_view, sizeof...(Encodings)>{
+            Encodings::kCode...};
+        std::sort(codes.begin(), codes.end());
+        return std::adjacent_find(codes.begin(), codes.end()) == codes.end();
+      }(),
+      "The encodings of a StaticParser must have different codes");
+
+ public:
+  /**
+   * @brief Constructor for the StaticParser class.
+   * @param body_decoding When the bodies are decoded, see Parser.
+   * @param thread_count The number of threads used to parse, see Parser.
+   * @param error_messages Whether the errors carry their messages.
+   * @param symbol_table Where the IDs of the parsed messages are interned, it
+   * must outlive the parser and the messages.
+   */
+  StaticParser(BodyDecoding body_decoding, size_t thread_count,
+               ErrorMessages error_messages,
+               log_message::SymbolTable& symbol_table)
+      : body_decoding_(body_decoding),
+        thread_count_(thread_count),
+        error_messages_(error_messages),
+        symbol_table_(&symbol_table) {}
+
+#if defined(PIPELINES_TESTING)
+  /**
+   * @brief Constructor that interns the IDs in the global table, only for
+   * the tests.
+   * @param body_decoding When the bodies are decoded, see Parser.
+   * @param thread_count The number of threads used to parse, see Parser.
+   * @param error_messages Whether the errors carry their messages.
+   */
+  explicit StaticParser(BodyDecoding body_decoding = BodyDecoding::kEager,
+                        size_t thread_count = 1,
+                        ErrorMessages error_messages = ErrorMessages::kFull)
+      : StaticParser(body_decoding, thread_count, error_messages,
+                     log_message::SymbolTable::Global()) {}
+#endif
+
+  /**
+   * @brief Parses the structured log messages.
+   * @param structure_log_messages The structured log messages to parse.
+   * @return A ParseResult containing the parsed messages and errors.
+   */
+  ParseResult Parse(const structure::LogMessages& structure_log_messages) {
+    return ParseInBatches(body_parsers_, body_decoding_, error_messages_,
+                          *symbol_table_, structure_log_messages, nullptr,
+                          thread_count_);
+  }
+
+  /**
+   * @brief Parses the structured log messages produced by the zero-copy parser.
+   * @param structure_log_messages The structured log message views to parse.
+   * @param input_owner Keeps the viewed input alive for the lazily decoded
+   * bodies, see Parser.
+   * @return A ParseResult containing the parsed messages and errors.
+   */
+  ParseResult Parse(const structure::LogMessageViews& structure_log_messages,
+                    std::shared_ptr<const void> input_owner = nullptr) {
+    return ParseInBatches(body_parsers_, body_decoding_, error_messages_,
+                          *symbol_table_, structure_log_messages, input_owner,
+                          thread_count_);
+  }
+
+  /**
+   * @brief Checks the structured log messages without creating them, see
+   * Parser::Validate.
+   * @param structure_log_messages The structured log messages to check.
+   * @return The error Parse() reports for every message, none for the ones
+   * it parses.
+   */
+  MessageErrors Validate(
+      const structure::LogMessages& structure_log_messages) const {
+    return ValidateMessages(body_parsers_, error_messages_,
+                            structure_log_messages);
+  }
+
+ private:
+  StaticBodyParsers<Encodings...> body_parsers_; /**< The body parsers. */
+  BodyDecoding body_decoding_;   /**< When the bodies are decoded. */
+  size_t thread_count_;          /**< The number of threads used to parse. */
+  ErrorMessages error_messages_; /**< Whether the errors carry messages. */
+  log_message::SymbolTable* symbol_table_; /**< Where the IDs are interned. */
+};
+
+}  // namespace pipelines::log_message_parser::semantics
+
+#endif  // COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_STATIC_PARSER_H_
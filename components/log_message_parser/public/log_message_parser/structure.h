@@ -15,10 +15,17 @@
  * INCLUDES
  *****************************************************************************/
 
+#include <cstddef>
 #include <istream>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#include "log_message_parser/field_arena.h"
+#include "log_message_parser/input_source.h"
+
 /******************************************************************************
  * TYPE DEFINITIONS
  *****************************************************************************/
@@ -30,6 +37,20 @@ using LogMessages =
 using ParseErrors =
     std::vector<class ParseError>; /**< Collection of parsing errors. */
 
+/**
+ * @struct BodyLimits
+ * @brief Limits on the size of a message body, 0 means no limit.
+ *
+ * An opening bracket that is never closed makes the body extend until the end
+ * of the input. With a limit, such a body is reported as a single error and
+ * the parsing continues at the next line that looks like the start of a
+ * message (three fields and an opening bracket).
+ */
+struct BodyLimits {
+  size_t max_bytes{0}; /**< Maximum number of bytes of a body. */
+  size_t max_lines{0}; /**< Maximum number of lines a body can span. */
+};
+
 }  // namespace pipelines::log_message_parser::structure
 
 /******************************************************************************
@@ -44,21 +65,51 @@ namespace pipelines::log_message_parser::structure {
  *
  * This class encapsulates the details of a log message, including its pipeline ID,
  * message ID, encoding type, body content, and the ID of the next message in the sequence.
+ *
+ * The fields are views into a FieldArena that the message keeps alive. The
+ * parsers store all the messages of a parse in the same arena, so a message
+ * doesn't allocate anything on its own.
  */
 class LogMessage {
  public:
   /**
-   * @brief Constructs a LogMessage with the given parameters.
+   * @brief Constructs a LogMessage with the given parameters, copying them
+   * into an arena of its own.
+   * @param pipeline_id The ID of the pipeline.
+   * @param id The ID of the log message.
+   * @param encoding The encoding type of the log message body.
+   * @param body The body content of the log message.
+   * @param next_id The ID of the next log message in the sequence.
+   */
+  LogMessage(std::string_view pipeline_id, std::string_view id,
+             std::string_view encoding, std::string_view body,
+             std::string_view next_id) {
+    auto arena = std::make_shared<FieldArena>(
+        pipeline_id.size() + id.size() + encoding.size() + body.size() +
+        next_id.size());
+    pipeline_id_ = arena->Store(pipeline_id);
+    id_ = arena->Store(id);
+    encoding_ = arena->Store(encoding);
+    body_ = arena->Store(body);
+    next_id_ = arena->Store(next_id);
+    arena_ = std::move(arena);
+  }
+
+  /**
+   * @brief Constructs a LogMessage whose fields are already in an arena.
+   * @param arena The arena where the fields are stored.
    * @param pipeline_id The ID of the pipeline.
    * @param id The ID of the log message.
    * @param encoding The encoding type of the log message body.
    * @param body The body content of the log message.
    * @param next_id The ID of the next log message in the sequence.
    */
-  LogMessage(const std::string& pipeline_id, const std::string& id,
-             const std::string& encoding, const std::string& body,
-             const std::string& next_id)
-      : pipeline_id_(pipeline_id),
+  LogMessage(std::shared_ptr<const FieldArena> arena,
+             std::string_view pipeline_id, std::string_view id,
+             std::string_view encoding, std::string_view body,
+             std::string_view next_id)
+      : arena_(std::move(arena)),
+        pipeline_id_(pipeline_id),
         id_(id),
         encoding_(encoding),
         body_(body),
@@ -66,33 +117,39 @@ class LogMessage {
 
   /**
    * @brief Retrieves the pipeline ID.
-   * @return The pipeline ID as a string.
+   * @return The pipeline ID, valid as long as the message.
    */
-  const std::string& pipeline_id() const { return pipeline_id_; }
+  std::string_view pipeline_id() const { return pipeline_id_; }
 
   /**
    * @brief Retrieves the log message ID.
-   * @return The log message ID as a string.
+   * @return The log message ID, valid as long as the message.
    */
-  const std::string& id() const { return id_; }
+  std::string_view id() const { return id_; }
 
   /**
    * @brief Retrieves the body content of the log message.
-   * @return The body content as a string.
+   * @return The body content, valid as long as the message.
    */
-  const std::string& body() const { return body_; }
+  std::string_view body() const { return body_; }
 
   /**
    * @brief Retrieves the ID of the next log message in the sequence.
-   * @return The next log message ID as a string.
+   * @return The next log message ID, valid as long as the message.
    */
-  const std::string& next_id() const { return next_id_; }
+  std::string_view next_id() const { return next_id_; }
 
   /**
    * @brief Retrieves the encoding type of the log message body.
-   * @return The encoding type as a string.
+   * @return The encoding type, valid as long as the message.
    */
-  const std::string& encoding() const { return encoding_; }
+  std::string_view encoding() const { return encoding_; }
+
+  /**
+   * @brief Retrieves the arena where the fields are stored.
+   * @return The arena, sharing it keeps the fields alive.
+   */
+  const std::shared_ptr<const FieldArena>& arena() const { return arena_; }
 
   /**
    * @brief Compares two LogMessage objects for equality.
@@ -121,11 +178,12 @@ class LogMessage {
   }
 
  private:
-  std::string pipeline_id_; /**< The ID of the pipeline. */
-  std::string id_;          /**< The ID of the log message. */
-  std::string encoding_;    /**< The encoding type of the log message body. */
-  std::string body_;        /**< The body content of the log message. */
-  std::string next_id_; /**< The ID of the next log message in the sequence. */
+  std::shared_ptr<const FieldArena> arena_; /**< Where the fields are. */
+  std::string_view pipeline_id_; /**< The ID of the pipeline. */
+  std::string_view id_;          /**< The ID of the log message. */
+  std::string_view encoding_; /**< The encoding type of the message body. */
+  std::string_view body_;     /**< The body content of the log message. */
+  std::string_view next_id_;  /**< The ID of the next log message. */
 };
 
 /**
@@ -176,20 +234,32 @@ class ParseResult {
    * @param messages The successfully parsed log messages.
    * @param errors The errors encountered during parsing.
    */
-  ParseResult(const LogMessages& messages, const ParseErrors& errors)
-      : messages_(messages), errors_(errors) {}
+  ParseResult(LogMessages messages, ParseErrors errors)
+      : messages_(std::move(messages)), errors_(std::move(errors)) {}
 
   /**
    * @brief Retrieves the parsed log messages.
    * @return A reference to the collection of parsed log messages.
    */
-  const LogMessages& messages() const { return messages_; }
+  const LogMessages& messages() const& { return messages_; }
+
+  /**
+   * @brief Moves the parsed log messages out of an expiring result.
+   * @return The collection of parsed log messages.
+   */
+  LogMessages messages() && { return std::move(messages_); }
 
   /**
    * @brief Retrieves the parsing errors.
    * @return A reference to the collection of parsing errors.
    */
-  const ParseErrors& errors() const { return errors_; }
+  const ParseErrors& errors() const& { return errors_; }
+
+  /**
+   * @brief Moves the parsing errors out of an expiring result.
+   * @return The collection of parsing errors.
+   */
+  ParseErrors errors() && { return std::move(errors_); }
 
   /**
    * @brief Checks if any errors were encountered during parsing.
@@ -206,26 +276,51 @@ class ParseResult {
  * @class Parser
  * @brief Parses structured log messages from an input stream.
  *
- * This class reads structured log messages from an input stream and
- * produces a ParseResult containing the parsed messages and any errors
- * encountered during parsing.
+ * This class reads structured log messages from an input stream, or from any
+ * other InputSource, and produces a ParseResult containing the parsed
+ * messages and any errors encountered during parsing.
  */
 class Parser {
  public:
   /**
    * @brief Constructs a Parser with the given input stream.
    * @param input_stream The input stream containing structured log messages.
+   * @param thread_count The number of threads used to parse. With more than
+   * one thread the whole stream is read into memory before parsing, the
+   * result is the same for any number of threads.
+   * @param body_limits The limits on the size of the message bodies.
+   */
+  explicit Parser(std::istream& input_stream, size_t thread_count = 1,
+                  BodyLimits body_limits = {})
+      : Parser(std::make_unique<StreamInputSource>(input_stream), thread_count,
+               body_limits) {}
+
+  /**
+   * @brief Constructs a Parser with the given input source.
+   * @param input_source The input source containing structured log messages.
+   * @param thread_count The number of threads used to parse. With more than
+   * one thread the whole input is read into memory before parsing, the
+   * result is the same for any number of threads.
+   * @param body_limits The limits on the size of the message bodies.
    */
-  explicit Parser(std::istream& input_stream) : input_stream_(input_stream) {}
+  explicit Parser(std::unique_ptr<InputSource> input_source,
+                  size_t thread_count = 1, BodyLimits body_limits = {})
+      : input_source_(std::move(input_source)),
+        thread_count_(thread_count),
+        body_limits_(body_limits) {}
 
   /**
-   * @brief Parses the structured log messages from the input stream.
+   * @brief Parses the structured log messages from the input.
    * @return A ParseResult containing the parsed messages and errors.
+   * @throws InputSourceError if the input can't be read.
    */
   ParseResult Parse();
 
  private:
-  std::istream& input_stream_; /**< The input stream containing log messages. */
+  std::unique_ptr<InputSource>
+      input_source_;    /**< The input containing log messages. */
+  size_t thread_count_;    /**< The number of threads used to parse. */
+  BodyLimits body_limits_; /**< The limits on the size of the bodies. */
 };
 
 }  // namespace pipelines::log_message_parser::structure
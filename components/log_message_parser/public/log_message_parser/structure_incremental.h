@@ -0,0 +1,106 @@
+/**
+ * @file structure_incremental.h
+ * @brief Push based variant of the structure parser.
+ *
+ * This file contains the declaration of the IncrementalParser class. It
+ * follows the same rules as the Parser in structure.h, but instead of pulling
+ * the whole input from a stream, the input is pushed to it in blocks as they
+ * arrive (e.g. from a socket), and every message is returned as soon as it is
+ * complete.
+ */
+
+#ifndef COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_STRUCTURE_INCREMENTAL_H_
+#define COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_STRUCTURE_INCREMENTAL_H_
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+
+#include "log_message_parser/structure.h"
+
+/******************************************************************************
+ * CLASSES
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+struct UnfinishedMessage;
+
+/**
+ * @class IncrementalParser
+ * @brief Parses structured log messages from input that arrives in blocks.
+ *
+ * A message is returned by the Feed() call that delivers the end of the line
+ * after its next ID, and the errors are returned together with the message
+ * they belong to. Only the data of the message that is not complete yet is
+ * kept, so the memory used is bounded by the biggest message and not by the
+ * size of the input.
+ *
+ * Feeding the whole input at once, or in blocks of any size, and then calling
+ * Finish() produces the same messages and errors as Parser.
+ */
+class IncrementalParser {
+ public:
+  /**
+   * @brief Constructs an IncrementalParser.
+   * @param body_limits The limits on the size of the message bodies, which
+   * also bound the memory used by an incomplete message.
+   */
+  explicit IncrementalParser(BodyLimits body_limits = {})
+      : body_limits_(body_limits) {}
+
+  /**
+   * @brief Parses the next block of the input.
+   * @param data The next block of the input, it can end anywhere, even in
+   * the middle of a message.
+   * @return The messages completed by this block, and their errors.
+   */
+  ParseResult Feed(std::span<const char> data);
+
+  /**
+   * @brief Parses what is left of the input, once it has ended.
+   *
+   * After this call the parser can be used for a new input.
+   *
+   * @return The messages and errors found in the end of the input.
+   */
+  ParseResult Finish();
+
+  /**
+   * @brief Gets the size of the input kept for the message that is not
+   * complete yet.
+   * @return The number of characters kept.
+   */
+  size_t pending_size() const { return pending_.size(); }
+
+ private:
+  std::string pending_;    /**< The input of the incomplete message. */
+  size_t parsed_size_ = 0; /**< The size of the pending input after the
+                                last parse. */
+  size_t line_number_ = 1; /**< The line number of the pending input. */
+  BodyLimits body_limits_; /**< The limits on the size of the bodies. */
+  bool is_skipping_lines_ = false; /**< If the pending input starts in the
+                                        lines skipped after a body that
+                                        exceeded the limits. */
+  /// The incomplete message at the start of the pending input, if its body
+  /// was being read, so the reading continues where it stopped
+  std::shared_ptr<const UnfinishedMessage> unfinished_message_;
+
+  /**
+   * @brief Parses the messages of the pending input, dropping the input of
+   * the ones that are complete.
+   * @param has_input_ended If the end of the pending input is the end of the
+   * input, so every message is complete.
+   * @return The complete messages and their errors.
+   */
+  ParseResult ParsePending(bool has_input_ended);
+};
+
+}  // namespace pipelines::log_message_parser::structure
+
+#endif  // COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_STRUCTURE_INCREMENTAL_H_
@@ -0,0 +1,267 @@
+/**
+ * @file structure_view.h
+ * @brief Zero-copy variant of the structure parser.
+ *
+ * This file contains the declarations of the LogMessageView, ViewParseResult
+ * and ViewParser classes. They follow the same rules as the classes in
+ * structure.h, but instead of copying every field into a new string, the
+ * fields are views into the parsed input (e.g. a memory mapped file).
+ */
+
+#ifndef COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_STRUCTURE_VIEW_H_
+#define COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_STRUCTURE_VIEW_H_
+
+/******************************************************************************
+ * INCLUDES
+ *****************************************************************************/
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "log_message_parser/mapped_file.h"
+#include "log_message_parser/structure.h"
+
+/******************************************************************************
+ * TYPE DEFINITIONS
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+using LogMessageViews =
+    std::vector<class LogMessageView>; /**< Collection of log message views. */
+
+}  // namespace pipelines::log_message_parser::structure
+
+/******************************************************************************
+ * CLASSES
+ *****************************************************************************/
+
+namespace pipelines::log_message_parser::structure {
+
+/**
+ * @class LogMessageView
+ * @brief Represents a structured log message whose fields point into the
+ * parsed input.
+ *
+ * It has the same fields as LogMessage, but it does not own them. The input
+ * the message was parsed from must outlive it.
+ */
+class LogMessageView {
+ public:
+  /**
+   * @brief Constructs a LogMessageView with the given parameters.
+   * @param pipeline_id The ID of the pipeline.
+   * @param id The ID of the log message.
+   * @param encoding The encoding type of the log message body.
+   * @param body The body content of the log message.
+   * @param next_id The ID of the next log message in the sequence.
+   */
+  constexpr LogMessageView(std::string_view pipeline_id, std::string_view id,
+                           std::string_view encoding, std::string_view body,
+                           std::string_view next_id)
+      : pipeline_id_(pipeline_id),
+        id_(id),
+        encoding_(encoding),
+        body_(body),
+        next_id_(next_id) {}
+
+  /**
+   * @brief Retrieves the pipeline ID.
+   * @return The pipeline ID.
+   */
+  std::string_view pipeline_id() const { return pipeline_id_; }
+
+  /**
+   * @brief Retrieves the log message ID.
+   * @return The log message ID.
+   */
+  std::string_view id() const { return id_; }
+
+  /**
+   * @brief Retrieves the body content of the log message.
+   * @return The body content.
+   */
+  std::string_view body() const { return body_; }
+
+  /**
+   * @brief Retrieves the ID of the next log message in the sequence.
+   * @return The next log message ID.
+   */
+  std::string_view next_id() const { return next_id_; }
+
+  /**
+   * @brief Retrieves the encoding type of the log message body.
+   * @return The encoding type.
+   */
+  std::string_view encoding() const { return encoding_; }
+
+  /**
+   * @brief Copies the fields into an owning LogMessage.
+   * @return A LogMessage with the same content as this view.
+   */
+  LogMessage ToLogMessage() const {
+    return {pipeline_id_, id_, encoding_, body_, next_id_};
+  }
+
+  /**
+   * @brief Compares two LogMessageView objects for equality.
+   * @param other The other LogMessageView object to compare.
+   * @return true if the content of both views is equal, false otherwise.
+   */
+  bool operator==(const LogMessageView& other) const {
+    return pipeline_id_ == other.pipeline_id_ && id_ == other.id_ &&
+           encoding_ == other.encoding_ && body_ == other.body_ &&
+           next_id_ == other.next_id_;
+  }
+
+  /**
+   * @brief Outputs the LogMessageView details to a stream.
+   * @param os The output stream.
+   * @param message The LogMessageView object to output.
+   * @return The output stream.
+   */
+  friend std::ostream& operator<<(std::ostream& os,
+                                  const LogMessageView& message) {
+    os << "(Pipeline ID: \"" << message.pipeline_id_ << "\", "
+       << "ID: \"" << message.id_ << "\", "
+       << "Encoding: \"" << message.encoding_ << "\", "
+       << "Body: \"" << message.body_ << "\", "
+       << "Next ID: \"" << message.next_id_ << "\")";
+    return os;
+  }
+
+ private:
+  std::string_view pipeline_id_; /**< The ID of the pipeline. */
+  std::string_view id_;          /**< The ID of the log message. */
+  std::string_view encoding_; /**< The encoding type of the log message body. */
+  std::string_view body_;     /**< The body content of the log message. */
+  std::string_view next_id_;  /**< The ID of the next log message. */
+};
+
+/**
+ * @class ViewParseResult
+ * @brief Represents the result of a zero-copy parsing operation.
+ *
+ * Besides the parsed messages and the errors, it also keeps the memory mapping
+ * the messages point into alive, if the input was a mapped file.
+ */
+class ViewParseResult {
+ public:
+  /**
+   * @brief Constructs a ViewParseResult with the given messages and errors.
+   * @param messages The successfully parsed log messages.
+   * @param errors The errors encountered during parsing.
+   * @param mapped_file The mapping the messages point into, can be null if
+   * the caller owns the parsed input.
+   */
+  ViewParseResult(LogMessageViews messages, ParseErrors errors,
+                  std::shared_ptr<const MappedFile> mapped_file)
+      : mapped_file_(std::move(mapped_file)),
+        messages_(std::move(messages)),
+        errors_(std::move(errors)) {}
+
+  /**
+   * @brief Retrieves the parsed log messages.
+   * @return A reference to the collection of parsed log messages.
+   */
+  const LogMessageViews& messages() const& { return messages_; }
+
+  /**
+   * @brief Moves the parsed log messages out of an expiring result.
+   * @return The collection of parsed log messages.
+   */
+  LogMessageViews messages() && { return std::move(messages_); }
+
+  /**
+   * @brief Retrieves the parsing errors.
+   * @return A reference to the collection of parsing errors.
+   */
+  const ParseErrors& errors() const& { return errors_; }
+
+  /**
+   * @brief Moves the parsing errors out of an expiring result.
+   * @return The collection of parsing errors.
+   */
+  ParseErrors errors() && { return std::move(errors_); }
+
+  /**
+   * @brief Retrieves the mapping the messages point into.
+   * @return The mapping, null if the caller owns the parsed input.
+   */
+  const std::shared_ptr<const MappedFile>& mapped_file() const {
+    return mapped_file_;
+  }
+
+  /**
+   * @brief Checks if any errors were encountered during parsing.
+   * @return true if there are errors, false otherwise.
+   */
+  bool HasErrors() const { return !errors_.empty(); }
+
+ private:
+  std::shared_ptr<const MappedFile>
+      mapped_file_;         /**< Keeps the viewed memory alive. */
+  LogMessageViews messages_; /**< The successfully parsed log messages. */
+  ParseErrors errors_;       /**< The errors encountered during parsing. */
+};
+
+/**
+ * @class ViewParser
+ * @brief Parses structured log messages from contiguous memory without
+ * copying the fields.
+ *
+ * It follows the same rules and reports the same errors as Parser, but the
+ * resulting messages are views into the input.
+ */
+class ViewParser {
+ public:
+  /**
+   * @brief Constructs a ViewParser over memory owned by the caller.
+   * @param input The input containing structured log messages, it must
+   * outlive the parse result.
+   * @param thread_count The number of threads used to parse, the result is
+   * the same for any number of threads.
+   * @param body_limits The limits on the size of the message bodies.
+   */
+  explicit ViewParser(std::span<const char> input, size_t thread_count = 1,
+                      BodyLimits body_limits = {})
+      : input_(input), thread_count_(thread_count), body_limits_(body_limits) {}
+
+  /**
+   * @brief Constructs a ViewParser over a mapped file.
+   * @param mapped_file The mapped file, its ownership is shared with the
+   * parse result so the messages stay valid.
+   * @param thread_count The number of threads used to parse, the result is
+   * the same for any number of threads.
+   * @param body_limits The limits on the size of the message bodies.
+   */
+  explicit ViewParser(std::shared_ptr<const MappedFile> mapped_file,
+                      size_t thread_count = 1, BodyLimits body_limits = {})
+      : input_(mapped_file->data()),
+        mapped_file_(std::move(mapped_file)),
+        thread_count_(thread_count),
+        body_limits_(body_limits) {}
+
+  /**
+   * @brief Parses the structured log messages from the input.
+   * @return A ViewParseResult containing the parsed messages and errors.
+   */
+  ViewParseResult Parse() const;
+
+ private:
+  std::span<const char> input_; /**< The input containing log messages. */
+  std::shared_ptr<const MappedFile>
+      mapped_file_; /**< The owner of the input, if any. */
+  size_t thread_count_;    /**< The number of threads used to parse. */
+  BodyLimits body_limits_; /**< The limits on the size of the bodies. */
+};
+
+}  // namespace pipelines::log_message_parser::structure
+
+#endif  // COMPONENT_LOG_MESSAGE_PARSER_PUBLIC_LOG_MESSAGE_PARSER_STRUCTURE_VIEW_H_
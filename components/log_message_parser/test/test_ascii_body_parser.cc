@@ -1,5 +1,8 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+#include <vector>
 #include "log_message_parser/ascii_body_parser.h"
 
 using ::testing::Eq;
@@ -38,3 +41,41 @@ TEST_F(AsciiBodyParserTest, StringWithTabs) {
   std::string expected_output = "Hello,\tWorld!";
   ASSERT_THAT(parser.Parse(input), Eq(expected_output));
 }
+
+TEST_F(AsciiBodyParserTest, AnyBodyIsValidAndDecodedAsItIs) {
+  std::string input = "Hello, [World]!\n";
+  std::string decoded;
+
+  ASSERT_THAT(parser.Validate(input).has_value(), Eq(false));
+  parser.decoder()(input, decoded);
+  ASSERT_THAT(decoded, Eq(input));
+}
+
+TEST_F(AsciiBodyParserTest, ParseIntoDoesNotCopyTheBody) {
+  std::string input = "Hello, World!";
+  std::string buffer;
+
+  auto parsed_body = parser.ParseInto(input, buffer);
+
+  ASSERT_THAT(parsed_body.has_value(), Eq(true));
+  ASSERT_THAT(parsed_body->data(), Eq(input.data()));
+  ASSERT_THAT(*parsed_body, Eq(input));
+  ASSERT_THAT(buffer.empty(), Eq(true));
+}
+
+TEST_F(AsciiBodyParserTest, ParseBatchDoesNotCopyTheBodies) {
+  std::vector<std::string_view> bodies = {"Hello", "", "World!"};
+  std::string buffer;
+  pipelines::log_message_parser::semantics::BodyParseBatchResults results;
+
+  parser.ParseBatch(bodies, buffer, results);
+
+  ASSERT_THAT(results.size(), Eq(bodies.size()));
+  for (size_t i = 0; i < bodies.size(); ++i) {
+    ASSERT_THAT(results[i].has_value(), Eq(true));
+    ASSERT_THAT(results[i]->data(), Eq(bodies[i].data()));
+    ASSERT_THAT(*results[i], Eq(bodies[i]));
+  }
+  ASSERT_THAT(buffer.empty(), Eq(true));
+}
+
@@ -0,0 +1,117 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <array>
+#include <random>
+#include <string>
+#include "chunked_parser.h"
+
+using ::testing::Eq;
+
+class ChunkedParserTest : public ::testing::Test {
+ protected:
+  /// Small chunks, so small inputs are already split in many of them
+  static constexpr size_t kSmallChunkSize = 256;
+
+  /**
+   * Parses the input with one thread and with several, checking that all of
+   * them produce the same messages and errors.
+   */
+  static void ExpectSameForAnyThreadCount(
+      const std::string& input,
+      pipelines::log_message_parser::structure::BodyLimits body_limits = {}) {
+    using pipelines::log_message_parser::structure::LogMessageViews;
+    using pipelines::log_message_parser::structure::ParseErrors;
+    using pipelines::log_message_parser::structure::ParseInChunks;
+
+    auto expected_messages = LogMessageViews{};
+    auto expected_errors = ParseErrors{};
+    ParseInChunks(input, 1, expected_messages, expected_errors, body_limits);
+
+    for (size_t thread_count : {2, 7, 32}) {
+      auto messages = LogMessageViews{};
+      auto errors = ParseErrors{};
+      ParseInChunks(input, thread_count, messages, errors, body_limits,
+                    kSmallChunkSize);
+
+      ASSERT_THAT(messages, Eq(expected_messages));
+      ASSERT_THAT(errors.size(), Eq(expected_errors.size()));
+      for (size_t i = 0; i < expected_errors.size(); ++i) {
+        ASSERT_THAT(errors[i].message(), Eq(expected_errors[i].message()));
+        ASSERT_THAT(errors[i].line_number(),
+                    Eq(expected_errors[i].line_number()));
+      }
+    }
+  }
+
+  /**
+   * Creates an input by concatenating random tokens.
+   */
+  template <size_t N>
+  static std::string RandomInput(
+      const std::array<std::string_view, N>& tokens, size_t size,
+      unsigned seed) {
+    auto generator = std::mt19937{seed};
+    auto distribution = std::uniform_int_distribution<size_t>{0, N - 1};
+
+    auto input = std::string{};
+    while (input.size() < size) {
+      input += tokens[distribution(generator)];
+    }
+    return input;
+  }
+};
+
+TEST_F(ChunkedParserTest, EmptyInput) {
+  ExpectSameForAnyThreadCount("");
+}
+
+TEST_F(ChunkedParserTest, InputWithoutNewlines) {
+  ExpectSameForAnyThreadCount("1 2 3 [" + std::string(2000, 'a') + "] 4");
+}
+
+TEST_F(ChunkedParserTest, ValidMessages) {
+  auto input = std::string{};
+  for (int i = 0; i < 500; ++i) {
+    input += std::to_string(i % 13) + " " + std::to_string(i) + " 0 [body " +
+             std::to_string(i) + "] " + std::to_string(i + 1) + "\n";
+  }
+  ExpectSameForAnyThreadCount(input);
+}
+
+TEST_F(ChunkedParserTest, BodiesSpanningLines) {
+  // Lines that look like the start of a message inside of the bodies make the
+  // chunks guess wrong where the messages start.
+  constexpr auto kTokens = std::array<std::string_view, 10>{
+      "1 2 3 [", "a",    " ", "\n",     "]", "] 4\n", "[", "x y z [w] 5\n",
+      "\r\n",    "\t"};
+  for (unsigned seed = 0; seed < 20; ++seed) {
+    ExpectSameForAnyThreadCount(RandomInput(kTokens, 20000, seed));
+  }
+}
+
+TEST_F(ChunkedParserTest, MostlyInvalidInput) {
+  constexpr auto kTokens = std::array<std::string_view, 6>{
+      "[", "]", "\n", " ", "a", "\n\n"};
+  for (unsigned seed = 0; seed < 20; ++seed) {
+    ExpectSameForAnyThreadCount(RandomInput(kTokens, 5000, seed));
+  }
+}
+
+TEST_F(ChunkedParserTest, BodyCoveringEveryChunk) {
+  auto input = std::string{"1 2 3 [start\n"};
+  for (int i = 0; i < 500; ++i) {
+    input += "4 5 6 [not a message\n";
+  }
+  input += "] 7\n8 9 0 [last] -1\n";
+  ExpectSameForAnyThreadCount(input);
+}
+
+TEST_F(ChunkedParserTest, BodiesExceedingTheLimits) {
+  constexpr auto kTokens = std::array<std::string_view, 8>{
+      "1 2 3 [", "a", " ", "\n", "]", "] 4\n", "x y z [w] 5\n", "\r\n"};
+  for (unsigned seed = 0; seed < 10; ++seed) {
+    auto input = RandomInput(kTokens, 20000, seed);
+    ExpectSameForAnyThreadCount(input, {.max_bytes = 16});
+    ExpectSameForAnyThreadCount(input, {.max_lines = 2});
+  }
+}
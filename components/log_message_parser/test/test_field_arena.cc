@@ -0,0 +1,76 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "log_message_parser/field_arena.h"
+
+using ::testing::Eq;
+using ::testing::Ge;
+using ::testing::IsEmpty;
+
+using pipelines::log_message_parser::structure::FieldArena;
+
+TEST(FieldArenaTest, StoredFieldsAreCopies) {
+  auto arena = FieldArena{};
+  auto field = std::string{"pipeline-1"};
+  auto stored = arena.Store(field);
+  field[0] = 'x';
+
+  EXPECT_THAT(stored, Eq("pipeline-1"));
+  EXPECT_NE(stored.data(), field.data());
+}
+
+TEST(FieldArenaTest, EmptyFieldsAllocateNothing) {
+  auto arena = FieldArena{};
+
+  EXPECT_THAT(arena.Store(""), IsEmpty());
+  EXPECT_THAT(arena.allocated_bytes(), Eq(0));
+}
+
+TEST(FieldArenaTest, FieldsStayValidWhenTheArenaGrows) {
+  auto arena = FieldArena{16};
+  auto stored = std::vector<std::string_view>{};
+  for (int i = 0; i < 10000; ++i) {
+    stored.push_back(arena.Store(std::to_string(i)));
+  }
+
+  for (int i = 0; i < 10000; ++i) {
+    EXPECT_THAT(stored[i], Eq(std::to_string(i)));
+  }
+}
+
+TEST(FieldArenaTest, SlabsDoubleUpToTheMaximum) {
+  auto arena = FieldArena{16};
+  arena.Store(std::string(16, 'a'));
+  EXPECT_THAT(arena.allocated_bytes(), Eq(16));
+  arena.Store("b");
+  EXPECT_THAT(arena.allocated_bytes(), Eq(16 + 32));
+
+  for (int i = 0; i < 100; ++i) {
+    arena.Store(std::string(FieldArena::kMaxSlabSize / 2, 'c'));
+  }
+  // Fifty slabs of the maximum size, plus the small ones before them
+  EXPECT_THAT(arena.allocated_bytes(), Ge(50 * FieldArena::kMaxSlabSize));
+  EXPECT_LT(arena.allocated_bytes(), 52 * FieldArena::kMaxSlabSize);
+}
+
+TEST(FieldArenaTest, FieldsBiggerThanASlabGetTheirOwn) {
+  auto arena = FieldArena{};
+  const auto big = std::string(FieldArena::kMaxSlabSize * 2, 'a');
+  auto stored = arena.Store(big);
+
+  EXPECT_THAT(stored, Eq(big));
+  EXPECT_THAT(arena.allocated_bytes(), Eq(big.size()));
+}
+
+TEST(FieldArenaTest, AdoptedBuffersAreNotCopied) {
+  auto arena = FieldArena{};
+  auto buffer = std::string(1000, 'a');
+  const auto* data = buffer.data();
+  auto adopted = arena.Adopt(std::move(buffer));
+
+  EXPECT_THAT(adopted.data(), Eq(data));
+  EXPECT_THAT(adopted.size(), Eq(1000));
+  EXPECT_THAT(arena.allocated_bytes(), Eq(1000));
+}
@@ -1,5 +1,9 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <string_view>
+#include <vector>
 #include "log_message_parser/hex16_body_parser.h"
 
 using ::testing::Eq;
@@ -57,3 +61,150 @@ TEST_F(Hex16BodyParserTest, NonHexadecimalCharacters) {
   ASSERT_THROW(parser.Parse(input),
                pipelines::log_message_parser::semantics::BodyParserError);
 }
+
+TEST_F(Hex16BodyParserTest, TryParseValidHexadecimalString) {
+  auto parsed_body = parser.TryParse("4F 4B");
+
+  ASSERT_THAT(parsed_body.has_value(), Eq(true));
+  ASSERT_THAT(*parsed_body, Eq("OK"));
+}
+
+TEST_F(Hex16BodyParserTest, TryParseReturnsErrorsInsteadOfThrowing) {
+  using ::testing::HasSubstr;
+
+  auto odd_length = parser.TryParse("4F4B1");
+  auto non_hexadecimal = parser.TryParse("4G4B");
+
+  ASSERT_THAT(odd_length.has_value(), Eq(false));
+  ASSERT_THAT(odd_length.error().what(), HasSubstr("odd number"));
+  ASSERT_THAT(non_hexadecimal.has_value(), Eq(false));
+  ASSERT_THAT(non_hexadecimal.error().what(), HasSubstr("non-hexadecimal"));
+}
+
+TEST_F(Hex16BodyParserTest, ErrorMessagesAreOnlyBuiltWhenAsked) {
+  using ::testing::HasSubstr;
+
+  auto odd_length = parser.TryParse("4F4B1");
+
+  ASSERT_THAT(odd_length.has_value(), Eq(false));
+  auto message = odd_length.error().Message("4F4B1");
+  ASSERT_THAT(message, HasSubstr("odd number of characters: 5"));
+  ASSERT_THAT(message, HasSubstr("Original string: 4F4B1"));
+  try {
+    parser.Parse("4F4B1");
+    FAIL() << "Parse must throw";
+  } catch (const pipelines::log_message_parser::semantics::BodyParserError&
+               error) {
+    ASSERT_THAT(std::string{error.what()}, Eq(message));
+  }
+}
+
+TEST_F(Hex16BodyParserTest, ValidateReturnsTheErrorsOfTryParse) {
+  for (const auto* input : {"4F4B1", "4G4B", "4G4B1", "4F 4\nB"}) {
+    auto parsed_body = parser.TryParse(input);
+    auto error = parser.Validate(input);
+
+    ASSERT_THAT(error.has_value(), Eq(!parsed_body.has_value())) << input;
+    if (error) {
+      ASSERT_THAT(error->what(), Eq(std::string{parsed_body.error().what()}));
+    }
+  }
+}
+
+TEST_F(Hex16BodyParserTest, DecoderDecodesValidBodies) {
+  std::string input =
+      "566976616d75732072757472756d2069642065726174206e6563207665686963756c612e"
+      "20446f6e6563206672696e67696c6c61206c6163696e696120656c656966656e\n642e";
+  std::string decoded = "Already decoded. ";
+
+  ASSERT_THAT(parser.Validate(input).has_value(), Eq(false));
+  parser.decoder()(input, decoded);
+
+  ASSERT_THAT(decoded, Eq("Already decoded. " + parser.Parse(input)));
+}
+
+TEST_F(Hex16BodyParserTest, ParseIntoReplacesTheBufferContent) {
+  std::string buffer = "previous content, longer than the new one";
+  auto capacity = buffer.capacity();
+
+  auto parsed_body = parser.ParseInto("4F 4B", buffer);
+
+  ASSERT_THAT(parsed_body.has_value(), Eq(true));
+  ASSERT_THAT(*parsed_body, Eq("OK"));
+  ASSERT_THAT(parsed_body->data(), Eq(buffer.data()));
+  ASSERT_THAT(buffer.capacity(), Eq(capacity));
+}
+
+TEST_F(Hex16BodyParserTest, ParseIntoReturnsTheErrorsOfTryParse) {
+  std::string buffer;
+  for (const auto* input : {"4F4B1", "4G4B"}) {
+    auto parsed_body = parser.ParseInto(input, buffer);
+
+    ASSERT_THAT(parsed_body.has_value(), Eq(false));
+    ASSERT_THAT(parsed_body.error().what(),
+                Eq(std::string{parser.TryParse(input).error().what()}));
+  }
+}
+
+TEST_F(Hex16BodyParserTest, ParseBatchDecodesEveryBody) {
+  std::vector<std::string_view> bodies = {"4F4B", "4G4B", "", "62 6F\n64 79",
+                                          "4F4B1"};
+  std::string buffer;
+  pipelines::log_message_parser::semantics::BodyParseBatchResults results;
+
+  parser.ParseBatch(bodies, buffer, results);
+
+  ASSERT_THAT(results.size(), Eq(bodies.size()));
+  ASSERT_THAT(results[0].has_value(), Eq(true));
+  ASSERT_THAT(*results[0], Eq("OK"));
+  ASSERT_THAT(results[2].has_value(), Eq(true));
+  ASSERT_THAT(*results[2], Eq(""));
+  ASSERT_THAT(results[3].has_value(), Eq(true));
+  ASSERT_THAT(*results[3], Eq("body"));
+  for (auto i : {1, 4}) {
+    ASSERT_THAT(results[i].has_value(), Eq(false));
+    ASSERT_THAT(results[i].error().what(),
+                Eq(std::string{
+                    parser.TryParse(std::string(bodies[i])).error().what()}));
+  }
+}
+
+
+TEST_F(Hex16BodyParserTest, ParseBatchCanBeCalledConcurrently) {
+  constexpr auto kThreads = 4;
+
+  // Long bodies, so the decoding kernels run on all the threads at once
+  auto encoded = std::string{};
+  auto expected = std::string{};
+  for (int i = 0; i < 4096; ++i) {
+    encoded += "0123456789abcdef"[(i >> 4) & 0xF];
+    encoded += "0123456789ABCDEF"[i & 0xF];
+    expected.push_back(static_cast<char>(i));
+  }
+  std::vector<std::string_view> bodies(64, encoded);
+
+  auto results = std::vector<std::vector<std::string>>(kThreads);
+  auto threads = std::vector<std::thread>{};
+  for (int thread = 0; thread < kThreads; ++thread) {
+    threads.emplace_back([this, &bodies, &results, thread] {
+      std::string buffer;
+      pipelines::log_message_parser::semantics::BodyParseBatchResults batch;
+      for (int i = 0; i < 16; ++i) {
+        parser.ParseBatch(bodies, buffer, batch);
+        for (const auto& result : batch) {
+          results[thread].emplace_back(result.has_value() ? *result : "");
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (const auto& thread_results : results) {
+    ASSERT_THAT(thread_results.size(), Eq(16 * bodies.size()));
+    for (const auto& result : thread_results) {
+      ASSERT_THAT(result, Eq(expected));
+    }
+  }
+}
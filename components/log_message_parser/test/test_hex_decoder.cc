@@ -0,0 +1,119 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <string_view>
+#include "hex_decoder.h"
+
+using ::testing::Eq;
+
+class HexDecoderTest : public ::testing::Test {
+ protected:
+  /**
+   * Decodes a body with the selected kernel and with the scalar reference,
+   * and checks both agree on the result and the decoded bytes.
+   */
+  static void ExpectSameAsScalar(std::string_view encoded) {
+    using pipelines::log_message_parser::semantics::DecodeHex;
+    using pipelines::log_message_parser::semantics::DecodeHexScalar;
+
+    auto decoded = std::string(encoded.size() / 2, '\0');
+    auto reference = std::string(encoded.size() / 2, '\0');
+    auto result = DecodeHex(encoded, decoded.data());
+    auto reference_result = DecodeHexScalar(encoded, reference.data());
+    auto validated = DecodeHex(encoded, nullptr);
+
+    ASSERT_THAT(result.hex_length, Eq(reference_result.hex_length)) << encoded;
+    ASSERT_THAT(result.are_all_characters_hex,
+                Eq(reference_result.are_all_characters_hex))
+        << encoded;
+    ASSERT_THAT(validated.hex_length, Eq(reference_result.hex_length));
+    ASSERT_THAT(validated.is_valid(), Eq(reference_result.is_valid()));
+    if (result.is_valid()) {
+      ASSERT_THAT(result.decoded_size, Eq(reference_result.decoded_size));
+      decoded.resize(result.decoded_size);
+      reference.resize(result.decoded_size);
+      ASSERT_THAT(decoded, Eq(reference)) << encoded;
+    }
+  }
+};
+
+TEST_F(HexDecoderTest, DecodesDigitsAndBothCases) {
+  using pipelines::log_message_parser::semantics::DecodeHex;
+
+  auto encoded = std::string{"00ff7FaB10"};
+  auto decoded = std::string(5, '\0');
+  auto result = DecodeHex(encoded, decoded.data());
+
+  ASSERT_THAT(result.is_valid(), Eq(true));
+  ASSERT_THAT(result.hex_length, Eq(10));
+  ASSERT_THAT(result.decoded_size, Eq(5));
+  ASSERT_THAT(decoded, Eq(std::string{"\x00\xff\x7f\xab\x10", 5}));
+}
+
+TEST_F(HexDecoderTest, LongBodiesUseTheKernels) {
+  using pipelines::log_message_parser::semantics::DecodeHex;
+
+  auto expected = std::string{};
+  auto encoded = std::string{};
+  for (int i = 0; i < 1000; ++i) {
+    expected.push_back(static_cast<char>(i));
+    encoded += "0123456789abcdef"[(i >> 4) & 0xF];
+    encoded += "0123456789ABCDEF"[i & 0xF];
+  }
+  auto decoded = std::string(expected.size(), '\0');
+  auto result = DecodeHex(encoded, decoded.data());
+
+  ASSERT_THAT(result.is_valid(), Eq(true));
+  ASSERT_THAT(decoded, Eq(expected));
+}
+
+TEST_F(HexDecoderTest, WhitespaceIsSkippedAnywhere) {
+  ExpectSameAsScalar("4 F4B");
+  ExpectSameAsScalar(std::string(40, 'a') + "\n" + std::string(41, 'b') +
+                     " \t\r\v\f" + std::string(61, 'c'));
+  ExpectSameAsScalar(std::string(100, ' ') + std::string(100, 'f'));
+}
+
+TEST_F(HexDecoderTest, InvalidCharactersAreCountedInTheLength) {
+  using pipelines::log_message_parser::semantics::DecodeHex;
+
+  auto body = std::string(70, 'a') + "g" + std::string(29, 'b') + "  ";
+  auto result = DecodeHex(body, nullptr);
+
+  ASSERT_THAT(result.is_valid(), Eq(false));
+  ASSERT_THAT(result.are_all_characters_hex, Eq(false));
+  ASSERT_THAT(result.hex_length, Eq(100));
+}
+
+TEST_F(HexDecoderTest, OddLengthIsInvalid) {
+  using pipelines::log_message_parser::semantics::DecodeHex;
+
+  auto result = DecodeHex(std::string(99, 'a'), nullptr);
+
+  ASSERT_THAT(result.is_valid(), Eq(false));
+  ASSERT_THAT(result.are_all_characters_hex, Eq(true));
+  ASSERT_THAT(result.hex_length, Eq(99));
+}
+
+TEST_F(HexDecoderTest, RandomBodiesMatchTheScalarDecoder) {
+  // Mostly hex digits, so the kernels are used, with some whitespace and a
+  // few invalid characters at random positions
+  constexpr auto kAlphabet =
+      std::string_view{"0123456789abcdefABCDEF \n\tgG/:@`\xff"};
+  auto generator = std::mt19937{42};
+  auto hex_digit = std::uniform_int_distribution<size_t>{0, 21};
+  auto rare_character =
+      std::uniform_int_distribution<size_t>{0, kAlphabet.size() - 1};
+  auto length = std::uniform_int_distribution<size_t>{0, 300};
+  auto is_rare = std::bernoulli_distribution{0.01};
+
+  for (int i = 0; i < 2000; ++i) {
+    auto body = std::string(length(generator), ' ');
+    for (auto& c : body) {
+      c = kAlphabet[is_rare(generator) ? rare_character(generator)
+                                       : hex_digit(generator)];
+    }
+    ExpectSameAsScalar(body);
+  }
+}
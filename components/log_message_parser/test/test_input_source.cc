@@ -0,0 +1,218 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "log_message_parser/input_source.h"
+#include "log_message_parser/structure.h"
+
+using ::testing::Eq;
+
+class InputSourceTest : public ::testing::TestWithParam<
+                            pipelines::log_message_parser::InputMode> {
+ protected:
+  /**
+   * Writes the given content into a temporary file and returns its path.
+   */
+  std::string WriteTemporaryFile(const std::string& content) {
+    auto path = std::filesystem::temp_directory_path() /
+                ("input_source_test_" +
+                 std::to_string(static_cast<int>(GetParam())) + "_" +
+                 std::to_string(::testing::UnitTest::GetInstance()
+                                    ->current_test_info()
+                                    ->line()) +
+                 ".txt");
+    std::ofstream file(path, std::ios::binary);
+    file << content;
+    paths_.push_back(path);
+    return path.string();
+  }
+
+  /**
+   * Reads the whole source, in blocks of the given size.
+   */
+  static std::string ReadAll(pipelines::log_message_parser::InputSource& source,
+                             size_t block_size) {
+    auto content = std::string{};
+    auto block = std::vector<char>(block_size);
+    while (auto read = source.Read(block)) {
+      content.append(block.data(), read);
+    }
+    return content;
+  }
+
+  void TearDown() override {
+    for (const auto& path : paths_) {
+      std::filesystem::remove(path);
+    }
+  }
+
+ private:
+  std::vector<std::filesystem::path> paths_;
+};
+
+TEST_P(InputSourceTest, ReadsSmallFile) {
+  using pipelines::log_message_parser::OpenInputSource;
+
+  auto content = std::string{"1 2 3 [4F4B] -1\n1 3 0 [text] 2\n"};
+  auto source = OpenInputSource(WriteTemporaryFile(content), GetParam());
+
+  ASSERT_THAT(ReadAll(*source, 7), Eq(content));
+}
+
+TEST_P(InputSourceTest, ReadsBigFile) {
+  using pipelines::log_message_parser::OpenInputSource;
+
+  // Bigger than the mmap windows and the O_DIRECT blocks
+  auto content = std::string{};
+  for (int i = 0; content.size() < 9 * 1024 * 1024 + 123; ++i) {
+    content += std::to_string(i) + " 2 0 [body] -1\n";
+  }
+  auto source = OpenInputSource(WriteTemporaryFile(content), GetParam());
+
+  ASSERT_THAT(ReadAll(*source, 100000), Eq(content));
+}
+
+TEST_P(InputSourceTest, ReadsEmptyFile) {
+  using pipelines::log_message_parser::OpenInputSource;
+
+  auto source = OpenInputSource(WriteTemporaryFile(""), GetParam());
+
+  ASSERT_THAT(ReadAll(*source, 64), Eq(""));
+}
+
+TEST_P(InputSourceTest, OpeningMissingFileThrows) {
+  using pipelines::log_message_parser::InputSourceError;
+  using pipelines::log_message_parser::OpenInputSource;
+
+  ASSERT_THROW(OpenInputSource("this/file/does/not/exist.txt", GetParam()),
+               InputSourceError);
+}
+
+TEST_P(InputSourceTest, ParsesTheSameAsTheStreamParser) {
+  using pipelines::log_message_parser::OpenInputSource;
+  using pipelines::log_message_parser::structure::Parser;
+
+  auto content = std::string{
+      "2 3 1 [4F4B] -1\n"
+      "1 0 0 [some text] 1\n"
+      "1 1 0 [another\ntext] 2\n"
+      "unparsed\n"
+      "2 99 1 [4F4B] 3\n"
+      "1 2 1 [626F6479] -1\n"};
+  auto path = WriteTemporaryFile(content);
+  auto input_stream = std::istringstream{content};
+  auto expected = Parser{input_stream}.Parse();
+
+  for (size_t thread_count : {1, 2}) {
+    auto result =
+        Parser{OpenInputSource(path, GetParam()), thread_count}.Parse();
+
+    ASSERT_THAT(result.messages(), Eq(expected.messages()));
+    ASSERT_THAT(result.errors().size(), Eq(expected.errors().size()));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AllFileModes, InputSourceTest,
+    ::testing::Values(pipelines::log_message_parser::InputMode::kStream,
+                      pipelines::log_message_parser::InputMode::kRead,
+                      pipelines::log_message_parser::InputMode::kMemoryMap,
+                      pipelines::log_message_parser::InputMode::kDirect));
+
+class FollowedFileTest : public ::testing::Test {
+ protected:
+  /**
+   * Reads everything that is available in the followed file.
+   */
+  static std::string ReadAvailable(
+      pipelines::log_message_parser::FollowedFile& followed_file) {
+    auto content = std::string{};
+    auto block = std::vector<char>(5);
+    while (auto read = followed_file.Read(block)) {
+      content.append(block.data(), read);
+    }
+    return content;
+  }
+
+  /**
+   * Appends the content to the test file.
+   */
+  void Append(const std::string& content) {
+    std::ofstream file(path_, std::ios::binary | std::ios::app);
+    file << content;
+  }
+
+  void TearDown() override {
+    std::filesystem::remove(path_);
+    std::filesystem::remove(path_.string() + ".new");
+  }
+
+  std::filesystem::path path_ =
+      std::filesystem::temp_directory_path() /
+      ("followed_file_test_" +
+       std::string(
+           ::testing::UnitTest::GetInstance()->current_test_info()->name()) +
+       ".txt");
+};
+
+TEST_F(FollowedFileTest, ReadsAppendedData) {
+  using pipelines::log_message_parser::FollowedFile;
+
+  Append("1 2 0 [first] 3\n");
+  auto followed_file = FollowedFile{path_.string()};
+
+  ASSERT_THAT(ReadAvailable(followed_file), Eq("1 2 0 [first] 3\n"));
+  ASSERT_THAT(ReadAvailable(followed_file), Eq(""));
+  ASSERT_THAT(followed_file.ReopenIfReplaced(), Eq(false));
+
+  Append("1 3 0 [second] 4\n");
+  ASSERT_THAT(ReadAvailable(followed_file), Eq("1 3 0 [second] 4\n"));
+  ASSERT_THAT(followed_file.ReopenIfReplaced(), Eq(false));
+}
+
+TEST_F(FollowedFileTest, ReopensTruncatedFile) {
+  using pipelines::log_message_parser::FollowedFile;
+
+  Append("1 2 0 [first] 3\n");
+  auto followed_file = FollowedFile{path_.string()};
+  ASSERT_THAT(ReadAvailable(followed_file), Eq("1 2 0 [first] 3\n"));
+
+  std::filesystem::resize_file(path_, 0);
+  Append("2 1 0 [x] 2\n");
+
+  ASSERT_THAT(ReadAvailable(followed_file), Eq(""));
+  ASSERT_THAT(followed_file.ReopenIfReplaced(), Eq(true));
+  ASSERT_THAT(ReadAvailable(followed_file), Eq("2 1 0 [x] 2\n"));
+}
+
+TEST_F(FollowedFileTest, ReopensReplacedFile) {
+  using pipelines::log_message_parser::FollowedFile;
+
+  Append("1 2 0 [first] 3\n");
+  auto followed_file = FollowedFile{path_.string()};
+  ASSERT_THAT(ReadAvailable(followed_file), Eq("1 2 0 [first] 3\n"));
+
+  // Data appended to the old file before the rotation is still read
+  Append("1 3 0 [last] 4\n");
+  {
+    std::ofstream new_file(path_.string() + ".new", std::ios::binary);
+    new_file << "1 4 0 [rotated file with more data] 5\n";
+  }
+  std::filesystem::rename(path_.string() + ".new", path_);
+
+  ASSERT_THAT(ReadAvailable(followed_file), Eq("1 3 0 [last] 4\n"));
+  ASSERT_THAT(followed_file.ReopenIfReplaced(), Eq(true));
+  ASSERT_THAT(ReadAvailable(followed_file),
+              Eq("1 4 0 [rotated file with more data] 5\n"));
+  ASSERT_THAT(followed_file.ReopenIfReplaced(), Eq(false));
+}
+
+TEST_F(FollowedFileTest, OpeningMissingFileThrows) {
+  using pipelines::log_message_parser::FollowedFile;
+  using pipelines::log_message_parser::InputSourceError;
+
+  ASSERT_THROW(FollowedFile{"this/file/does/not/exist.txt"}, InputSourceError);
+}
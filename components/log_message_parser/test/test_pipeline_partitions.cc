@@ -0,0 +1,153 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+#include "log_message_parser/pipeline_partitions.h"
+#include "log_message_parser/structure.h"
+
+using ::testing::Eq;
+using ::testing::IsEmpty;
+
+class PipelinePartitionsTest : public ::testing::Test {
+ protected:
+  /**
+   * Creates an empty directory for the partition files of a test.
+   */
+  void SetUp() override {
+    directory_ = std::filesystem::temp_directory_path() /
+                 ("pipeline_partitions_test_" +
+                  std::string{::testing::UnitTest::GetInstance()
+                                  ->current_test_info()
+                                  ->name()});
+    std::filesystem::remove_all(directory_);
+    std::filesystem::create_directory(directory_);
+  }
+
+  void TearDown() override { std::filesystem::remove_all(directory_); }
+
+  /**
+   * Structure messages of several pipelines, with empty fields and a body
+   * with brackets and new lines.
+   */
+  static pipelines::log_message_parser::structure::LogMessages
+  CreateMessages() {
+    auto messages = pipelines::log_message_parser::structure::LogMessages{};
+    for (int i = 0; i < 100; ++i) {
+      messages.emplace_back("pipeline_" + std::to_string(i % 7),
+                            std::to_string(i), std::to_string(i % 2),
+                            i % 5 == 0 ? "" : "[body]\n" + std::to_string(i),
+                            i % 3 == 0 ? "-1" : std::to_string(i + 1));
+    }
+    return messages;
+  }
+
+  std::filesystem::path directory_; /**< The directory of the test. */
+};
+
+TEST_F(PipelinePartitionsTest, PipelinesKeepTheirOrderInOnePartition) {
+  using pipelines::log_message_parser::PipelinePartitions;
+  using StructureLogMessages =
+      pipelines::log_message_parser::structure::LogMessages;
+
+  auto input = CreateMessages();
+  auto partitions = PipelinePartitions{directory_, 3};
+  for (const auto& message : input) {
+    partitions.Add(message);
+  }
+  ASSERT_THAT(partitions.size(), Eq(input.size()));
+  ASSERT_THAT(partitions.partition_count(), Eq(3));
+
+  auto expected = std::map<std::string, StructureLogMessages>{};
+  for (const auto& message : input) {
+    expected[std::string{message.pipeline_id()}].push_back(message);
+  }
+  auto read = std::map<std::string, StructureLogMessages>{};
+  auto partition_by_pipeline = std::map<std::string, size_t>{};
+  for (size_t partition = 0; partition < partitions.partition_count();
+       ++partition) {
+    for (auto& message : partitions.Read(partition)) {
+      auto pipeline_id = std::string{message.pipeline_id()};
+      auto it = partition_by_pipeline.try_emplace(pipeline_id, partition).first;
+      ASSERT_THAT(it->second, Eq(partition));
+      read[pipeline_id].push_back(std::move(message));
+    }
+  }
+  ASSERT_THAT(read, Eq(expected));
+
+  // A partition is emptied when it's read
+  for (size_t partition = 0; partition < partitions.partition_count();
+       ++partition) {
+    ASSERT_THAT(partitions.Read(partition), IsEmpty());
+  }
+}
+
+TEST_F(PipelinePartitionsTest, FilesAreRemovedWithThePartitions) {
+  using pipelines::log_message_parser::PipelinePartitions;
+
+  {
+    auto partitions = PipelinePartitions{directory_, 4};
+    for (const auto& message : CreateMessages()) {
+      partitions.Add(message);
+    }
+    auto read = size_t{0};
+    for (size_t partition = 0; partition < partitions.partition_count();
+         ++partition) {
+      read += partitions.Read(partition).size();
+    }
+    ASSERT_THAT(read, Eq(partitions.size()));
+    ASSERT_THAT(std::filesystem::is_empty(directory_), Eq(false));
+  }
+  ASSERT_THAT(std::filesystem::is_empty(directory_), Eq(true));
+}
+
+TEST_F(PipelinePartitionsTest, PartitionsAreReadConcurrently) {
+  using pipelines::log_message_parser::PipelinePartitions;
+
+  auto input = CreateMessages();
+  auto partitions = PipelinePartitions{directory_, 4};
+  for (const auto& message : input) {
+    partitions.Add(message);
+  }
+  auto bytes = size_t{0};
+  for (size_t partition = 0; partition < partitions.partition_count();
+       ++partition) {
+    bytes += partitions.partition_bytes(partition);
+  }
+  // Every record has a header of four 32 bits sizes and a 64 bits one
+  auto record_bytes = input.size() * (4 * sizeof(uint32_t) + sizeof(uint64_t));
+  for (const auto& message : input) {
+    record_bytes += message.pipeline_id().size() + message.id().size() +
+                    message.encoding().size() + message.body().size() +
+                    message.next_id().size();
+  }
+  ASSERT_THAT(bytes, Eq(record_bytes));
+
+  auto sizes = std::vector<size_t>(partitions.partition_count());
+  auto threads = std::vector<std::thread>{};
+  for (size_t partition = 0; partition < sizes.size(); ++partition) {
+    threads.emplace_back([&partitions, &sizes, partition] {
+      sizes[partition] = partitions.Read(partition).size();
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_THAT(std::accumulate(sizes.begin(), sizes.end(), size_t{0}),
+              Eq(input.size()));
+  for (size_t partition = 0; partition < sizes.size(); ++partition) {
+    ASSERT_THAT(partitions.partition_bytes(partition), Eq(0));
+  }
+}
+
+TEST_F(PipelinePartitionsTest, MissingDirectoryThrows) {
+  using pipelines::log_message_parser::PipelinePartitions;
+  using pipelines::log_message_parser::PipelinePartitionsError;
+
+  ASSERT_THROW(PipelinePartitions(directory_ / "missing", 2),
+               PipelinePartitionsError);
+}
@@ -1,5 +1,12 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <cctype>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
 #include "log_message_parser/semantics.h"
 
 using ::testing::Eq;
@@ -12,6 +19,62 @@ class MockBodyParser : public BodyParser {
   MOCK_METHOD(std::string, Parse, (const std::string&), (const override));
 };
 
+class MockNonThrowingBodyParser : public BodyParser {
+ public:
+  MOCK_METHOD(std::string, Parse, (const std::string&), (const override));
+  MOCK_METHOD(BodyParseResult, TryParse, (const std::string&),
+              (const override));
+};
+
+class MockBatchBodyParser : public BodyParser {
+ public:
+  MOCK_METHOD(std::string, Parse, (const std::string&), (const override));
+  MOCK_METHOD(void, ParseBatch,
+              (std::span<const std::string_view>, std::string&,
+               BodyParseBatchResults&),
+              (const override));
+};
+
+class MockLazyBodyParser : public BodyParser {
+ public:
+  MOCK_METHOD(std::string, Parse, (const std::string&), (const override));
+  MOCK_METHOD(std::optional<BodyError>, Validate, (std::string_view),
+              (const override));
+  MOCK_METHOD(Body::Decoder, decoder, (), (const override));
+};
+
+/**
+ * Body parser used by the tests, it only implements Parse, reversing the
+ * body, and fails for the bodies that start with '!'.
+ */
+class ReverseBodyParser : public BodyParser {
+ public:
+  std::string Parse(const std::string& body) const override {
+    if (!body.empty() && body.front() == '!') {
+      throw BodyParserError("Body starts with !");
+    }
+    return {body.rbegin(), body.rend()};
+  }
+};
+
+/**
+ * ParseBatch used by the tests, it returns the bodies as they are.
+ */
+inline void ParseBatchAsIs(std::span<const std::string_view> bodies,
+                           std::string& /*buffer*/,
+                           BodyParseBatchResults& results) {
+  results.assign(bodies.begin(), bodies.end());
+}
+
+/**
+ * Decoder used by the tests, it converts the body to lower case.
+ */
+inline void DecodeToLower(std::string_view encoded, std::string& decoded) {
+  for (auto c : encoded) {
+    decoded.push_back(static_cast<char>(std::tolower(c)));
+  }
+}
+
 }  // namespace pipelines::log_message_parser::semantics::test
 
 class SemanticsParserTest : public ::testing::Test {
@@ -173,4 +236,391 @@ TEST_F(SemanticsParserTest, MultipleMessagesWithErrors) {
 
   ASSERT_THAT(parse_result.errors()[0].message(),
               HasSubstr("Encoding \"7\" is not supported for log message"));
-}
\ No newline at end of file
+}
+
+TEST_F(SemanticsParserTest, MessageViews) {
+  using pipelines::log_message_parser::semantics::Parser;
+  using pipelines::log_message_parser::semantics::test::MockBodyParser;
+  using pipelines::log_message_parser::structure::LogMessageViews;
+  using SemanticLogMessage =
+      pipelines::log_message_parser::semantics::LogMessage;
+
+  auto input = LogMessageViews{
+      {"1", "2", "3", "4F4B", "-1"},
+      {"5", "6", "7", "8F8B", "-2"},
+  };
+
+  auto mock_body_parser = std::make_unique<MockBodyParser>();
+  auto* mock_body_parser_ptr = mock_body_parser.get();
+
+  EXPECT_CALL(*mock_body_parser_ptr, Parse("4F4B"))
+      .WillOnce(testing::Return("Parsed body"));
+
+  auto parser = Parser{};
+  parser.RegisterBodyParser("3", std::move(mock_body_parser));
+  auto parse_result = parser.Parse(input);
+
+  ASSERT_THAT(parse_result.messages().size(), Eq(1));
+  ASSERT_THAT(parse_result.messages()[0],
+              Eq(SemanticLogMessage{"1", "2", "Parsed body", "-1"}));
+  ASSERT_THAT(parse_result.errors().size(), Eq(1));
+  ASSERT_THAT(parse_result.errors()[0].message(),
+              HasSubstr("Encoding \"7\" is not supported for log message"));
+}
+
+TEST_F(SemanticsParserTest, BodyParserReturnsError) {
+  using pipelines::log_message_parser::Unexpected;
+  using pipelines::log_message_parser::semantics::BodyError;
+  using pipelines::log_message_parser::semantics::BodyParseResult;
+  using pipelines::log_message_parser::semantics::Parser;
+  using pipelines::log_message_parser::semantics::test::
+      MockNonThrowingBodyParser;
+  using StructureLogMessages =
+      pipelines::log_message_parser::structure::LogMessages;
+  using SemanticLogMessage =
+      pipelines::log_message_parser::semantics::LogMessage;
+
+  auto input = StructureLogMessages{
+      {"1", "2", "3", "4F4B", "-1"},
+      {"5", "6", "3", "8F8B", "-2"},
+  };
+
+  auto mock_body_parser = std::make_unique<MockNonThrowingBodyParser>();
+  auto* mock_body_parser_ptr = mock_body_parser.get();
+
+  EXPECT_CALL(*mock_body_parser_ptr, TryParse("4F4B"))
+      .WillOnce(testing::Return(BodyParseResult{
+          Unexpected{BodyError{"Parsing error"}}}));
+  EXPECT_CALL(*mock_body_parser_ptr, TryParse("8F8B"))
+      .WillOnce(testing::Return(BodyParseResult{"Parsed body"}));
+  EXPECT_CALL(*mock_body_parser_ptr, Parse).Times(0);
+
+  auto parser = Parser{};
+  parser.RegisterBodyParser("3", std::move(mock_body_parser));
+  auto parse_result = parser.Parse(input);
+
+  ASSERT_THAT(parse_result.messages().size(), Eq(1));
+  ASSERT_THAT(parse_result.messages()[0],
+              Eq(SemanticLogMessage{"5", "6", "Parsed body", "-2"}));
+  ASSERT_THAT(parse_result.errors().size(), Eq(1));
+  ASSERT_THAT(parse_result.errors()[0].message(),
+              HasSubstr("Failed to parse body for log message"));
+  ASSERT_THAT(parse_result.errors()[0].message(), HasSubstr("Parsing error"));
+}
+
+TEST_F(SemanticsParserTest, ErrorsWithoutMessagesAreCountedTheSame) {
+  using pipelines::log_message_parser::semantics::BodyDecoding;
+  using pipelines::log_message_parser::semantics::ErrorMessages;
+  using pipelines::log_message_parser::semantics::Parser;
+  using pipelines::log_message_parser::semantics::test::ReverseBodyParser;
+  using StructureLogMessages =
+      pipelines::log_message_parser::structure::LogMessages;
+
+  auto input = StructureLogMessages{
+      {"1", "1", "3", "!A", "2"},
+      {"1", "2", "3", "B", "3"},
+      {"1", "3", "7", "C", "-1"},
+  };
+
+  auto full_parser = Parser{};
+  full_parser.RegisterBodyParser("3", std::make_unique<ReverseBodyParser>());
+  auto quiet_parser = Parser{BodyDecoding::kEager, 1, ErrorMessages::kNone};
+  quiet_parser.RegisterBodyParser("3", std::make_unique<ReverseBodyParser>());
+  auto full_result = full_parser.Parse(input);
+  auto quiet_result = quiet_parser.Parse(input);
+
+  ASSERT_THAT(quiet_result.messages(), Eq(full_result.messages()));
+  ASSERT_THAT(quiet_result.errors().size(), Eq(2));
+  ASSERT_THAT(full_result.errors().size(), Eq(2));
+  for (const auto& error : quiet_result.errors()) {
+    ASSERT_THAT(error.message(), Eq(""));
+  }
+  auto validated = quiet_parser.Validate(input);
+  ASSERT_THAT(validated.size(), Eq(3));
+  ASSERT_THAT(validated[0].has_value(), Eq(true));
+  ASSERT_THAT(validated[1].has_value(), Eq(false));
+  ASSERT_THAT(validated[2].has_value(), Eq(true));
+  ASSERT_THAT(validated[0]->message(), Eq(""));
+}
+
+TEST_F(SemanticsParserTest, LazyDecodingOnlyValidatesTheBodies) {
+  using pipelines::log_message_parser::semantics::BodyDecoding;
+  using pipelines::log_message_parser::semantics::Parser;
+  using pipelines::log_message_parser::semantics::test::DecodeToLower;
+  using pipelines::log_message_parser::semantics::test::MockLazyBodyParser;
+  using StructureLogMessages =
+      pipelines::log_message_parser::structure::LogMessages;
+  using SemanticLogMessage =
+      pipelines::log_message_parser::semantics::LogMessage;
+
+  auto mock_body_parser = std::make_unique<MockLazyBodyParser>();
+  auto* mock_body_parser_ptr = mock_body_parser.get();
+
+  EXPECT_CALL(*mock_body_parser_ptr, decoder())
+      .WillRepeatedly(testing::Return(DecodeToLower));
+  EXPECT_CALL(*mock_body_parser_ptr, Validate(std::string_view{"4F4B"}))
+      .WillOnce(testing::Return(std::nullopt));
+  EXPECT_CALL(*mock_body_parser_ptr, Parse).Times(0);
+
+  auto parser = Parser{BodyDecoding::kLazy};
+  parser.RegisterBodyParser("3", std::move(mock_body_parser));
+
+  // The bodies stay valid after the structure messages are destroyed
+  auto parse_result =
+      parser.Parse(StructureLogMessages{{"1", "2", "3", "4F4B", "-1"}});
+
+  ASSERT_THAT(parse_result.HasErrors(), Eq(false));
+  ASSERT_THAT(parse_result.messages().size(), Eq(1));
+  ASSERT_THAT(parse_result.messages()[0].body().is_decoded(), Eq(false));
+  ASSERT_THAT(parse_result.messages()[0],
+              Eq(SemanticLogMessage{"1", "2", "4f4b", "-1"}));
+}
+
+TEST_F(SemanticsParserTest, LazyDecodingReportsTheValidationErrors) {
+  using pipelines::log_message_parser::semantics::BodyDecoding;
+  using pipelines::log_message_parser::semantics::BodyError;
+  using pipelines::log_message_parser::semantics::Parser;
+  using pipelines::log_message_parser::semantics::test::DecodeToLower;
+  using pipelines::log_message_parser::semantics::test::MockLazyBodyParser;
+  using StructureLogMessages =
+      pipelines::log_message_parser::structure::LogMessages;
+
+  auto input = StructureLogMessages{{"1", "2", "3", "4G4B", "-1"}};
+
+  auto mock_body_parser = std::make_unique<MockLazyBodyParser>();
+  auto* mock_body_parser_ptr = mock_body_parser.get();
+
+  EXPECT_CALL(*mock_body_parser_ptr, decoder())
+      .WillRepeatedly(testing::Return(DecodeToLower));
+  EXPECT_CALL(*mock_body_parser_ptr, Validate(std::string_view{"4G4B"}))
+      .WillOnce(testing::Return(BodyError{"Validation error"}));
+
+  auto parser = Parser{BodyDecoding::kLazy};
+  parser.RegisterBodyParser("3", std::move(mock_body_parser));
+  auto parse_result = parser.Parse(input);
+
+  ASSERT_THAT(parse_result.messages().size(), Eq(0));
+  ASSERT_THAT(parse_result.errors().size(), Eq(1));
+  ASSERT_THAT(parse_result.errors()[0].message(),
+              HasSubstr("Failed to parse body for log message"));
+  ASSERT_THAT(parse_result.errors()[0].message(),
+              HasSubstr("Validation error"));
+}
+
+TEST_F(SemanticsParserTest, LazyDecodingParsesWhenThereIsNoDecoder) {
+  using pipelines::log_message_parser::semantics::BodyDecoding;
+  using pipelines::log_message_parser::semantics::Parser;
+  using pipelines::log_message_parser::semantics::test::MockBodyParser;
+  using StructureLogMessages =
+      pipelines::log_message_parser::structure::LogMessages;
+  using SemanticLogMessage =
+      pipelines::log_message_parser::semantics::LogMessage;
+
+  auto input = StructureLogMessages{{"1", "2", "3", "4F4B", "-1"}};
+
+  auto mock_body_parser = std::make_unique<MockBodyParser>();
+  auto* mock_body_parser_ptr = mock_body_parser.get();
+
+  EXPECT_CALL(*mock_body_parser_ptr, Parse("4F4B"))
+      .WillOnce(testing::Return("Parsed body"));
+
+  auto parser = Parser{BodyDecoding::kLazy};
+  parser.RegisterBodyParser("3", std::move(mock_body_parser));
+  auto parse_result = parser.Parse(input);
+
+  ASSERT_THAT(parse_result.messages().size(), Eq(1));
+  ASSERT_THAT(parse_result.messages()[0].body().is_decoded(), Eq(true));
+  ASSERT_THAT(parse_result.messages()[0],
+              Eq(SemanticLogMessage{"1", "2", "Parsed body", "-1"}));
+}
+
+TEST_F(SemanticsParserTest, LazyDecodingKeepsTheViewedInputAlive) {
+  using pipelines::log_message_parser::semantics::BodyDecoding;
+  using pipelines::log_message_parser::semantics::Parser;
+  using pipelines::log_message_parser::semantics::test::DecodeToLower;
+  using pipelines::log_message_parser::semantics::test::MockLazyBodyParser;
+  using pipelines::log_message_parser::structure::LogMessageViews;
+  using SemanticLogMessage =
+      pipelines::log_message_parser::semantics::LogMessage;
+
+  auto input = std::make_shared<std::string>("4F4B");
+  auto views = LogMessageViews{{"1", "2", "3", *input, "-1"}};
+
+  auto mock_body_parser = std::make_unique<MockLazyBodyParser>();
+  auto* mock_body_parser_ptr = mock_body_parser.get();
+
+  EXPECT_CALL(*mock_body_parser_ptr, decoder())
+      .WillRepeatedly(testing::Return(DecodeToLower));
+  EXPECT_CALL(*mock_body_parser_ptr, Validate)
+      .WillOnce(testing::Return(std::nullopt));
+
+  auto parser = Parser{BodyDecoding::kLazy};
+  parser.RegisterBodyParser("3", std::move(mock_body_parser));
+  auto parse_result = parser.Parse(views, input);
+  input.reset();
+
+  ASSERT_THAT(parse_result.messages().size(), Eq(1));
+  ASSERT_THAT(parse_result.messages()[0],
+              Eq(SemanticLogMessage{"1", "2", "4f4b", "-1"}));
+}
+
+TEST_F(SemanticsParserTest, ParseIntoAdaptsParsersThatOnlyParse) {
+  using pipelines::log_message_parser::semantics::test::MockBodyParser;
+
+  auto body_parser = MockBodyParser{};
+  EXPECT_CALL(body_parser, Parse("4F4B"))
+      .WillOnce(testing::Return("Parsed body"));
+  EXPECT_CALL(body_parser, Parse("4G4B"))
+      .WillOnce(testing::Throw(
+          pipelines::log_message_parser::semantics::BodyParserError(
+              "Parsing error")));
+
+  auto buffer = std::string{};
+  auto parsed_body = body_parser.ParseInto("4F4B", buffer);
+  auto parse_error = body_parser.ParseInto("4G4B", buffer);
+
+  ASSERT_THAT(parsed_body.has_value(), Eq(true));
+  ASSERT_THAT(*parsed_body, Eq("Parsed body"));
+  ASSERT_THAT(parsed_body->data(), Eq(buffer.data()));
+  ASSERT_THAT(parse_error.has_value(), Eq(false));
+  ASSERT_THAT(parse_error.error().what(), HasSubstr("Parsing error"));
+}
+
+
+TEST_F(SemanticsParserTest, ParseBatchAdaptsParsersThatOnlyParse) {
+  using pipelines::log_message_parser::semantics::BodyParseBatchResults;
+  using pipelines::log_message_parser::semantics::test::MockBodyParser;
+
+  auto body_parser = MockBodyParser{};
+  EXPECT_CALL(body_parser, Parse("4F4B"))
+      .WillOnce(testing::Return("Parsed body 1"));
+  EXPECT_CALL(body_parser, Parse("4G4B"))
+      .WillOnce(testing::Throw(
+          pipelines::log_message_parser::semantics::BodyParserError(
+              "Parsing error")));
+  EXPECT_CALL(body_parser, Parse("8F8B"))
+      .WillOnce(testing::Return("Parsed body 2"));
+
+  auto bodies = std::vector<std::string_view>{"4F4B", "4G4B", "8F8B"};
+  auto buffer = std::string{};
+  auto results = BodyParseBatchResults{};
+  body_parser.ParseBatch(bodies, buffer, results);
+
+  ASSERT_THAT(results.size(), Eq(3));
+  ASSERT_THAT(results[0].has_value(), Eq(true));
+  ASSERT_THAT(*results[0], Eq("Parsed body 1"));
+  ASSERT_THAT(results[1].has_value(), Eq(false));
+  ASSERT_THAT(results[1].error().what(), HasSubstr("Parsing error"));
+  ASSERT_THAT(results[2].has_value(), Eq(true));
+  ASSERT_THAT(*results[2], Eq("Parsed body 2"));
+}
+
+TEST_F(SemanticsParserTest, BatchesKeepTheOrderOfTheMessages) {
+  using pipelines::log_message_parser::semantics::Parser;
+  using pipelines::log_message_parser::semantics::test::MockBodyParser;
+  using StructureLogMessages =
+      pipelines::log_message_parser::structure::LogMessages;
+  using SemanticLogMessage =
+      pipelines::log_message_parser::semantics::LogMessage;
+
+  auto input = StructureLogMessages{
+      {"1", "1", "3", "A", "2"}, {"1", "2", "4", "B", "3"},
+      {"1", "3", "7", "C", "4"}, {"1", "4", "3", "D", "5"},
+      {"1", "5", "4", "E", "-1"},
+  };
+
+  auto first_body_parser = std::make_unique<MockBodyParser>();
+  EXPECT_CALL(*first_body_parser, Parse("A")).WillOnce(testing::Return("a"));
+  EXPECT_CALL(*first_body_parser, Parse("D"))
+      .WillOnce(testing::Throw(
+          pipelines::log_message_parser::semantics::BodyParserError(
+              "Parsing error")));
+  auto second_body_parser = std::make_unique<MockBodyParser>();
+  EXPECT_CALL(*second_body_parser, Parse("B")).WillOnce(testing::Return("b"));
+  EXPECT_CALL(*second_body_parser, Parse("E")).WillOnce(testing::Return("e"));
+
+  auto parser = Parser{};
+  parser.RegisterBodyParser("3", std::move(first_body_parser));
+  parser.RegisterBodyParser("4", std::move(second_body_parser));
+  auto parse_result = parser.Parse(input);
+
+  ASSERT_THAT(parse_result.messages().size(), Eq(3));
+  ASSERT_THAT(parse_result.messages()[0],
+              Eq(SemanticLogMessage{"1", "1", "a", "2"}));
+  ASSERT_THAT(parse_result.messages()[1],
+              Eq(SemanticLogMessage{"1", "2", "b", "3"}));
+  ASSERT_THAT(parse_result.messages()[2],
+              Eq(SemanticLogMessage{"1", "5", "e", "-1"}));
+  ASSERT_THAT(parse_result.errors().size(), Eq(2));
+  ASSERT_THAT(parse_result.errors()[0].message(),
+              HasSubstr("Encoding \"7\" is not supported"));
+  ASSERT_THAT(parse_result.errors()[1].message(), HasSubstr("Parsing error"));
+}
+
+TEST_F(SemanticsParserTest, BodyParsersAreCalledOncePerBatch) {
+  using pipelines::log_message_parser::semantics::Parser;
+  using pipelines::log_message_parser::semantics::test::MockBatchBodyParser;
+  using pipelines::log_message_parser::semantics::test::ParseBatchAsIs;
+  using StructureLogMessages =
+      pipelines::log_message_parser::structure::LogMessages;
+
+  // Enough messages for three windows of bodies
+  auto input = StructureLogMessages{};
+  for (int i = 0; i < 2500; ++i) {
+    input.emplace_back("1", std::to_string(i), "3", std::to_string(i),
+                       std::to_string(i + 1));
+  }
+
+  auto body_parser = std::make_unique<MockBatchBodyParser>();
+  EXPECT_CALL(*body_parser, Parse(testing::_)).Times(0);
+  EXPECT_CALL(*body_parser, ParseBatch(testing::_, testing::_, testing::_))
+      .Times(3)
+      .WillRepeatedly(testing::Invoke(ParseBatchAsIs));
+
+  auto parser = Parser{};
+  parser.RegisterBodyParser("3", std::move(body_parser));
+  auto parse_result = parser.Parse(input);
+
+  ASSERT_THAT(parse_result.HasErrors(), Eq(false));
+  ASSERT_THAT(parse_result.messages().size(), Eq(input.size()));
+  for (size_t i = 0; i < input.size(); ++i) {
+    ASSERT_THAT(parse_result.messages()[i].body(), Eq(std::to_string(i)));
+  }
+}
+
+TEST_F(SemanticsParserTest, ThreadsGiveTheSameResultInTheSameOrder) {
+  using pipelines::log_message_parser::semantics::BodyDecoding;
+  using pipelines::log_message_parser::semantics::Parser;
+  using pipelines::log_message_parser::semantics::test::ReverseBodyParser;
+  using StructureLogMessages =
+      pipelines::log_message_parser::structure::LogMessages;
+
+  // Enough messages for several threads, with errors spread all over them
+  auto input = StructureLogMessages{};
+  for (int i = 0; i < 50000; ++i) {
+    auto body = std::string{i % 7 == 0 ? "!" : ""};
+    body += std::to_string(i);
+    input.emplace_back(std::to_string(i % 3), std::to_string(i),
+                       i % 11 == 0 ? "9" : "3", body, std::to_string(i + 1));
+  }
+
+  for (auto body_decoding : {BodyDecoding::kEager, BodyDecoding::kLazy}) {
+    auto serial_parser = Parser{body_decoding};
+    serial_parser.RegisterBodyParser("3",
+                                     std::make_unique<ReverseBodyParser>());
+    auto expected = serial_parser.Parse(input);
+
+    for (size_t thread_count : {2, 4, 16}) {
+      auto parser = Parser{body_decoding, thread_count};
+      parser.RegisterBodyParser("3", std::make_unique<ReverseBodyParser>());
+      auto parse_result = parser.Parse(input);
+
+      ASSERT_THAT(parse_result.messages(), Eq(expected.messages()));
+      ASSERT_THAT(parse_result.errors().size(), Eq(expected.errors().size()));
+      for (size_t i = 0; i < expected.errors().size(); ++i) {
+        ASSERT_THAT(parse_result.errors()[i].message(),
+                    Eq(expected.errors()[i].message()));
+      }
+    }
+  }
+}
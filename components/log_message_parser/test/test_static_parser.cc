@@ -0,0 +1,217 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <cctype>
+#include <memory>
+#include <string>
+#include "log_message_parser/ascii_body_parser.h"
+#include "log_message_parser/hex16_body_parser.h"
+#include "log_message_parser/semantics.h"
+#include "log_message_parser/static_parser.h"
+
+using ::testing::Eq;
+using ::testing::HasSubstr;
+
+namespace pipelines::log_message_parser::semantics::test {
+
+/**
+ * Body parser used by the tests, it only implements Parse, converting the
+ * body to upper case.
+ */
+class UpperCaseBodyParser : public BodyParser {
+ public:
+  std::string Parse(const std::string& body) const override {
+    auto parsed_body = body;
+    for (auto& c : parsed_body) {
+      c = static_cast<char>(std::toupper(c));
+    }
+    return parsed_body;
+  }
+};
+
+/**
+ * The parser of the encodings used by the application.
+ */
+using ApplicationParser = StaticParser<Encoding<"0", AsciiBodyParser>,
+                                       Encoding<"1", Hex16BodyParser>>;
+
+/**
+ * Structure messages with every kind of result, valid bodies of both
+ * encodings, invalid hexadecimal bodies and an unsupported encoding.
+ */
+inline structure::LogMessages CreateMixedInput() {
+  return {
+      {"1", "1", "0", "some ascii body", "2"},
+      {"1", "2", "1", "626F6479", "3"},
+      {"1", "3", "1", "4F4G", "4"},
+      {"1", "4", "7", "unknown encoding", "5"},
+      {"1", "5", "1", "4F4B1", "6"},
+      {"1", "6", "0", "", "-1"},
+  };
+}
+
+/**
+ * Parses the input with the application parser and with a Parser with the
+ * same body parsers registered, and checks both give the same results.
+ */
+inline void ExpectSameAsRuntimeParser(const structure::LogMessages& input,
+                                      BodyDecoding body_decoding) {
+  auto runtime_parser = Parser{body_decoding};
+  runtime_parser.RegisterBodyParser("0", std::make_unique<AsciiBodyParser>());
+  runtime_parser.RegisterBodyParser("1", std::make_unique<Hex16BodyParser>());
+  auto expected = runtime_parser.Parse(input);
+  auto result = ApplicationParser{body_decoding}.Parse(input);
+
+  ASSERT_THAT(result.messages(), Eq(expected.messages()));
+  ASSERT_THAT(result.errors().size(), Eq(expected.errors().size()));
+  for (size_t i = 0; i < result.errors().size(); ++i) {
+    ASSERT_THAT(result.errors()[i].message(),
+                Eq(expected.errors()[i].message()));
+  }
+}
+
+}  // namespace pipelines::log_message_parser::semantics::test
+
+class StaticParserTest : public ::testing::Test {};
+
+TEST_F(StaticParserTest, EncodingsAreFoundAtCompileTime) {
+  using pipelines::log_message_parser::semantics::AsciiBodyParser;
+  using pipelines::log_message_parser::semantics::Encoding;
+  using pipelines::log_message_parser::semantics::Hex16BodyParser;
+  using pipelines::log_message_parser::semantics::kNoBatch;
+  using pipelines::log_message_parser::semantics::StaticBodyParsers;
+  using BodyParsers = StaticBodyParsers<Encoding<"0", AsciiBodyParser>,
+                                        Encoding<"10", Hex16BodyParser>>;
+
+  static_assert(BodyParsers::size() == 2);
+  static_assert(BodyParsers::Find("0") == 0);
+  static_assert(BodyParsers::Find("10") == 1);
+  static_assert(BodyParsers::Find("1") == kNoBatch);
+  static_assert(BodyParsers::Find("") == kNoBatch);
+  ASSERT_THAT(BodyParsers::Find(std::string{"10"}), Eq(1));
+}
+
+TEST_F(StaticParserTest, EncodingsAreFoundByTheirPackedCodes) {
+  using pipelines::log_message_parser::semantics::AsciiBodyParser;
+  using pipelines::log_message_parser::semantics::Encoding;
+  using pipelines::log_message_parser::semantics::Hex16BodyParser;
+  using pipelines::log_message_parser::semantics::kNoBatch;
+  using pipelines::log_message_parser::semantics::PackEncodingCode;
+  using pipelines::log_message_parser::semantics::StaticBodyParsers;
+  using BodyParsers =
+      StaticBodyParsers<Encoding<"ab", AsciiBodyParser>,
+                        Encoding<"ba", Hex16BodyParser>,
+                        Encoding<"a\0", AsciiBodyParser>,
+                        Encoding<"ascii-encoded", AsciiBodyParser>,
+                        Encoding<"hex16-encoded", Hex16BodyParser>>;
+
+  // The length keeps the codes that end with null characters apart
+  static_assert(PackEncodingCode("a") != PackEncodingCode({"a\0", 2}));
+  static_assert(BodyParsers::Find("ab") == 0);
+  static_assert(BodyParsers::Find("ba") == 1);
+  static_assert(BodyParsers::Find({"a\0", 2}) == 2);
+  static_assert(BodyParsers::Find("a") == kNoBatch);
+  // The codes too long to be packed are compared as strings
+  static_assert(BodyParsers::Find("ascii-encoded") == 3);
+  static_assert(BodyParsers::Find("hex16-encoded") == 4);
+  static_assert(BodyParsers::Find("utf16-encoded") == kNoBatch);
+  ASSERT_THAT(BodyParsers::Find(std::string{"hex16-encoded"}), Eq(4));
+  ASSERT_THAT(BodyParsers::Find(std::string{"ba"}), Eq(1));
+}
+
+TEST_F(StaticParserTest, SameResultsAsTheRuntimeParser) {
+  using pipelines::log_message_parser::semantics::BodyDecoding;
+  using pipelines::log_message_parser::semantics::test::CreateMixedInput;
+  using pipelines::log_message_parser::semantics::test::
+      ExpectSameAsRuntimeParser;
+
+  ExpectSameAsRuntimeParser(CreateMixedInput(), BodyDecoding::kEager);
+  ExpectSameAsRuntimeParser(CreateMixedInput(), BodyDecoding::kLazy);
+}
+
+TEST_F(StaticParserTest, ReportsTheErrorsInTheOriginalOrder) {
+  using pipelines::log_message_parser::semantics::test::ApplicationParser;
+  using pipelines::log_message_parser::semantics::test::CreateMixedInput;
+  using SemanticLogMessage =
+      pipelines::log_message_parser::semantics::LogMessage;
+
+  auto result = ApplicationParser{}.Parse(CreateMixedInput());
+
+  ASSERT_THAT(result.messages().size(), Eq(3));
+  ASSERT_THAT(result.messages()[0],
+              Eq(SemanticLogMessage{"1", "1", "some ascii body", "2"}));
+  ASSERT_THAT(result.messages()[1],
+              Eq(SemanticLogMessage{"1", "2", "body", "3"}));
+  ASSERT_THAT(result.messages()[2], Eq(SemanticLogMessage{"1", "6", "", "-1"}));
+  ASSERT_THAT(result.errors().size(), Eq(3));
+  ASSERT_THAT(result.errors()[0].message(),
+              HasSubstr("non-hexadecimal characters"));
+  ASSERT_THAT(result.errors()[1].message(),
+              HasSubstr("Encoding \"7\" is not supported"));
+  ASSERT_THAT(result.errors()[2].message(), HasSubstr("odd number"));
+}
+
+TEST_F(StaticParserTest, LazyDecodingKeepsTheViewedInputAlive) {
+  using pipelines::log_message_parser::semantics::BodyDecoding;
+  using pipelines::log_message_parser::semantics::test::ApplicationParser;
+  using pipelines::log_message_parser::structure::LogMessageViews;
+  using SemanticLogMessage =
+      pipelines::log_message_parser::semantics::LogMessage;
+
+  auto input = std::make_shared<std::string>("4F4B");
+  auto parse_result = ApplicationParser{BodyDecoding::kLazy}.Parse(
+      LogMessageViews{{"1", "2", "1", *input, "-1"}}, input);
+  input.reset();
+
+  ASSERT_THAT(parse_result.messages().size(), Eq(1));
+  ASSERT_THAT(parse_result.messages()[0].body().is_decoded(), Eq(false));
+  ASSERT_THAT(parse_result.messages()[0],
+              Eq(SemanticLogMessage{"1", "2", "OK", "-1"}));
+}
+
+TEST_F(StaticParserTest, BodyParsersThatOnlyParseWork) {
+  using pipelines::log_message_parser::semantics::Encoding;
+  using pipelines::log_message_parser::semantics::StaticParser;
+  using pipelines::log_message_parser::semantics::test::UpperCaseBodyParser;
+  using StructureLogMessages =
+      pipelines::log_message_parser::structure::LogMessages;
+  using SemanticLogMessage =
+      pipelines::log_message_parser::semantics::LogMessage;
+
+  auto parser = StaticParser<Encoding<"u", UpperCaseBodyParser>>{};
+  auto parse_result =
+      parser.Parse(StructureLogMessages{{"1", "2", "u", "body", "-1"}});
+
+  ASSERT_THAT(parse_result.HasErrors(), Eq(false));
+  ASSERT_THAT(parse_result.messages()[0],
+              Eq(SemanticLogMessage{"1", "2", "BODY", "-1"}));
+}
+
+TEST_F(StaticParserTest, ValidateGivesTheErrorsOfParse) {
+  using pipelines::log_message_parser::semantics::AsciiBodyParser;
+  using pipelines::log_message_parser::semantics::Hex16BodyParser;
+  using pipelines::log_message_parser::semantics::MessageErrors;
+  using pipelines::log_message_parser::semantics::Parser;
+  using pipelines::log_message_parser::semantics::test::ApplicationParser;
+  using pipelines::log_message_parser::semantics::test::CreateMixedInput;
+
+  auto runtime_parser = Parser{};
+  runtime_parser.RegisterBodyParser("0", std::make_unique<AsciiBodyParser>());
+  runtime_parser.RegisterBodyParser("1", std::make_unique<Hex16BodyParser>());
+  auto parse_result = ApplicationParser{}.Parse(CreateMixedInput());
+
+  for (const auto& errors :
+       {ApplicationParser{}.Validate(CreateMixedInput()),
+        runtime_parser.Validate(CreateMixedInput())}) {
+    ASSERT_THAT(errors.size(), Eq(CreateMixedInput().size()));
+    auto parsed_errors = size_t{0};
+    for (size_t i = 0; i < errors.size(); ++i) {
+      // Only the messages 3, 4 and 5 are invalid
+      ASSERT_THAT(errors[i].has_value(), Eq(i >= 2 && i <= 4));
+      if (errors[i]) {
+        ASSERT_THAT(errors[i]->message(),
+                    Eq(parse_result.errors()[parsed_errors++].message()));
+      }
+    }
+    ASSERT_THAT(parsed_errors, Eq(parse_result.errors().size()));
+  }
+}
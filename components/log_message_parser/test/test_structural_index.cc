@@ -0,0 +1,162 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <array>
+#include <cctype>
+#include <random>
+#include <string>
+#include "structural_index.h"
+
+using ::testing::Eq;
+
+class StructuralIndexTest : public ::testing::Test {
+ protected:
+  /**
+   * Computes the masks of a block one character at a time, with the same
+   * functions used by the original character by character parser.
+   */
+  static pipelines::log_message_parser::structure::BlockMasks ReferenceMasks(
+      const char* block) {
+    auto masks = pipelines::log_message_parser::structure::BlockMasks{};
+    for (size_t i = 0;
+         i < pipelines::log_message_parser::structure::kIndexBlockSize; ++i) {
+      const auto character = block[i];
+      const auto bit = uint64_t{1} << i;
+      if (std::isspace(static_cast<unsigned char>(character))) {
+        masks.whitespace |= bit;
+      }
+      if (character == ']') {
+        masks.close_bracket |= bit;
+      }
+      if (character == '\n' || character == '\r') {
+        masks.end_of_line |= bit;
+      }
+      if (character == '\n') {
+        masks.newline |= bit;
+      }
+    }
+    return masks;
+  }
+
+  static void ExpectSameMasks(
+      const pipelines::log_message_parser::structure::BlockMasks& result,
+      const pipelines::log_message_parser::structure::BlockMasks& expected) {
+    ASSERT_THAT(result.whitespace, Eq(expected.whitespace));
+    ASSERT_THAT(result.close_bracket, Eq(expected.close_bracket));
+    ASSERT_THAT(result.end_of_line, Eq(expected.end_of_line));
+    ASSERT_THAT(result.newline, Eq(expected.newline));
+  }
+};
+
+TEST_F(StructuralIndexTest, KernelsClassifyEveryByte) {
+  using pipelines::log_message_parser::structure::IndexBlock;
+  using pipelines::log_message_parser::structure::IndexBlockScalar;
+  using pipelines::log_message_parser::structure::kIndexBlockSize;
+
+  for (size_t first = 0; first < 256; first += kIndexBlockSize) {
+    auto block = std::array<char, kIndexBlockSize>{};
+    for (size_t i = 0; i < kIndexBlockSize; ++i) {
+      block[i] = static_cast<char>(first + i);
+    }
+    ExpectSameMasks(IndexBlockScalar(block.data()),
+                    ReferenceMasks(block.data()));
+    ExpectSameMasks(IndexBlock(block.data()), ReferenceMasks(block.data()));
+  }
+}
+
+TEST_F(StructuralIndexTest, KernelsMatchOnRandomBlocks) {
+  using pipelines::log_message_parser::structure::IndexBlock;
+  using pipelines::log_message_parser::structure::IndexBlockScalar;
+  using pipelines::log_message_parser::structure::kIndexBlockSize;
+
+  constexpr auto kAlphabet = std::string_view{" \t\n\v\f\r[]ab\x80\xff"};
+  auto generator = std::mt19937{42};
+  auto distribution =
+      std::uniform_int_distribution<size_t>{0, kAlphabet.size() - 1};
+
+  for (int i = 0; i < 1000; ++i) {
+    auto block = std::array<char, kIndexBlockSize>{};
+    for (auto& character : block) {
+      character = kAlphabet[distribution(generator)];
+    }
+    ExpectSameMasks(IndexBlockScalar(block.data()),
+                    ReferenceMasks(block.data()));
+    ExpectSameMasks(IndexBlock(block.data()), ReferenceMasks(block.data()));
+  }
+}
+
+TEST_F(StructuralIndexTest, FindStopsAtSelectedCharacter) {
+  using pipelines::log_message_parser::structure::BlockMasks;
+  using pipelines::log_message_parser::structure::StructuralIndex;
+
+  auto input = std::string{"abc\n\ndef]ghi"};
+  auto index = StructuralIndex{input};
+  auto result = index.Find(
+      0, [](const BlockMasks& masks) { return masks.close_bracket; });
+
+  ASSERT_THAT(result.position, Eq(8));
+  ASSERT_THAT(result.newlines, Eq(2));
+}
+
+TEST_F(StructuralIndexTest, FindAcrossBlocks) {
+  using pipelines::log_message_parser::structure::BlockMasks;
+  using pipelines::log_message_parser::structure::StructuralIndex;
+
+  auto input = std::string(200, 'a');
+  input[10] = '\n';
+  input[70] = '\n';
+  input[150] = ']';
+  input[190] = '\n';
+  auto index = StructuralIndex{input};
+  auto result = index.Find(
+      11, [](const BlockMasks& masks) { return masks.close_bracket; });
+
+  ASSERT_THAT(result.position, Eq(150));
+  ASSERT_THAT(result.newlines, Eq(1));
+}
+
+TEST_F(StructuralIndexTest, FindWithoutMatchReturnsTheSize) {
+  using pipelines::log_message_parser::structure::BlockMasks;
+  using pipelines::log_message_parser::structure::StructuralIndex;
+
+  auto input = std::string(130, '\n');
+  auto index = StructuralIndex{input};
+  auto result = index.Find(
+      5, [](const BlockMasks& masks) { return ~masks.whitespace; });
+
+  ASSERT_THAT(result.position, Eq(130));
+  ASSERT_THAT(result.newlines, Eq(125));
+}
+
+TEST_F(StructuralIndexTest, FindIgnoresBytesAfterTheBuffer) {
+  using pipelines::log_message_parser::structure::BlockMasks;
+  using pipelines::log_message_parser::structure::StructuralIndex;
+
+  auto input = std::string{"   ]   "};
+  auto index = StructuralIndex{std::string_view{input}.substr(0, 3)};
+  auto result = index.Find(
+      0, [](const BlockMasks& masks) { return masks.close_bracket; });
+
+  ASSERT_THAT(result.position, Eq(3));
+}
+
+TEST_F(StructuralIndexTest, FindStopsAtTheEnd) {
+  using pipelines::log_message_parser::structure::BlockMasks;
+  using pipelines::log_message_parser::structure::StructuralIndex;
+
+  auto input = std::string(200, '\n');
+  input[150] = ']';
+  auto index = StructuralIndex{input};
+  auto selector = [](const BlockMasks& masks) { return masks.close_bracket; };
+
+  auto before_match = index.Find(10, selector, 100);
+  ASSERT_THAT(before_match.position, Eq(100));
+  ASSERT_THAT(before_match.newlines, Eq(90));
+
+  auto after_match = index.Find(10, selector, 151);
+  ASSERT_THAT(after_match.position, Eq(150));
+  ASSERT_THAT(after_match.newlines, Eq(140));
+
+  auto at_match = index.Find(10, selector, 150);
+  ASSERT_THAT(at_match.position, Eq(150));
+  ASSERT_THAT(at_match.newlines, Eq(140));
+}
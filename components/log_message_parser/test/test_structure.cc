@@ -883,4 +883,73 @@ legacy-hex 1 1
                             "e6563207665686963756c612e20446f6e6563206672696e"
                             "67696c6c61206c6163696e696120656c656966656e\n642e",
                             "2"}));
-}
\ No newline at end of file
+}
+
+TEST_F(LogMessageParserTest, UnterminatedBodyWithinByteLimit) {
+  using pipelines::log_message_parser::structure::LogMessage;
+  using pipelines::log_message_parser::structure::Parser;
+
+  std::istringstream input(
+      "1 0 0 [unterminated\n"
+      "this is not a message ] [\n"
+      "   2 1 0 [ok] 2\n"
+      "2 2 0 [exactly 11!] 3\n");
+  auto parser = Parser{input, 1, {.max_bytes = 11}};
+  auto parse_result = parser.Parse();
+  auto result = parse_result.messages();
+
+  ASSERT_THAT(parse_result.errors().size(), Eq(1));
+  ASSERT_THAT(parse_result.errors()[0].message(),
+              Eq("Body too long: Exceeded the maximum body size"));
+  ASSERT_THAT(parse_result.errors()[0].line_number(), Eq(1));
+  ASSERT_THAT(result.size(), Eq(2));
+  ASSERT_THAT(result[0], Eq(LogMessage{"2", "1", "0", "ok", "2"}));
+  ASSERT_THAT(result[1], Eq(LogMessage{"2", "2", "0", "exactly 11!", "3"}));
+}
+
+TEST_F(LogMessageParserTest, UnterminatedBodyWithinLineLimit) {
+  using pipelines::log_message_parser::structure::LogMessage;
+  using pipelines::log_message_parser::structure::Parser;
+
+  std::istringstream input(
+      "1 0 0 [two\nlines] 1\n"
+      "1 1 0 [three\nlines\nbody] 2\n"
+      "1 2 0 [ok] 3\n");
+  auto parser = Parser{input, 1, {.max_lines = 2}};
+  auto parse_result = parser.Parse();
+  auto result = parse_result.messages();
+
+  ASSERT_THAT(parse_result.errors().size(), Eq(1));
+  ASSERT_THAT(parse_result.errors()[0].message(),
+              Eq("Body too long: Exceeded the maximum number of body lines"));
+  ASSERT_THAT(parse_result.errors()[0].line_number(), Eq(3));
+  ASSERT_THAT(result.size(), Eq(2));
+  ASSERT_THAT(result[0], Eq(LogMessage{"1", "0", "0", "two\nlines", "1"}));
+  ASSERT_THAT(result[1], Eq(LogMessage{"1", "2", "0", "ok", "3"}));
+}
+
+TEST_F(LogMessageParserTest, UnterminatedBodyLongerThanTheWindow) {
+  using pipelines::log_message_parser::structure::LogMessage;
+  using pipelines::log_message_parser::structure::Parser;
+
+  auto text = std::string{"1 0 0 [unterminated\n"};
+  for (int i = 0; i < 100000; ++i) {
+    text += "garbage [ line\n";
+  }
+  text += "1 1 0 [ok] 2\n";
+
+  std::istringstream input(text);
+  auto parser = Parser{input, 1, {.max_bytes = 64}};
+  auto parse_result = parser.Parse();
+  auto result = parse_result.messages();
+
+  ASSERT_THAT(parse_result.errors().size(), Eq(1));
+  ASSERT_THAT(result.size(), Eq(1));
+  ASSERT_THAT(result[0], Eq(LogMessage{"1", "1", "0", "ok", "2"}));
+
+  // Without a limit, the first message swallows the whole input
+  std::istringstream unlimited_input(text);
+  auto unlimited_result = Parser{unlimited_input}.Parse().messages();
+  ASSERT_THAT(unlimited_result.size(), Eq(1));
+  ASSERT_THAT(unlimited_result[0].id(), Eq("0"));
+}
@@ -0,0 +1,326 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <array>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include "log_message_parser/structure.h"
+#include "log_message_parser/structure_incremental.h"
+
+using ::testing::Eq;
+using ::testing::HasSubstr;
+using ::testing::Le;
+
+class StructureIncrementalParserTest : public ::testing::Test {
+ protected:
+  /**
+   * Feeds the input in blocks of the given size, collecting everything the
+   * parser returns.
+   */
+  static pipelines::log_message_parser::structure::ParseResult FeedInBlocks(
+      std::string_view input, size_t block_size,
+      pipelines::log_message_parser::structure::BodyLimits body_limits = {}) {
+    using pipelines::log_message_parser::structure::IncrementalParser;
+    using pipelines::log_message_parser::structure::LogMessages;
+    using pipelines::log_message_parser::structure::ParseErrors;
+    using pipelines::log_message_parser::structure::ParseResult;
+
+    auto messages = LogMessages{};
+    auto errors = ParseErrors{};
+    auto append = [&messages, &errors](const ParseResult& result) {
+      messages.insert(messages.end(), result.messages().begin(),
+                      result.messages().end());
+      errors.insert(errors.end(), result.errors().begin(),
+                    result.errors().end());
+    };
+
+    auto parser = IncrementalParser{body_limits};
+    for (size_t i = 0; i < input.size(); i += block_size) {
+      auto block = input.substr(i, block_size);
+      append(parser.Feed(std::span{block.data(), block.size()}));
+    }
+    append(parser.Finish());
+    return {messages, errors};
+  }
+
+  /**
+   * Feeds the input in blocks of several sizes and checks that all of them
+   * produce the same messages and errors as the stream parser.
+   */
+  static void ExpectSameAsStreamParser(
+      const std::string& input,
+      pipelines::log_message_parser::structure::BodyLimits body_limits = {}) {
+    using pipelines::log_message_parser::structure::Parser;
+
+    auto input_stream = std::istringstream{input};
+    auto expected = Parser{input_stream, 1, body_limits}.Parse();
+
+    for (size_t block_size : {1, 2, 7, 64, 1000, 100000}) {
+      auto result = FeedInBlocks(input, block_size, body_limits);
+
+      ASSERT_THAT(result.messages(), Eq(expected.messages()));
+      ASSERT_THAT(result.errors().size(), Eq(expected.errors().size()));
+      for (size_t i = 0; i < expected.errors().size(); ++i) {
+        ASSERT_THAT(result.errors()[i].message(),
+                    Eq(expected.errors()[i].message()));
+        ASSERT_THAT(result.errors()[i].line_number(),
+                    Eq(expected.errors()[i].line_number()));
+      }
+    }
+  }
+};
+
+TEST_F(StructureIncrementalParserTest, EmptyInput) {
+  ExpectSameAsStreamParser("");
+  ExpectSameAsStreamParser(" \n\t\r\n");
+}
+
+TEST_F(StructureIncrementalParserTest, ValidMessages) {
+  ExpectSameAsStreamParser(
+      "2 3 1 [4F4B] -1\n"
+      "1 0 0 [some text] 1\n"
+      "1 1 0 [another text] 2\r\n"
+      "2 99 1 [4F4B] 3\n"
+      "1 2 1 [626F6479] -1");
+}
+
+TEST_F(StructureIncrementalParserTest, BodiesSpanningLines) {
+  ExpectSameAsStreamParser(
+      "1 0 0 [first\nline] ]\n second] 1\n"
+      "1 1 0 [a]\n\n b] \n\n 2 \n"
+      "1 2 0 [unterminated\n 3 4 5 [x] 6 7\n");
+}
+
+TEST_F(StructureIncrementalParserTest, InvalidMessages) {
+  ExpectSameAsStreamParser(
+      "1 2 0 no brackets 3\n"
+      "1 3 0 [body] 4 trailing\n"
+      "1 4\n"
+      "unparsed line\n"
+      "1 5 0 [body] 6\n"
+      "1 6 0 [body]");
+}
+
+TEST_F(StructureIncrementalParserTest, RandomInputs) {
+  constexpr auto kTokens = std::array<std::string_view, 10>{
+      "1 2 3 [", "a", " ", "\n", "]", "] 4\n", "[", "x y z [w] 5\n", "\r\n",
+      "\t"};
+  for (unsigned seed = 0; seed < 10; ++seed) {
+    auto generator = std::mt19937{seed};
+    auto distribution =
+        std::uniform_int_distribution<size_t>{0, kTokens.size() - 1};
+
+    auto input = std::string{};
+    while (input.size() < 2000) {
+      input += kTokens[distribution(generator)];
+    }
+    ExpectSameAsStreamParser(input);
+  }
+}
+
+TEST_F(StructureIncrementalParserTest, BodiesExceedingTheLimits) {
+  ExpectSameAsStreamParser(
+      "1 0 0 [unterminated\n more\n 1 [x] 2\n garbage\n1 1 0 [ok] 2\n",
+      {.max_bytes = 8});
+  ExpectSameAsStreamParser(
+      "1 0 0 [unterminated\n more\n 1 [x] 2\n garbage\n1 1 0 [ok] 2\n",
+      {.max_lines = 2});
+  ExpectSameAsStreamParser("1 0 0 [unterminated\n a\n b\n 1 2",
+                           {.max_lines = 1});
+
+  constexpr auto kTokens = std::array<std::string_view, 8>{
+      "1 2 3 [", "a", " ", "\n", "]", "] 4\n", "x y z [w] 5\n", "\r\n"};
+  for (unsigned seed = 0; seed < 10; ++seed) {
+    auto generator = std::mt19937{seed};
+    auto distribution =
+        std::uniform_int_distribution<size_t>{0, kTokens.size() - 1};
+
+    auto input = std::string{};
+    while (input.size() < 2000) {
+      input += kTokens[distribution(generator)];
+    }
+    ExpectSameAsStreamParser(input, {.max_bytes = 16});
+    ExpectSameAsStreamParser(input, {.max_lines = 2});
+  }
+}
+
+TEST_F(StructureIncrementalParserTest, SkippedLinesAreNotKept) {
+  using pipelines::log_message_parser::structure::IncrementalParser;
+  using pipelines::log_message_parser::structure::LogMessage;
+
+  auto parser = IncrementalParser{{.max_bytes = 16}};
+  auto feed = [&parser](std::string_view block) {
+    return parser.Feed(std::span{block.data(), block.size()});
+  };
+
+  auto result = feed("1 2 0 [this body never ends\n");
+  ASSERT_THAT(result.errors().size(), Eq(1));
+  ASSERT_THAT(result.errors()[0].message(), HasSubstr("Body too long"));
+
+  // The error is only reported once, however long the garbage is
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_THAT(feed("more garbage ] ] [\n").errors().size(), Eq(0));
+  }
+
+  result = feed("1 3 0 [x] 4\n");
+  ASSERT_THAT(result.messages().size(), Eq(1));
+  ASSERT_THAT(result.messages()[0], Eq(LogMessage{"1", "3", "0", "x", "4"}));
+  ASSERT_THAT(result.errors().size(), Eq(0));
+  ASSERT_THAT(parser.Finish().errors().size(), Eq(0));
+}
+
+TEST_F(StructureIncrementalParserTest, BodiesWithoutAnEndOfLineAreBounded) {
+  using pipelines::log_message_parser::structure::IncrementalParser;
+  using pipelines::log_message_parser::structure::LogMessage;
+  using pipelines::log_message_parser::structure::ParseErrors;
+
+  constexpr auto kMaxBodyBytes = size_t{1000};
+  constexpr auto kBlockSize = size_t{100};
+  auto parser = IncrementalParser{{.max_bytes = kMaxBodyBytes}};
+  auto feed = [&parser](std::string_view block) {
+    return parser.Feed(std::span{block.data(), block.size()});
+  };
+
+  // The body and the garbage skipped after it never reach an end of line
+  auto errors = ParseErrors{};
+  feed("1 2 0 [");
+  const auto block = std::string(kBlockSize, 'a');
+  for (int i = 0; i < 1000; ++i) {
+    auto result = feed(block);
+    ASSERT_THAT(result.messages().size(), Eq(0));
+    errors.insert(errors.end(), result.errors().begin(),
+                  result.errors().end());
+    ASSERT_THAT(parser.pending_size(), Le(2 * kMaxBodyBytes + kBlockSize));
+  }
+  ASSERT_THAT(errors.size(), Eq(1));
+  ASSERT_THAT(errors[0].message(), HasSubstr("Body too long"));
+
+  auto result = feed("\n1 3 0 [x] 4\n");
+  ASSERT_THAT(result.messages().size(), Eq(1));
+  ASSERT_THAT(result.messages()[0], Eq(LogMessage{"1", "3", "0", "x", "4"}));
+  ASSERT_THAT(result.errors().size(), Eq(0));
+  ASSERT_THAT(parser.Finish().errors().size(), Eq(0));
+}
+
+TEST_F(StructureIncrementalParserTest, MessagesAreReturnedAsSoonAsComplete) {
+  using pipelines::log_message_parser::structure::IncrementalParser;
+  using pipelines::log_message_parser::structure::LogMessage;
+
+  auto parser = IncrementalParser{};
+  auto feed = [&parser](std::string_view block) {
+    return parser.Feed(std::span{block.data(), block.size()});
+  };
+
+  ASSERT_THAT(feed("1 2 0 [body").messages().size(), Eq(0));
+  ASSERT_THAT(feed("] 3").messages().size(), Eq(0));
+
+  // The next ID could still continue
+  ASSERT_THAT(feed("4").messages().size(), Eq(0));
+
+  auto result = feed("\n1 3 0 [x] 4 5\n1 4");
+  ASSERT_THAT(result.messages().size(), Eq(1));
+  ASSERT_THAT(result.messages()[0],
+              Eq(LogMessage{"1", "2", "0", "body", "34"}));
+  ASSERT_THAT(result.errors().size(), Eq(0));
+
+  // The body of the second message could still end in another line
+  result = feed(" 0 [y] 5");
+  ASSERT_THAT(result.messages().size(), Eq(0));
+
+  result = parser.Finish();
+  ASSERT_THAT(result.messages().size(), Eq(1));
+  ASSERT_THAT(result.messages()[0],
+              Eq(LogMessage{"1", "3", "0", "x] 4 5\n1 4 0 [y", "5"}));
+}
+
+TEST_F(StructureIncrementalParserTest, ErrorsAreReturnedWithTheirMessage) {
+  using pipelines::log_message_parser::structure::IncrementalParser;
+
+  auto parser = IncrementalParser{};
+  auto feed = [&parser](std::string_view block) {
+    return parser.Feed(std::span{block.data(), block.size()});
+  };
+
+  ASSERT_THAT(feed("\n\n1 2 0 no brackets").errors().size(), Eq(0));
+
+  auto result = feed(" 3\n");
+  ASSERT_THAT(result.messages().size(), Eq(0));
+  ASSERT_THAT(result.errors().size(), Eq(2));
+  ASSERT_THAT(result.errors()[0].message(),
+              HasSubstr("Expected an opening bracket"));
+  ASSERT_THAT(result.errors()[0].line_number(), Eq(3));
+  ASSERT_THAT(result.errors()[1].message(),
+              HasSubstr("There is unparsed data in line 3"));
+}
+
+TEST_F(StructureIncrementalParserTest, FinishStartsANewInput) {
+  using pipelines::log_message_parser::structure::IncrementalParser;
+  using pipelines::log_message_parser::structure::LogMessage;
+
+  auto parser = IncrementalParser{};
+  auto feed = [&parser](std::string_view block) {
+    return parser.Feed(std::span{block.data(), block.size()});
+  };
+
+  feed("\n\n1 2 0 [unterminated\n");
+  auto result = parser.Finish();
+  ASSERT_THAT(result.errors().size(), Eq(1));
+  ASSERT_THAT(result.errors()[0].line_number(), Eq(3));
+
+  result = feed("\n1 2 0 no brackets 3\n");
+  ASSERT_THAT(result.errors().size(), Eq(2));
+  ASSERT_THAT(result.errors()[0].line_number(), Eq(2));
+  ASSERT_THAT(parser.Finish().errors().size(), Eq(0));
+}
+
+TEST_F(StructureIncrementalParserTest, BigBodiesAreOnlyScannedOnce) {
+  using pipelines::log_message_parser::structure::IncrementalParser;
+  using pipelines::log_message_parser::structure::LogMessages;
+  using pipelines::log_message_parser::structure::ParseErrors;
+  using pipelines::log_message_parser::structure::ParseResult;
+  using pipelines::log_message_parser::structure::Parser;
+
+  // Many lines with closing brackets that don't end the body, so every
+  // block completes lines but not the message. Scanning the body again for
+  // every block would take minutes.
+  constexpr auto kBodySize = size_t{8 * 1024 * 1024};
+  constexpr auto kBlockSize = size_t{4096};
+  auto body = std::string{};
+  for (size_t line = 0; body.size() < kBodySize; ++line) {
+    body += "line " + std::to_string(line) + " ] is not the end ]]\n";
+  }
+
+  for (const auto& end : {std::string{"] 2\n1 2 0 [last] -1\n"},
+                          std::string{"without a closing bracket\n"}}) {
+    const auto input = "1 1 0 [" + body + end;
+    auto parser = IncrementalParser{};
+    auto messages = LogMessages{};
+    auto errors = ParseErrors{};
+    auto append = [&messages, &errors](const ParseResult& result) {
+      messages.insert(messages.end(), result.messages().begin(),
+                      result.messages().end());
+      errors.insert(errors.end(), result.errors().begin(),
+                    result.errors().end());
+    };
+    for (size_t i = 0; i < input.size(); i += kBlockSize) {
+      auto block = std::string_view{input}.substr(i, kBlockSize);
+      append(parser.Feed(std::span{block.data(), block.size()}));
+      if (i + kBlockSize < input.size() - end.size()) {
+        ASSERT_THAT(messages.size(), Eq(0));
+        ASSERT_THAT(errors.size(), Eq(0));
+      }
+    }
+    append(parser.Finish());
+
+    auto input_stream = std::istringstream{input};
+    auto expected = Parser{input_stream}.Parse();
+    ASSERT_THAT(messages, Eq(expected.messages()));
+    ASSERT_THAT(errors.size(), Eq(expected.errors().size()));
+    for (size_t i = 0; i < expected.errors().size(); ++i) {
+      ASSERT_THAT(errors[i].message(), Eq(expected.errors()[i].message()));
+      ASSERT_THAT(errors[i].line_number(),
+                  Eq(expected.errors()[i].line_number()));
+    }
+  }
+}
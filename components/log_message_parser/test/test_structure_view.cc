@@ -0,0 +1,219 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include "log_message_parser/structure.h"
+#include "log_message_parser/structure_view.h"
+
+using ::testing::Eq;
+using ::testing::HasSubstr;
+
+class StructureViewParserTest : public ::testing::Test {
+ protected:
+  /**
+   * Parses the input with both the stream parser and the view parser and
+   * checks that both of them produce the same messages and errors.
+   */
+  static void ExpectSameAsStreamParser(const std::string& input) {
+    using pipelines::log_message_parser::structure::Parser;
+    using pipelines::log_message_parser::structure::ViewParser;
+
+    auto input_stream = std::istringstream(input);
+    auto expected = Parser{input_stream}.Parse();
+    auto result = ViewParser{std::span{input.data(), input.size()}}.Parse();
+
+    ASSERT_THAT(result.messages().size(), Eq(expected.messages().size()));
+    for (size_t i = 0; i < expected.messages().size(); ++i) {
+      ASSERT_THAT(result.messages()[i].ToLogMessage(),
+                  Eq(expected.messages()[i]));
+    }
+    ASSERT_THAT(result.errors().size(), Eq(expected.errors().size()));
+    for (size_t i = 0; i < expected.errors().size(); ++i) {
+      ASSERT_THAT(result.errors()[i].message(),
+                  Eq(expected.errors()[i].message()));
+      ASSERT_THAT(result.errors()[i].line_number(),
+                  Eq(expected.errors()[i].line_number()));
+    }
+  }
+
+  /**
+   * Parses the input with several thread counts and checks that all of them
+   * produce the same messages and errors as the sequential parsers.
+   */
+  static void ExpectSameForAnyThreadCount(const std::string& input) {
+    using pipelines::log_message_parser::structure::Parser;
+    using pipelines::log_message_parser::structure::ViewParser;
+
+    auto span = std::span{input.data(), input.size()};
+    auto expected = ViewParser{span}.Parse();
+
+    for (size_t thread_count : {2, 3}) {
+      auto result = ViewParser{span, thread_count}.Parse();
+      ASSERT_THAT(result.messages(), Eq(expected.messages()));
+      ASSERT_THAT(result.errors().size(), Eq(expected.errors().size()));
+      for (size_t i = 0; i < expected.errors().size(); ++i) {
+        ASSERT_THAT(result.errors()[i].message(),
+                    Eq(expected.errors()[i].message()));
+        ASSERT_THAT(result.errors()[i].line_number(),
+                    Eq(expected.errors()[i].line_number()));
+      }
+    }
+
+    auto input_stream = std::istringstream(input);
+    auto owned_result = Parser{input_stream, 4}.Parse();
+    ASSERT_THAT(owned_result.messages().size(),
+                Eq(expected.messages().size()));
+    for (size_t i = 0; i < expected.messages().size(); ++i) {
+      ASSERT_THAT(owned_result.messages()[i],
+                  Eq(expected.messages()[i].ToLogMessage()));
+    }
+    ASSERT_THAT(owned_result.errors().size(), Eq(expected.errors().size()));
+  }
+
+  /**
+   * Writes the given content into a temporary file and returns its path.
+   */
+  static std::string WriteTemporaryFile(const std::string& content) {
+    auto path = std::filesystem::temp_directory_path() /
+                ("structure_view_test_" +
+                 std::to_string(::testing::UnitTest::GetInstance()
+                                    ->current_test_info()
+                                    ->line()) +
+                 ".txt");
+    std::ofstream file(path, std::ios::binary);
+    file << content;
+    return path.string();
+  }
+};
+
+TEST_F(StructureViewParserTest, EmptyInput) {
+  using pipelines::log_message_parser::structure::ViewParser;
+
+  auto input = std::string{};
+  auto parse_result = ViewParser{std::span{input.data(), input.size()}}.Parse();
+
+  ASSERT_THAT(parse_result.HasErrors(), Eq(false));
+  ASSERT_THAT(parse_result.messages().size(), Eq(0));
+}
+
+TEST_F(StructureViewParserTest, SingleLineInput) {
+  using pipelines::log_message_parser::structure::LogMessageView;
+  using pipelines::log_message_parser::structure::ViewParser;
+
+  auto input = std::string{"1 2 3 [4F4B] -1"};
+  auto parse_result = ViewParser{std::span{input.data(), input.size()}}.Parse();
+
+  ASSERT_THAT(parse_result.HasErrors(), Eq(false));
+  ASSERT_THAT(parse_result.messages().size(), Eq(1));
+  ASSERT_THAT(parse_result.messages()[0],
+              Eq(LogMessageView{"1", "2", "3", "4F4B", "-1"}));
+}
+
+TEST_F(StructureViewParserTest, FieldsPointIntoTheInput) {
+  using pipelines::log_message_parser::structure::ViewParser;
+
+  auto input = std::string{"pipeline id 0 [a [nested] body] next\n"};
+  auto parse_result = ViewParser{std::span{input.data(), input.size()}}.Parse();
+
+  ASSERT_THAT(parse_result.messages().size(), Eq(1));
+  const auto& message = parse_result.messages()[0];
+  auto input_begin = input.data();
+  auto input_end = input.data() + input.size();
+  for (auto field : {message.pipeline_id(), message.id(), message.encoding(),
+                     message.body(), message.next_id()}) {
+    ASSERT_TRUE(field.data() >= input_begin && field.data() < input_end);
+  }
+  ASSERT_THAT(message.body(), Eq("a [nested] body"));
+}
+
+TEST_F(StructureViewParserTest, ErrorsMatchTheStreamParser) {
+  ExpectSameAsStreamParser("This \n");
+  ExpectSameAsStreamParser("This is \n");
+  ExpectSameAsStreamParser("This is a \n");
+  ExpectSameAsStreamParser("This is a test\n");
+  ExpectSameAsStreamParser("This is a [tes[t] [test]\n");
+  ExpectSameAsStreamParser("This is a [test] [test] [test]\n");
+  ExpectSameAsStreamParser("This is a [test]\n");
+  ExpectSameAsStreamParser("1 2 3 [4F4B] -1 unparsed\n1 2 3 [4F4B] -1");
+  ExpectSameAsStreamParser("1 2 3 [open\n\n2 3 4 [body] 5\n6 7");
+}
+
+TEST_F(StructureViewParserTest, BodiesMatchTheStreamParser) {
+  ExpectSameAsStreamParser("1\t2    3\t[4F4B] -1\r\n");
+  ExpectSameAsStreamParser("1 2 3 [4F4B] -1\r   ");
+  ExpectSameAsStreamParser("1 2 3 [a te]st[] [message]]]]] -1\n");
+  ExpectSameAsStreamParser("1 2 3 [a test\n[message]] -1\n");
+  ExpectSameAsStreamParser("1 2 3 [a] b c] -1\n");
+  ExpectSameAsStreamParser("1 2 3 [body]\n\n  next  \n4 5 6 [x] -1");
+  ExpectSameAsStreamParser(
+      "2 3 1 [4F4B] -1\n"
+      "1 0 0 [some text] 1\n"
+      "1 1 0 [another text] 2\n"
+      "2 99 1 [4F4B] 3\n"
+      "1 2 1 [626F6479] -1\n");
+}
+
+TEST_F(StructureViewParserTest, LargeInputMatchesTheStreamParser) {
+  // Big enough for the stream parser to refill its window many times, with
+  // records and bodies crossing the window boundaries.
+  auto input = std::string{};
+  for (int i = 0; i < 20000; ++i) {
+    input += std::to_string(i % 7) + " " + std::to_string(i) + " 1 [" +
+             std::string(static_cast<size_t>(i % 97), 'a') + "] [x] " +
+             std::to_string(i + 1) + "\n";
+    if (i % 1000 == 0) {
+      input += "1 2 3 [" + std::string(100000, 'b') + "\n] -1\n";
+    }
+    if (i % 1500 == 0) {
+      input += "unparsed\n";
+    }
+  }
+  ExpectSameAsStreamParser(input);
+}
+
+TEST_F(StructureViewParserTest, ParallelParsingOfValidMessages) {
+  auto input = std::string{};
+  for (int i = 0; input.size() < 3 * 1024 * 1024; ++i) {
+    input += std::to_string(i % 13) + " " + std::to_string(i) + " 0 [body " +
+             std::to_string(i) + "] " + std::to_string(i + 1) + "\n";
+  }
+  ExpectSameForAnyThreadCount(input);
+}
+
+TEST_F(StructureViewParserTest, MappedFileIsKeptAliveByTheResult) {
+  using pipelines::log_message_parser::MappedFile;
+  using pipelines::log_message_parser::structure::LogMessageView;
+  using pipelines::log_message_parser::structure::ViewParser;
+
+  auto path = WriteTemporaryFile("1 2 3 [4F4B] -1\n1 3 0 [text] 2\n");
+  auto parser = ViewParser{std::make_shared<const MappedFile>(path)};
+  auto parse_result = parser.Parse();
+  parser = ViewParser{std::span<const char>{}};
+  std::filesystem::remove(path);
+
+  ASSERT_THAT(parse_result.HasErrors(), Eq(false));
+  ASSERT_THAT(parse_result.messages().size(), Eq(2));
+  ASSERT_THAT(parse_result.messages()[0],
+              Eq(LogMessageView{"1", "2", "3", "4F4B", "-1"}));
+  ASSERT_THAT(parse_result.messages()[1],
+              Eq(LogMessageView{"1", "3", "0", "text", "2"}));
+}
+
+TEST_F(StructureViewParserTest, MappedEmptyFile) {
+  using pipelines::log_message_parser::MappedFile;
+
+  auto path = WriteTemporaryFile("");
+  auto mapped_file = MappedFile{path};
+  std::filesystem::remove(path);
+
+  ASSERT_THAT(mapped_file.size(), Eq(0));
+}
+
+TEST_F(StructureViewParserTest, MappingMissingFileThrows) {
+  using pipelines::log_message_parser::MappedFile;
+  using pipelines::log_message_parser::MappedFileError;
+
+  ASSERT_THROW(MappedFile{"this/file/does/not/exist.txt"}, MappedFileError);
+}